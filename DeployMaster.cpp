@@ -47,6 +47,15 @@
 #include "src/utils/FormatUtils.h"      // formatFileSize()
 #include "config/SettingsDialog.h"      // 配置管理面板
 
+// 远程条目所在目录（以 '/' 结尾）："/a/b/" → "/a/"，"/a/f.txt" → "/a/"
+static QString remoteParentOf(const QString& remotePath)
+{
+    QString p = remotePath;
+    if (p.endsWith('/')) p.chop(1);
+    const int lastSlash = p.lastIndexOf('/');
+    return lastSlash >= 0 ? p.left(lastSlash + 1) : QStringLiteral("/");
+}
+
 DeployMaster::DeployMaster(QWidget* parent)
     : QMainWindow(parent)
 {
@@ -353,11 +362,19 @@ DeployMaster::~DeployMaster()
 
 void DeployMaster::setupRemotePreview()
 {
-    // 初始化远程文件模型，启用多选批量下载
-    remoteFileModel = new QStandardItemModel(this);
+    // 初始化远程文件模型，启用多选批量下载；子目录展开时才在后台列出
+    remoteFileModel = new RemoteFileTreeModel(this);
+    remoteFileModel->setIcons(QApplication::style()->standardIcon(QStyle::SP_DirIcon),
+                              QApplication::style()->standardIcon(QStyle::SP_FileIcon));
+    connect(remoteFileModel, &RemoteFileTreeModel::directoryFailed, this,
+            [this](const QString& path, const QString& error) {
+                appendGlobalLog(QString("❌ 展开失败 %1: %2").arg(path, error.left(100)));
+            });
     ui.tree_remoteFiles->setModel(remoteFileModel);
     ui.tree_remoteFiles->setSelectionMode(QAbstractItemView::ExtendedSelection);
     ui.tree_remoteFiles->setEditTriggers(QAbstractItemView::NoEditTriggers); // 禁用双击重命名
+    ui.tree_remoteFiles->setExpandsOnDoubleClick(false); // 双击进入目录，箭头原地展开
+    ui.tree_remoteFiles->setUniformRowHeights(true);
     ui.tree_remoteFiles->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(ui.tree_remoteFiles, &QTreeView::customContextMenuRequested,
             this, &DeployMaster::onRemoteFileContextMenu);
@@ -497,6 +514,11 @@ void DeployMaster::refreshRemoteFiles()
     
     appendGlobalLog(QString("🔄 正在刷新远程文件列表: %1%2").arg(currentRemoteIP).arg(currentRemotePath));
     
+    // 再次刷新当前目录时强制重新列出（增量更新缓存）；切换目录时 TTL 内直接用缓存
+    const QString listingKey = currentRemoteIP + currentRemotePath;
+    const bool forceRefresh = (listingKey == m_lastRemoteListing);
+    m_lastRemoteListing = listingKey;
+
     // 异步刷新远程文件列表（按值捕获避免数据竞争）
     QString ip = currentRemoteIP;
     QString path = currentRemotePath;
@@ -504,11 +526,17 @@ void DeployMaster::refreshRemoteFiles()
         try {
             FtpManager ftpm(ip, 21);
             ftpm.setCredentials(user, pass);
-            QList<FtpFileInfo> files = ftpm.listFtpDirectoryDetailed(path);
-            
+            RemoteTreeCache::Delta delta;
+            QList<FtpFileInfo> files = ftpm.listFtpDirectoryCached(path, forceRefresh, &delta);
+            RemoteFileTreeModel::sortEntries(files);   // 大目录排序不占用界面线程
+            const QString summary = delta.fromCache
+                ? QString("✅ 远程文件列表刷新成功（缓存，%1 项）").arg(files.size())
+                : QString("✅ 远程文件列表刷新成功（%1 项，新增 %2 / 删除 %3 / 变化 %4）")
+                      .arg(files.size()).arg(delta.added).arg(delta.removed).arg(delta.changed);
+
             // 在主线程更新UI
             QMetaObject::invokeMethod(this, "buildRemoteFileTree", Qt::QueuedConnection, Q_ARG(QList<FtpFileInfo>, files));
-            QMetaObject::invokeMethod(this, "appendGlobalLog", Qt::QueuedConnection, Q_ARG(QString, "✅ 远程文件列表刷新成功"));
+            QMetaObject::invokeMethod(this, "appendGlobalLog", Qt::QueuedConnection, Q_ARG(QString, summary));
         } catch (const std::exception& ex) {
             QMetaObject::invokeMethod(this, "appendGlobalLog", Qt::QueuedConnection, Q_ARG(QString, QString("❌ 刷新失败: %1").arg(QString::fromStdString(ex.what()).left(100))));
         }
@@ -517,80 +545,31 @@ void DeployMaster::refreshRemoteFiles()
 
 void DeployMaster::buildRemoteFileTree(const QList<FtpFileInfo>& files)
 {
-    // 清空现有模型
-    remoteFileModel->clear();
-    
-    // 添加根目录项
-    QStandardItem* rootItem = new QStandardItem(QString("%1 (%2)").arg(currentRemoteIP).arg(currentRemotePath));
-    rootItem->setData(currentRemotePath, Qt::UserRole);
-    rootItem->setData(true, Qt::UserRole + 1); // 标记为目录
-    rootItem->setData(true, Qt::UserRole + 2); // 标记为根目录项
-    remoteFileModel->appendRow(rootItem);
-    
-    // 添加返回上一级文件夹的选项（如果当前路径不是根目录）
-    if (currentRemotePath != "/" && !currentRemotePath.isEmpty()) {
-        QStandardItem* parentItem = new QStandardItem(".. (返回上一级)");
-        // 使用Qt标准目录图标
-        parentItem->setIcon(QApplication::style()->standardIcon(QStyle::SP_DirIcon));
-        QString parentPath = currentRemotePath;
-        // 移除末尾的斜杠
-        if (parentPath.endsWith('/')) {
-            parentPath.chop(1);
-        }
-        // 找到上一级目录
-        int lastSlashIndex = parentPath.lastIndexOf('/');
-        if (lastSlashIndex >= 0) {
-            parentPath = parentPath.left(lastSlashIndex + 1);
-        } else {
-            parentPath = "/";
-        }
-        parentItem->setData(parentPath, Qt::UserRole);
-        parentItem->setData(true, Qt::UserRole + 1); // 标记为目录
-        parentItem->setData(false, Qt::UserRole + 2); // 标记为非根目录项
-        rootItem->appendRow(parentItem);
-    }
-    
-    // 排序：目录在前，文件在后，各自按名称字母排序
-    QList<FtpFileInfo> sorted = files;
-    std::sort(sorted.begin(), sorted.end(), [](const FtpFileInfo& a, const FtpFileInfo& b) {
-        if (a.isDirectory != b.isDirectory)
-            return a.isDirectory > b.isDirectory; // 目录排在文件前
-        return a.name.compare(b.name, Qt::CaseInsensitive) < 0;
+    // 子目录展开时在后台列出（经远程树缓存，按设备区分）
+    const QString ip = currentRemoteIP;
+    const QString user = m_deviceBusWidget ? m_deviceBusWidget->user() : QString();
+    const QString pass = m_deviceBusWidget ? m_deviceBusWidget->password() : QString();
+    remoteFileModel->setLister([ip, user, pass](const QString& dir) {
+        FtpManager ftm(ip, 21);
+        ftm.setCredentials(user, pass);
+        return ftm.listFtpDirectoryCached(dir);
     });
 
-    // 添加文件和文件夹
-    for (const FtpFileInfo& file : sorted) {
-        QStandardItem* item;
-        if (file.isDirectory) {
-            item = new QStandardItem(file.name);
-            item->setIcon(QApplication::style()->standardIcon(QStyle::SP_DirIcon));
-            item->setData(currentRemotePath + file.name + "/", Qt::UserRole);
-            item->setData(true, Qt::UserRole + 1); // 标记为目录
-            item->setData(false, Qt::UserRole + 2); // 标记为非根目录项
-            item->setData(file.name, Qt::UserRole + 3); // 存储原始目录名
-        } else {
-            QString sizeStr = formatFileSize(file.size);
-            item = new QStandardItem(QString("%1 (%2)").arg(file.name, sizeStr));
-            item->setIcon(QApplication::style()->standardIcon(QStyle::SP_FileIcon));
-            item->setData(currentRemotePath + file.name, Qt::UserRole);
-            item->setData(false, Qt::UserRole + 1); // 标记为文件
-            item->setData(false, Qt::UserRole + 2); // 标记为非根目录项
-            item->setData(file.name, Qt::UserRole + 3); // 存储原始文件名
-        }
-        rootItem->appendRow(item);
-    }
-    
-    // 展开根节点
-    ui.tree_remoteFiles->expandAll();
+    // files 已在后台线程排序；只先插入第一批，其余随滚动按批插入
+    remoteFileModel->setRoot(QString("%1 (%2)").arg(currentRemoteIP).arg(currentRemotePath),
+                             currentRemotePath, files,
+                             currentRemotePath != "/" && !currentRemotePath.isEmpty());
+
+    // 只展开根节点（子目录按需加载）
+    ui.tree_remoteFiles->expand(remoteFileModel->index(0, 0));
 }
 
 void DeployMaster::onRemoteFileDoubleClicked(const QModelIndex& index)
 {
-    QStandardItem* item = remoteFileModel->itemFromIndex(index);
-    if (!item) return;
-    
-    bool isDirectory = item->data(Qt::UserRole + 1).toBool();
-    bool isRootItem = item->data(Qt::UserRole + 2).toBool();
+    if (!index.isValid()) return;
+
+    bool isDirectory = index.data(RemoteFileTreeModel::IsDirRole).toBool();
+    bool isRootItem = index.data(RemoteFileTreeModel::IsRootRole).toBool();
     
     if (isRootItem) {
         // 双击根目录项，允许编辑路径
@@ -610,7 +589,7 @@ void DeployMaster::onRemoteFileDoubleClicked(const QModelIndex& index)
             refreshRemoteFiles();
         }
     } else if (isDirectory) {
-        QString path = item->data(Qt::UserRole).toString();
+        QString path = index.data(RemoteFileTreeModel::PathRole).toString();
         currentRemotePath = path;
         appendGlobalLog(QString("📁 进入目录: %1").arg(path));
         refreshRemoteFiles();
@@ -643,14 +622,12 @@ void DeployMaster::onDownloadRemoteFile()
     QList<SelectedEntry> entries;
 
     for (const auto& idx : uniqueRows) {
-        QStandardItem* item = remoteFileModel->itemFromIndex(idx);
-        if (!item) continue;
-        bool isDir = item->data(Qt::UserRole + 1).toBool();
-        bool isRoot = item->data(Qt::UserRole + 2).toBool();
+        bool isDir = idx.data(RemoteFileTreeModel::IsDirRole).toBool();
+        bool isRoot = idx.data(RemoteFileTreeModel::IsRootRole).toBool();
         if (isRoot) continue;
 
-        QString remotePath = item->data(Qt::UserRole).toString();
-        QString name = item->data(Qt::UserRole + 3).toString();
+        QString remotePath = idx.data(RemoteFileTreeModel::PathRole).toString();
+        QString name = idx.data(RemoteFileTreeModel::NameRole).toString();
 
         SelectedEntry e;
         e.remotePath = remotePath;
@@ -727,9 +704,14 @@ void DeployMaster::onDownloadRemoteFile()
             QString localPath = localDir + "/" + f.localName;
             QDir().mkpath(QFileInfo(localPath).absolutePath());
             try {
-                ftm.downloadFile(f.remotePath, localPath);
+                const qint64 resumed = ftm.downloadFile(f.remotePath, localPath);
                 ++success;
-                log(QString("  [%1/%2] ✅ %3").arg(i + 1).arg(total).arg(f.localName));
+                if (resumed > 0) {
+                    log(QString("  [%1/%2] ✅ %3（断点续传，复用 %4）").arg(i + 1).arg(total)
+                        .arg(f.localName).arg(formatFileSize(resumed)));
+                } else {
+                    log(QString("  [%1/%2] ✅ %3").arg(i + 1).arg(total).arg(f.localName));
+                }
             } catch (const std::exception& ex) {
                 ++failed;
                 log(QString("  [%1/%2] ❌ %3: %4").arg(i + 1).arg(total).arg(f.localName)
@@ -747,8 +729,8 @@ void DeployMaster::onDownloadRemoteFile()
 void DeployMaster::onRemoteFileContextMenu(const QPoint& pos)
 {
     QModelIndex index = ui.tree_remoteFiles->indexAt(pos);
-    bool isDir = index.isValid() ? index.data(Qt::UserRole + 1).toBool() : false;
-    bool isRoot = index.isValid() ? index.data(Qt::UserRole + 2).toBool() : false;
+    bool isDir = index.isValid() ? index.data(RemoteFileTreeModel::IsDirRole).toBool() : false;
+    bool isRoot = index.isValid() ? index.data(RemoteFileTreeModel::IsRootRole).toBool() : false;
 
     QMenu menu(ui.tree_remoteFiles);
 
@@ -785,13 +767,11 @@ void DeployMaster::onViewRemoteFile()
 {
     QModelIndex idx = ui.tree_remoteFiles->currentIndex();
     if (!idx.isValid()) return;
-    QStandardItem* item = remoteFileModel->itemFromIndex(idx);
-    if (!item) return;
-    bool isDir = item->data(Qt::UserRole + 1).toBool();
+    bool isDir = idx.data(RemoteFileTreeModel::IsDirRole).toBool();
     if (isDir) return;
 
-    QString remotePath = item->data(Qt::UserRole).toString();
-    QString fileName = item->data(Qt::UserRole + 3).toString();
+    QString remotePath = idx.data(RemoteFileTreeModel::PathRole).toString();
+    QString fileName = idx.data(RemoteFileTreeModel::NameRole).toString();
 
     QString user = m_deviceBusWidget->user();
     QString pass = m_deviceBusWidget->password();
@@ -807,7 +787,7 @@ void DeployMaster::onViewRemoteFile()
             ftm.setCredentials(user, pass);
             QString parentDir = remotePath.left(remotePath.lastIndexOf('/'));
             if (parentDir.isEmpty()) parentDir = "/";
-            QList<FtpFileInfo> files = ftm.listFtpDirectoryDetailed(parentDir);
+            QList<FtpFileInfo> files = ftm.listFtpDirectoryCached(parentDir);
             qint64 actualSize = -1;
             for (const auto& f : files) {
                 if (f.name == fileName) { actualSize = f.size; break; }
@@ -851,15 +831,12 @@ void DeployMaster::onDeleteRemoteFile()
     QList<DelItem> items;
     for (const auto& idx : selected) {
         if (idx.column() != 0) continue;
-        QStandardItem* item = remoteFileModel->itemFromIndex(idx);
-        if (!item) continue;
-        bool isDir = item->data(Qt::UserRole + 1).toBool();
-        bool isRoot = item->data(Qt::UserRole + 2).toBool();
-        if (isRoot) continue;
-        QString remotePath = item->data(Qt::UserRole).toString();
-        QString name = item->data(Qt::UserRole + 3).toString();
-        // 从 remotePath 提取 parentDir
-        QString parentDir = currentRemotePath;
+        bool isDir = idx.data(RemoteFileTreeModel::IsDirRole).toBool();
+        bool isRoot = idx.data(RemoteFileTreeModel::IsRootRole).toBool();
+        QString name = idx.data(RemoteFileTreeModel::NameRole).toString();
+        if (isRoot || name.isEmpty()) continue;   // 跳过根目录项与"返回上一级"
+        // 条目可能位于已展开的子目录中：从 remotePath 提取 parentDir
+        QString parentDir = remoteParentOf(idx.data(RemoteFileTreeModel::PathRole).toString());
         items.append({parentDir, name, isDir});
     }
     if (items.isEmpty()) return;
@@ -904,12 +881,11 @@ void DeployMaster::onRenameRemoteFile()
 {
     QModelIndex idx = ui.tree_remoteFiles->currentIndex();
     if (!idx.isValid()) return;
-    QStandardItem* item = remoteFileModel->itemFromIndex(idx);
-    if (!item) return;
-    bool isRoot = item->data(Qt::UserRole + 2).toBool();
+    bool isRoot = idx.data(RemoteFileTreeModel::IsRootRole).toBool();
     if (isRoot) return;
 
-    QString oldName = item->data(Qt::UserRole + 3).toString();
+    QString oldName = idx.data(RemoteFileTreeModel::NameRole).toString();
+    if (oldName.isEmpty()) return;
     bool ok;
     QString newName = QInputDialog::getText(this, "重命名",
         QString("新名称（当前: %1）:").arg(oldName),
@@ -921,7 +897,7 @@ void DeployMaster::onRenameRemoteFile()
 
     appendGlobalLog(QString("✏ 重命名: %1 → %2").arg(oldName, newName));
     QString ip = currentRemoteIP;
-    QString path = currentRemotePath;
+    QString path = remoteParentOf(idx.data(RemoteFileTreeModel::PathRole).toString());
     QPointer<DeployMaster> self(this);
     QtConcurrent::run([=]() {
         if (!self) return;
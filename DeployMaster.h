@@ -9,6 +9,7 @@
 #include "ui_DeployMaster.h"
 #include "src/framework/AppState.h"
 #include "src/model/FtpManager.h"
+#include "src/ui/RemoteFileTreeModel.h"
 #include "src/updater/UpdateTypes.h" // Task 5: UpdateState 枚举(用于 onUpdateStateChanged 签名)
 
 class ToolHost;
@@ -47,7 +48,7 @@ private:
     // 远端预览相关
     QString currentRemoteIP; // 当前选中的远程设备IP
     QString currentRemotePath; // 当前浏览的远程路径
-    QStandardItemModel* remoteFileModel; // 远程文件树模型
+    RemoteFileTreeModel* remoteFileModel; // 远程文件树模型（子目录展开时按需加载）
 
 private:
     void addFileToList(const QString& filePath); // 添加文件到列表的函数
@@ -107,6 +108,7 @@ private:
     QLineEdit* m_remotePathEdit = nullptr;  // 远端预览路径（替代旧 ui.txt_remotePath）
     QComboBox* m_protocolCombo = nullptr;   // 协议选择（FTP / SCP）
     QPushButton* m_refreshBtn = nullptr;    // 刷新按钮（替代旧 ui.btn_refreshRemote）
+    QString m_lastRemoteListing;            // 上次列出的 IP+路径（再次刷新时绕过缓存）
     std::shared_ptr<class FtpDeployBackend> m_ftpBackend;
     std::shared_ptr<class TelnetBackend> m_telnetBackend;
     std::shared_ptr<class WebSocketBackend> m_webSocketBackend;
@@ -9,6 +9,7 @@
 #include "src/adapter/FtpAdapter.h"
 #include "src/adapter/TelnetAdapter.h"
 #include "src/adapter/SshAdapter.h"
+#include "src/adapter/SftpAdapter.h"
 #include "src/adapter/OpcUaAdapter.h"
 #include "src/framework/ToolHost.h"
 #include "src/framework/ToolRegistry.h"
@@ -53,6 +54,10 @@ int main(int argc, char *argv[])
         []() -> std::shared_ptr<IProtocolAdapter> {
             return std::make_shared<SshAdapter>();
         });
+    ProtocolRegistry::instance()->registerFactory("sftp",
+        []() -> std::shared_ptr<IProtocolAdapter> {
+            return std::make_shared<SftpAdapter>();
+        });
     ProtocolRegistry::instance()->registerFactory("opcua",
         []() -> std::shared_ptr<IProtocolAdapter> {
             return std::make_shared<OpcUaAdapter>();
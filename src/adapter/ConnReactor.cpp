@@ -0,0 +1,435 @@
+#include "ConnReactor.h"
+#include "lwconn.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#define CONN_REACTOR_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 当前线程正在分发的连接令牌（unwatch 在自身回调内调用时不等待，避免自锁）
+thread_local uint64_t t_dispatching = 0;
+
+constexpr int kReceiveTimeoutMs = 10;   // 句柄已可读，receive 只作防御性上限
+
+} // namespace
+
+// ============================================================
+// Pimpl 实现体 — 轮询线程 + 分发线程池
+// ============================================================
+struct ConnReactor::Impl {
+    struct Entry {
+        uint64_t token = 0;
+        int fd = -1;
+        std::shared_ptr<LWConnBase> conn;
+        DataCallback onData;
+        ClosedCallback onClosed;
+        bool busy = false;      // 已交给分发线程，期间不再监听该句柄
+        bool removed = false;   // 已注销或已断开，不再重新监听
+        int emptyReads = 0;
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_readyCv;   // 分发队列非空 / 退出
+    std::condition_variable m_idleCv;    // 某连接分发结束（unwatch 等待）
+    std::unordered_map<uint64_t, std::shared_ptr<Entry>> m_entries;
+    std::deque<std::shared_ptr<Entry>> m_ready;
+    uint64_t m_nextToken = 1;
+    size_t m_threadCount = 0;
+    bool m_started = false;
+    std::atomic<bool> m_stop{false};
+    std::thread m_poller;
+    std::vector<std::thread> m_workers;
+
+#if CONN_REACTOR_EPOLL
+    int m_epoll = -1;
+    int m_wakeFd = -1;
+#elif defined(_WIN32)
+    SOCKET m_wakeSock = INVALID_SOCKET;   // 连接到自身的回环 UDP 套接字
+#else
+    int m_wakePipe[2] = { -1, -1 };
+#endif
+
+    // --- 首次注册时创建唤醒句柄并启动线程（调用方持有 m_mutex） ---
+    bool startLocked() {
+        if (m_started) return true;
+        if (!openBackend()) return false;
+        m_poller = std::thread([this]() {
+            while (!m_stop) pollOnce();
+        });
+        for (size_t i = 0; i < m_threadCount; ++i) {
+            m_workers.emplace_back([this]() { workLoop(); });
+        }
+        m_started = true;
+        return true;
+    }
+
+    // --- 句柄可读：标记为分发中并入队（调用方持有 m_mutex） ---
+    void markReadyLocked(uint64_t token) {
+        auto it = m_entries.find(token);
+        if (it == m_entries.end()) return;
+        const auto& e = it->second;
+        if (e->removed || e->busy) return;
+        e->busy = true;
+        m_ready.push_back(e);
+        m_readyCv.notify_one();
+    }
+
+    void workLoop() {
+        for (;;) {
+            std::shared_ptr<Entry> e;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_readyCv.wait(lock, [this]() { return m_stop || !m_ready.empty(); });
+                if (m_stop) return;
+                e = std::move(m_ready.front());
+                m_ready.pop_front();
+            }
+            dispatch(e);
+        }
+    }
+
+    // --- 一次 receive + 数据回调；断开时注销并回调 onClosed ---
+    void dispatch(const std::shared_ptr<Entry>& e) {
+        thread_local std::vector<char> buffer(kReadChunk);
+
+        {
+            // 入队后已被注销：不再读取，直接收尾
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (e->removed) {
+                e->busy = false;
+                m_entries.erase(e->token);
+                m_idleCv.notify_all();
+                return;
+            }
+        }
+
+        t_dispatching = e->token;
+        size_t received = 0;
+        const LWConnError err = e->conn->receive(buffer.data(), buffer.size(), received,
+                                                 kReceiveTimeoutMs);
+        bool closed = false;
+        if (err == LWConnError::SUCCESS && received > 0) {
+            e->emptyReads = 0;
+            if (e->onData) e->onData(buffer.data(), received);
+        } else if (!e->conn->isConnected()
+                   || (err != LWConnError::SUCCESS && err != LWConnError::TIMEOUT)
+                   || ++e->emptyReads >= kMaxEmptyReads) {
+            closed = true;
+        }
+
+        ClosedCallback onClosed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (closed && !e->removed) {
+                // 先停止监听，onClosed 执行期间保持 busy，unwatch 会等它结束
+                e->removed = true;
+                unarmLocked(*e);
+                onClosed = std::move(e->onClosed);
+            }
+            if (!onClosed) {
+                e->busy = false;
+                if (e->removed) {
+                    m_entries.erase(e->token);
+                } else {
+                    rearmLocked(*e);
+                }
+                m_idleCv.notify_all();
+            }
+        }
+
+        if (onClosed) {
+            onClosed();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            e->busy = false;
+            m_entries.erase(e->token);
+            m_idleCv.notify_all();
+        }
+        t_dispatching = 0;
+    }
+
+    // ------------------------------------------------------------
+    // 平台相关：唤醒句柄 / 注册 / 轮询
+    // ------------------------------------------------------------
+#if CONN_REACTOR_EPOLL
+    bool openBackend() {
+        m_epoll = epoll_create1(EPOLL_CLOEXEC);
+        m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_epoll < 0 || m_wakeFd < 0) {
+            closeBackend();
+            return false;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = 0;   // 令牌从 1 开始，0 保留给唤醒句柄
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeFd, &ev);
+        return true;
+    }
+
+    void closeBackend() {
+        if (m_wakeFd >= 0) ::close(m_wakeFd);
+        if (m_epoll >= 0) ::close(m_epoll);
+        m_wakeFd = m_epoll = -1;
+    }
+
+    void wake() {
+        const uint64_t one = 1;
+        (void)!::write(m_wakeFd, &one, sizeof(one));
+    }
+
+    // EPOLLONESHOT：触发一次后自动停止监听，分发结束后再重新启用，保证同一连接回调串行
+    bool armLocked(Entry& e) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.u64 = e.token;
+        return epoll_ctl(m_epoll, EPOLL_CTL_ADD, e.fd, &ev) == 0;
+    }
+
+    void rearmLocked(Entry& e) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.u64 = e.token;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, e.fd, &ev);
+    }
+
+    void unarmLocked(Entry& e) {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, e.fd, nullptr);
+    }
+
+    void pollOnce() {
+        epoll_event events[256];
+        const int n = epoll_wait(m_epoll, events, 256, -1);
+        if (n <= 0) return;   // EINTR
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.u64 == 0) {
+                uint64_t drained = 0;
+                (void)!::read(m_wakeFd, &drained, sizeof(drained));
+                continue;
+            }
+            markReadyLocked(events[i].data.u64);
+        }
+    }
+#else
+    // poll / WSAPoll：每轮按当前注册表重建监听集合，注册变化与分发结束时唤醒轮询线程
+#if defined(_WIN32)
+    using PollFd = WSAPOLLFD;
+    static constexpr short kReadEvents = POLLRDNORM;
+
+    bool openBackend() {
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+        m_wakeSock = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (m_wakeSock == INVALID_SOCKET) return false;
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int len = sizeof(addr);
+        u_long nonBlocking = 1;
+        if (::bind(m_wakeSock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::getsockname(m_wakeSock, reinterpret_cast<sockaddr*>(&addr), &len) != 0
+            || ::connect(m_wakeSock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::ioctlsocket(m_wakeSock, FIONBIO, &nonBlocking) != 0) {
+            closeBackend();
+            return false;
+        }
+        return true;
+    }
+
+    void closeBackend() {
+        if (m_wakeSock != INVALID_SOCKET) ::closesocket(m_wakeSock);
+        m_wakeSock = INVALID_SOCKET;
+        WSACleanup();
+    }
+
+    void wake() {
+        const char one = 1;
+        ::send(m_wakeSock, &one, 1, 0);
+    }
+
+    void drainWake() {
+        char buf[64];
+        while (::recv(m_wakeSock, buf, sizeof(buf), 0) > 0) {}
+    }
+
+    PollFd wakePollFd() const { return PollFd{ m_wakeSock, kReadEvents, 0 }; }
+    static PollFd entryPollFd(const Entry& e) {
+        return PollFd{ static_cast<SOCKET>(e.fd), kReadEvents, 0 };
+    }
+    static int pollFds(std::vector<PollFd>& fds) {
+        return WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), -1);
+    }
+#else
+    using PollFd = pollfd;
+    static constexpr short kReadEvents = POLLIN;
+
+    bool openBackend() {
+        if (::pipe(m_wakePipe) != 0) return false;
+        for (int fd : m_wakePipe) {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        return true;
+    }
+
+    void closeBackend() {
+        for (int& fd : m_wakePipe) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    }
+
+    void wake() {
+        const char one = 1;
+        (void)!::write(m_wakePipe[1], &one, 1);
+    }
+
+    void drainWake() {
+        char buf[64];
+        while (::read(m_wakePipe[0], buf, sizeof(buf)) > 0) {}
+    }
+
+    PollFd wakePollFd() const { return PollFd{ m_wakePipe[0], kReadEvents, 0 }; }
+    static PollFd entryPollFd(const Entry& e) { return PollFd{ e.fd, kReadEvents, 0 }; }
+    static int pollFds(std::vector<PollFd>& fds) {
+        return ::poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+    }
+#endif
+
+    bool armLocked(Entry&) { wake(); return true; }
+    void rearmLocked(Entry&) { wake(); }
+    void unarmLocked(Entry&) { wake(); }
+
+    void pollOnce() {
+        std::vector<PollFd> fds;
+        std::vector<uint64_t> tokens;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            fds.reserve(m_entries.size() + 1);
+            tokens.reserve(m_entries.size());
+            fds.push_back(wakePollFd());
+            for (const auto& kv : m_entries) {
+                const Entry& e = *kv.second;
+                if (e.busy || e.removed) continue;
+                fds.push_back(entryPollFd(e));
+                tokens.push_back(e.token);
+            }
+        }
+
+        if (pollFds(fds) <= 0) return;
+        if (fds[0].revents) drainWake();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 1; i < fds.size(); ++i) {
+            // 挂断 / 错误也交给分发线程，由 receive 的结果判定断开
+            if (fds[i].revents) markReadyLocked(tokens[i - 1]);
+        }
+    }
+#endif
+};
+
+// ============================================================
+// 单例 / 构造 / 析构
+// ============================================================
+
+ConnReactor& ConnReactor::instance() {
+    static ConnReactor s;
+    return s;
+}
+
+ConnReactor::ConnReactor() : m_impl(std::make_unique<Impl>()) {
+    // 分发线程只做一次 receive + 回调，少量线程即可覆盖数百会话
+    const unsigned hw = std::thread::hardware_concurrency();
+    m_impl->m_threadCount = std::clamp<size_t>(hw / 2, 2, 4);
+}
+
+ConnReactor::~ConnReactor() {
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        if (!m_impl->m_started) return;
+        m_impl->m_stop = true;
+        m_impl->m_readyCv.notify_all();
+    }
+    m_impl->wake();
+    if (m_impl->m_poller.joinable()) m_impl->m_poller.join();
+    for (auto& t : m_impl->m_workers) {
+        if (t.joinable()) t.join();
+    }
+    m_impl->closeBackend();
+}
+
+// ============================================================
+// 注册 / 注销
+// ============================================================
+
+uint64_t ConnReactor::watch(std::shared_ptr<LWConnBase> conn, DataCallback onData,
+                            ClosedCallback onClosed) {
+    if (!conn) return 0;
+    const int fd = conn->nativeHandle();
+    if (fd < 0) return 0;
+#if defined(_WIN32)
+    // Windows 串口是文件句柄，不能参与 WSAPoll
+    if (conn->getType() == LWConnType::SERIAL) return 0;
+#endif
+
+    auto e = std::make_shared<Impl::Entry>();
+    e->fd = fd;
+    e->conn = std::move(conn);
+    e->onData = std::move(onData);
+    e->onClosed = std::move(onClosed);
+
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    if (m_impl->m_stop || !m_impl->startLocked()) return 0;
+    e->token = m_impl->m_nextToken++;
+    m_impl->m_entries.emplace(e->token, e);
+    if (!m_impl->armLocked(*e)) {
+        m_impl->m_entries.erase(e->token);
+        return 0;
+    }
+    return e->token;
+}
+
+void ConnReactor::unwatch(uint64_t token) {
+    if (token == 0) return;
+    std::unique_lock<std::mutex> lock(m_impl->m_mutex);
+    auto it = m_impl->m_entries.find(token);
+    if (it == m_impl->m_entries.end()) return;
+    std::shared_ptr<Impl::Entry> e = it->second;
+    if (!e->removed) {
+        e->removed = true;
+        m_impl->unarmLocked(*e);
+    }
+    // 等待进行中的分发结束；在自身回调内注销时由分发线程收尾
+    if (t_dispatching != token) {
+        m_impl->m_idleCv.wait(lock, [&e]() { return !e->busy; });
+        m_impl->m_entries.erase(token);
+    }
+}
+
+size_t ConnReactor::watchedCount() const {
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    return m_impl->m_entries.size();
+}
+
+size_t ConnReactor::threadCount() const {
+    return m_impl->m_threadCount;
+}
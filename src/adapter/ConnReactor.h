@@ -0,0 +1,54 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+class LWConnBase;
+
+// lwcommunicate 连接的共享读事件反应器（进程级单例）
+// 以 LWConnBase::nativeHandle() 注册到单个轮询线程（Linux 为 epoll，其余平台为 poll/WSAPoll），
+// 句柄可读时交给少量分发线程执行一次 receive 并回调数据；会话数增长时线程数不变，
+// 空闲会话不占用 CPU。
+//
+// 线程约定：
+//   - 回调在分发线程上执行，同一连接的回调严格串行（EPOLLONESHOT / 分发期间不再监听），
+//     不同连接的回调可并行；回调内不得长时间阻塞
+//   - 连接断开（receive 失败 / 对端关闭）时先自动注销再调用 onClosed，之后不再回调
+//   - unwatch 返回后保证该连接不再有进行中或后续的回调（在自身回调内调用时不等待）
+//
+// 使用范围：目前接入的是 TelnetAdapter 的 LWTcpClient 会话（工程内唯一常驻的 lwcommunicate
+// 网络连接）。ModbusRtuBus 不接入：串口事务须在同一线程上按 t1.5/t3.5 精确计时收发，
+// 且 Windows 串口句柄无法参与 WSAPoll；ModbusTcpPoller 使用自有套接字与轮询循环。
+class ConnReactor {
+public:
+    using DataCallback = std::function<void(const char* data, size_t length)>;
+    using ClosedCallback = std::function<void()>;
+
+    static ConnReactor& instance();
+
+    // 注册已连接的连接，返回非 0 令牌；句柄无效或当前平台不支持该连接类型
+    // （如 Windows 串口句柄无法 WSAPoll）时返回 0，调用方应退回自有读取线程
+    uint64_t watch(std::shared_ptr<LWConnBase> conn, DataCallback onData,
+                   ClosedCallback onClosed = nullptr);
+
+    // 注销；须在关闭连接（stop/disconnect）之前调用。令牌无效时忽略
+    void unwatch(uint64_t token);
+
+    // 当前注册的连接数 / 分发线程数
+    size_t watchedCount() const;
+    size_t threadCount() const;
+
+    static constexpr size_t kReadChunk = 16 * 1024;   // 单次 receive 缓冲区大小
+    static constexpr int kMaxEmptyReads = 3;          // 可读却连续读不到数据的次数上限，超过视为对端关闭
+
+    ConnReactor(const ConnReactor&) = delete;
+    ConnReactor& operator=(const ConnReactor&) = delete;
+
+private:
+    ConnReactor();
+    ~ConnReactor();
+
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
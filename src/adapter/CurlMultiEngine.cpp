@@ -0,0 +1,207 @@
+#include "CurlMultiEngine.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+
+// ============================================================
+// Pimpl 实现体 — multi 句柄 + 事件线程
+// ============================================================
+struct CurlMultiEngine::Impl {
+    CURLM* m_multi = nullptr;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+
+    // 待加入 multi 的句柄（任意线程写入，引擎线程取出）
+    mutable std::mutex m_mutex;
+    std::vector<std::pair<CURL*, DoneCallback>> m_pending;
+    std::atomic<size_t> m_active{0};
+
+    // 因限速暂停、到期待恢复的句柄（受 m_mutex 保护）
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::pair<Clock::time_point, CURL*>> m_paused;
+
+    // 已加入 multi 的句柄 → 完成回调（仅引擎线程访问）
+    std::unordered_map<CURL*, DoneCallback> m_running;
+
+    void run() {
+        while (!m_stop) {
+            drainPending();
+
+            const int untilResume = resumeDue();
+
+            int stillRunning = 0;
+            curl_multi_perform(m_multi, &stillRunning);
+            collectFinished();
+
+            // 无活动句柄时也会在 submit 的 curl_multi_wakeup 处被唤醒；
+            // 有暂停句柄时按最近的恢复时刻缩短等待
+            curl_multi_poll(m_multi, nullptr, 0, std::min(1000, untilResume), nullptr);
+        }
+        abortAll();
+    }
+
+    void drainPending() {
+        std::vector<std::pair<CURL*, DoneCallback>> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            batch.swap(m_pending);
+        }
+        for (auto& item : batch) {
+            CURLMcode mc = curl_multi_add_handle(m_multi, item.first);
+            if (mc != CURLM_OK) {
+                // 无法加入（句柄已在其他 multi 中等），按失败立即完成
+                finish(item.second, CURLE_FAILED_INIT);
+                continue;
+            }
+            m_running.emplace(item.first, std::move(item.second));
+        }
+    }
+
+    // 恢复已到期的暂停句柄，返回距下一个恢复时刻的毫秒数（无则 1000）
+    int resumeDue() {
+        std::vector<CURL*> due;
+        int next = 1000;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_paused.empty()) return next;
+            const auto now = Clock::now();
+            for (auto it = m_paused.begin(); it != m_paused.end();) {
+                if (it->first <= now) {
+                    due.push_back(it->second);
+                    it = m_paused.erase(it);
+                } else {
+                    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(it->first - now);
+                    next = std::min(next, static_cast<int>(ms.count()) + 1);
+                    ++it;
+                }
+            }
+        }
+        for (CURL* easy : due) {
+            if (m_running.count(easy)) {
+                curl_easy_pause(easy, CURLPAUSE_CONT);
+            }
+        }
+        return next;
+    }
+
+    void collectFinished() {
+        int msgsLeft = 0;
+        while (CURLMsg* msg = curl_multi_info_read(m_multi, &msgsLeft)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            CURL* easy = msg->easy_handle;
+            const CURLcode res = msg->data.result;  // remove 之前读取，remove 后 msg 失效
+            curl_multi_remove_handle(m_multi, easy);
+
+            auto it = m_running.find(easy);
+            if (it == m_running.end()) continue;
+            DoneCallback done = std::move(it->second);
+            m_running.erase(it);
+            finish(done, res);
+        }
+    }
+
+    // 引擎退出：未完成的传输一律以中止结束，保证同步等待方能返回
+    void abortAll() {
+        for (auto& kv : m_running) {
+            curl_multi_remove_handle(m_multi, kv.first);
+            finish(kv.second, CURLE_ABORTED_BY_CALLBACK);
+        }
+        m_running.clear();
+
+        std::vector<std::pair<CURL*, DoneCallback>> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            batch.swap(m_pending);
+        }
+        for (auto& item : batch) {
+            finish(item.second, CURLE_ABORTED_BY_CALLBACK);
+        }
+    }
+
+    void finish(DoneCallback& done, CURLcode res) {
+        m_active--;
+        if (done) done(res);
+    }
+};
+
+// ============================================================
+// 单例 / 构造 / 析构
+// ============================================================
+
+CurlMultiEngine& CurlMultiEngine::instance() {
+    static CurlMultiEngine s;
+    return s;
+}
+
+CurlMultiEngine::CurlMultiEngine() : m_impl(std::make_unique<Impl>()) {
+    // curl_global_init 内部计数，与 FtpAdapter 的全局守卫叠加无副作用
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    m_impl->m_multi = curl_multi_init();
+    // 连接缓存上限：覆盖大规模设备并发时每台设备保留一条控制连接
+    curl_multi_setopt(m_impl->m_multi, CURLMOPT_MAXCONNECTS, 512L);
+    m_impl->m_thread = std::thread([this]() { m_impl->run(); });
+}
+
+CurlMultiEngine::~CurlMultiEngine() {
+    m_impl->m_stop = true;
+    curl_multi_wakeup(m_impl->m_multi);
+    if (m_impl->m_thread.joinable()) {
+        m_impl->m_thread.join();
+    }
+    curl_multi_cleanup(m_impl->m_multi);
+    curl_global_cleanup();
+}
+
+// ============================================================
+// 提交 / 同步执行
+// ============================================================
+
+void CurlMultiEngine::submit(CURL* easy, DoneCallback done) {
+    if (!easy) {
+        if (done) done(CURLE_FAILED_INIT);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        // 在锁内判断：与 abortAll 的队列交换互斥，退出后提交的句柄不会被遗漏
+        if (!m_impl->m_stop) {
+            m_impl->m_pending.emplace_back(easy, std::move(done));
+            m_impl->m_active++;
+            done = nullptr;
+        }
+    }
+    if (done) {
+        done(CURLE_ABORTED_BY_CALLBACK);
+        return;
+    }
+    curl_multi_wakeup(m_impl->m_multi);
+}
+
+CURLcode CurlMultiEngine::perform(CURL* easy) {
+    if (std::this_thread::get_id() == m_impl->m_thread.get_id()) {
+        return curl_easy_perform(easy);
+    }
+
+    std::promise<CURLcode> promise;
+    std::future<CURLcode> result = promise.get_future();
+    submit(easy, [&promise](CURLcode res) { promise.set_value(res); });
+    return result.get();
+}
+
+void CurlMultiEngine::resumeAfter(CURL* easy, std::chrono::milliseconds delay) {
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        m_impl->m_paused.emplace_back(Impl::Clock::now() + delay, easy);
+    }
+    curl_multi_wakeup(m_impl->m_multi);
+}
+
+size_t CurlMultiEngine::activeTransfers() const {
+    return m_impl->m_active.load();
+}
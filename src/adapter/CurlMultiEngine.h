@@ -0,0 +1,46 @@
+#pragma once
+#include <curl/curl.h>
+#include <functional>
+#include <memory>
+#include <cstddef>
+#include <chrono>
+
+// libcurl multi 传输核心（进程级单例）
+// 单个后台线程以 curl_multi_poll 驱动所有已提交的 easy 句柄；multi 句柄自带连接缓存，
+// 同主机的后续传输可复用控制连接。FtpAdapter 的同步接口经 perform() 提交并等待，
+// 调用线程仍会阻塞到传输结束（部署每台在途设备占一个工作线程）；FtpRemoteTree 的批量
+// 列目录/删除以 submit() 异步提交，单线程即可保持多路在途。
+//
+// 线程约定：
+//   - easy 句柄的所有回调（读/写/进度）与完成回调都在引擎线程上执行，回调内不得阻塞
+//   - 提交后直到完成回调触发前，调用方不得再修改或释放该 easy 句柄
+class CurlMultiEngine {
+public:
+    using DoneCallback = std::function<void(CURLcode)>;
+
+    static CurlMultiEngine& instance();
+
+    // 异步提交：立即返回，传输结束（成功/失败/中止）后在引擎线程调用 done
+    void submit(CURL* easy, DoneCallback done);
+
+    // 同步执行：提交并等待完成，语义等同 curl_easy_perform
+    // 在引擎线程内调用时直接退化为 curl_easy_perform，避免自锁
+    CURLcode perform(CURL* easy);
+
+    // 读回调返回 CURL_READFUNC_PAUSE 后登记：delay 之后由引擎线程恢复该句柄（限速用）
+    // 句柄在此之前已结束时忽略
+    void resumeAfter(CURL* easy, std::chrono::milliseconds delay);
+
+    // 当前在途传输数（含排队待加入 multi 的句柄）
+    size_t activeTransfers() const;
+
+    CurlMultiEngine(const CurlMultiEngine&) = delete;
+    CurlMultiEngine& operator=(const CurlMultiEngine&) = delete;
+
+private:
+    CurlMultiEngine();
+    ~CurlMultiEngine();
+
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
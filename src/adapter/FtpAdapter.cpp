@@ -1,12 +1,19 @@
 #include "FtpAdapter.h"
+#include "CurlMultiEngine.h"
+#include "FtpRemoteTree.h"
 #include <curl/curl.h>
 #include <sstream>
 #include <cstring>
 #include <cstdio>
+#include <cstdint>
 #include <filesystem>
 #include <algorithm>
 #include <vector>
 #include <future>
+#include <unordered_set>
+#include <thread>
+#include <chrono>
+#include <cctype>
 
 // libcurl 全局初始化 RAII 守卫 — 整个进程生命周期仅构造/析构一次
 namespace {
@@ -28,9 +35,45 @@ struct FtpAdapter::Impl {
     std::string m_lastError;
     bool        m_connected = false;
     std::function<void(int)> m_progressCb;
+    std::function<void(uint64_t)> m_bytesCb;
+    const std::atomic<bool>* m_cancelFlag = nullptr;
+    uint64_t    m_bytesCommitted = 0;   // 已完成上传的累计字节
+    uint64_t    m_xferOffset = 0;       // 当前传输的续传起点（进度按整文件计）
+    int         m_maxAttempts = 5;      // 断点续传最大尝试次数（含首次）
 
     bool m_useFtps = false;
 
+    // 持久会话句柄：同一适配器的顺序传输共用，保持已登录的控制连接不断开
+    CURL* m_session = nullptr;
+    // 本次连接内已确认存在的远程目录（相对登录目录，不含首尾 '/'）
+    std::unordered_set<std::string> m_knownDirs;
+    // 最近一次 clearRemoteDirectory 的统计
+    FtpTreeStats m_treeStats;
+
+    // 远端摘要命令（FEAT 探测结果），连接时重置
+    enum ChecksumCommand { kChecksumUnknown, kChecksumNone, kChecksumHashMd5, kChecksumXmd5, kChecksumXcrc };
+    ChecksumCommand m_checksumCmd = kChecksumUnknown;
+
+    ~Impl() { closeSession(); }
+
+    // --- 取持久会话句柄：复用时仅重置选项，curl_easy_reset 保留已建立的连接 ---
+    CURL* session() {
+        if (m_session) {
+            curl_easy_reset(m_session);
+        } else {
+            m_session = curl_easy_init();
+        }
+        return m_session;
+    }
+
+    void closeSession() {
+        if (m_session) {
+            curl_easy_cleanup(m_session);
+            m_session = nullptr;
+        }
+        m_knownDirs.clear();
+    }
+
     // --- URL 拼接 ---
     std::string buildUrl(const std::string& path) const {
         std::ostringstream oss;
@@ -56,10 +99,43 @@ struct FtpAdapter::Impl {
         return total;
     }
 
-    // --- libcurl 读回调（从 FILE* 读取） ---
-    static size_t readCallback(void* ptr, size_t size, size_t nmemb, void* userdata) {
-        FILE* file = static_cast<FILE*>(userdata);
-        return fread(ptr, size, nmemb, file);
+    // --- libcurl 头回调：FTP 模式下收到的是服务器应答行（含 QUOTE 命令的应答） ---
+    static size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+        auto* str = static_cast<std::string*>(userdata);
+        str->append(buffer, size * nitems);
+        return size * nitems;
+    }
+
+    // --- libcurl 读回调（从内存缓冲读取，用于小文件直接写入） ---
+    struct MemorySource {
+        const char* data = nullptr;
+        size_t remaining = 0;
+    };
+    static size_t readFromMemoryCallback(void* ptr, size_t size, size_t nmemb, void* userdata) {
+        auto* src = static_cast<MemorySource*>(userdata);
+        size_t n = std::min(size * nmemb, src->remaining);
+        memcpy(ptr, src->data, n);
+        src->data += n;
+        src->remaining -= n;
+        return n;
+    }
+
+    // --- libcurl 读回调（自定义数据源） ---
+    struct SourceContext {
+        const UploadSource* source = nullptr;
+        CURL* curl = nullptr;
+    };
+    static size_t sourceReadCallback(void* ptr, size_t size, size_t nmemb, void* userdata) {
+        auto* ctx = static_cast<SourceContext*>(userdata);
+        const size_t n = ctx->source->read(static_cast<char*>(ptr), size * nmemb);
+        if (n == UploadSource::kFailed) return CURL_READFUNC_ABORT;
+        if (n == UploadSource::kPause) {
+            // 暂无可发送数据：暂停本句柄，其他传输不受影响
+            CurlMultiEngine::instance().resumeAfter(
+                ctx->curl, std::chrono::milliseconds(UploadSource::kPauseRetryMs));
+            return CURL_READFUNC_PAUSE;
+        }
+        return n;
     }
 
     // --- libcurl 写回调（写入 FILE*） ---
@@ -68,17 +144,218 @@ struct FtpAdapter::Impl {
         return fwrite(ptr, size, nmemb, file);
     }
 
-    // --- libcurl 进度回调 ---
+    // --- libcurl 进度回调（返回非 0 时 curl 以 CURLE_ABORTED_BY_CALLBACK 中止传输） ---
     static int progressCallback(void* clientp, curl_off_t /*dltotal*/, curl_off_t /*dlnow*/,
                                  curl_off_t ultotal, curl_off_t ulnow) {
         auto* self = static_cast<Impl*>(clientp);
+        if (self->m_cancelFlag && self->m_cancelFlag->load()) {
+            return 1;
+        }
+        // 续传时 curl 只报告本次发送量，加上起点换算为整文件进度
+        const uint64_t done = self->m_xferOffset + static_cast<uint64_t>(ulnow);
         if (self->m_progressCb && ultotal > 0) {
-            int pct = static_cast<int>((ulnow / ultotal) * 100.0);
+            const uint64_t total = self->m_xferOffset + static_cast<uint64_t>(ultotal);
+            int pct = static_cast<int>(done * 100 / total);
             self->m_progressCb(pct);
         }
+        if (self->m_bytesCb && done > 0) {
+            self->m_bytesCb(self->m_bytesCommitted + done);
+        }
         return 0;
     }
 
+    // --- 可通过续传恢复的错误（网络中断/超时类）；认证、路径等错误重试无意义 ---
+    static bool isResumable(CURLcode res) {
+        switch (res) {
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_UPLOAD_FAILED:
+        case CURLE_GOT_NOTHING:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_FTP_ACCEPT_TIMEOUT:
+        case CURLE_FTP_ACCEPT_FAILED:
+        case CURLE_FTP_CANT_GET_HOST:
+        case CURLE_FTP_WEIRD_PASV_REPLY:
+        case CURLE_SSL_CONNECT_ERROR:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool cancelled() const {
+        return m_cancelFlag && m_cancelFlag->load();
+    }
+
+    // --- 两次续传之间退避（可被取消打断） ---
+    void backoff(int attempt) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(attempt);
+        while (!cancelled() && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    // --- 慢速判定替代总超时：大文件不会因传输时间长被中断，链路停滞 60 秒才判失败 ---
+    static void setupStallTimeout(CURL* curl) {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 0L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+    }
+
+    // --- 查询远程文件大小（FTP SIZE），未知/不存在返回 -1 ---
+    curl_off_t remoteSize(const std::string& remotePath) {
+        CURL* curl = session();
+        if (!curl) return -1;
+        setupCommonOpts(curl, buildUrl(remotePath));
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
+
+        if (CurlMultiEngine::instance().perform(curl) != CURLE_OK) return -1;
+        curl_off_t size = -1;
+        if (curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &size) != CURLE_OK) return -1;
+        return size;
+    }
+
+    // --- 查询远程文件大小与修改时间（SIZE + MDTM），未知项为 -1 ---
+    void remoteStat(const std::string& remotePath, curl_off_t& size, curl_off_t& mtime) {
+        size = -1;
+        mtime = -1;
+        CURL* curl = session();
+        if (!curl) return;
+        setupCommonOpts(curl, buildUrl(remotePath));
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+        curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
+
+        if (CurlMultiEngine::instance().perform(curl) != CURLE_OK) return;
+        curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &size);
+        curl_easy_getinfo(curl, CURLINFO_FILETIME_T, &mtime);
+    }
+
+    // --- .part 旁路文件：记录写入时远端的大小与修改时间，续传前据此确认仍是同一版本 ---
+    static bool partMetaMatches(const std::string& metaPath, curl_off_t size, curl_off_t mtime) {
+        FILE* f = fopen(metaPath.c_str(), "rb");
+        if (!f) return false;
+        long long s = -1;
+        long long t = -1;
+        const bool ok = fscanf(f, "%lld %lld", &s, &t) == 2;
+        fclose(f);
+        return ok && s == size && t == mtime;
+    }
+
+    static void writePartMeta(const std::string& metaPath, curl_off_t size, curl_off_t mtime) {
+        FILE* f = fopen(metaPath.c_str(), "wb");
+        if (!f) return;   // 写不成只影响下次能否续传
+        fprintf(f, "%lld %lld\n", static_cast<long long>(size), static_cast<long long>(mtime));
+        fclose(f);
+    }
+
+    // --- 远程文件确实不存在（而非连接/权限等其他失败）：SIZE 应答 550 ---
+    bool remoteMissing(const std::string& remotePath) {
+        CURL* curl = session();
+        if (!curl) return false;
+        setupCommonOpts(curl, buildUrl(remotePath));
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
+
+        const CURLcode res = CurlMultiEngine::instance().perform(curl);
+        if (res == CURLE_OK) return false;
+        if (res == CURLE_REMOTE_FILE_NOT_FOUND) return true;
+        long code = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+        return code == 550;
+    }
+
+    // --- 在会话上依次发送 QUOTE 命令，收集服务器应答文本；任一命令失败返回 false ---
+    bool quote(const std::vector<std::string>& commands, std::string& replies) {
+        CURL* curl = session();
+        if (!curl) return false;
+        struct curl_slist* list = nullptr;
+        for (const auto& cmd : commands) list = curl_slist_append(list, cmd.c_str());
+
+        setupCommonOpts(curl, buildUrl("/"));
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_QUOTE, list);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &replies);
+
+        const CURLcode res = CurlMultiEngine::instance().perform(curl);
+        curl_slist_free_all(list);
+        if (res != CURLE_OK) {
+            m_lastError = std::string("FTP 命令失败: ") + curl_easy_strerror(res);
+            return false;
+        }
+        return true;
+    }
+
+    // --- FEAT 探测摘要命令：优先 HASH(MD5)，其次 XMD5、XCRC ---
+    ChecksumCommand checksumCommand() {
+        if (m_checksumCmd != kChecksumUnknown) return m_checksumCmd;
+        m_checksumCmd = kChecksumNone;
+
+        std::string replies;
+        if (!quote({ "FEAT" }, replies)) return m_checksumCmd;
+
+        bool hashMd5 = false, xmd5 = false, xcrc = false;
+        std::istringstream iss(replies);
+        std::string line;
+        while (std::getline(iss, line)) {
+            // 特性行以空格开头，如 " HASH SHA-1;SHA-256*;MD5"
+            if (line.empty() || line[0] != ' ') continue;
+            std::string upper = line;
+            std::transform(upper.begin(), upper.end(), upper.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            std::istringstream fields(upper);
+            std::string feature;
+            fields >> feature;
+            if (feature == "HASH" && upper.find("MD5") != std::string::npos) hashMd5 = true;
+            else if (feature == "XMD5") xmd5 = true;
+            else if (feature == "XCRC") xcrc = true;
+        }
+        if (hashMd5) m_checksumCmd = kChecksumHashMd5;
+        else if (xmd5) m_checksumCmd = kChecksumXmd5;
+        else if (xcrc) m_checksumCmd = kChecksumXcrc;
+        return m_checksumCmd;
+    }
+
+    // --- 从最后一条 2xx 应答中取摘要：HASH 为 "213 MD5 0-N <hex> name"，
+    //     XMD5 / XCRC 为 "250 <hex>"；按长度区分 MD5（32 位）与 CRC-32（至多 8 位） ---
+    static bool parseChecksumReply(const std::string& replies, bool md5, std::string& outHex) {
+        std::string last;
+        std::istringstream iss(replies);
+        std::string line;
+        while (std::getline(iss, line)) {
+            if (line.size() > 4 && line[0] == '2' && line[3] == ' ') last = line;
+        }
+        if (last.empty()) return false;
+
+        std::istringstream fields(last.substr(4));
+        std::string token;
+        while (fields >> token) {
+            const bool hex = std::all_of(token.begin(), token.end(),
+                                         [](unsigned char c) { return std::isxdigit(c) != 0; });
+            if (!hex) continue;
+            if (md5 ? token.size() == 32 : (token.size() >= 1 && token.size() <= 8)) {
+                std::transform(token.begin(), token.end(), token.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                outHex = token;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // --- 挂接进度回调（有进度/字节回调或取消标志时才启用，减少无谓回调） ---
+    void setupProgress(CURL* curl) {
+        if (m_progressCb || m_bytesCb || m_cancelFlag) {
+            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progressCallback);
+        }
+    }
+
     // --- 解析 FTP LIST 输出中的文件名 ---
     static std::string parseListFilename(const std::string& line) {
         // Unix ls -l 格式: "drwxr-xr-x 2 user group 4096 Jan 01 12:00 filename"
@@ -115,6 +392,123 @@ struct FtpAdapter::Impl {
             curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
             curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
         }
+        if (m_cancelFlag) {
+            setupProgress(curl);
+        }
+    }
+
+    // --- 规范化远程路径：去掉首尾 '/'，与 buildUrl 的相对登录目录语义一致 ---
+    static std::string trimSlashes(const std::string& path) {
+        size_t b = path.find_first_not_of('/');
+        if (b == std::string::npos) return {};
+        size_t e = path.find_last_not_of('/');
+        return path.substr(b, e - b + 1);
+    }
+
+    static std::string parentDir(const std::string& remotePath) {
+        std::string p = trimSlashes(remotePath);
+        size_t slash = p.find_last_of('/');
+        return slash == std::string::npos ? std::string() : p.substr(0, slash);
+    }
+
+    // --- 确保一组远程目录存在：每个目录（含各级父目录）本次连接内只 MKD 一次 ---
+    // 所有 MKD 作为一个请求的 QUOTE 前置命令在同一控制连接上发送；
+    // '*' 前缀表示忽略失败（目录已存在时服务器返回 550）
+    bool ensureDirs(const std::vector<std::string>& dirs) {
+        std::vector<std::string> toCreate;
+        for (const auto& d : dirs) {
+            const std::string dir = trimSlashes(d);
+            size_t pos = 0;
+            while (!dir.empty()) {
+                pos = dir.find('/', pos);
+                const std::string prefix = dir.substr(0, pos);
+                if (m_knownDirs.insert(prefix).second) {
+                    toCreate.push_back(prefix);
+                }
+                if (pos == std::string::npos) break;
+                ++pos;
+            }
+        }
+        if (toCreate.empty()) return true;
+
+        // 按深度排序，保证父目录先于子目录创建
+        std::stable_sort(toCreate.begin(), toCreate.end(),
+                         [](const std::string& a, const std::string& b) {
+                             return std::count(a.begin(), a.end(), '/')
+                                  < std::count(b.begin(), b.end(), '/');
+                         });
+
+        struct curl_slist* commands = nullptr;
+        for (const auto& dir : toCreate) {
+            commands = curl_slist_append(commands, ("*MKD " + dir).c_str());
+        }
+
+        CURL* curl = session();
+        if (!curl) {
+            curl_slist_free_all(commands);
+            m_lastError = "curl_easy_init() 失败";
+            return false;
+        }
+        setupCommonOpts(curl, buildUrl("/"));
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_QUOTE, commands);
+
+        CURLcode res = CurlMultiEngine::instance().perform(curl);
+        curl_slist_free_all(commands);
+
+        if (res != CURLE_OK) {
+            for (const auto& dir : toCreate) m_knownDirs.erase(dir);
+            m_lastError = std::string("创建远程目录失败: ") + curl_easy_strerror(res);
+            return false;
+        }
+        return true;
+    }
+
+    // --- 配置上传句柄（同步/异步上传共用） ---
+    // createDirs = false 时调用方须已通过 ensureDirs 建好父目录，
+    // 此时用 NOCWD 直接 STOR 完整路径，省去逐级 CWD 往返
+    void setupUploadOpts(CURL* curl, size_t (*readFn)(void*, size_t, size_t, void*), void* readData, uint64_t size,
+                         const std::string& remotePath,
+                         bool createDirs = true) {
+        const std::string url = buildUrl(remotePath);
+        const std::string credentials = userPwd();
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_USERPWD, credentials.c_str());
+        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, readFn);
+        curl_easy_setopt(curl, CURLOPT_READDATA, readData);
+        curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(size));
+        if (createDirs) {
+            curl_easy_setopt(curl, CURLOPT_FTP_CREATE_MISSING_DIRS, 1L);
+        } else {
+            curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
+        }
+        setupStallTimeout(curl);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
+        curl_easy_setopt(curl, CURLOPT_REDIR_PROTOCOLS_STR, "ftp,ftps");
+        if (m_useFtps) {
+            curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+        }
+
+        // 进度回调 / 取消检查
+        setupProgress(curl);
+    }
+
+    // --- 上传结束：累计字节 + lastError（同步/异步上传共用） ---
+    bool finishUpload(CURLcode res, uint64_t fileSize) {
+        if (res == CURLE_OK) {
+            m_bytesCommitted += static_cast<uint64_t>(fileSize);
+            if (m_bytesCb) m_bytesCb(m_bytesCommitted);
+            m_lastError.clear();
+            return true;
+        }
+        m_lastError = std::string("上传失败: ") + curl_easy_strerror(res);
+        return false;
     }
 };
 
@@ -137,6 +531,8 @@ bool FtpAdapter::connect(const DeviceInfo& device, const AuthInfo& auth) {
     m_impl->m_port = device.port > 0 ? device.port : 21;
     m_impl->m_user = auth.user;
     m_impl->m_password = auth.password;
+    m_impl->closeSession();
+    m_impl->m_checksumCmd = Impl::kChecksumUnknown;
 
     // 验证可达性：尝试列出根目录（仅列目录名,节省流量）
     CURL* curl = curl_easy_init();
@@ -154,7 +550,7 @@ bool FtpAdapter::connect(const DeviceInfo& device, const AuthInfo& auth) {
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &result);
     curl_easy_setopt(curl, CURLOPT_DIRLISTONLY, 1L);  // 仅列文件名,节省流量
 
-    CURLcode res = curl_easy_perform(curl);
+    CURLcode res = CurlMultiEngine::instance().perform(curl);
     curl_easy_cleanup(curl);
 
     if (res == CURLE_OK) {
@@ -169,6 +565,7 @@ bool FtpAdapter::connect(const DeviceInfo& device, const AuthInfo& auth) {
 }
 
 void FtpAdapter::disconnect() {
+    m_impl->closeSession();
     volatile char* p = const_cast<volatile char*>(m_impl->m_password.data());
     for (size_t i = 0; i < m_impl->m_password.size(); ++i) p[i] = '\0';
     m_impl->m_password.clear();
@@ -270,51 +667,74 @@ bool FtpAdapter::uploadFile(const std::string& localPath, const std::string& rem
     long fileSize = ftell(file);
     fseek(file, 0, SEEK_SET);
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        fclose(file);
-        m_impl->m_lastError = "curl_easy_init() 失败";
+    UploadSource source;
+    source.size = static_cast<uint64_t>(fileSize);
+    source.read = [file](char* buf, size_t len) -> size_t {
+        const size_t n = fread(buf, 1, len, file);
+        return (n == 0 && ferror(file)) ? UploadSource::kFailed : n;
+    };
+    source.seek = [file](uint64_t offset) {
+        return fseek(file, static_cast<long>(offset), SEEK_SET) == 0;
+    };
+
+    const bool ok = uploadFromSource(source, remotePath);
+    fclose(file);
+    return ok;
+}
+
+bool FtpAdapter::uploadFromSource(const UploadSource& source, const std::string& remotePath) {
+    // 父目录本次连接内只创建一次
+    if (!m_impl->ensureDirs({ Impl::parentDir(remotePath) })) {
         return false;
     }
 
-    std::string url = m_impl->buildUrl(remotePath);
-    std::string userPwd = m_impl->userPwd();
+    const curl_off_t total = static_cast<curl_off_t>(source.size);
+
+    // 断点续传：失败后以 SIZE 查询远端已落盘字节，从该偏移 APPEND 续写
+    CURLcode res = CURLE_OK;
+    curl_off_t offset = 0;
+    for (int attempt = 0; attempt < m_impl->m_maxAttempts; ++attempt) {
+        if (attempt > 0) {
+            m_impl->backoff(attempt);
+            if (m_impl->cancelled()) break;
+            offset = m_impl->remoteSize(remotePath);
+            if (offset < 0 || offset > total) offset = 0;  // 无法确认 → 从头覆盖
+        }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_USERPWD, userPwd.c_str());
-    curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, Impl::readCallback);
-    curl_easy_setopt(curl, CURLOPT_READDATA, file);
-    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(fileSize));
-    curl_easy_setopt(curl, CURLOPT_FTP_CREATE_MISSING_DIRS, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
-    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
-    curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
-    curl_easy_setopt(curl, CURLOPT_REDIR_PROTOCOLS_STR, "ftp,ftps");
-    if (m_impl->m_useFtps) {
-        curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-    }
-
-    // 进度回调
-    if (m_impl->m_progressCb) {
-        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
-        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, m_impl.get());
-        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, Impl::progressCallback);
-    }
-
-    CURLcode res = curl_easy_perform(curl);
-    fclose(file);
-    curl_easy_cleanup(curl);
+        CURL* curl = m_impl->session();
+        if (!curl) {
+            m_impl->m_lastError = "curl_easy_init() 失败";
+            return false;
+        }
 
-    if (res == CURLE_OK) {
-        m_impl->m_lastError.clear();
-        return true;
+        if (!source.seek(static_cast<uint64_t>(offset))) {
+            m_impl->m_lastError = "上传失败: 数据源定位失败";
+            return false;
+        }
+        m_impl->m_xferOffset = static_cast<uint64_t>(offset);
+        Impl::SourceContext ctx{ &source, curl };
+        m_impl->setupUploadOpts(curl, Impl::sourceReadCallback, &ctx,
+                                source.size - static_cast<uint64_t>(offset), remotePath, false);
+        if (offset > 0) {
+            curl_easy_setopt(curl, CURLOPT_APPEND, 1L);
+        }
+
+        res = CurlMultiEngine::instance().perform(curl);
+        if (res == CURLE_OK || !Impl::isResumable(res) || m_impl->cancelled()) break;
+    }
+    m_impl->m_xferOffset = 0;
+
+    if (res == CURLE_OK && offset > 0) {
+        // 续传过的文件校验最终大小，防止追加错位
+        const curl_off_t finalSize = m_impl->remoteSize(remotePath);
+        if (finalSize != total) {
+            m_impl->m_lastError = "上传失败: 续传后远端大小不一致 (" + std::to_string(finalSize)
+                                + " != " + std::to_string(total) + ")";
+            return false;
+        }
     }
 
-    m_impl->m_lastError = std::string("上传失败: ") + curl_easy_strerror(res);
-    return false;
+    return m_impl->finishUpload(res, source.size);
 }
 
 bool FtpAdapter::uploadFolder(const std::string& localPath, const std::string& remotePath) {
@@ -340,9 +760,13 @@ bool FtpAdapter::uploadFolder(const std::string& localPath, const std::string& r
     }
     remoteBase += "/" + folderName;
 
-    bool allOk = true;
+    // 先收集全部文件及其远程目录，目录一次性批量创建，随后在同一控制连接上逐个 STOR
+    std::string cleanBase = cleanLocal;
+    std::replace(cleanBase.begin(), cleanBase.end(), '\\', '/');
+
+    std::vector<std::pair<std::string, std::string>> files;  // (本地路径, 远程路径)
+    std::vector<std::string> dirs{ remoteBase };
 
-    // 遍历文件夹中的所有文件
     for (const auto& entry : fs::recursive_directory_iterator(cleanLocal, ec)) {
         if (ec) break;
 
@@ -354,9 +778,6 @@ bool FtpAdapter::uploadFolder(const std::string& localPath, const std::string& r
         std::replace(filePath.begin(), filePath.end(), '\\', '/');
 
         // 计算相对路径
-        std::string cleanBase = cleanLocal;
-        std::replace(cleanBase.begin(), cleanBase.end(), '\\', '/');
-
         std::string relPath;
         size_t pos = filePath.find(cleanBase);
         if (pos != std::string::npos) {
@@ -374,57 +795,177 @@ bool FtpAdapter::uploadFolder(const std::string& localPath, const std::string& r
         }
         remoteFile += relPath;
 
-        if (!uploadFile(filePath, remoteFile)) {
+        dirs.push_back(Impl::parentDir(remoteFile));
+        files.emplace_back(std::move(filePath), std::move(remoteFile));
+    }
+
+    std::sort(dirs.begin(), dirs.end());
+    dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+    if (!m_impl->ensureDirs(dirs)) {
+        return false;
+    }
+
+    bool allOk = true;
+    std::string firstError;
+    for (const auto& f : files) {
+        if (m_impl->m_cancelFlag && m_impl->m_cancelFlag->load()) {
             allOk = false;
+            if (firstError.empty()) firstError = "上传已取消";
+            break;
+        }
+        if (!uploadFile(f.first, f.second)) {
+            allOk = false;
+            if (firstError.empty()) firstError = m_impl->m_lastError;
             // 继续上传其余文件,不中止
         }
     }
 
+    if (!allOk) {
+        m_impl->m_lastError = firstError;
+    }
     return allOk;
 }
 
 bool FtpAdapter::downloadFile(const std::string& remotePath, const std::string& localPath) {
-    FILE* file = fopen(localPath.c_str(), "wb");
-    if (!file) {
-        m_impl->m_lastError = "无法创建本地文件: " + localPath;
+    // 先写入 .part 临时文件，中断后可从其长度续传；完成且校验大小后再改名
+    const std::string partPath = localPath + ".part";
+    const std::string metaPath = partPath + ".meta";
+    curl_off_t expected = -1;
+    curl_off_t mtime = -1;
+    m_impl->remoteStat(remotePath, expected, mtime);
+
+    // 残留的 .part 只有在旁路文件记录的远端大小与修改时间都与当前一致时才续传；
+    // 任一未知或不一致（远端已换版本）则丢弃，从头下载
+    const bool versionKnown = expected >= 0 && mtime >= 0;
+    std::error_code ec;
+    if (!versionKnown || !Impl::partMetaMatches(metaPath, expected, mtime)) {
+        std::filesystem::remove(partPath, ec);
+        std::filesystem::remove(metaPath, ec);
+        if (versionKnown) Impl::writePartMeta(metaPath, expected, mtime);
+    }
+
+    CURLcode res = CURLE_OK;
+    for (int attempt = 0; attempt < m_impl->m_maxAttempts; ++attempt) {
+        if (attempt > 0) {
+            m_impl->backoff(attempt);
+            if (m_impl->cancelled()) break;
+        }
+
+        curl_off_t offset = static_cast<curl_off_t>(std::filesystem::file_size(partPath, ec));
+        if (ec || (expected >= 0 && offset > expected)) offset = 0;
+
+        if (expected > 0 && offset == expected) {
+            res = CURLE_OK;
+            break;  // 同一版本上次已完整下载，只差改名
+        }
+
+        FILE* file = fopen(partPath.c_str(), offset > 0 ? "ab" : "wb");
+        if (!file) {
+            m_impl->m_lastError = "无法创建本地文件: " + localPath;
+            return false;
+        }
+
+        CURL* curl = m_impl->session();
+        if (!curl) {
+            fclose(file);
+            m_impl->m_lastError = "curl_easy_init() 失败";
+            return false;
+        }
+
+        m_impl->setupCommonOpts(curl, m_impl->buildUrl(remotePath));
+        Impl::setupStallTimeout(curl);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Impl::writeToFileCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, file);
+        curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
+        if (offset > 0) {
+            curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, offset);
+        }
+
+        res = CurlMultiEngine::instance().perform(curl);
+        fclose(file);
+        if (res == CURLE_OK || !Impl::isResumable(res) || m_impl->cancelled()) break;
+    }
+
+    if (res != CURLE_OK) {
+        m_impl->m_lastError = std::string("下载失败: ") + curl_easy_strerror(res);
         return false;
     }
 
-    CURL* curl = curl_easy_init();
+    const auto got = std::filesystem::file_size(partPath, ec);
+    if (ec || (expected >= 0 && static_cast<curl_off_t>(got) != expected)) {
+        // 内容已不可信，不留给下次续传
+        std::filesystem::remove(partPath, ec);
+        std::filesystem::remove(metaPath, ec);
+        m_impl->m_lastError = "下载失败: 本地大小与远端不一致";
+        return false;
+    }
+
+    std::filesystem::remove(localPath, ec);
+    std::filesystem::rename(partPath, localPath, ec);
+    if (ec) {
+        m_impl->m_lastError = "下载完成但重命名失败: " + ec.message();
+        return false;
+    }
+    std::filesystem::remove(metaPath, ec);
+
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool FtpAdapter::readRemoteFile(const std::string& remotePath, std::string& outData) {
+    CURL* curl = m_impl->session();
     if (!curl) {
-        fclose(file);
         m_impl->m_lastError = "curl_easy_init() 失败";
         return false;
     }
 
-    std::string url = m_impl->buildUrl(remotePath);
-    std::string userPwd = m_impl->userPwd();
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_USERPWD, userPwd.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Impl::writeToFileCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, file);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
-    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
-    curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
-    curl_easy_setopt(curl, CURLOPT_REDIR_PROTOCOLS_STR, "ftp,ftps");
-    if (m_impl->m_useFtps) {
-        curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-    }
-
-    CURLcode res = curl_easy_perform(curl);
-    fclose(file);
-    curl_easy_cleanup(curl);
+    std::string buffer;
+    m_impl->setupCommonOpts(curl, m_impl->buildUrl(remotePath));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Impl::writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
 
-    if (res == CURLE_OK) {
-        m_impl->m_lastError.clear();
-        return true;
+    CURLcode res = CurlMultiEngine::instance().perform(curl);
+    if (res != CURLE_OK) {
+        m_impl->m_lastError = std::string("读取远程文件失败: ") + curl_easy_strerror(res);
+        return false;
     }
 
-    m_impl->m_lastError = std::string("下载失败: ") + curl_easy_strerror(res);
-    return false;
+    outData = std::move(buffer);
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool FtpAdapter::writeRemoteFile(const std::string& remotePath, const std::string& data) {
+    if (!m_impl->ensureDirs({ Impl::parentDir(remotePath) })) {
+        return false;
+    }
+
+    CURL* curl = m_impl->session();
+    if (!curl) {
+        m_impl->m_lastError = "curl_easy_init() 失败";
+        return false;
+    }
+
+    Impl::MemorySource src{ data.data(), data.size() };
+    m_impl->setupCommonOpts(curl, m_impl->buildUrl(remotePath));
+    curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, Impl::readFromMemoryCallback);
+    curl_easy_setopt(curl, CURLOPT_READDATA, &src);
+    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(data.size()));
+    curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
+
+    CURLcode res = CurlMultiEngine::instance().perform(curl);
+    if (res != CURLE_OK) {
+        m_impl->m_lastError = std::string("写入远程文件失败: ") + curl_easy_strerror(res);
+        return false;
+    }
+
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool FtpAdapter::makeDirectories(const std::vector<std::string>& remoteDirs) {
+    return m_impl->ensureDirs(remoteDirs);
 }
 
 bool FtpAdapter::listDirectory(const std::string& remotePath, std::string& outJsonList) {
@@ -442,7 +983,7 @@ bool FtpAdapter::listDirectory(const std::string& remotePath, std::string& outJs
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
     curl_easy_setopt(curl, CURLOPT_DIRLISTONLY, 0L);  // 获取详细列表
 
-    CURLcode res = curl_easy_perform(curl);
+    CURLcode res = CurlMultiEngine::instance().perform(curl);
     curl_easy_cleanup(curl);
 
     if (res != CURLE_OK) {
@@ -473,7 +1014,57 @@ bool FtpAdapter::listDirectory(const std::string& remotePath, std::string& outJs
     return true;
 }
 
-bool FtpAdapter::deleteFile(const std::string& remotePath) {
+bool FtpAdapter::remoteFileSize(const std::string& remotePath, uint64_t& outSize) {
+    const curl_off_t size = m_impl->remoteSize(remotePath);
+    if (size < 0) {
+        m_impl->m_lastError = "查询远程文件大小失败: " + remotePath;
+        return false;
+    }
+    outSize = static_cast<uint64_t>(size);
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+std::string FtpAdapter::checksumAlgorithm() {
+    switch (m_impl->checksumCommand()) {
+    case Impl::kChecksumHashMd5:
+    case Impl::kChecksumXmd5:
+        return "md5";
+    case Impl::kChecksumXcrc:
+        return "crc32";
+    default:
+        return {};
+    }
+}
+
+bool FtpAdapter::remoteChecksum(const std::string& remotePath, std::string& outHex) {
+    const Impl::ChecksumCommand cmd = m_impl->checksumCommand();
+    if (cmd == Impl::kChecksumNone) {
+        m_impl->m_lastError = "服务器不支持 HASH / XMD5 / XCRC";
+        return false;
+    }
+
+    const std::string path = (!remotePath.empty() && remotePath[0] == '/') ? remotePath : "/" + remotePath;
+    std::vector<std::string> commands;
+    if (cmd == Impl::kChecksumHashMd5) {
+        commands = { "OPTS HASH MD5", "HASH " + path };
+    } else if (cmd == Impl::kChecksumXmd5) {
+        commands = { "XMD5 " + path };
+    } else {
+        commands = { "XCRC " + path };
+    }
+
+    std::string replies;
+    if (!m_impl->quote(commands, replies)) return false;
+    if (!Impl::parseChecksumReply(replies, cmd != Impl::kChecksumXcrc, outHex)) {
+        m_impl->m_lastError = "无法解析远端摘要应答: " + remotePath;
+        return false;
+    }
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool FtpAdapter::deleteFile(const std::string& remotePath, bool missingOk) {
     CURL* curl = curl_easy_init();
     if (!curl) {
         m_impl->m_lastError = "curl_easy_init() 失败";
@@ -494,7 +1085,7 @@ bool FtpAdapter::deleteFile(const std::string& remotePath) {
     commands = curl_slist_append(commands, deleteCmd.c_str());
     curl_easy_setopt(curl, CURLOPT_QUOTE, commands);
 
-    CURLcode res = curl_easy_perform(curl);
+    CURLcode res = CurlMultiEngine::instance().perform(curl);
     curl_slist_free_all(commands);
     curl_easy_cleanup(curl);
 
@@ -503,11 +1094,19 @@ bool FtpAdapter::deleteFile(const std::string& remotePath) {
         return true;
     }
 
+    if (missingOk && m_impl->remoteMissing(remotePath)) {
+        m_impl->m_lastError.clear();
+        return true;
+    }
+
     m_impl->m_lastError = std::string("删除文件失败: ") + curl_easy_strerror(res);
     return false;
 }
 
 bool FtpAdapter::deleteDirectory(const std::string& remotePath) {
+    // 目录可能被删除，已知目录缓存作废
+    m_impl->m_knownDirs.clear();
+
     CURL* curl = curl_easy_init();
     if (!curl) {
         m_impl->m_lastError = "curl_easy_init() 失败";
@@ -528,7 +1127,7 @@ bool FtpAdapter::deleteDirectory(const std::string& remotePath) {
     commands = curl_slist_append(commands, rmdCmd.c_str());
     curl_easy_setopt(curl, CURLOPT_QUOTE, commands);
 
-    CURLcode res = curl_easy_perform(curl);
+    CURLcode res = CurlMultiEngine::instance().perform(curl);
     curl_slist_free_all(commands);
     curl_easy_cleanup(curl);
 
@@ -542,59 +1141,44 @@ bool FtpAdapter::deleteDirectory(const std::string& remotePath) {
 }
 
 bool FtpAdapter::clearRemoteDirectory(const std::string& remotePath) {
-    // 安全校验：不允许清空根目录
-    std::string cleanPath = remotePath;
-    while (!cleanPath.empty() && cleanPath.front() == '/') {
-        cleanPath.erase(0, 1);
-    }
-    while (!cleanPath.empty() && cleanPath.back() == '/') {
-        cleanPath.pop_back();
-    }
-    if (cleanPath.empty()) {
-        m_impl->m_lastError = "不能清空根目录 '/'";
-        return false;
-    }
+    m_impl->m_knownDirs.clear();
+
+    // 递归清空：每个目录只列一次，删除按批走 QUOTE 序列，多个目录/批次并行
+    std::ostringstream base;
+    base << (m_impl->m_useFtps ? "ftps://" : "ftp://") << m_impl->m_ip << ":" << m_impl->m_port;
+    Impl* impl = m_impl.get();
+    FtpRemoteTree tree(base.str(), [impl](CURL* curl) {
+        impl->setupCommonOpts(curl, std::string());
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);  // 取消由 FtpRemoteTree 在调度间隙检查
+    });
+    tree.setCancelFlag(m_impl->m_cancelFlag);
 
-    // 列出目录内容
-    std::string listing;
-    if (!listDirectory(cleanPath, listing)) {
+    const bool ok = tree.clear(remotePath);
+    m_impl->m_treeStats = tree.stats();
+    if (!ok) {
+        m_impl->m_lastError = tree.lastError();
         return false;
     }
+    m_impl->m_lastError.clear();
+    return true;
+}
 
-    // 解析 JSON 数组获取文件名列表
-    std::vector<std::string> entries;
-    size_t pos = 0;
-    while ((pos = listing.find('"', pos)) != std::string::npos) {
-        size_t start = pos + 1;
-        size_t end = listing.find('"', start);
-        if (end == std::string::npos) break;
-        std::string name = listing.substr(start, end - start);
-        if (name != "." && name != "..") {
-            entries.push_back(name);
-        }
-        pos = end + 1;
-    }
-
-    // 逐一删除（先尝试作为文件,失败则尝试作为目录）
-    bool allOk = true;
-    for (const auto& entry : entries) {
-        std::string fullPath = cleanPath + "/" + entry;
-
-        if (!deleteFile(fullPath)) {
-            // 文件删除失败,尝试作为目录删除
-            if (!deleteDirectory(fullPath)) {
-                allOk = false;
-            }
-        }
-    }
-
-    return allOk;
+const FtpTreeStats& FtpAdapter::lastTreeStats() const {
+    return m_impl->m_treeStats;
 }
 
 void FtpAdapter::setProgressCallback(std::function<void(int)> cb) {
     m_impl->m_progressCb = std::move(cb);
 }
 
+void FtpAdapter::setBytesCallback(std::function<void(uint64_t)> cb) {
+    m_impl->m_bytesCb = std::move(cb);
+}
+
+void FtpAdapter::setCancelFlag(const std::atomic<bool>* cancelled) {
+    m_impl->m_cancelFlag = cancelled;
+}
+
 void FtpAdapter::setUseFtps(bool useFtps) {
     m_impl->m_useFtps = useFtps;
 }
@@ -1,12 +1,32 @@
 #pragma once
 #include "IProtocolAdapter.h"
+#include "FtpRemoteTree.h"
 #include <string>
+#include <vector>
 #include <future>
 #include <memory>
 #include <functional>
+#include <atomic>
+#include <cstdint>
+
+// 自定义上传数据源（如多设备共享的分块缓存）
+//   read: 读取至多 len 字节，返回实际字节数；0 = 结束；kFailed = 读取失败（中止传输）；
+//         kPause = 暂无可发送数据（无带宽配额或块仍在读盘；传输暂停，
+//         约 kPauseRetryMs 后再次调用 read）
+//   seek: 定位到 offset（断点续传时跳到远端已落盘位置），失败返回 false
+// 回调在传输引擎线程执行，不得阻塞
+struct UploadSource {
+    static constexpr size_t kFailed = SIZE_MAX;
+    static constexpr size_t kPause = SIZE_MAX - 1;
+    static constexpr int kPauseRetryMs = 10;
+
+    uint64_t size = 0;
+    std::function<size_t(char* buf, size_t len)> read;
+    std::function<bool(uint64_t offset)> seek;
+};
 
 // FTP 协议适配器 — 封装 libcurl FTP 操作,实现 IProtocolAdapter 统一接口
-// 使用 Pimpl 模式隐藏 libcurl 实现细节
+// 使用 Pimpl 模式隐藏 libcurl 实现细节；所有传输经 CurlMultiEngine 单线程事件循环执行
 class FtpAdapter : public IProtocolAdapter {
 public:
     FtpAdapter();
@@ -25,13 +45,34 @@ public:
 
     // --- FTP 特有操作（直接调用,不通过 request 抽象） ---
     bool uploadFile(const std::string& localPath, const std::string& remotePath);
+    // 从自定义数据源上传，支持断点续传，语义同 uploadFile
+    bool uploadFromSource(const UploadSource& source, const std::string& remotePath);
     bool uploadFolder(const std::string& localPath, const std::string& remotePath);
     bool downloadFile(const std::string& remotePath, const std::string& localPath);
+    // 小文件整体读写（内存 ↔ 远程），用于部署清单等元数据
+    bool readRemoteFile(const std::string& remotePath, std::string& outData);
+    bool writeRemoteFile(const std::string& remotePath, const std::string& data);
+    // 批量创建远程目录（含各级父目录），本次连接内已创建的目录不重复发送 MKD
+    bool makeDirectories(const std::vector<std::string>& remoteDirs);
     bool listDirectory(const std::string& remotePath, std::string& outJsonList);
-    bool deleteFile(const std::string& remotePath);
+    // 远程文件大小（SIZE），不存在或服务器不支持时返回 false
+    bool remoteFileSize(const std::string& remotePath, uint64_t& outSize);
+    // 服务器支持的远端摘要算法（FEAT 探测 HASH / XMD5 / XCRC，本次连接内只探测一次）：
+    // "md5" / "crc32"；均不支持时返回空串
+    std::string checksumAlgorithm();
+    // 远端文件摘要（小写十六进制），算法见 checksumAlgorithm()；不支持或失败时返回 false
+    bool remoteChecksum(const std::string& remotePath, std::string& outHex);
+    // missingOk 为 true 时文件本就不存在（SIZE 应答 550）也视为成功
+    bool deleteFile(const std::string& remotePath, bool missingOk = false);
     bool deleteDirectory(const std::string& remotePath);
+    // 递归清空远程目录内容（保留目录本身）；统计见 lastTreeStats()
     bool clearRemoteDirectory(const std::string& remotePath);
+    const FtpTreeStats& lastTreeStats() const;
     void setProgressCallback(std::function<void(int)> cb);
+    // 累计已上传字节回调（本适配器生命周期内所有上传之和，含当前文件已发送部分）
+    void setBytesCallback(std::function<void(uint64_t)> cb);
+    // 外部取消标志：置 true 后正在进行的传输在下一次进度回调时中止
+    void setCancelFlag(const std::atomic<bool>* cancelled) override;
     void setUseFtps(bool useFtps);
 
 private:
@@ -0,0 +1,444 @@
+#include "FtpRemoteTree.h"
+#include "CurlMultiEngine.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// ============================================================
+// 内部工具
+// ============================================================
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t msSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+}
+
+size_t appendToString(void* ptr, size_t size, size_t nmemb, void* userdata) {
+    static_cast<std::string*>(userdata)->append(static_cast<char*>(ptr), size * nmemb);
+    return size * nmemb;
+}
+
+std::string trimSlashes(std::string p) {
+    while (!p.empty() && p.front() == '/') p.erase(0, 1);
+    while (!p.empty() && p.back() == '/') p.pop_back();
+    return p;
+}
+
+std::string joinPath(const std::string& a, const std::string& b) {
+    if (a.empty()) return b;
+    return a + "/" + b;
+}
+
+// URL 路径百分号编码（保留 '/'），文件名含空格、'#'、'%' 等时 URL 才能被正确解析
+std::string encodePath(const std::string& path) {
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(path.size());
+    for (unsigned char c : path) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')
+            || c == '-' || c == '.' || c == '_' || c == '~' || c == '/') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += kHex[c >> 4];
+            out += kHex[c & 0x0F];
+        }
+    }
+    return out;
+}
+
+// 引擎线程投递完成事件，调用线程等待
+struct Completion {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::pair<size_t, CURLcode>> done;
+
+    void push(size_t id, CURLcode res) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.emplace_back(id, res);
+        }
+        cv.notify_one();
+    }
+
+    std::vector<std::pair<size_t, CURLcode>> wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return !done.empty(); });
+        std::vector<std::pair<size_t, CURLcode>> out;
+        out.swap(done);
+        return out;
+    }
+};
+
+bool startsWithNoCase(const std::string& s, size_t pos, const char* prefix) {
+    for (size_t i = 0; prefix[i]; ++i) {
+        if (pos + i >= s.size()) return false;
+        if (std::tolower(static_cast<unsigned char>(s[pos + i])) != prefix[i]) return false;
+    }
+    return true;
+}
+
+// 第 n 个空白分隔字段的起始位置（从 0 计），不存在返回 npos
+size_t fieldStart(const std::string& line, int n) {
+    size_t pos = 0;
+    for (int i = 0;; ++i) {
+        pos = line.find_first_not_of(" \t", pos);
+        if (pos == std::string::npos || i == n) return pos;
+        pos = line.find_first_of(" \t", pos);
+        if (pos == std::string::npos) return pos;
+    }
+}
+
+std::string fieldAt(const std::string& line, int n) {
+    const size_t start = fieldStart(line, n);
+    if (start == std::string::npos) return {};
+    const size_t end = line.find_first_of(" \t", start);
+    return line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+int64_t toSize(const std::string& s) {
+    if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos) return -1;
+    try {
+        return std::stoll(s);
+    } catch (...) {
+        return -1;
+    }
+}
+
+} // namespace
+
+// ============================================================
+// 构造 / URL
+// ============================================================
+
+FtpRemoteTree::FtpRemoteTree(std::string baseUrl, Configure configure, int maxInFlight)
+    : m_baseUrl(std::move(baseUrl))
+    , m_configure(std::move(configure))
+    , m_maxInFlight(std::max(1, maxInFlight))
+{
+}
+
+std::string FtpRemoteTree::dirUrl(const std::string& dir) const {
+    const std::string clean = trimSlashes(dir);
+    return m_baseUrl + "/" + encodePath(clean) + (clean.empty() ? "" : "/");
+}
+
+// ============================================================
+// 列表解析
+// ============================================================
+
+void FtpRemoteTree::parseListing(const std::string& text, bool mlsd, std::vector<FtpRemoteEntry>& out) {
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = text.size();
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        FtpRemoteEntry e;
+        if (mlsd) {
+            // "type=file;size=12;modify=20240101120000; name"：事实与文件名以首个空格分隔
+            const size_t sp = line.find(' ');
+            if (sp == std::string::npos || sp + 1 >= line.size()) continue;
+            e.name = line.substr(sp + 1);
+            bool skip = false;
+            size_t f = 0;
+            while (f < sp) {
+                size_t semi = line.find(';', f);
+                if (semi == std::string::npos || semi > sp) semi = sp;
+                if (startsWithNoCase(line, f, "type=")) {
+                    const std::string type = line.substr(f + 5, semi - f - 5);
+                    if (type == "cdir" || type == "pdir") skip = true;
+                    e.isDir = (type == "dir");
+                } else if (startsWithNoCase(line, f, "size=")) {
+                    e.size = toSize(line.substr(f + 5, semi - f - 5));
+                }
+                f = semi + 1;
+            }
+            if (skip) continue;
+        } else if (std::isdigit(static_cast<unsigned char>(line[0]))) {
+            // DOS/IIS: "01-01-24  12:00PM  <DIR>  name" 或 "... 1234 name"
+            const std::string third = fieldAt(line, 2);
+            const size_t nameStart = fieldStart(line, 3);
+            if (third.empty() || nameStart == std::string::npos) continue;
+            e.isDir = (third == "<DIR>");
+            e.size = e.isDir ? -1 : toSize(third);
+            e.name = line.substr(nameStart);
+        } else {
+            // Unix ls -l: "drwxr-xr-x 2 user group 4096 Jan 01 12:00 name"
+            if (startsWithNoCase(line, 0, "total ")) continue;
+            const size_t nameStart = fieldStart(line, 8);
+            if (nameStart == std::string::npos) continue;
+            e.isDir = (line[0] == 'd');
+            e.size = toSize(fieldAt(line, 4));
+            e.name = line.substr(nameStart);
+            if (line[0] == 'l') {
+                // 符号链接按文件处理（DELE 删除链接本身），去掉 " -> 目标"
+                const size_t arrow = e.name.find(" -> ");
+                if (arrow != std::string::npos) e.name.erase(arrow);
+            }
+        }
+
+        if (e.name.empty() || e.name == "." || e.name == "..") continue;
+        out.push_back(std::move(e));
+    }
+}
+
+// ============================================================
+// 列目录 / 递归遍历
+// ============================================================
+
+bool FtpRemoteTree::list(const std::string& dir, std::vector<FtpRemoteEntry>& out) {
+    for (;;) {
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            m_lastError = "curl_easy_init() 失败";
+            return false;
+        }
+        const bool mlsd = m_mlsd != Mlsd::No;
+        std::string body;
+        m_configure(curl);
+        curl_easy_setopt(curl, CURLOPT_URL, dirUrl(dir).c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendToString);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+        if (mlsd) curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "MLSD");
+
+        const CURLcode res = CurlMultiEngine::instance().perform(curl);
+        curl_easy_cleanup(curl);
+
+        if (res != CURLE_OK) {
+            if (mlsd && m_mlsd == Mlsd::Unknown) {
+                m_mlsd = Mlsd::No;  // 服务器不支持 MLSD → 回退 LIST 重试
+                continue;
+            }
+            m_lastError = "列目录失败: /" + trimSlashes(dir) + " — " + curl_easy_strerror(res);
+            return false;
+        }
+        if (mlsd) m_mlsd = Mlsd::Yes;
+        m_stats.dirsListed++;
+        parseListing(body, mlsd, out);
+        return true;
+    }
+}
+
+bool FtpRemoteTree::walk(const std::string& root,
+                         std::vector<std::pair<std::string, FtpRemoteEntry>>& out) {
+    struct Job {
+        std::string rel;
+        bool mlsd = false;
+        CURL* curl = nullptr;
+        std::string body;
+    };
+
+    const std::string base = trimSlashes(root);
+    std::deque<std::string> queue{ std::string() };
+    std::unordered_map<size_t, std::unique_ptr<Job>> inflight;
+    Completion completion;
+    size_t nextId = 0;
+    bool ok = true;
+
+    auto launch = [&](const std::string& rel) {
+        auto job = std::make_unique<Job>();
+        job->rel = rel;
+        job->mlsd = m_mlsd != Mlsd::No;
+        job->curl = curl_easy_init();
+        if (!job->curl) {
+            m_lastError = "curl_easy_init() 失败";
+            return false;
+        }
+        m_configure(job->curl);
+        curl_easy_setopt(job->curl, CURLOPT_URL, dirUrl(joinPath(base, rel)).c_str());
+        curl_easy_setopt(job->curl, CURLOPT_WRITEFUNCTION, appendToString);
+        curl_easy_setopt(job->curl, CURLOPT_WRITEDATA, &job->body);
+        if (job->mlsd) curl_easy_setopt(job->curl, CURLOPT_CUSTOMREQUEST, "MLSD");
+
+        const size_t id = nextId++;
+        CURL* curl = job->curl;
+        inflight.emplace(id, std::move(job));
+        CurlMultiEngine::instance().submit(curl, [&completion, id](CURLcode res) {
+            completion.push(id, res);
+        });
+        return true;
+    };
+
+    for (;;) {
+        while (ok && !cancelled() && !queue.empty()
+               && inflight.size() < static_cast<size_t>(m_maxInFlight)) {
+            if (!launch(queue.front())) ok = false;
+            queue.pop_front();
+        }
+        if (inflight.empty()) break;
+
+        for (const auto& done : completion.wait()) {
+            auto it = inflight.find(done.first);
+            std::unique_ptr<Job> job = std::move(it->second);
+            inflight.erase(it);
+            curl_easy_cleanup(job->curl);
+
+            if (done.second != CURLE_OK) {
+                // MLSD 失败且支持情况未确认 → 认定不支持，本目录改用 LIST 重列
+                if (job->mlsd && m_mlsd != Mlsd::Yes) {
+                    m_mlsd = Mlsd::No;
+                    queue.push_front(job->rel);
+                    continue;
+                }
+                if (ok) {
+                    m_lastError = "列目录失败: /" + joinPath(base, job->rel) + " — "
+                                + curl_easy_strerror(done.second);
+                }
+                ok = false;
+                continue;
+            }
+            if (job->mlsd) m_mlsd = Mlsd::Yes;
+            m_stats.dirsListed++;
+
+            std::vector<FtpRemoteEntry> entries;
+            parseListing(job->body, job->mlsd, entries);
+            for (auto& e : entries) {
+                std::string rel = joinPath(job->rel, e.name);
+                if (e.isDir) queue.push_back(rel);
+                out.emplace_back(std::move(rel), std::move(e));
+            }
+        }
+    }
+
+    if (ok && cancelled()) {
+        m_lastError = "已取消";
+        ok = false;
+    }
+    return ok;
+}
+
+// ============================================================
+// 批量删除
+// ============================================================
+
+void FtpRemoteTree::runBatches(const std::vector<std::vector<std::string>>& batches) {
+    struct Running {
+        CURL* curl = nullptr;
+        curl_slist* commands = nullptr;
+    };
+
+    std::unordered_map<size_t, Running> inflight;
+    Completion completion;
+    size_t next = 0;
+    const std::string rootUrl = m_baseUrl + "/";
+
+    for (;;) {
+        while (next < batches.size() && !cancelled()
+               && inflight.size() < static_cast<size_t>(m_maxInFlight)) {
+            const size_t id = next++;
+            Running r;
+            r.curl = curl_easy_init();
+            if (!r.curl) continue;
+            for (const auto& cmd : batches[id]) {
+                r.commands = curl_slist_append(r.commands, cmd.c_str());
+            }
+            m_configure(r.curl);
+            curl_easy_setopt(r.curl, CURLOPT_URL, rootUrl.c_str());
+            curl_easy_setopt(r.curl, CURLOPT_NOBODY, 1L);
+            curl_easy_setopt(r.curl, CURLOPT_QUOTE, r.commands);
+            CURL* curl = r.curl;
+            inflight.emplace(id, r);
+            CurlMultiEngine::instance().submit(curl, [&completion, id](CURLcode res) {
+                completion.push(id, res);
+            });
+        }
+        if (inflight.empty()) break;
+
+        // 命令均以 '*' 开头：单条失败不中断序列，结果由清空后的复查统计
+        for (const auto& done : completion.wait()) {
+            auto it = inflight.find(done.first);
+            curl_slist_free_all(it->second.commands);
+            curl_easy_cleanup(it->second.curl);
+            inflight.erase(it);
+        }
+    }
+}
+
+bool FtpRemoteTree::clear(const std::string& root) {
+    m_stats = FtpTreeStats();
+    m_lastError.clear();
+    const auto start = Clock::now();
+
+    const std::string base = trimSlashes(root);
+    if (base.empty()) {
+        m_lastError = "不能清空根目录 '/'";
+        return false;
+    }
+
+    std::vector<std::pair<std::string, FtpRemoteEntry>> entries;
+    if (!walk(base, entries)) {
+        m_stats.listMs = m_stats.totalMs = msSince(start);
+        return false;
+    }
+    m_stats.listMs = msSince(start);
+
+    // 文件：按遍历顺序（同目录相邻）成批 DELE
+    std::vector<std::vector<std::string>> fileBatches;
+    // 目录：按深度由深到浅逐层 RMD，同层各批并行
+    std::map<size_t, std::vector<std::string>, std::greater<size_t>> dirsByDepth;
+    size_t fileCount = 0, dirCount = 0;
+
+    for (const auto& kv : entries) {
+        const std::string abs = "/" + base + "/" + kv.first;
+        if (kv.second.isDir) {
+            dirsByDepth[static_cast<size_t>(std::count(kv.first.begin(), kv.first.end(), '/'))]
+                .push_back("*RMD " + abs);
+            dirCount++;
+        } else {
+            if (fileBatches.empty() || fileBatches.back().size() >= kBatchSize) {
+                fileBatches.emplace_back();
+            }
+            fileBatches.back().push_back("*DELE " + abs);
+            fileCount++;
+        }
+    }
+
+    const auto deleteStart = Clock::now();
+    runBatches(fileBatches);
+    for (const auto& level : dirsByDepth) {
+        std::vector<std::vector<std::string>> batches;
+        for (size_t i = 0; i < level.second.size(); i += kBatchSize) {
+            const size_t end = std::min(level.second.size(), i + kBatchSize);
+            batches.emplace_back(level.second.begin() + static_cast<std::ptrdiff_t>(i),
+                                 level.second.begin() + static_cast<std::ptrdiff_t>(end));
+        }
+        runBatches(batches);
+    }
+    m_stats.deleteMs = msSince(deleteStart);
+
+    if (cancelled()) {
+        m_lastError = "已取消";
+        m_stats.totalMs = msSince(start);
+        return false;
+    }
+
+    // 复查：正常情况下只多一次根目录列表；有残留时统计实际删除数
+    std::vector<std::pair<std::string, FtpRemoteEntry>> rest;
+    const bool verified = walk(base, rest);
+    size_t restFiles = 0, restDirs = 0;
+    for (const auto& kv : rest) (kv.second.isDir ? restDirs : restFiles)++;
+    m_stats.filesDeleted = fileCount - std::min(fileCount, restFiles);
+    m_stats.dirsDeleted = dirCount - std::min(dirCount, restDirs);
+    m_stats.failures = rest.size();
+    m_stats.totalMs = msSince(start);
+
+    if (!verified) return false;
+    if (!rest.empty()) {
+        m_lastError = "清空不完整: 残留 " + std::to_string(rest.size()) + " 个条目（如 /" + base
+                    + "/" + rest.front().first + "）";
+        return false;
+    }
+    return true;
+}
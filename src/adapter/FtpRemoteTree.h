@@ -0,0 +1,76 @@
+#pragma once
+#include <curl/curl.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 远程目录条目
+struct FtpRemoteEntry {
+    std::string name;
+    bool isDir = false;
+    int64_t size = -1;      // 未知为 -1
+};
+
+// 遍历/清空统计
+struct FtpTreeStats {
+    size_t dirsListed = 0;
+    size_t filesDeleted = 0;
+    size_t dirsDeleted = 0;
+    size_t failures = 0;    // 清空后仍残留的条目数
+    int64_t listMs = 0;
+    int64_t deleteMs = 0;
+    int64_t totalMs = 0;
+};
+
+// FTP 远程目录树批量操作：
+//   - 每个目录只列一次（优先 MLSD，服务器不支持时自动回退 LIST）
+//   - 同时在途 maxInFlight 个目录列表 / 删除批次，均由 CurlMultiEngine 驱动
+//   - 删除按目录成批放入一个请求的 QUOTE 序列，在同一控制连接上连续发送，
+//     不再逐条目新建请求，也不再"先试文件、失败再试目录"
+// 路径约定与 FtpAdapter 一致：URL 相对登录目录，FTP 命令使用 '/' 开头的绝对路径
+class FtpRemoteTree {
+public:
+    // 为每个句柄设置凭据、超时、TLS 等公共选项（URL 由本类设置）
+    using Configure = std::function<void(CURL*)>;
+
+    static constexpr int kDefaultInFlight = 4;
+    static constexpr size_t kBatchSize = 200;   // 单个 QUOTE 序列的命令数上限
+
+    // baseUrl: "ftp://host:port"（不含结尾 '/'）
+    FtpRemoteTree(std::string baseUrl, Configure configure, int maxInFlight = kDefaultInFlight);
+
+    void setCancelFlag(const std::atomic<bool>* cancelled) { m_cancelled = cancelled; }
+
+    // 列出单个目录（不含 . / ..）
+    bool list(const std::string& dir, std::vector<FtpRemoteEntry>& out);
+    // 递归列出 root 下全部条目：路径相对 root（'/' 分隔），父目录先于其内容出现
+    bool walk(const std::string& root, std::vector<std::pair<std::string, FtpRemoteEntry>>& out);
+    // 递归清空 root 的内容（保留 root 本身），不允许清空根目录
+    bool clear(const std::string& root);
+
+    const FtpTreeStats& stats() const { return m_stats; }
+    const std::string& lastError() const { return m_lastError; }
+
+    // 解析 MLSD / LIST 输出（LIST 支持 Unix ls -l 与 DOS/IIS 两种格式）
+    static void parseListing(const std::string& text, bool mlsd, std::vector<FtpRemoteEntry>& out);
+
+private:
+    std::string dirUrl(const std::string& dir) const;
+    bool cancelled() const { return m_cancelled && *m_cancelled; }
+    // 并行执行多组 QUOTE 命令序列（每组一个请求）
+    void runBatches(const std::vector<std::vector<std::string>>& batches);
+
+    std::string m_baseUrl;
+    Configure m_configure;
+    int m_maxInFlight;
+    const std::atomic<bool>* m_cancelled = nullptr;
+
+    enum class Mlsd { Unknown, Yes, No };
+    Mlsd m_mlsd = Mlsd::Unknown;
+
+    FtpTreeStats m_stats;
+    std::string m_lastError;
+};
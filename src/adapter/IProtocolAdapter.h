@@ -1,6 +1,7 @@
 #pragma once
 #include "ProtocolCapability.h"
 #include <string>
+#include <atomic>
 #include <future>
 #include <functional>
 #include <memory>
@@ -8,6 +9,9 @@
 // 流式数据回调：每次收到新数据块时调用
 using StreamCallback = std::function<void(const std::string& data, bool isFinished)>;
 
+// 请求响应的分块交付：设置后大响应边到达边交出，Response::data 只含尚未交出的尾部
+using ResponseSink = std::function<void(const char* data, size_t length)>;
+
 // 所有协议适配器的统一基类
 class IProtocolAdapter {
 public:
@@ -21,6 +25,11 @@ public:
     virtual void disconnect() = 0;
     virtual bool isConnected() const = 0;
     virtual std::string lastError() const = 0;
+    // 外部取消标志：置 true 后进行中的连接/请求尽快中止并返回失败。
+    // 标志须存活到适配器断开；默认忽略，由支持中止的适配器覆盖
+    virtual void setCancelFlag(const std::atomic<bool>* /*cancelled*/) {}
+    // 响应分块交付（在 request 的执行线程上回调）；默认忽略，整段放入 Response::data
+    virtual void setResponseSink(ResponseSink /*sink*/) {}
 
     // --- 传输模式 ---
     // 请求-响应（FTP、HTTP、Modbus 读）
@@ -0,0 +1,585 @@
+#include "SftpAdapter.h"
+#include "SftpPipeline.h"
+#include "SshSessionPool.h"
+#include <libssh2/libssh2_sftp.h>
+#include <lwlog/lwlog.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <set>
+
+namespace {
+
+constexpr int kShutdownTimeoutMs = 1000;   // 断开时关闭 SFTP 子系统的等待上限
+
+// libssh2 以 unsigned int 传路径长度
+unsigned int pathLen(const std::string& path)
+{
+    return static_cast<unsigned int>(path.size());
+}
+
+} // namespace
+
+struct SftpAdapter::Impl {
+    // 同一 SFTP 实例上的操作串行：libssh2 按实例保存各调用的非阻塞状态，不能交错
+    mutable std::mutex m_opMutex;
+    std::shared_ptr<SshSession> m_session;
+    LIBSSH2_SFTP* m_sftp = nullptr;
+    bool m_reused = false;
+    std::string m_lastError;
+    const std::atomic<bool>* m_cancelFlag = nullptr;
+    std::set<std::string> m_knownDirs;      // 本次连接内已确认存在的远程目录
+
+    std::function<void(int)> m_progressCb;
+    std::function<void(uint64_t)> m_bytesCb;
+    uint64_t m_bytesCommitted = 0;          // 已完成上传的累计字节
+
+    // --- 会话上执行一次非阻塞调用（EAGAIN 重试 / 超时 / 取消由 SshSession::call 处理） ---
+    ssize_t call(const std::function<ssize_t(LIBSSH2_SESSION*)>& op) {
+        return m_session->call(op, kIoTimeoutMs, m_cancelFlag);
+    }
+
+    // --- 失败原因：SFTP 状态码 / 取消 / 超时 / 会话错误 ---
+    void fail(const std::string& what, ssize_t rc) {
+        std::string reason;
+        if (rc == SshSession::kErrorCancelled) {
+            reason = "已取消";
+        } else if (rc == LIBSSH2_ERROR_TIMEOUT) {
+            reason = "超时";
+        } else if (rc == LIBSSH2_ERROR_SFTP_PROTOCOL && m_sftp) {
+            switch (libssh2_sftp_last_error(m_sftp)) {
+            case LIBSSH2_FX_NO_SUCH_FILE:
+            case LIBSSH2_FX_NO_SUCH_PATH:         reason = "文件或目录不存在"; break;
+            case LIBSSH2_FX_PERMISSION_DENIED:    reason = "权限不足"; break;
+            case LIBSSH2_FX_FILE_ALREADY_EXISTS:  reason = "已存在"; break;
+            case LIBSSH2_FX_DIR_NOT_EMPTY:        reason = "目录非空"; break;
+            case LIBSSH2_FX_NO_SPACE_ON_FILESYSTEM:
+            case LIBSSH2_FX_QUOTA_EXCEEDED:       reason = "远端空间不足"; break;
+            default:
+                reason = "SFTP 状态码 " + std::to_string(libssh2_sftp_last_error(m_sftp));
+                break;
+            }
+        } else {
+            reason = m_session ? m_session->lastError() : std::string();
+            if (reason.empty()) reason = "libssh2 错误 " + std::to_string(rc);
+        }
+        m_lastError = what + ": " + reason;
+    }
+
+    bool ready() {
+        if (m_sftp) return true;
+        m_lastError = "SFTP 未连接";
+        return false;
+    }
+
+    LIBSSH2_SFTP_HANDLE* open(const std::string& path, unsigned long flags, long mode, int type, ssize_t& rc) {
+        LIBSSH2_SFTP_HANDLE* handle = nullptr;
+        rc = call([&](LIBSSH2_SESSION* s) -> ssize_t {
+            handle = libssh2_sftp_open_ex(m_sftp, path.c_str(), pathLen(path), flags, mode, type);
+            return handle ? 0 : libssh2_session_last_errno(s);
+        });
+        return rc == 0 ? handle : nullptr;
+    }
+
+    void close(LIBSSH2_SFTP_HANDLE* handle) {
+        call([handle](LIBSSH2_SESSION*) -> ssize_t { return libssh2_sftp_close_handle(handle); });
+    }
+
+    bool stat(const std::string& path, LIBSSH2_SFTP_ATTRIBUTES& attrs, ssize_t& rc) {
+        rc = call([&](LIBSSH2_SESSION*) -> ssize_t {
+            return libssh2_sftp_stat_ex(m_sftp, path.c_str(), pathLen(path), LIBSSH2_SFTP_STAT, &attrs);
+        });
+        return rc == 0;
+    }
+
+    // --- 打开 SFTP 子系统（占用会话的一个 channel 名额） ---
+    bool startSftp() {
+        if (!m_session->acquireChannel(m_cancelFlag)) {
+            m_lastError = m_session->broken() ? "SSH 会话已断开" : "SFTP 连接已取消";
+            return false;
+        }
+        LIBSSH2_SFTP* sftp = nullptr;
+        const ssize_t rc = call([&sftp](LIBSSH2_SESSION* s) -> ssize_t {
+            sftp = libssh2_sftp_init(s);
+            return sftp ? 0 : libssh2_session_last_errno(s);
+        });
+        if (rc != 0) {
+            m_session->releaseChannel();
+            fail("打开 SFTP 子系统失败", rc);
+            return false;
+        }
+        m_sftp = sftp;
+        return true;
+    }
+
+    void stopSftp() {
+        if (!m_sftp) return;
+        LIBSSH2_SFTP* sftp = m_sftp;
+        m_sftp = nullptr;
+        // 取消后仍需关闭子系统，不传取消标志；超时则留给会话释放时回收
+        m_session->call([sftp](LIBSSH2_SESSION*) -> ssize_t { return libssh2_sftp_shutdown(sftp); },
+                        kShutdownTimeoutMs, nullptr);
+        m_session->releaseChannel();
+    }
+
+    void reportProgress(uint64_t done, uint64_t total) {
+        if (m_progressCb && total > 0) {
+            m_progressCb(static_cast<int>(done * 100 / total));
+        }
+    }
+
+    // --- 流水线写：缓冲压实逻辑见 SftpPipeline::writeStream，这里接入 libssh2 与进度回调 ---
+    bool writeStream(LIBSSH2_SFTP_HANDLE* handle, const std::function<size_t(char*, size_t)>& read,
+                     uint64_t total, const std::string& what) {
+        std::vector<char> buf(kPipelineBytes);
+        int64_t writeError = 0;
+        const auto result = SftpPipeline::writeStream(buf, read,
+            [&](const char* data, size_t len) -> int64_t {
+                return call([&](LIBSSH2_SESSION*) -> ssize_t {
+                    return libssh2_sftp_write(handle, data, len);
+                });
+            },
+            [&](uint64_t acked) {
+                reportProgress(acked, total);
+                if (m_bytesCb) m_bytesCb(m_bytesCommitted + acked);
+            },
+            writeError);
+        if (result == SftpPipeline::WriteResult::ReadFailed) {
+            m_lastError = what + ": 读取本地数据失败";
+            return false;
+        }
+        if (result == SftpPipeline::WriteResult::WriteFailed) {
+            fail(what, static_cast<ssize_t>(writeError));
+            return false;
+        }
+        return true;
+    }
+
+    // --- 流水线读：大缓冲让 libssh2 预先发出多个 READ 请求（read-ahead） ---
+    bool readStream(LIBSSH2_SFTP_HANDLE* handle, const std::function<bool(const char*, size_t)>& write,
+                    uint64_t total, const std::string& what) {
+        std::vector<char> buf(kPipelineBytes);
+        uint64_t received = 0;
+        for (;;) {
+            const ssize_t rc = call([&](LIBSSH2_SESSION*) -> ssize_t {
+                return libssh2_sftp_read(handle, buf.data(), buf.size());
+            });
+            if (rc == 0) return true;
+            if (rc < 0) {
+                fail(what, rc);
+                return false;
+            }
+            if (!write(buf.data(), static_cast<size_t>(rc))) {
+                m_lastError = what + ": 写入本地数据失败";
+                return false;
+            }
+            received += static_cast<uint64_t>(rc);
+            reportProgress(received, total);
+        }
+    }
+
+    bool upload(const std::function<size_t(char*, size_t)>& read, uint64_t total,
+                const std::string& remotePath) {
+        ssize_t rc = 0;
+        LIBSSH2_SFTP_HANDLE* handle = open(remotePath,
+            LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_TRUNC,
+            LIBSSH2_SFTP_S_IRUSR | LIBSSH2_SFTP_S_IWUSR | LIBSSH2_SFTP_S_IRGRP | LIBSSH2_SFTP_S_IROTH,
+            LIBSSH2_SFTP_OPENFILE, rc);
+        if (!handle) {
+            fail("无法创建远程文件 " + remotePath, rc);
+            return false;
+        }
+        const bool ok = writeStream(handle, read, total, "上传失败 " + remotePath);
+        close(handle);
+        if (ok) {
+            m_bytesCommitted += total;
+            m_lastError.clear();
+        }
+        return ok;
+    }
+
+    bool download(const std::string& remotePath, const std::function<bool(const char*, size_t)>& write) {
+        ssize_t rc = 0;
+        LIBSSH2_SFTP_HANDLE* handle = open(remotePath, LIBSSH2_FXF_READ, 0, LIBSSH2_SFTP_OPENFILE, rc);
+        if (!handle) {
+            fail("无法打开远程文件 " + remotePath, rc);
+            return false;
+        }
+        LIBSSH2_SFTP_ATTRIBUTES attrs{};
+        const ssize_t st = call([&](LIBSSH2_SESSION*) -> ssize_t {
+            return libssh2_sftp_fstat_ex(handle, &attrs, 0);
+        });
+        const uint64_t total = (st == 0 && (attrs.flags & LIBSSH2_SFTP_ATTR_SIZE)) ? attrs.filesize : 0;
+        const bool ok = readStream(handle, write, total, "下载失败 " + remotePath);
+        close(handle);
+        if (ok) m_lastError.clear();
+        return ok;
+    }
+};
+
+// ============================================================
+// 构造 / 析构
+// ============================================================
+
+SftpAdapter::SftpAdapter()
+    : m_impl(std::make_unique<Impl>())
+{
+}
+
+SftpAdapter::~SftpAdapter()
+{
+    disconnect();
+}
+
+// ============================================================
+// IProtocolAdapter — 连接生命周期
+// ============================================================
+
+bool SftpAdapter::connect(const DeviceInfo& device, const AuthInfo& auth)
+{
+    disconnect();
+
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    const std::string host = device.ip;
+    const int port = device.port ? device.port : 22;
+
+    std::string error;
+    bool reused = false;
+    m_impl->m_session = SshSessionPool::instance().acquire(host, port, auth, reused, error);
+    if (!m_impl->m_session) {
+        m_impl->m_lastError = error;
+        return false;
+    }
+    m_impl->m_reused = reused;
+
+    if (!m_impl->startSftp() && reused && m_impl->m_session->broken()
+        && !(m_impl->m_cancelFlag && m_impl->m_cancelFlag->load())) {
+        // 池中会话空闲期间已被对端关闭：换一条新会话重试一次
+        LWLOG_W("SFTP pooled session to " + host + " went stale, reconnecting");
+        SshSessionPool::instance().release(m_impl->m_session);
+        m_impl->m_session = SshSessionPool::instance().acquire(host, port, auth, reused, error);
+        m_impl->m_reused = false;
+        if (!m_impl->m_session) {
+            m_impl->m_lastError = error;
+            return false;
+        }
+        m_impl->startSftp();
+    }
+    if (!m_impl->m_sftp) {
+        SshSessionPool::instance().release(m_impl->m_session);
+        m_impl->m_session.reset();
+        return false;
+    }
+    m_impl->m_knownDirs.clear();
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+void SftpAdapter::disconnect()
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->m_session) return;
+    m_impl->stopSftp();
+    // 归还而非断开：会话留在池中供批量命令或下次连接复用
+    SshSessionPool::instance().release(m_impl->m_session);
+    m_impl->m_session.reset();
+}
+
+bool SftpAdapter::isConnected() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    return m_impl->m_sftp && !m_impl->m_session->broken();
+}
+
+std::string SftpAdapter::lastError() const
+{
+    return m_impl->m_lastError;
+}
+
+bool SftpAdapter::sessionReused() const
+{
+    return m_impl->m_reused;
+}
+
+void SftpAdapter::setCancelFlag(const std::atomic<bool>* cancelled)
+{
+    m_impl->m_cancelFlag = cancelled;
+}
+
+// ============================================================
+// IProtocolAdapter — 传输模式
+// ============================================================
+
+std::future<Response> SftpAdapter::request(const Request& req)
+{
+    return std::async(std::launch::async, [this, req]() -> Response {
+        Response resp;
+
+        // "a|b" 形式的 payload
+        auto splitPair = [&req](std::string& first, std::string& second) {
+            const size_t sep = req.payload.find('|');
+            if (sep == std::string::npos) return false;
+            first = req.payload.substr(0, sep);
+            second = req.payload.substr(sep + 1);
+            return true;
+        };
+
+        if (req.path == "LIST") {
+            std::string listing;
+            resp.success = listDirectory(req.payload, listing);
+            resp.data = listing;
+        } else if (req.path == "DELETE_FILE") {
+            resp.success = deleteFile(req.payload);
+        } else if (req.path == "DELETE_DIR") {
+            resp.success = deleteDirectory(req.payload);
+        } else if (req.path == "MKDIR") {
+            resp.success = makeDirectories({ req.payload });
+        } else if (req.path == "UPLOAD") {
+            std::string localPath, remotePath;
+            if (!splitPair(localPath, remotePath)) {
+                resp.errorMessage = "UPLOAD 需要 localPath|remotePath 格式的 payload";
+                return resp;
+            }
+            resp.success = uploadFile(localPath, remotePath);
+        } else if (req.path == "DOWNLOAD") {
+            std::string remotePath, localPath;
+            if (!splitPair(remotePath, localPath)) {
+                resp.errorMessage = "DOWNLOAD 需要 remotePath|localPath 格式的 payload";
+                return resp;
+            }
+            resp.success = downloadFile(remotePath, localPath);
+        } else {
+            resp.errorMessage = "未知 SFTP 操作: " + req.path;
+            return resp;
+        }
+        if (!resp.success) resp.errorMessage = m_impl->m_lastError;
+        return resp;
+    });
+}
+
+void SftpAdapter::subscribe(const Request& /*req*/, StreamCallback /*onData*/)
+{
+    m_impl->m_lastError = "SFTP 协议不支持流模式";
+}
+
+void SftpAdapter::unsubscribe()
+{
+}
+
+ProtocolCapability SftpAdapter::capability() const
+{
+    ProtocolCapability c;
+    c.requestResponse  = true;
+    c.streaming        = false;
+    c.broadcast        = false;
+    c.publishSubscribe = false;
+    c.maxConnections   = SshSession::kMaxChannels;   // 每个适配器占用会话的一个 channel
+    return c;
+}
+
+// ============================================================
+// SFTP 文件操作
+// ============================================================
+
+bool SftpAdapter::uploadFile(const std::string& localPath, const std::string& remotePath)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    std::error_code ec;
+    const uint64_t total = std::filesystem::file_size(localPath, ec);
+    FILE* file = fopen(localPath.c_str(), "rb");
+    if (!file || ec) {
+        if (file) fclose(file);
+        m_impl->m_lastError = "无法打开本地文件: " + localPath;
+        return false;
+    }
+    const bool ok = m_impl->upload([file](char* buf, size_t len) -> size_t {
+        const size_t n = fread(buf, 1, len, file);
+        return (n < len && ferror(file)) ? SIZE_MAX : n;
+    }, total, remotePath);
+    fclose(file);
+    return ok;
+}
+
+bool SftpAdapter::downloadFile(const std::string& remotePath, const std::string& localPath)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    FILE* file = fopen(localPath.c_str(), "wb");
+    if (!file) {
+        m_impl->m_lastError = "无法创建本地文件: " + localPath;
+        return false;
+    }
+    const bool ok = m_impl->download(remotePath, [file](const char* data, size_t len) {
+        return fwrite(data, 1, len, file) == len;
+    });
+    fclose(file);
+    if (!ok) std::remove(localPath.c_str());   // 不留下不完整的文件
+    return ok;
+}
+
+bool SftpAdapter::readRemoteFile(const std::string& remotePath, std::string& outData)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    outData.clear();
+    return m_impl->download(remotePath, [&outData](const char* data, size_t len) {
+        outData.append(data, len);
+        return true;
+    });
+}
+
+bool SftpAdapter::writeRemoteFile(const std::string& remotePath, const std::string& data)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    size_t offset = 0;
+    return m_impl->upload([&data, &offset](char* buf, size_t len) -> size_t {
+        const size_t n = std::min(len, data.size() - offset);
+        std::memcpy(buf, data.data() + offset, n);
+        offset += n;
+        return n;
+    }, data.size(), remotePath);
+}
+
+bool SftpAdapter::makeDirectories(const std::vector<std::string>& remoteDirs)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    for (const std::string& dir : remoteDirs) {
+        // 逐级向下：先确认父目录，再创建子目录
+        size_t pos = 0;
+        while (pos != std::string::npos) {
+            pos = dir.find('/', pos + 1);
+            const std::string level = dir.substr(0, pos);
+            if (level.empty() || level == "/" || m_impl->m_knownDirs.count(level)) continue;
+
+            LIBSSH2_SFTP_ATTRIBUTES attrs{};
+            ssize_t rc = 0;
+            if (m_impl->stat(level, attrs, rc)) {
+                if ((attrs.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS)
+                    && !LIBSSH2_SFTP_S_ISDIR(attrs.permissions)) {
+                    m_impl->m_lastError = "创建远程目录失败: " + level + " 已存在且不是目录";
+                    return false;
+                }
+            } else {
+                rc = m_impl->call([&](LIBSSH2_SESSION*) -> ssize_t {
+                    return libssh2_sftp_mkdir_ex(m_impl->m_sftp, level.c_str(), pathLen(level),
+                                                 LIBSSH2_SFTP_S_IRWXU | LIBSSH2_SFTP_S_IRGRP
+                                                 | LIBSSH2_SFTP_S_IXGRP | LIBSSH2_SFTP_S_IROTH
+                                                 | LIBSSH2_SFTP_S_IXOTH);
+                });
+                if (rc != 0) {
+                    m_impl->fail("创建远程目录失败 " + level, rc);
+                    return false;
+                }
+            }
+            m_impl->m_knownDirs.insert(level);
+        }
+    }
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool SftpAdapter::listDirectory(const std::string& remotePath, std::string& outJsonList)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    const std::string path = remotePath.empty() ? "." : remotePath;
+    ssize_t rc = 0;
+    LIBSSH2_SFTP_HANDLE* handle = m_impl->open(path, 0, 0, LIBSSH2_SFTP_OPENDIR, rc);
+    if (!handle) {
+        m_impl->fail("列目录失败 " + path, rc);
+        return false;
+    }
+
+    std::vector<std::string> names;
+    char name[512];
+    LIBSSH2_SFTP_ATTRIBUTES attrs{};
+    for (;;) {
+        rc = m_impl->call([&](LIBSSH2_SESSION*) -> ssize_t {
+            return libssh2_sftp_readdir_ex(handle, name, sizeof(name), nullptr, 0, &attrs);
+        });
+        if (rc <= 0) break;
+        const std::string entry(name, static_cast<size_t>(rc));
+        if (entry == "." || entry == "..") continue;
+        names.push_back(entry);
+    }
+    m_impl->close(handle);
+
+    if (rc < 0) {
+        m_impl->fail("列目录失败 " + path, rc);
+        return false;
+    }
+    outJsonList = SftpPipeline::jsonStringArray(names);
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool SftpAdapter::remoteFileSize(const std::string& remotePath, uint64_t& outSize)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    LIBSSH2_SFTP_ATTRIBUTES attrs{};
+    ssize_t rc = 0;
+    if (!m_impl->stat(remotePath, attrs, rc) || !(attrs.flags & LIBSSH2_SFTP_ATTR_SIZE)) {
+        m_impl->fail("查询远程文件大小失败 " + remotePath, rc);
+        return false;
+    }
+    outSize = attrs.filesize;
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool SftpAdapter::deleteFile(const std::string& remotePath)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    const ssize_t rc = m_impl->call([&](LIBSSH2_SESSION*) -> ssize_t {
+        return libssh2_sftp_unlink_ex(m_impl->m_sftp, remotePath.c_str(), pathLen(remotePath));
+    });
+    if (rc != 0) {
+        m_impl->fail("删除文件失败 " + remotePath, rc);
+        return false;
+    }
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+bool SftpAdapter::deleteDirectory(const std::string& remotePath)
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_opMutex);
+    if (!m_impl->ready()) return false;
+
+    // 目录可能被删除，已知目录缓存作废
+    m_impl->m_knownDirs.clear();
+    const ssize_t rc = m_impl->call([&](LIBSSH2_SESSION*) -> ssize_t {
+        return libssh2_sftp_rmdir_ex(m_impl->m_sftp, remotePath.c_str(), pathLen(remotePath));
+    });
+    if (rc != 0) {
+        m_impl->fail("删除目录失败 " + remotePath, rc);
+        return false;
+    }
+    m_impl->m_lastError.clear();
+    return true;
+}
+
+void SftpAdapter::setProgressCallback(std::function<void(int)> cb)
+{
+    m_impl->m_progressCb = std::move(cb);
+}
+
+void SftpAdapter::setBytesCallback(std::function<void(uint64_t)> cb)
+{
+    m_impl->m_bytesCb = std::move(cb);
+}
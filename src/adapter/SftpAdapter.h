@@ -0,0 +1,65 @@
+#pragma once
+#include "IProtocolAdapter.h"
+#include <string>
+#include <vector>
+#include <future>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+// SFTP 协议适配器 — 在 SshSessionPool 的已认证会话上打开 SFTP 子系统，提供与 FtpAdapter 对应的文件操作。
+// 同一设备已有 SSH 会话（批量命令、其他 SFTP 适配器）时直接复用，不再重新握手认证；
+// SFTP 子系统在连接期间占用会话的一个 channel 名额。
+// 读写均为流水线方式：每次交给 libssh2 一大块缓冲，由其同时保持多个未确认的
+// READ/WRITE 请求在途，吞吐不再受 往返时延 × 单包大小 限制。
+// 远程路径为相对登录目录的路径或绝对路径
+class SftpAdapter : public IProtocolAdapter {
+public:
+    SftpAdapter();
+    ~SftpAdapter() override;
+
+    // --- IProtocolAdapter 实现 ---
+    std::string protocolId() const override { return "sftp"; }
+    bool connect(const DeviceInfo& device, const AuthInfo& auth) override;
+    void disconnect() override;
+    bool isConnected() const override;
+    std::string lastError() const override;
+    void setCancelFlag(const std::atomic<bool>* cancelled) override;
+    // LIST / DELETE_FILE / DELETE_DIR / MKDIR 的 payload 为远程路径；
+    // UPLOAD 为 "localPath|remotePath"，DOWNLOAD 为 "remotePath|localPath"
+    std::future<Response> request(const Request& req) override;
+    void subscribe(const Request& req, StreamCallback onData) override;
+    void unsubscribe() override;
+    ProtocolCapability capability() const override;
+
+    // --- SFTP 文件操作（与 FtpAdapter 同名同义） ---
+    bool uploadFile(const std::string& localPath, const std::string& remotePath);
+    bool downloadFile(const std::string& remotePath, const std::string& localPath);
+    // 小文件整体读写（内存 ↔ 远程）
+    bool readRemoteFile(const std::string& remotePath, std::string& outData);
+    bool writeRemoteFile(const std::string& remotePath, const std::string& data);
+    // 批量创建远程目录（含各级父目录），本次连接内已确认存在的目录不再检查
+    bool makeDirectories(const std::vector<std::string>& remoteDirs);
+    // 目录项名称列表，JSON 数组 ["name1","name2",...]（不含 . 与 ..）
+    bool listDirectory(const std::string& remotePath, std::string& outJsonList);
+    bool remoteFileSize(const std::string& remotePath, uint64_t& outSize);
+    bool deleteFile(const std::string& remotePath);
+    bool deleteDirectory(const std::string& remotePath);
+    // 当前文件传输进度（0-100）
+    void setProgressCallback(std::function<void(int)> cb);
+    // 累计已上传字节回调（本适配器生命周期内所有上传之和）
+    void setBytesCallback(std::function<void(uint64_t)> cb);
+
+    // 最近一次 connect 是否复用了池中已认证的会话
+    bool sessionReused() const;
+
+    // 每次交给 libssh2 的读写缓冲：libssh2 按约 30 KB 一包拆分，缓冲越大在途请求越多
+    static constexpr size_t kPipelineBytes = 1024 * 1024;
+    // 单次 SFTP 调用无进展的等待上限
+    static constexpr int kIoTimeoutMs = 30000;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
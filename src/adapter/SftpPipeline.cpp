@@ -0,0 +1,73 @@
+#include "SftpPipeline.h"
+#include <cstdio>
+#include <cstring>
+
+SftpPipeline::WriteResult SftpPipeline::writeStream(std::vector<char>& buf, const ReadFn& read,
+                                                    const WriteFn& write,
+                                                    const std::function<void(uint64_t)>& onAcked,
+                                                    int64_t& writeError)
+{
+    size_t have = 0;
+    bool eof = false;
+    uint64_t acked = 0;
+    for (;;) {
+        if (!eof && have < buf.size()) {
+            const size_t n = read(buf.data() + have, buf.size() - have);
+            if (n == SIZE_MAX) return WriteResult::ReadFailed;
+            if (n == 0) eof = true;
+            have += n;
+        }
+        if (have == 0) return WriteResult::Done;
+
+        const int64_t rc = write(buf.data(), have);
+        if (rc < 0) {
+            writeError = rc;
+            return WriteResult::WriteFailed;
+        }
+        // rc 为已被对端确认的字节；其余已发出的数据必须原样留在缓冲前端再次交给 libssh2
+        const size_t done = static_cast<size_t>(rc) < have ? static_cast<size_t>(rc) : have;
+        std::memmove(buf.data(), buf.data() + done, have - done);
+        have -= done;
+        acked += done;
+        if (done > 0 && onAcked) onAcked(acked);
+    }
+}
+
+std::string SftpPipeline::jsonStringArray(const std::vector<std::string>& names)
+{
+    std::string json = "[";
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i > 0) json += ',';
+        json += '"';
+        json += jsonEscape(names[i]);
+        json += '"';
+    }
+    json += ']';
+    return json;
+}
+
+std::string SftpPipeline::jsonEscape(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char hex[8];
+                std::snprintf(hex, sizeof(hex), "\\u%04x", static_cast<unsigned char>(c));
+                out += hex;
+            } else {
+                out += c;   // UTF-8 多字节原样保留
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// SFTP 流水线传输中与 libssh2 无关的部分：写缓冲压实与目录列表的 JSON 编码。
+// SftpAdapter 通过回调把实际的 libssh2 调用接进来
+class SftpPipeline {
+public:
+    // 从本地读入最多 size 字节，返回读到的字节数；0 为结束，SIZE_MAX 为读取失败
+    using ReadFn = std::function<size_t(char* buf, size_t size)>;
+    // 交给 libssh2_sftp_write：返回已被对端确认的字节数，负值为错误码
+    using WriteFn = std::function<int64_t(const char* data, size_t length)>;
+
+    enum class WriteResult { Done, ReadFailed, WriteFailed };
+
+    // 流水线写：未确认的部分保留在缓冲前端原样再次交出（libssh2 要求同一段数据重复传入），
+    // 空出的位置立即用后续数据补满，libssh2 始终有整块缓冲可拆包发送。
+    // onAcked 在每次有新确认时收到累计确认字节；WriteFailed 时 writeError 为错误码
+    static WriteResult writeStream(std::vector<char>& buf, const ReadFn& read, const WriteFn& write,
+                                   const std::function<void(uint64_t acked)>& onAcked,
+                                   int64_t& writeError);
+
+    // 目录项名称编码为 JSON 字符串数组（控制字符按 \uXXXX 转义）
+    static std::string jsonStringArray(const std::vector<std::string>& names);
+    static std::string jsonEscape(const std::string& s);
+};
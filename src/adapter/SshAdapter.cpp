@@ -1,11 +1,5 @@
 #include "SshAdapter.h"
 #include <lwlog/lwlog.h>
-#include <QHostAddress>
-#include <QCryptographicHash>
-#include <thread>
-
-// TOFU 已接受主机指纹集合 — 进程级静态存储，跨适配器实例共享
-QSet<QString> SshAdapter::s_knownHosts;
 
 // ============================================================
 // 构造 / 析构
@@ -13,13 +7,13 @@ QSet<QString> SshAdapter::s_knownHosts;
 
 SshAdapter::SshAdapter()
 {
-    // libssh2_init(0) 在 main.cpp 进程级调用一次，此处不再重复初始化
+    // libssh2 全局初始化由首次 libssh2_session_init 隐式完成
 }
 
 SshAdapter::~SshAdapter()
 {
     disconnect();
-    // 不调用 libssh2_exit()：会拆除进程级全局状态，影响其他适配器实例
+    // 不调用 libssh2_exit()：会拆除进程级全局状态，影响其他适配器实例与池中会话
 }
 
 // ============================================================
@@ -30,84 +24,65 @@ bool SshAdapter::connect(const DeviceInfo& device, const AuthInfo& auth)
 {
     disconnect();
 
-    // 1. TCP 连接
-    m_socket = new QTcpSocket();
-    m_socket->connectToHost(QString::fromStdString(device.ip),
-                            device.port ? device.port : 22);
-    if (!m_socket->waitForConnected(10000)) {
-        m_lastError = "SSH 连接失败: " + m_socket->errorString().toStdString();
-        delete m_socket;
-        m_socket = nullptr;
+    m_host = device.ip;
+    m_port = device.port ? device.port : 22;
+    m_auth = auth;
+
+    // 从会话池取已认证会话；没有可复用的会话时由池完成 TCP 建连、握手、TOFU 校验与认证
+    std::string error;
+    bool reused = false;
+    auto session = SshSessionPool::instance().acquire(m_host, m_port, m_auth, reused, error);
+    if (!session) {
+        m_lastError = error;
+        m_auth.clear();
         return false;
     }
 
-    // 2. 创建 libssh2 session
-    m_session = libssh2_session_init();
-    if (!m_session) {
-        m_lastError = "libssh2 session 初始化失败";
-        disconnect();
-        return false;
-    }
-
-    // 3. 握手（阻塞模式 — 由调用方放入后台线程）
-    libssh2_session_set_blocking(m_session, 1);
-    // I5: 设置阻塞操作超时，防止握手/读写永久阻塞不可中断（默认 10s）
-    libssh2_session_set_timeout(m_session, 10000);
-    if (libssh2_session_handshake(m_session, static_cast<libssh2_socket_t>(
-            m_socket->socketDescriptor())) != 0) {
-        m_lastError = "SSH 握手失败";
-        disconnect();
-        return false;
-    }
-
-    // 4. 主机密钥校验 (TOFU)
-    if (!verifyHostKey()) {
-        // m_lastError 已由 verifyHostKey 设置
-        disconnect();
-        return false;
-    }
-
-    // 5. 密码认证
-    if (libssh2_userauth_password(m_session, auth.user.c_str(),
-                                   auth.password.c_str()) != 0) {
-        m_lastError = "SSH 认证失败: 用户名或密码错误";
-        disconnect();
-        return false;
-    }
-
-    // C1: 连接成功。disconnect() 曾将 m_cancelled 置 true，此处复位，
-    //     否则 request() 的 while(!m_cancelled) 读循环会立即退出导致 0 字节输出
-    m_cancelled = false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_session = std::move(session);
+    m_reused = reused;
+    m_lastError.clear();
     return true;
 }
 
 void SshAdapter::disconnect()
 {
-    m_cancelled = true;
-
-    if (m_subscribeActive) {
-        unsubscribe();
+    std::shared_ptr<SshSession> session;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        session.swap(m_session);
     }
+    // 归还而非断开：会话在池中保持至空闲超时，下次连接同一设备时跳过密钥交换；
+    // 进行中的 request 持有会话副本，归还后仍可执行完毕
+    if (session) SshSessionPool::instance().release(session);
+    m_auth.clear();
+}
 
-    closeChannel(m_channel);
-
-    if (m_session) {
-        libssh2_session_disconnect(m_session, "bye");
-        libssh2_session_free(m_session);
-        m_session = nullptr;
+bool SshAdapter::reconnect()
+{
+    std::shared_ptr<SshSession> old;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        old.swap(m_session);
     }
-
-    if (m_socket) {
-        m_socket->close();
-        // I8: 在 QtConcurrent::run 线程中无事件循环，deleteLater 事件永不派发→泄漏
-        delete m_socket;
-        m_socket = nullptr;
+    if (old) SshSessionPool::instance().release(old);
+
+    std::string error;
+    bool reused = false;
+    auto session = SshSessionPool::instance().acquire(m_host, m_port, m_auth, reused, error);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!session) {
+        m_lastError = error;
+        return false;
     }
+    m_session = std::move(session);
+    return true;
 }
 
 bool SshAdapter::isConnected() const
 {
-    return m_session != nullptr;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_session && !m_session->broken();
 }
 
 std::string SshAdapter::lastError() const
@@ -115,6 +90,16 @@ std::string SshAdapter::lastError() const
     return m_lastError;
 }
 
+void SshAdapter::setCancelFlag(const std::atomic<bool>* cancelled)
+{
+    m_cancelFlag = cancelled;
+}
+
+void SshAdapter::setResponseSink(ResponseSink sink)
+{
+    m_responseSink = std::move(sink);
+}
+
 // ============================================================
 // IProtocolAdapter — 传输模式
 // ============================================================
@@ -122,66 +107,36 @@ std::string SshAdapter::lastError() const
 std::future<Response> SshAdapter::request(const Request& req)
 {
     return std::async(std::launch::async, [this, req]() -> Response {
-        Response r;
-
-        if (!m_session) {
-            r.success = false;
-            r.errorMessage = "SSH 未连接";
-            return r;
-        }
-
-        // I5: 按请求设置阻塞操作超时，防止 libssh2_channel_read 永久阻塞
-        int timeoutMs = req.timeoutMs > 0 ? req.timeoutMs : 10000;
-        libssh2_session_set_timeout(m_session, timeoutMs);
-
-        LIBSSH2_CHANNEL* ch = libssh2_channel_open_session(m_session);
-        if (!ch) {
-            r.success = false;
-            r.errorMessage = "打开 SSH channel 失败";
-            return r;
+        std::shared_ptr<SshSession> session;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            session = m_session;
         }
-
-        // I4: 合并 stderr 到普通读流，使 libssh2_channel_read 同时返回 stdout+stderr
-        libssh2_channel_handle_extended_data2(ch,
-            LIBSSH2_CHANNEL_EXTENDED_DATA_MERGE);
-
-        int rc = libssh2_channel_exec(ch, req.path.c_str());
-        if (rc != 0) {
-            char* errMsg = nullptr;
-            int errLen = 0;
-            libssh2_session_last_error(m_session, &errMsg, &errLen, 0);
-            r.success = false;
-            r.errorMessage = std::string("命令执行失败: ")
-                           + std::string(errMsg ? errMsg : "", errLen);
-            libssh2_channel_free(ch);
+        if (!session) {
+            Response r;
+            r.errorMessage = "SSH 未连接";
             return r;
         }
 
-        char buf[4096];
-        std::string output;
-        r.success = true;  // I3: 默认成功，读错误分支置为 false，循环结束不再无条件覆盖
-        while (!m_cancelled) {
-            ssize_t n = libssh2_channel_read(ch, buf, sizeof(buf));
-            if (n > 0) {
-                output.append(buf, static_cast<size_t>(n));
-            } else if (n == 0) {
-                // 阻塞模式：0 表示读到 EOF/无更多数据
-                break;
-            } else {
-                // n < 0: 错误
-                r.success = false;
-                r.errorMessage = "读取 SSH 命令输出失败";
-                break;
+        // I5: 超时语义不变 — 连续 timeoutMs 无输出才判失败
+        const int timeoutMs = req.timeoutMs > 0 ? req.timeoutMs : 10000;
+        bool started = false;
+        Response r = session->exec(req.path, timeoutMs, m_cancelFlag, m_responseSink, &started);
+
+        // 池中复用的会话可能在空闲期间已被对端关闭：命令请求尚未发出时换新会话重试一次。
+        // 不能按输出是否为空判断 — 设置 sink 时输出已分段交出，且无输出的命令同样可能已执行
+        if (!r.success && !started && session->broken() && m_reused
+            && !(m_cancelFlag && m_cancelFlag->load())) {
+            LWLOG_W("SSH pooled session to " + m_host + " went stale, reconnecting");
+            m_reused = false;
+            if (reconnect()) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                session = m_session;
+            }
+            if (session && !session->broken()) {
+                r = session->exec(req.path, timeoutMs, m_cancelFlag, m_responseSink);
             }
         }
-
-        libssh2_channel_send_eof(ch);
-        // I3: 不再无条件 r.success = true；成功/失败由读循环决定
-        r.statusCode = libssh2_channel_get_exit_status(ch);
-        libssh2_channel_wait_closed(ch);
-        libssh2_channel_free(ch);
-
-        r.data = output;
         return r;
     });
 }
@@ -193,8 +148,6 @@ void SshAdapter::subscribe(const Request& /*req*/, StreamCallback /*onData*/)
 
 void SshAdapter::unsubscribe()
 {
-    m_subscribeActive = false;
-    closeChannel(m_channel);
 }
 
 ProtocolCapability SshAdapter::capability() const
@@ -204,68 +157,6 @@ ProtocolCapability SshAdapter::capability() const
     c.streaming        = false;
     c.broadcast        = false;
     c.publishSubscribe = false;
-    c.maxConnections   = 1;
+    c.maxConnections   = SshSession::kMaxChannels;   // 同一会话上可并发的 channel 数
     return c;
 }
-
-// ============================================================
-// 主机密钥校验 — TOFU (Trust On First Use)
-// ============================================================
-
-std::string SshAdapter::collectHostFingerprint()
-{
-    size_t len = 0;
-    int type = 0;
-    const char* key = libssh2_session_hostkey(m_session, &len, &type);
-    if (!key || len == 0) {
-        return "";
-    }
-
-    // SHA256 hash of raw host key → hex string
-    QByteArray rawKey(key, static_cast<int>(len));
-    QByteArray hex = QCryptographicHash::hash(rawKey,
-                                              QCryptographicHash::Sha256).toHex();
-    return hex.toStdString();
-}
-
-bool SshAdapter::verifyHostKey()
-{
-    std::string fp = collectHostFingerprint();
-    if (fp.empty()) {
-        m_lastError = "无法获取 SSH 主机密钥";
-        return false;
-    }
-
-    QString qfp = QString::fromStdString(fp);
-
-    // I7: 指纹已在进程级 TOFU 集合中 → 与历史一致，通过
-    if (s_knownHosts.contains(qfp)) {
-        return true;
-    }
-
-    // I7: 集合非空但当前指纹不在其中 → 与首次连接不符，拒绝（防中间人攻击）
-    if (!s_knownHosts.isEmpty()) {
-        m_lastError = "SSH 主机密钥与首次连接时不符，可能存在中间人攻击";
-        LWLOG_W("SSH TOFU: host key mismatch, rejecting connection");
-        return false;
-    }
-
-    // I7: 集合为空（进程内首次 SSH 连接）→ 记录并接受
-    s_knownHosts.insert(qfp);
-    LWLOG_I("SSH TOFU: accepted host key " + fp);
-    return true;
-}
-
-// ============================================================
-// 辅助方法
-// ============================================================
-
-void SshAdapter::closeChannel(LIBSSH2_CHANNEL*& ch)
-{
-    if (ch) {
-        libssh2_channel_send_eof(ch);
-        libssh2_channel_wait_closed(ch);
-        libssh2_channel_free(ch);
-        ch = nullptr;
-    }
-}
@@ -1,14 +1,14 @@
 #pragma once
 #include "IProtocolAdapter.h"
-#include <QTcpSocket>
-#include <libssh2/libssh2.h>
-#include <QSet>
-#include <QFuture>
+#include "SshSessionPool.h"
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 // SSH 协议适配器 — 基于 libssh2 实现 IProtocolAdapter
 // 支持密码认证 + TOFU (Trust On First Use) 主机密钥校验
-// 阻塞模式，由调用方放入 QtConcurrent::run 线程中执行
+// 会话取自 SshSessionPool：同一设备的已认证会话跨适配器/批次复用，disconnect 只归还不断开；
+// 每个 request 在会话上新开一个 channel，多个 request 可并发（共用一条传输）
 class SshAdapter : public IProtocolAdapter {
 public:
     SshAdapter();
@@ -20,22 +20,27 @@ public:
     void disconnect() override;
     bool isConnected() const override;
     std::string lastError() const override;
+    void setCancelFlag(const std::atomic<bool>* cancelled) override;
+    void setResponseSink(ResponseSink sink) override;
     std::future<Response> request(const Request& req) override;
     void subscribe(const Request& req, StreamCallback onData) override;
     void unsubscribe() override;
     ProtocolCapability capability() const override;
 
+    // 最近一次 connect 是否复用了池中已认证的会话（跳过了密钥交换与认证）
+    bool sessionReused() const { return m_reused; }
+
 private:
-    QTcpSocket*         m_socket = nullptr;
-    LIBSSH2_SESSION*    m_session = nullptr;
-    LIBSSH2_CHANNEL*    m_channel = nullptr;  // subscribe 模式用，request 模式每次新建
-    std::string         m_lastError;
-    std::atomic<bool>   m_cancelled{false};
-    static QSet<QString> s_knownHosts;        // TOFU: 已接受的主机指纹集合（进程级共享）
-    QFuture<void>       m_subscribeFuture;
-    std::atomic<bool>   m_subscribeActive{false};
+    // 复用的会话在空闲期间被对端断开时，换一条新会话重试一次
+    bool reconnect();
 
-    std::string collectHostFingerprint();     // 获取当前连接主机指纹（SHA256 Hex）
-    bool verifyHostKey();                     // TOFU 校验（首次接受，变化告警）
-    void closeChannel(LIBSSH2_CHANNEL*& ch);  // 安全关闭 channel
+    mutable std::mutex  m_mutex;                      // 保护 m_session（request 在后台线程取用）
+    std::shared_ptr<SshSession> m_session;
+    std::string         m_host;
+    int                 m_port = 22;
+    AuthInfo            m_auth;                       // 重连用，disconnect 时擦除
+    std::atomic<bool>   m_reused{false};
+    std::string         m_lastError;
+    const std::atomic<bool>* m_cancelFlag = nullptr;  // 外部取消标志（request 执行期间检查）
+    ResponseSink        m_responseSink;               // 响应分块交付（connect 前设置）
 };
@@ -0,0 +1,11 @@
+#include "SshHostKeyStore.h"
+
+SshHostKeyStore::Result SshHostKeyStore::verify(const std::string& host, int port,
+                                                const std::string& fingerprint)
+{
+    const std::string key = host + ":" + std::to_string(port);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto inserted = m_known.emplace(key, fingerprint);
+    if (inserted.second) return Result::Accepted;
+    return inserted.first->second == fingerprint ? Result::Known : Result::Mismatch;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// SSH 主机密钥 TOFU 记录：按 host:port 记住首次连接时的密钥指纹，之后该主机密钥
+// 变化即拒绝（防中间人攻击）；不同主机各自首次接受，互不影响。线程安全，
+// 同一主机的并发首次连接只有一个指纹会被记录
+class SshHostKeyStore {
+public:
+    enum class Result {
+        Accepted,   // 首次连接该主机，已记录
+        Known,      // 与记录一致
+        Mismatch    // 与首次连接时不符
+    };
+
+    Result verify(const std::string& host, int port, const std::string& fingerprint);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::string> m_known;   // host:port → 指纹
+};
@@ -0,0 +1,624 @@
+#include "SshSessionPool.h"
+#include "SshHostKeyStore.h"
+#include <lwlog/lwlog.h>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+constexpr int kPollMs = 100;          // 等待 channel 名额时检查取消的间隔
+constexpr int kMuxPollMs = 10;        // 多 channel 共用传输时的等待上限：本 channel 的数据可能已被其他线程读入缓冲
+constexpr int kAbortCloseMs = 1000;   // 中止/超时后关闭 channel 的等待上限
+
+void closeSocket(libssh2_socket_t sock)
+{
+    if (sock == LIBSSH2_INVALID_SOCKET) return;
+#ifdef _WIN32
+    ::closesocket(sock);
+#else
+    ::close(sock);
+#endif
+}
+
+void setNonBlocking(libssh2_socket_t sock, bool on)
+{
+#ifdef _WIN32
+    u_long mode = on ? 1 : 0;
+    ::ioctlsocket(sock, FIONBIO, &mode);
+#else
+    const int flags = ::fcntl(sock, F_GETFL);
+    ::fcntl(sock, F_SETFL, on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+#endif
+}
+
+// TCP 建连（带超时），成功后恢复为阻塞 socket 交给 libssh2
+libssh2_socket_t connectSocket(const std::string& host, int port, int timeoutMs, std::string& error)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    const std::string service = std::to_string(port);
+    if (::getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0 || !result) {
+        error = "SSH 连接失败: 无法解析主机 " + host;
+        return LIBSSH2_INVALID_SOCKET;
+    }
+
+    libssh2_socket_t sock = LIBSSH2_INVALID_SOCKET;
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        sock = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock == LIBSSH2_INVALID_SOCKET) continue;
+
+        setNonBlocking(sock, true);
+        bool connected = ::connect(sock, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0;
+        if (!connected) {
+            fd_set writeFds;
+            fd_set errorFds;
+            FD_ZERO(&writeFds);
+            FD_ZERO(&errorFds);
+            FD_SET(sock, &writeFds);
+            FD_SET(sock, &errorFds);
+            timeval tv;
+            tv.tv_sec = timeoutMs / 1000;
+            tv.tv_usec = (timeoutMs % 1000) * 1000;
+            if (select(static_cast<int>(sock) + 1, nullptr, &writeFds, &errorFds, &tv) > 0
+                && FD_ISSET(sock, &writeFds)) {
+                int soError = 0;
+                socklen_t len = sizeof(soError);
+                ::getsockopt(sock, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&soError), &len);
+                connected = soError == 0;
+            }
+        }
+        if (connected) {
+            setNonBlocking(sock, false);
+            break;
+        }
+        closeSocket(sock);
+        sock = LIBSSH2_INVALID_SOCKET;
+    }
+    ::freeaddrinfo(result);
+
+    if (sock == LIBSSH2_INVALID_SOCKET) {
+        error = "SSH 连接失败: " + host + ":" + std::to_string(port) + " 连接超时或被拒绝";
+    }
+    return sock;
+}
+
+} // namespace
+
+// ============================================================
+// SshSession — 非阻塞多 channel 执行
+// ============================================================
+
+SshSession::~SshSession()
+{
+    if (m_session) {
+        // 会话可能正处于非阻塞模式，断开前切回阻塞并限时，避免析构卡住
+        libssh2_session_set_blocking(m_session, 1);
+        libssh2_session_set_timeout(m_session, kAbortCloseMs);
+        libssh2_session_disconnect(m_session, "bye");
+        libssh2_session_free(m_session);
+    }
+    closeSocket(m_sock);
+}
+
+bool SshSession::isTransportError(int rc)
+{
+    switch (rc) {
+    case LIBSSH2_ERROR_SOCKET_NONE:
+    case LIBSSH2_ERROR_SOCKET_SEND:
+    case LIBSSH2_ERROR_SOCKET_RECV:
+    case LIBSSH2_ERROR_SOCKET_DISCONNECT:
+    case LIBSSH2_ERROR_SOCKET_TIMEOUT:
+    case LIBSSH2_ERROR_TIMEOUT:
+    case LIBSSH2_ERROR_KEX_FAILURE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::string SshSession::lastErrorLocked() const
+{
+    char* msg = nullptr;
+    int len = 0;
+    libssh2_session_last_error(m_session, &msg, &len, 0);
+    return std::string(msg ? msg : "", static_cast<size_t>(len));
+}
+
+void SshSession::waitSocket(int timeoutMs)
+{
+    int dir = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_io);
+        dir = libssh2_session_block_directions(m_session);
+    }
+
+    fd_set readFds;
+    fd_set writeFds;
+    FD_ZERO(&readFds);
+    FD_ZERO(&writeFds);
+    // 方向未知（其他线程刚处理完数据）时按可读等待
+    if ((dir & LIBSSH2_SESSION_BLOCK_INBOUND) || dir == 0) FD_SET(m_sock, &readFds);
+    if (dir & LIBSSH2_SESSION_BLOCK_OUTBOUND) FD_SET(m_sock, &writeFds);
+
+    timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    select(static_cast<int>(m_sock) + 1, &readFds, &writeFds, nullptr, &tv);
+}
+
+void SshSession::closeChannel(LIBSSH2_CHANNEL* ch, int& exitStatus, int timeoutMs)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    // 逐步：send_eof → close → wait_closed → free，每步遇 EAGAIN 等 socket 后重试
+    enum Step { SendEof, Close, WaitClosed, Free, Done } step = SendEof;
+    while (step != Done) {
+        int rc = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_io);
+            switch (step) {
+            case SendEof:    rc = libssh2_channel_send_eof(ch); break;
+            case Close:      rc = libssh2_channel_close(ch); break;
+            case WaitClosed: rc = libssh2_channel_wait_closed(ch);
+                             if (rc != LIBSSH2_ERROR_EAGAIN) exitStatus = libssh2_channel_get_exit_status(ch);
+                             break;
+            case Free:       rc = libssh2_channel_free(ch); break;
+            case Done:       break;
+            }
+        }
+        if (rc == LIBSSH2_ERROR_EAGAIN) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                // 对端迟迟不关闭：channel 留给 session_free 回收，会话不再复用
+                m_broken = true;
+                return;
+            }
+            waitSocket(kMuxPollMs);
+            continue;
+        }
+        if (rc != 0 && isTransportError(rc)) m_broken = true;
+        if (step == Free && rc != 0) {
+            m_broken = true;
+            return;
+        }
+        step = static_cast<Step>(step + 1);
+    }
+}
+
+bool SshSession::acquireChannel(const std::atomic<bool>* cancelled)
+{
+    auto isCancelled = [cancelled]() { return cancelled && cancelled->load(); };
+    std::unique_lock<std::mutex> lock(m_slotMutex);
+    // 定时醒来检查外部取消（取消方不会通知本条件变量）
+    while (!m_slotCv.wait_for(lock, std::chrono::milliseconds(kPollMs), [this, &isCancelled]() {
+        return m_openChannels < kMaxChannels || m_broken || isCancelled();
+    })) {}
+    if (m_broken || isCancelled()) return false;
+    ++m_openChannels;
+    return true;
+}
+
+void SshSession::releaseChannel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_slotMutex);
+        --m_openChannels;
+    }
+    m_slotCv.notify_one();
+}
+
+ssize_t SshSession::call(const std::function<ssize_t(LIBSSH2_SESSION*)>& op, int timeoutMs,
+                         const std::atomic<bool>* cancelled)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        ssize_t rc = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_io);
+            rc = op(m_session);
+        }
+        if (rc != LIBSSH2_ERROR_EAGAIN) {
+            if (rc < 0 && isTransportError(static_cast<int>(rc))) m_broken = true;
+            return rc;
+        }
+        if (cancelled && cancelled->load()) return kErrorCancelled;
+        if (m_broken) return LIBSSH2_ERROR_SOCKET_DISCONNECT;
+        if (std::chrono::steady_clock::now() >= deadline) return LIBSSH2_ERROR_TIMEOUT;
+        waitSocket(kMuxPollMs);
+    }
+}
+
+std::string SshSession::lastError()
+{
+    std::lock_guard<std::mutex> lock(m_io);
+    return lastErrorLocked();
+}
+
+Response SshSession::exec(const std::string& command, int timeoutMs, const std::atomic<bool>* cancelled,
+                          const ResponseSink& sink, bool* started)
+{
+    Response r;
+    if (started) *started = false;
+    auto isCancelled = [cancelled]() { return cancelled && cancelled->load(); };
+
+    // 占用一个 channel 名额
+    if (!acquireChannel(cancelled)) {
+        r.errorMessage = m_broken ? "SSH 会话已断开" : "SSH 请求已取消";
+        return r;
+    }
+    struct SlotGuard {
+        SshSession* s;
+        ~SlotGuard() { s->releaseChannel(); }
+    } slotGuard{ this };
+
+    const auto timeout = std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 10000);
+    auto idleSince = std::chrono::steady_clock::now();
+    auto timedOut = [&]() { return std::chrono::steady_clock::now() - idleSince >= timeout; };
+
+    // 1. 打开 channel 并执行命令
+    LIBSSH2_CHANNEL* ch = nullptr;
+    for (;;) {
+        int rc = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_io);
+            ch = libssh2_channel_open_session(m_session);
+            if (!ch) {
+                rc = libssh2_session_last_errno(m_session);
+                if (rc != LIBSSH2_ERROR_EAGAIN) {
+                    r.errorMessage = "打开 SSH channel 失败: " + lastErrorLocked();
+                }
+            }
+        }
+        if (ch) break;
+        if (rc != LIBSSH2_ERROR_EAGAIN) {
+            if (isTransportError(rc)) m_broken = true;
+            return r;
+        }
+        if (isCancelled()) { r.errorMessage = "SSH 请求已取消"; return r; }
+        if (timedOut()) { r.errorMessage = "打开 SSH channel 超时"; return r; }
+        waitSocket(kMuxPollMs);
+    }
+
+    int exitStatus = 0;
+    {
+        // I4: 合并 stderr 到普通读流，使 libssh2_channel_read 同时返回 stdout+stderr
+        std::lock_guard<std::mutex> lock(m_io);
+        libssh2_channel_handle_extended_data2(ch, LIBSSH2_CHANNEL_EXTENDED_DATA_MERGE);
+    }
+    // 自此命令请求可能已发出（即便随后报错，远端也可能已开始执行）
+    if (started) *started = true;
+    for (;;) {
+        int rc = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_io);
+            rc = libssh2_channel_exec(ch, command.c_str());
+            if (rc != 0 && rc != LIBSSH2_ERROR_EAGAIN) {
+                r.errorMessage = "命令执行失败: " + lastErrorLocked();
+            }
+        }
+        if (rc == 0) break;
+        if (rc != LIBSSH2_ERROR_EAGAIN || isCancelled() || timedOut()) {
+            if (isTransportError(rc)) m_broken = true;
+            if (rc == LIBSSH2_ERROR_EAGAIN) {
+                r.errorMessage = isCancelled() ? "SSH 请求已取消" : "SSH 命令启动超时";
+            }
+            closeChannel(ch, exitStatus, kAbortCloseMs);
+            return r;
+        }
+        waitSocket(kMuxPollMs);
+    }
+
+    // 2. 读输出：连续 timeoutMs 无输出判超时（语义同阻塞实现）
+    char buf[16 * 1024];
+    std::string output;
+    r.success = true;
+    idleSince = std::chrono::steady_clock::now();
+    for (;;) {
+        if (isCancelled()) {
+            r.success = false;
+            r.errorMessage = "SSH 请求已取消";
+            break;
+        }
+        ssize_t n = 0;
+        bool eof = false;
+        {
+            std::lock_guard<std::mutex> lock(m_io);
+            n = libssh2_channel_read(ch, buf, sizeof(buf));
+            if (n == LIBSSH2_ERROR_EAGAIN) eof = libssh2_channel_eof(ch) != 0;
+        }
+        if (n > 0) {
+            output.append(buf, static_cast<size_t>(n));
+            idleSince = std::chrono::steady_clock::now();
+            if (sink && output.size() >= kSinkFlushBytes) {
+                sink(output.data(), output.size());
+                output.clear();
+            }
+        } else if (n == 0 || eof) {
+            break;   // EOF
+        } else if (n == LIBSSH2_ERROR_EAGAIN) {
+            if (timedOut()) {
+                r.success = false;
+                r.errorMessage = "读取 SSH 命令输出超时";
+                break;
+            }
+            waitSocket(kMuxPollMs);
+        } else {
+            if (isTransportError(static_cast<int>(n))) m_broken = true;
+            r.success = false;
+            r.errorMessage = "读取 SSH 命令输出失败";
+            break;
+        }
+    }
+
+    // 3. 关闭 channel；成功路径按命令超时等待，中止/超时路径远端命令可能仍在运行，只短暂等待
+    closeChannel(ch, exitStatus, r.success ? static_cast<int>(timeout.count()) : kAbortCloseMs);
+    r.statusCode = exitStatus;
+    r.data = std::move(output);
+    return r;
+}
+
+// ============================================================
+// SshSessionPool — Pimpl 实现体：会话表 + 空闲回收线程
+// ============================================================
+
+struct SshSessionPool::Impl {
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<SshSession>>> m_sessions;
+    int m_idleTimeoutSec = kDefaultIdleTimeoutSec;
+    std::thread m_reaper;
+    bool m_stop = false;
+
+    // TOFU 已接受的主机指纹（按 host:port）— 进程级共享（I7）
+    SshHostKeyStore m_knownHosts;
+
+    static std::string makeKey(const std::string& host, int port, const AuthInfo& auth) {
+        // 不同口令不共享会话；键里只放口令摘要
+        const QByteArray digest = QCryptographicHash::hash(
+            QByteArray::fromStdString(auth.password), QCryptographicHash::Sha256).toHex();
+        return host + ":" + std::to_string(port) + ":" + auth.user + ":" + digest.toStdString();
+    }
+
+    // 关闭空闲超时（或 force 时全部空闲）的会话；调用方持有 m_mutex，
+    // 取出的会话在锁外析构（断开需要网络往返）
+    void collectIdleLocked(bool force, std::vector<std::shared_ptr<SshSession>>& out) {
+        const auto now = std::chrono::steady_clock::now();
+        const auto idle = std::chrono::seconds(m_idleTimeoutSec);
+        for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+            auto& list = it->second;
+            for (auto s = list.begin(); s != list.end();) {
+                const bool expired = (*s)->m_leases == 0
+                    && (force || (*s)->broken() || now - (*s)->m_lastUsed >= idle);
+                if (expired) {
+                    out.push_back(std::move(*s));
+                    s = list.erase(s);
+                } else {
+                    ++s;
+                }
+            }
+            it = list.empty() ? m_sessions.erase(it) : std::next(it);
+        }
+    }
+
+    void reapLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            const auto period = std::chrono::seconds(std::max(1, std::min(m_idleTimeoutSec, 30)));
+            m_cv.wait_for(lock, period);
+            std::vector<std::shared_ptr<SshSession>> expired;
+            collectIdleLocked(m_stop, expired);
+            lock.unlock();
+            expired.clear();
+            lock.lock();
+        }
+    }
+
+    bool verifyHostKey(LIBSSH2_SESSION* session, const std::string& host, int port,
+                       std::string& error) {
+        size_t len = 0;
+        int type = 0;
+        const char* key = libssh2_session_hostkey(session, &len, &type);
+        if (!key || len == 0) {
+            error = "无法获取 SSH 主机密钥";
+            return false;
+        }
+        const std::string fp = QCryptographicHash::hash(
+            QByteArray(key, static_cast<int>(len)), QCryptographicHash::Sha256).toHex().toStdString();
+        const std::string target = host + ":" + std::to_string(port);
+
+        switch (m_knownHosts.verify(host, port, fp)) {
+        case SshHostKeyStore::Result::Known:
+            return true;
+        case SshHostKeyStore::Result::Mismatch:
+            // I7: 该主机已记录的指纹与当前不同 → 拒绝
+            error = "SSH 主机密钥与首次连接时不符，可能存在中间人攻击";
+            LWLOG_W("SSH TOFU: host key mismatch for " + target + ", rejecting connection");
+            return false;
+        case SshHostKeyStore::Result::Accepted:
+            // I7: 进程内首次连接该主机 → 记录并接受
+            LWLOG_I("SSH TOFU: accepted host key for " + target + ": " + fp);
+            return true;
+        }
+        return false;
+    }
+
+    // 新建会话：TCP → 握手 → TOFU → 密码认证（阻塞 + 超时），完成后切换为非阻塞
+    std::shared_ptr<SshSession> open(const std::string& host, int port, const AuthInfo& auth,
+                                     std::string& error) {
+        std::shared_ptr<SshSession> s(new SshSession());
+        s->m_sock = connectSocket(host, port, kConnectTimeoutMs, error);
+        if (s->m_sock == LIBSSH2_INVALID_SOCKET) return nullptr;
+
+        s->m_session = libssh2_session_init();
+        if (!s->m_session) {
+            error = "libssh2 session 初始化失败";
+            return nullptr;
+        }
+        libssh2_session_set_blocking(s->m_session, 1);
+        // I5: 设置阻塞操作超时，防止握手/认证永久阻塞不可中断
+        libssh2_session_set_timeout(s->m_session, kConnectTimeoutMs);
+        if (libssh2_session_handshake(s->m_session, s->m_sock) != 0) {
+            error = "SSH 握手失败";
+            return nullptr;
+        }
+        if (!verifyHostKey(s->m_session, host, port, error)) return nullptr;
+        if (libssh2_userauth_password(s->m_session, auth.user.c_str(), auth.password.c_str()) != 0) {
+            error = "SSH 认证失败: 用户名或密码错误";
+            return nullptr;
+        }
+
+        // 保活：空闲保持期间由复用前的 keepalive 探测连接是否仍然可用
+        libssh2_keepalive_config(s->m_session, 1, 30);
+        libssh2_session_set_blocking(s->m_session, 0);
+        return s;
+    }
+
+    // 复用前的轻量探测：到期的 keepalive 发送失败即视为断开
+    static bool alive(SshSession& s) {
+        if (s.broken()) return false;
+        std::lock_guard<std::mutex> lock(s.m_io);
+        int nextSec = 0;
+        const int rc = libssh2_keepalive_send(s.m_session, &nextSec);
+        if (rc != 0 && rc != LIBSSH2_ERROR_EAGAIN) {
+            s.m_broken = true;
+            return false;
+        }
+        return true;
+    }
+};
+
+SshSessionPool& SshSessionPool::instance()
+{
+    static SshSessionPool s;
+    return s;
+}
+
+SshSessionPool::SshSessionPool() : m_impl(std::make_unique<Impl>())
+{
+#ifdef _WIN32
+    // 自建 socket 不经过 QTcpSocket，需自行初始化 Winsock（内部计数）
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+    m_impl->m_reaper = std::thread([this]() { m_impl->reapLoop(); });
+}
+
+SshSessionPool::~SshSessionPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        m_impl->m_stop = true;
+    }
+    m_impl->m_cv.notify_all();
+    if (m_impl->m_reaper.joinable()) m_impl->m_reaper.join();
+    m_impl->m_sessions.clear();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+std::shared_ptr<SshSession> SshSessionPool::acquire(const std::string& host, int port,
+                                                    const AuthInfo& auth, bool& reused,
+                                                    std::string& error)
+{
+    reused = false;
+    const std::string key = Impl::makeKey(host, port, auth);
+
+    std::vector<std::shared_ptr<SshSession>> dead;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        auto it = m_impl->m_sessions.find(key);
+        if (it != m_impl->m_sessions.end()) {
+            auto& list = it->second;
+            // 优先持有者最少的会话，让负载摊到各条传输上
+            std::sort(list.begin(), list.end(), [](const auto& a, const auto& b) {
+                return a->m_leases < b->m_leases;
+            });
+            for (auto s = list.begin(); s != list.end();) {
+                if ((*s)->m_leases == 0 && !Impl::alive(**s)) {
+                    dead.push_back(std::move(*s));
+                    s = list.erase(s);
+                    continue;
+                }
+                if (!(*s)->broken() && (*s)->m_leases < kMaxLeasesPerSession) {
+                    ++(*s)->m_leases;
+                    reused = true;
+                    return *s;
+                }
+                ++s;
+            }
+        }
+    }
+    dead.clear();   // 锁外关闭失效会话
+
+    // 新建（握手/认证耗时，不持池锁）
+    std::shared_ptr<SshSession> session = m_impl->open(host, port, auth, error);
+    if (!session) return nullptr;
+    session->m_key = key;
+    session->m_leases = 1;
+
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    m_impl->m_sessions[key].push_back(session);
+    return session;
+}
+
+void SshSessionPool::release(const std::shared_ptr<SshSession>& session)
+{
+    if (!session) return;
+    std::vector<std::shared_ptr<SshSession>> expired;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        session->m_leases = std::max(0, session->m_leases - 1);
+        session->m_lastUsed = std::chrono::steady_clock::now();
+        if (session->broken() || m_impl->m_idleTimeoutSec == 0) {
+            m_impl->collectIdleLocked(m_impl->m_idleTimeoutSec == 0, expired);
+        }
+    }
+    // expired 在锁外析构（断开需要网络往返）
+}
+
+void SshSessionPool::setIdleTimeout(int sec)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        m_impl->m_idleTimeoutSec = std::max(0, sec);
+    }
+    m_impl->m_cv.notify_all();
+}
+
+int SshSessionPool::idleTimeout() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    return m_impl->m_idleTimeoutSec;
+}
+
+void SshSessionPool::clearIdle()
+{
+    std::vector<std::shared_ptr<SshSession>> expired;
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    m_impl->collectIdleLocked(true, expired);
+}
+
+size_t SshSessionPool::sessionCount() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    size_t n = 0;
+    for (const auto& kv : m_impl->m_sessions) n += kv.second.size();
+    return n;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "IProtocolAdapter.h"
+#include <libssh2/libssh2.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 已认证的 SSH 会话 — 一条 TCP 传输 + 一个 libssh2 session，可被多个适配器同时持有。
+// 认证完成后 session 切换为非阻塞模式：每次 exec 各开一个 channel，
+// libssh2 调用在会话锁内逐个进行，等待 socket 时释放锁，多条命令因此在同一传输上交错执行。
+class SshSession {
+public:
+    ~SshSession();
+
+    // 在新 channel 上执行命令，返回合并后的 stdout+stderr；
+    // timeoutMs 为连续无输出的最长等待。线程安全，同时进行的 channel 数受 kMaxChannels 限制。
+    // sink 非空时输出每积累 kSinkFlushBytes 交出一次，Response::data 只含最后一段。
+    // started 非空时置为命令请求是否已发往远端（为 false 时命令确定未执行，可安全重试）
+    Response exec(const std::string& command, int timeoutMs, const std::atomic<bool>* cancelled,
+                  const ResponseSink& sink = nullptr, bool* started = nullptr);
+
+    // 传输已断开 / 协议出错，不能再用
+    bool broken() const { return m_broken; }
+
+    // 占用 / 归还一个 channel 名额（exec 每次自动占用；SFTP 子系统在其整个生命周期内占用一个）。
+    // 会话作废或被取消时 acquireChannel 返回 false
+    bool acquireChannel(const std::atomic<bool>* cancelled);
+    void releaseChannel();
+
+    // 在会话锁内执行一次非阻塞 libssh2 调用：op 返回 LIBSSH2_ERROR_EAGAIN 时释放锁等待 socket 后重试，
+    // 连续 timeoutMs 仍未完成返回 LIBSSH2_ERROR_TIMEOUT，外部取消返回 kErrorCancelled；
+    // 其余返回值原样返回。传输层错误同时把会话标记为作废。供 SFTP 等同一会话上的子协议使用
+    ssize_t call(const std::function<ssize_t(LIBSSH2_SESSION*)>& op, int timeoutMs,
+                 const std::atomic<bool>* cancelled);
+    // 最近一次 libssh2 错误描述
+    std::string lastError();
+
+    // 同一会话上同时打开的 channel 上限（OpenSSH MaxSessions 默认 10，留出余量）
+    static constexpr int kMaxChannels = 8;
+    static constexpr size_t kSinkFlushBytes = 64 * 1024;
+    static constexpr ssize_t kErrorCancelled = -10000;
+
+private:
+    friend class SshSessionPool;
+    SshSession() = default;
+
+    // 等待 socket 按 libssh2 需要的方向就绪（至多 timeoutMs）
+    void waitSocket(int timeoutMs);
+    // 关闭并释放 channel；中止路径下限时等待，超时则整条会话作废（由 session_free 回收）
+    void closeChannel(LIBSSH2_CHANNEL* ch, int& exitStatus, int timeoutMs);
+    // libssh2 错误码是否表示传输层已不可用
+    static bool isTransportError(int rc);
+    std::string lastErrorLocked() const;
+
+    libssh2_socket_t m_sock = LIBSSH2_INVALID_SOCKET;
+    LIBSSH2_SESSION* m_session = nullptr;
+    std::string m_key;
+
+    std::mutex m_io;                       // 串行化同一 session 上的 libssh2 调用
+    std::mutex m_slotMutex;
+    std::condition_variable m_slotCv;
+    int m_openChannels = 0;
+    std::atomic<bool> m_broken{false};
+
+    // 以下由 SshSessionPool 在池锁内维护
+    int m_leases = 0;
+    std::chrono::steady_clock::time_point m_lastUsed;
+};
+
+// SSH 会话池（进程级单例）— 按 主机:端口:用户:凭据 缓存已认证会话。
+// 同一设备的后续连接直接复用，跳过 TCP 建连、密钥交换与认证；无人持有的会话空闲超时后关闭。
+class SshSessionPool {
+public:
+    static SshSessionPool& instance();
+
+    // 取已认证会话：有可用的同凭据会话则复用（reused = true），否则新建并完成握手、
+    // TOFU 主机密钥校验与密码认证。失败返回空，原因写入 error
+    std::shared_ptr<SshSession> acquire(const std::string& host, int port, const AuthInfo& auth,
+                                        bool& reused, std::string& error);
+
+    // 归还：已作废的会话立即关闭，其余保留至空闲超时
+    void release(const std::shared_ptr<SshSession>& session);
+
+    // 空闲超时（秒，0 = 归还即关闭，不保持）
+    void setIdleTimeout(int sec);
+    int idleTimeout() const;
+
+    // 关闭所有无人持有的会话
+    void clearIdle();
+    size_t sessionCount() const;
+
+    static constexpr int kDefaultIdleTimeoutSec = 120;
+    static constexpr int kConnectTimeoutMs = 10000;
+    // 单个会话同时被多少个适配器持有后另开新会话
+    static constexpr int kMaxLeasesPerSession = SshSession::kMaxChannels;
+
+    SshSessionPool(const SshSessionPool&) = delete;
+    SshSessionPool& operator=(const SshSessionPool&) = delete;
+
+private:
+    SshSessionPool();
+    ~SshSessionPool();
+
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
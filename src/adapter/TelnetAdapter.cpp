@@ -1,8 +1,11 @@
 #include "TelnetAdapter.h"
+#include "ConnReactor.h"
 #include "lwconn.h"
 #include <sstream>
 #include <chrono>
 #include <cstring>
+#include <condition_variable>
+#include <regex>
 
 // ============================================================
 // Pimpl 实现体 — 封装 lwcommunicate::LWTcpClient 操作细节
@@ -16,19 +19,122 @@ struct TelnetAdapter::Impl {
     // 流模式状态
     StreamCallback m_streamCb;
     std::atomic<bool> m_streaming{false};
+
+    // 接收：优先注册到共享 ConnReactor；平台不支持时退回独立读取线程
+    uint64_t    m_reactorToken = 0;
     std::thread m_readThread;
     std::atomic<bool> m_readThreadRunning{false};
 
-    // 请求-响应模式的响应缓冲区（由读取线程填充，request() 超时后取用）
+    // 请求-响应模式的响应缓冲区（由接收回调填充并经 m_responseCv 通知 request()）
     std::string m_responseBuffer;
     std::mutex  m_responseMutex;
+    std::condition_variable m_responseCv;
+    uint64_t    m_dataSeq = 0;                              // 每收到一块数据递增
+    std::chrono::steady_clock::time_point m_lastDataAt;     // 最近一次收到数据的时刻
     std::mutex  m_requestMutex;   // 序列化 request() 调用，防止并发覆盖响应缓冲区
 
+    // 响应结束判据（m_requestMutex 保护）
+    std::regex  m_prompt{ kDefaultPromptPattern };
+    bool        m_hasPrompt = true;
+    // 登录输出末尾是否匹配提示符：未匹配说明该设备提示符与正则不符，按提示符判定只会
+    // 让每条命令等到超时，此时退回静默间隔判定（提示符仍可提前结束等待）
+    bool        m_promptSeen = false;
+    std::string m_loginTail;      // 登录输出末尾，更换提示符正则时据此重新判定
+    bool        m_sentinelEcho = false;
+    int         m_idleCompletionMs = kDefaultIdleCompletionMs;
+    uint64_t    m_sentinelSeq = 0;
+
+    // 外部取消标志（连接登录等待、请求等待期间检查）
+    const std::atomic<bool>* m_cancelFlag = nullptr;
+
+    // 响应分块交付（m_requestMutex 保护）
+    ResponseSink m_responseSink;
+
     // 预设超时（毫秒）
     static constexpr int kReadTimeoutMs = 200;
     static constexpr int kSendTimeoutMs = 5000;
     static constexpr int kConnectTimeoutMs = 10000;
     static constexpr int kAuthDelayMs = 500;
+    static constexpr int kCancelPollMs = 50;        // 等待响应时检查外部取消的间隔
+    static constexpr size_t kPromptTailBytes = 256; // 提示符只在缓冲区末尾这段内匹配
+    static constexpr size_t kSinkFlushBytes = 64 * 1024;   // 缓冲超过此值即交给 sink
+    static constexpr size_t kSinkKeepBytes = 4 * 1024;     // 交出时保留的尾部（提示符/标记可能跨块）
+    static constexpr size_t kMaxBufferedBytes = 32 * 1024 * 1024;  // 无 sink 时的缓冲上限，超出丢弃最旧数据
+
+    bool cancelled() const {
+        return m_cancelFlag && m_cancelFlag->load();
+    }
+
+    // --- 可被取消打断的等待，被取消时返回 false ---
+    bool waitFor(int ms) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (std::chrono::steady_clock::now() < until) {
+            if (cancelled()) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return !cancelled();
+    }
+
+    // --- 登录过程中止：停止客户端并记录原因 ---
+    bool abortConnect(const std::string& reason) {
+        m_lastError = reason;
+        m_client->stop();
+        m_client.reset();
+        return false;
+    }
+
+    // --- 缓冲区末尾是否为提示符（调用方持有 m_responseMutex） ---
+    bool endsWithPromptLocked() const {
+        return endsWithPrompt(m_responseBuffer);
+    }
+
+    bool endsWithPrompt(const std::string& text) const {
+        if (!m_hasPrompt || text.empty()) return false;
+        const size_t n = std::min(text.size(), kPromptTailBytes);
+        return std::regex_search(text.end() - static_cast<std::ptrdiff_t>(n), text.end(), m_prompt);
+    }
+
+    // --- 回显标记：单独成行的 marker 表示命令已执行完毕，返回其所在行起点 ---
+    static size_t findSentinelLine(const std::string& buf, const std::string& marker) {
+        for (size_t pos = buf.find(marker); pos != std::string::npos;
+             pos = buf.find(marker, pos + 1)) {
+            const bool lineStart = pos == 0 || buf[pos - 1] == '\n';
+            const size_t after = pos + marker.size();
+            const bool lineEnd = after < buf.size() && (buf[after] == '\r' || buf[after] == '\n');
+            if (lineStart && lineEnd) return pos;
+        }
+        return std::string::npos;
+    }
+
+    // --- 删除交出块中的 "echo 标记" 回显行（整行都在块内时） ---
+    static void dropEchoLine(std::string& text, const std::string& marker) {
+        const size_t at = text.find("echo " + marker);
+        if (at == std::string::npos) return;
+        const size_t eol = text.find('\n', at);
+        if (eol == std::string::npos) return;
+        const size_t bol = text.rfind('\n', at);
+        const size_t start = bol == std::string::npos ? 0 : bol + 1;
+        text.erase(start, eol + 1 - start);
+    }
+
+    // --- 连接建立后等待登录输出（欢迎信息、首个提示符）收齐并丢弃，
+    //     避免残留的提示符让第一条命令提前判定完成 ---
+    void drainLoginOutput() {
+        std::unique_lock<std::mutex> lock(m_responseMutex);
+        const auto deadline = std::chrono::steady_clock::now()
+                            + std::chrono::milliseconds(kAuthDelayMs * 2);
+        const int idleMs = m_idleCompletionMs > 0 ? m_idleCompletionMs : kDefaultIdleCompletionMs;
+        while (!cancelled()) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline || endsWithPromptLocked()) break;
+            if (m_dataSeq > 0 && now - m_lastDataAt >= std::chrono::milliseconds(idleMs)) break;
+            m_responseCv.wait_for(lock, std::chrono::milliseconds(kCancelPollMs));
+        }
+        const size_t n = std::min(m_responseBuffer.size(), kPromptTailBytes);
+        m_loginTail = m_responseBuffer.substr(m_responseBuffer.size() - n);
+        m_promptSeen = endsWithPrompt(m_loginTail);
+        m_responseBuffer.clear();
+    }
 
     // --- 连接事件回调 ---
     void onConnectionEvent(bool connected, const std::string& extra) {
@@ -37,8 +143,52 @@ struct TelnetAdapter::Impl {
         }
     }
 
-    // --- 后台读取线程 ---
-    // 持续调用 LWTcpClient::receive()，将数据分发给流回调或存入响应缓冲区
+    // --- 收到一块数据：分发给流回调，或存入响应缓冲区并唤醒等待中的 request() ---
+    void onChunk(const char* data, size_t length) {
+        std::string chunk(data, length);
+        if (m_streaming && m_streamCb) {
+            // 流模式：直接回调
+            m_streamCb(chunk, false);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_responseMutex);
+            m_responseBuffer += chunk;
+            if (m_responseBuffer.size() > kMaxBufferedBytes) {
+                // 无人取用的输出（如 dmesg 刷屏）不能无限增长：保留最新的一半
+                m_responseBuffer.erase(0, m_responseBuffer.size() - kMaxBufferedBytes / 2);
+            }
+            ++m_dataSeq;
+            m_lastDataAt = std::chrono::steady_clock::now();
+        }
+        m_responseCv.notify_all();
+    }
+
+    // --- 开始接收：注册到共享反应器，失败时启动独立读取线程 ---
+    void startReceiving() {
+        Impl* self = this;
+        m_reactorToken = ConnReactor::instance().watch(
+            m_client,
+            [self](const char* data, size_t length) { self->onChunk(data, length); },
+            [self]() { self->m_streaming = false; });
+        if (m_reactorToken == 0) {
+            m_readThreadRunning = true;
+            m_readThread = std::thread(&Impl::readLoop, this);
+        }
+    }
+
+    // --- 停止接收（须在关闭客户端之前调用） ---
+    void stopReceiving() {
+        ConnReactor::instance().unwatch(m_reactorToken);
+        m_reactorToken = 0;
+        m_readThreadRunning = false;
+        if (m_readThread.joinable()) {
+            m_readThread.join();
+        }
+    }
+
+    // --- 独立读取线程（反应器不可用时的退路） ---
+    // 持续调用 LWTcpClient::receive()，将数据交给 onChunk
     void readLoop() {
         char buffer[4096];
 
@@ -49,21 +199,11 @@ struct TelnetAdapter::Impl {
             }
 
             size_t received = 0;
-            LWConnError err = m_client->receive(buffer, sizeof(buffer) - 1,
+            LWConnError err = m_client->receive(buffer, sizeof(buffer),
                                                  received, kReadTimeoutMs);
 
             if (err == LWConnError::SUCCESS && received > 0) {
-                buffer[received] = '\0';
-                std::string chunk(buffer, received);
-
-                if (m_streaming && m_streamCb) {
-                    // 流模式：直接回调
-                    m_streamCb(chunk, false);
-                } else {
-                    // 请求-响应模式：存入共享缓冲区
-                    std::lock_guard<std::mutex> lock(m_responseMutex);
-                    m_responseBuffer += chunk;
-                }
+                onChunk(buffer, received);
             }
             // TIMEOUT / NOT_CONNECTED / RECEIVE_FAILED 都是正常的，继续循环
         }
@@ -123,35 +263,40 @@ bool TelnetAdapter::connect(const DeviceInfo& device, const AuthInfo& auth) {
 
     // Telnet 认证：发送用户名 + 密码
     // 等待服务端就绪（发送登录提示）
-    std::this_thread::sleep_for(std::chrono::milliseconds(Impl::kAuthDelayMs));
+    if (!m_impl->waitFor(Impl::kAuthDelayMs)) {
+        return m_impl->abortConnect("Telnet 连接已取消");
+    }
 
     std::string loginCmd = auth.user + "\r\n";
     LWConnError sendErr = m_impl->m_client->send(loginCmd.c_str(),
                                                    loginCmd.size(), Impl::kSendTimeoutMs);
     if (sendErr != LWConnError::SUCCESS) {
-        m_impl->m_lastError = "Telnet 发送用户名失败，连接已断开";
-        m_impl->m_client->stop();
-        m_impl->m_client.reset();
-        return false;
+        return m_impl->abortConnect("Telnet 发送用户名失败，连接已断开");
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(Impl::kAuthDelayMs));
+    if (!m_impl->waitFor(Impl::kAuthDelayMs)) {
+        return m_impl->abortConnect("Telnet 连接已取消");
+    }
 
     std::string passCmd = auth.password + "\r\n";
     sendErr = m_impl->m_client->send(passCmd.c_str(), passCmd.size(), Impl::kSendTimeoutMs);
     if (sendErr != LWConnError::SUCCESS) {
-        m_impl->m_lastError = "Telnet 发送密码失败，连接已断开";
-        m_impl->m_client->stop();
-        m_impl->m_client.reset();
-        return false;
+        return m_impl->abortConnect("Telnet 发送密码失败，连接已断开");
     }
 
     // 再等待服务端处理认证
-    std::this_thread::sleep_for(std::chrono::milliseconds(Impl::kAuthDelayMs));
+    if (!m_impl->waitFor(Impl::kAuthDelayMs)) {
+        return m_impl->abortConnect("Telnet 连接已取消");
+    }
 
-    // 启动后台读取线程
-    m_impl->m_readThreadRunning = true;
-    m_impl->m_readThread = std::thread(&Impl::readLoop, m_impl.get());
+    // 开始接收（共享反应器分发，不再为每个会话常驻一个读取线程）
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_responseMutex);
+        m_impl->m_responseBuffer.clear();
+        m_impl->m_dataSeq = 0;
+    }
+    m_impl->startReceiving();
+    m_impl->drainLoginOutput();
 
     m_impl->m_lastError.clear();
     return true;
@@ -161,11 +306,8 @@ void TelnetAdapter::disconnect() {
     // 停止流模式
     unsubscribe();
 
-    // 停止读取线程
-    m_impl->m_readThreadRunning = false;
-    if (m_impl->m_readThread.joinable()) {
-        m_impl->m_readThread.join();
-    }
+    // 停止接收（注销反应器 / 停止读取线程）
+    m_impl->stopReceiving();
 
     // 断开 TCP 连接
     if (m_impl->m_client) {
@@ -183,6 +325,10 @@ std::string TelnetAdapter::lastError() const {
     return m_impl->m_lastError;
 }
 
+void TelnetAdapter::setCancelFlag(const std::atomic<bool>* cancelled) {
+    m_impl->m_cancelFlag = cancelled;
+}
+
 // ============================================================
 // IProtocolAdapter — 传输模式
 // ============================================================
@@ -206,11 +352,16 @@ std::future<Response> TelnetAdapter::request(const Request& req) {
             m_impl->m_responseBuffer.clear();
         }
 
-        // 发送命令（path 为命令文本，追加 \r\n）
+        // 发送命令（path 为命令文本，追加 \r\n）；回显标记模式下紧跟一行 echo
         std::string cmd = req.path;
         if (!cmd.empty() && cmd.back() != '\n') {
             cmd += "\r\n";
         }
+        std::string marker;
+        if (m_impl->m_sentinelEcho) {
+            marker = "__DM_DONE_" + std::to_string(++m_impl->m_sentinelSeq) + "__";
+            cmd += "echo " + marker + "\r\n";
+        }
 
         LWConnError sendErr = m_impl->m_client->send(cmd.c_str(), cmd.size(),
                                                         Impl::kSendTimeoutMs);
@@ -220,39 +371,115 @@ std::future<Response> TelnetAdapter::request(const Request& req) {
             return resp;
         }
 
-        // 等待响应（由后台读取线程填充 m_responseBuffer）
-        int waited = 0;
-        int timeoutMs = req.timeoutMs > 0 ? req.timeoutMs : 5000;
-        int pollInterval = 100; // 每 100ms 检查一次
-
-        while (waited < timeoutMs) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(pollInterval));
-            waited += pollInterval;
-
-            // 检查是否已收到数据
-            {
-                std::lock_guard<std::mutex> lock(m_impl->m_responseMutex);
-                if (!m_impl->m_responseBuffer.empty()) {
-                    // 等待再多一点数据（可能分片到达）
-                    if (waited < 500) {
-                        continue; // 至少等待 500ms 聚合响应
-                    }
+        // 等待接收回调通知：命中标记 / 提示符即返回，最长 timeoutMs。
+        // 静默间隔只在两者都不可用时作为判据：长时间无输出的命令（解压、编译）不会被误判完成
+        const int timeoutMs = req.timeoutMs > 0 ? req.timeoutMs : 5000;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+        std::unique_lock<std::mutex> wait(m_impl->m_responseMutex);
+        const bool hasEndMarker = !marker.empty() || (m_impl->m_hasPrompt && m_impl->m_promptSeen);
+        const auto idle = std::chrono::milliseconds(hasEndMarker ? 0 : m_impl->m_idleCompletionMs);
+        const uint64_t startSeq = m_impl->m_dataSeq;
+        uint64_t checkedSeq = startSeq;
+        size_t sentinelAt = std::string::npos;
+        bool timedOut = false;
+        for (;;) {
+            if (m_impl->cancelled()) {
+                resp.success = false;
+                resp.errorMessage = "Telnet 请求已取消";
+                resp.data = m_impl->m_responseBuffer;
+                m_impl->m_responseBuffer.clear();
+                return resp;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const bool gotData = m_impl->m_dataSeq != startSeq;
+            if (gotData && m_impl->m_dataSeq != checkedSeq) {
+                checkedSeq = m_impl->m_dataSeq;
+                if (!marker.empty()) {
+                    sentinelAt = Impl::findSentinelLine(m_impl->m_responseBuffer, marker);
+                    if (sentinelAt != std::string::npos) break;
+                } else if (m_impl->endsWithPromptLocked()) {
                     break;
                 }
             }
-        }
+            if (now >= deadline) {
+                timedOut = true;
+                break;
+            }
+            if (gotData && idle.count() > 0 && now - m_impl->m_lastDataAt >= idle) break;
+
+            // 分块交付：超过阈值的部分交给 sink（锁外回调），缓冲只留尾部供提示符/标记匹配
+            if (m_impl->m_responseSink && m_impl->m_responseBuffer.size() > Impl::kSinkFlushBytes) {
+                std::string head = m_impl->m_responseBuffer.substr(
+                    0, m_impl->m_responseBuffer.size() - Impl::kSinkKeepBytes);
+                m_impl->m_responseBuffer.erase(0, head.size());
+                if (!marker.empty()) Impl::dropEchoLine(head, marker);
+                wait.unlock();
+                m_impl->m_responseSink(head.data(), head.size());
+                wait.lock();
+                continue;
+            }
 
-        {
-            std::lock_guard<std::mutex> lock(m_impl->m_responseMutex);
-            resp.success = true;
-            resp.data = m_impl->m_responseBuffer;
-            m_impl->m_responseBuffer.clear();
+            auto wake = std::min(deadline, now + std::chrono::milliseconds(Impl::kCancelPollMs));
+            if (gotData && idle.count() > 0) wake = std::min(wake, m_impl->m_lastDataAt + idle);
+            m_impl->m_responseCv.wait_until(wait, wake);
         }
 
+        resp.success = !timedOut;
+        if (timedOut) {
+            resp.errorMessage = "Telnet 响应超时: " + std::to_string(timeoutMs) + " ms 内"
+                              + (hasEndMarker ? "未检测到命令结束（提示符/完成标记）" : "未收到数据");
+        }
+        resp.data = m_impl->m_responseBuffer;
+        m_impl->m_responseBuffer.clear();
+        if (!marker.empty()) {
+            // 剔除 "echo 标记" 回显行及其后的标记行、提示符
+            // （回显行若已随前面的块交出，则从标记行处截断）
+            const size_t echoAt = resp.data.find("echo " + marker);
+            size_t cut = echoAt != std::string::npos ? echoAt : sentinelAt;
+            if (cut != std::string::npos) {
+                const size_t lineStart = resp.data.rfind('\n', cut);
+                resp.data.erase(lineStart == std::string::npos ? 0 : lineStart + 1);
+            }
+        }
         return resp;
     });
 }
 
+bool TelnetAdapter::setPromptPattern(const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(m_impl->m_requestMutex);
+    if (pattern.empty()) {
+        m_impl->m_hasPrompt = false;
+        return true;
+    }
+    try {
+        m_impl->m_prompt = std::regex(pattern, std::regex::ECMAScript | std::regex::optimize);
+        m_impl->m_hasPrompt = true;
+        std::lock_guard<std::mutex> responseLock(m_impl->m_responseMutex);
+        m_impl->m_promptSeen = m_impl->endsWithPrompt(m_impl->m_loginTail);
+        return true;
+    } catch (const std::regex_error& ex) {
+        m_impl->m_lastError = "提示符正则无效: " + pattern + " — " + ex.what();
+        return false;
+    }
+}
+
+void TelnetAdapter::setResponseSink(ResponseSink sink) {
+    std::lock_guard<std::mutex> lock(m_impl->m_requestMutex);
+    m_impl->m_responseSink = std::move(sink);
+}
+
+void TelnetAdapter::setSentinelEcho(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_impl->m_requestMutex);
+    m_impl->m_sentinelEcho = enabled;
+}
+
+void TelnetAdapter::setIdleCompletionMs(int idleMs) {
+    std::lock_guard<std::mutex> lock(m_impl->m_requestMutex);
+    m_impl->m_idleCompletionMs = idleMs > 0 ? idleMs : 0;
+}
+
 void TelnetAdapter::subscribe(const Request& req, StreamCallback onData) {
     if (!m_impl->m_client || !m_impl->m_client->isConnected()) {
         m_impl->m_lastError = "Telnet 未连接,无法订阅";
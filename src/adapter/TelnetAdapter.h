@@ -10,6 +10,9 @@
 
 // Telnet 协议适配器 — 基于 lwcommunicate::LWTcpClient 实现 IProtocolAdapter
 // 同时支持请求-响应模式（单次命令执行）和流模式（持续接收输出）
+// 请求-响应模式下由接收回调（共享 ConnReactor）经条件变量通知，按提示符 / 回显标记判定响应结束；
+// 两者都未启用（或登录输出末尾未匹配提示符）时才以静默间隔判定。
+// 超时未判定结束时 request 返回失败（data 为已收到的输出）
 // 使用 Pimpl 模式隐藏 lwcommunicate 实现细节
 class TelnetAdapter : public IProtocolAdapter {
 public:
@@ -22,11 +25,29 @@ public:
     void disconnect() override;
     bool isConnected() const override;
     std::string lastError() const override;
+    void setCancelFlag(const std::atomic<bool>* cancelled) override;
+    void setResponseSink(ResponseSink sink) override;
     std::future<Response> request(const Request& req) override;
     void subscribe(const Request& req, StreamCallback onData) override;
     void unsubscribe() override;
     ProtocolCapability capability() const override;
 
+    // --- 响应结束判据（下一次 request 生效） ---
+    // 提示符正则（ECMAScript），与响应缓冲区末尾匹配即判定命令完成，
+    // 如 SylixOS "-> $"；空串 = 不按提示符判定。正则无效时返回 false 并保留原设置。
+    // 登录输出末尾未匹配该正则时视为提示符不符，未启用标记的命令改按静默间隔判定
+    bool setPromptPattern(const std::string& pattern);
+    // 每条命令后追加一行 echo 标记，收到单独成行的标记即判定完成（提示符不固定时使用）；
+    // 标记行及其回显不计入响应数据
+    void setSentinelEcho(bool enabled);
+    // 提示符为空且未启用标记时的判据：已收到数据且静默 idleMs 后判定完成（0 = 等到超时）
+    void setIdleCompletionMs(int idleMs);
+
+    // 常见 shell 提示符：缓冲区最后一行（其后无换行）以 '#' '$' '>' '%' 或 SylixOS 的 "->"
+    // 结尾，可带一个空格
+    static constexpr const char* kDefaultPromptPattern = R"((?:^|\n)[^\n]*(?:[#$>%]|->) ?$)";
+    static constexpr int kDefaultIdleCompletionMs = 300;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> m_impl;
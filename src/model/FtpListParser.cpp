@@ -0,0 +1,314 @@
+#include "FtpListParser.h"
+#include <QTimeZone>
+#include <cstring>
+
+namespace {
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t'; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; }
+
+// 空白分隔字段游标：只移动指针，不复制
+struct Cursor {
+    const char* p;
+    const char* end;
+
+    bool next(const char*& b, const char*& e) {
+        while (p < end && isSpace(*p)) ++p;
+        if (p == end) return false;
+        b = p;
+        while (p < end && !isSpace(*p)) ++p;
+        e = p;
+        return true;
+    }
+
+    const char* rest() {
+        while (p < end && isSpace(*p)) ++p;
+        return p;
+    }
+};
+
+bool toNumber(const char* b, const char* e, qint64& out) {
+    if (b == e) return false;
+    qint64 v = 0;
+    for (; b < e; ++b) {
+        if (!isDigit(*b)) return false;
+        v = v * 10 + (*b - '0');
+    }
+    out = v;
+    return true;
+}
+
+// 读取定长数字，不足或含非数字时返回 -1
+int fixedDigits(const char* p, const char* end, int count) {
+    if (end - p < count) return -1;
+    int v = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!isDigit(p[i])) return -1;
+        v = v * 10 + (p[i] - '0');
+    }
+    return v;
+}
+
+// 英文月份缩写 → 1..12，无法识别返回 0
+int monthIndex(const char* b, const char* e) {
+    if (e - b != 3) return 0;
+    const char a = lower(b[0]), m = lower(b[1]), c = lower(b[2]);
+    switch (a) {
+    case 'j':
+        if (m == 'a' && c == 'n') return 1;
+        if (m == 'u' && c == 'n') return 6;
+        if (m == 'u' && c == 'l') return 7;
+        return 0;
+    case 'f': return (m == 'e' && c == 'b') ? 2 : 0;
+    case 'm':
+        if (m == 'a' && c == 'r') return 3;
+        if (m == 'a' && c == 'y') return 5;
+        return 0;
+    case 'a':
+        if (m == 'p' && c == 'r') return 4;
+        if (m == 'u' && c == 'g') return 8;
+        return 0;
+    case 's': return (m == 'e' && c == 'p') ? 9 : 0;
+    case 'o': return (m == 'c' && c == 't') ? 10 : 0;
+    case 'n': return (m == 'o' && c == 'v') ? 11 : 0;
+    case 'd': return (m == 'e' && c == 'c') ? 12 : 0;
+    default: return 0;
+    }
+}
+
+// "hh:mm"（可带 AM/PM），失败返回无效 QTime
+QTime parseClock(const char* b, const char* e) {
+    const char* colon = static_cast<const char*>(std::memchr(b, ':', static_cast<size_t>(e - b)));
+    if (!colon || colon == b || e - colon < 3) return QTime();
+    qint64 h = 0;
+    if (!toNumber(b, colon, h)) return QTime();
+    const int m = fixedDigits(colon + 1, e, 2);
+    if (m < 0) return QTime();
+    const char* suffix = colon + 3;
+    if (e - suffix == 2 && lower(suffix[1]) == 'm') {
+        const char ap = lower(suffix[0]);
+        if (ap == 'p' && h < 12) h += 12;
+        else if (ap == 'a' && h == 12) h = 0;
+    } else if (suffix != e) {
+        return QTime();
+    }
+    return QTime(static_cast<int>(h), m);
+}
+
+inline bool factIs(const char* b, const char* e, const char* key) {
+    const size_t n = std::strlen(key);
+    if (static_cast<size_t>(e - b) != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (lower(b[i]) != key[i]) return false;
+    }
+    return true;
+}
+
+inline bool isDotEntry(const char* b, const char* e) {
+    return (e - b == 1 && b[0] == '.') || (e - b == 2 && b[0] == '.' && b[1] == '.');
+}
+
+} // namespace
+
+FtpListParser::FtpListParser(Format format, const QDate& today)
+    : m_format(format)
+    , m_today(today)
+{
+}
+
+const QString& FtpListParser::permissions(const char* p, int len) {
+    // 目录内权限串高度重复：与上一条相同时直接复用（隐式共享，不再分配）
+    if (len != m_lastPermsLen || std::memcmp(p, m_lastPermsRaw, static_cast<size_t>(len)) != 0) {
+        if (len > static_cast<int>(sizeof(m_lastPermsRaw))) len = static_cast<int>(sizeof(m_lastPermsRaw));
+        std::memcpy(m_lastPermsRaw, p, static_cast<size_t>(len));
+        m_lastPermsLen = len;
+        m_lastPerms = QString::fromLatin1(p, len);
+    }
+    return m_lastPerms;
+}
+
+bool FtpListParser::parseLine(const char* begin, const char* end, FtpFileInfo& out) {
+    while (end > begin && (end[-1] == '\r' || end[-1] == '\n')) --end;
+    while (begin < end && isSpace(*begin)) ++begin;
+    if (begin == end) return false;
+
+    if (m_format == Format::Mlsd) return parseMlsd(begin, end, out);
+    return isDigit(*begin) ? parseDos(begin, end, out) : parseUnix(begin, end, out);
+}
+
+// "type=file;size=12;modify=20240101120000;UNIX.mode=0644; name"
+bool FtpListParser::parseMlsd(const char* p, const char* end, FtpFileInfo& out) {
+    const char* sp = static_cast<const char*>(std::memchr(p, ' ', static_cast<size_t>(end - p)));
+    if (!sp || sp + 1 >= end) return false;
+    const char* name = sp + 1;
+    if (isDotEntry(name, end)) return false;
+
+    bool isDir = false;
+    qint64 size = -1;
+    QDateTime modified;
+    int mode = -1;
+
+    for (const char* f = p; f < sp;) {
+        const char* semi = static_cast<const char*>(std::memchr(f, ';', static_cast<size_t>(sp - f)));
+        if (!semi) semi = sp;
+        const char* eq = static_cast<const char*>(std::memchr(f, '=', static_cast<size_t>(semi - f)));
+        if (eq) {
+            const char* v = eq + 1;
+            if (factIs(f, eq, "type")) {
+                if (factIs(v, semi, "cdir") || factIs(v, semi, "pdir")) return false;
+                isDir = factIs(v, semi, "dir");
+            } else if (factIs(f, eq, "size")) {
+                if (!toNumber(v, semi, size)) size = -1;
+            } else if (factIs(f, eq, "modify")) {
+                // YYYYMMDDHHMMSS[.sss]，UTC
+                const int y = fixedDigits(v, semi, 4), mo = fixedDigits(v + 4, semi, 2),
+                          d = fixedDigits(v + 6, semi, 2), h = fixedDigits(v + 8, semi, 2),
+                          mi = fixedDigits(v + 10, semi, 2), s = fixedDigits(v + 12, semi, 2);
+                if (y >= 0 && mo >= 0 && d >= 0 && h >= 0 && mi >= 0 && s >= 0) {
+                    modified = QDateTime(QDate(y, mo, d), QTime(h, mi, s), QTimeZone::utc()).toLocalTime();
+                }
+            } else if (factIs(f, eq, "unix.mode")) {
+                int m = 0;
+                const char* c = v;
+                for (; c < semi && *c >= '0' && *c <= '7'; ++c) m = m * 8 + (*c - '0');
+                if (c == semi && c != v) mode = m;
+            }
+        }
+        f = semi + 1;
+    }
+
+    out.name = QString::fromUtf8(name, static_cast<int>(end - name));
+    out.isDirectory = isDir;
+    out.size = size;
+    out.lastModified = modified;
+    if (mode >= 0) {
+        char perms[10];
+        perms[0] = isDir ? 'd' : '-';
+        static const char kRwx[] = "rwx";
+        for (int i = 0; i < 9; ++i) perms[1 + i] = (mode & (0400 >> i)) ? kRwx[i % 3] : '-';
+        out.permissions = permissions(perms, 10);
+    } else {
+        out.permissions.clear();
+    }
+    return true;
+}
+
+// "drwxr-xr-x 2 user group 4096 Jan 01 12:00 name"；缺 group 列、链接 "a -> b" 均可识别
+bool FtpListParser::parseUnix(const char* p, const char* end, FtpFileInfo& out) {
+    Cursor cur{ p, end };
+    const char* tb[8];
+    const char* te[8];
+    int n = 0;
+    int month = 0;
+    int mi = -1;
+
+    // 找到 "<size> <Mon> <day> <time|year>"：月份前一列为大小
+    while (n < 8 && cur.next(tb[n], te[n])) {
+        if (mi < 0 && n >= 2) {
+            qint64 dummy;
+            const int m = monthIndex(tb[n], te[n]);
+            if (m > 0 && toNumber(tb[n - 1], te[n - 1], dummy)) {
+                mi = n;
+                month = m;
+            }
+        }
+        ++n;
+        if (mi >= 0 && n == mi + 3) break;
+    }
+    if (mi < 0 || n != mi + 3) return false;
+
+    const char* name = cur.rest();
+    const char* nameEnd = end;
+    if (name == end) return false;
+
+    const char type = *p;
+    if (type == 'l') {
+        // 符号链接：去掉 " -> 目标"
+        for (const char* a = name; a + 4 <= nameEnd; ++a) {
+            if (a[0] == ' ' && a[1] == '-' && a[2] == '>' && a[3] == ' ') {
+                nameEnd = a;
+                break;
+            }
+        }
+    }
+    if (isDotEntry(name, nameEnd)) return false;
+
+    qint64 size = -1;
+    if (!toNumber(tb[mi - 1], te[mi - 1], size)) size = -1;
+
+    qint64 day = 0;
+    if (!toNumber(tb[mi + 1], te[mi + 1], day)) return false;
+
+    QDate date;
+    QTime time(0, 0);
+    qint64 year = 0;
+    if (toNumber(tb[mi + 2], te[mi + 2], year)) {
+        date = QDate(static_cast<int>(year), month, static_cast<int>(day));
+    } else {
+        time = parseClock(tb[mi + 2], te[mi + 2]);
+        date = QDate(m_today.year(), month, static_cast<int>(day));
+        if (date > m_today) date = QDate(m_today.year() - 1, month, static_cast<int>(day));
+    }
+
+    out.name = QString::fromUtf8(name, static_cast<int>(nameEnd - name));
+    out.isDirectory = (type == 'd');
+    out.size = size;
+    out.lastModified = date.isValid() ? QDateTime(date, time) : QDateTime();
+    const int permsLen = static_cast<int>(te[0] - tb[0]);
+    if (permsLen >= 10 && (type == 'd' || type == '-' || type == 'l')) {
+        out.permissions = permissions(tb[0], permsLen);
+    } else {
+        out.permissions.clear();
+    }
+    return true;
+}
+
+// "01-01-24  12:00PM  <DIR>  name" / "2024-01-01  12:00  1234 name"
+bool FtpListParser::parseDos(const char* p, const char* end, FtpFileInfo& out) {
+    Cursor cur{ p, end };
+    const char *db, *de, *cb, *ce, *sb, *se;
+    if (!cur.next(db, de) || !cur.next(cb, ce) || !cur.next(sb, se)) return false;
+    const char* name = cur.rest();
+    if (name == end || isDotEntry(name, end)) return false;
+
+    QDate date;
+    if (de - db == 10 && db[4] == '-') {
+        date = QDate(fixedDigits(db, de, 4), fixedDigits(db + 5, de, 2), fixedDigits(db + 8, de, 2));
+    } else if ((de - db == 8 || de - db == 10) && db[2] == '-') {
+        int y = de - db == 10 ? fixedDigits(db + 6, de, 4) : fixedDigits(db + 6, de, 2);
+        if (de - db == 8 && y >= 0) y += (y < 70) ? 2000 : 1900;
+        date = QDate(y, fixedDigits(db, de, 2), fixedDigits(db + 3, de, 2));
+    }
+
+    const bool isDir = factIs(sb, se, "<dir>");
+    qint64 size = -1;
+    if (!isDir && !toNumber(sb, se, size)) return false;
+
+    const QTime time = parseClock(cb, ce);
+    out.name = QString::fromUtf8(name, static_cast<int>(end - name));
+    out.isDirectory = isDir;
+    out.size = size;
+    out.lastModified = date.isValid() ? QDateTime(date, time.isValid() ? time : QTime(0, 0)) : QDateTime();
+    out.permissions.clear();
+    return true;
+}
+
+QList<FtpFileInfo> FtpListParser::parse(const QByteArray& data, const QString& remoteDir) {
+    QList<FtpFileInfo> result;
+    result.reserve(data.count('\n') + 1);
+
+    const char* p = data.constData();
+    const char* const end = p + data.size();
+    FtpFileInfo info;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* lineEnd = nl ? nl : end;
+        if (parseLine(p, lineEnd, info)) {
+            info.remotePath = remoteDir;
+            result.append(info);
+        }
+        p = lineEnd + 1;
+    }
+    return result;
+}
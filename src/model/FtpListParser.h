@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+struct FtpFileInfo {
+    QString remotePath;
+    QString name;
+    QDateTime lastModified;
+    qint64 size = -1;
+    bool isDirectory = false;
+    QString permissions; // FTP LIST 权限字符串（首字符 d=目录, -=文件）
+};
+
+// FTP 目录列表单遍解析器：直接在原始字节上逐字段扫描，每行不做 split、不用正则，
+// 除输出的文件名/权限串外不产生临时分配（相同权限串在条目间隐式共享）。
+// 支持 MLSD、Unix ls -l 与 DOS/IIS 三种格式；"total"、"."、".." 等行自动跳过
+class FtpListParser {
+public:
+    enum class Format { List, Mlsd };
+
+    // today 用于补全 Unix 列表中不带年份的时间（"Jan 01 12:00"）
+    explicit FtpListParser(Format format, const QDate& today = QDate::currentDate());
+
+    // 解析一行（不含换行符），可识别时填充 out 并返回 true；不修改 out.remotePath
+    bool parseLine(const char* begin, const char* end, FtpFileInfo& out);
+
+    // 解析完整列表，remoteDir 写入每个条目的 remotePath
+    QList<FtpFileInfo> parse(const QByteArray& data, const QString& remoteDir);
+
+private:
+    bool parseMlsd(const char* p, const char* end, FtpFileInfo& out);
+    bool parseUnix(const char* p, const char* end, FtpFileInfo& out);
+    bool parseDos(const char* p, const char* end, FtpFileInfo& out);
+    const QString& permissions(const char* p, int len);
+
+    Format m_format;
+    QDate m_today;
+    char m_lastPermsRaw[16] = {};
+    int m_lastPermsLen = -1;
+    QString m_lastPerms;
+};
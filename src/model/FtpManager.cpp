@@ -1,11 +1,12 @@
 #include "FtpManager.h"
 #include <QDirIterator>
 #include <QFileInfo>
-#include <QRegularExpression>
 #include <QDateTime>
 #include <QDebug>
 #include <QUrl>
 #include <QtConcurrent/QtConcurrent>
+#include <QThread>
+#include <algorithm>
 
 struct FtpContext {
     QFile* file = nullptr;
@@ -13,79 +14,6 @@ struct FtpContext {
     FtpManager::ProgressCallback progress;
 };
 
-static qint64 parseListSize(const QString& line) {
-    QStringList parts = line.trimmed().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-    if (parts.size() >= 5) {
-        bool ok = false;
-        qint64 size = parts[4].toLongLong(&ok);
-        return ok ? size : -1;
-    }
-    return -1;
-}
-
-// 检测 FTP LIST 输出是否目录项（权限首字符 'd'）
-static bool parseListIsDir(const QString& line) {
-    QString trimmed = line.trimmed();
-    if (trimmed.isEmpty()) return false;
-    // Unix-style: "drwxr-xr-x ..." → 首字符 'd' 表示目录
-    // Windows/IIS: 首字符可能是数字（日期），不是标准权限
-    QChar first = trimmed[0];
-    return first == QLatin1Char('d');
-}
-
-// 解析权限字符串（FTP LIST 第一列）
-static QString parseListPermissions(const QString& line) {
-    QStringList parts = line.trimmed().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-    if (parts.size() >= 1) {
-        QString first = parts[0];
-        // Unix-style: 10-character permission string
-        if (first.size() >= 10 && (first[0] == 'd' || first[0] == '-'))
-            return first;
-    }
-    return QString();
-}
-
-static QString parseListFilename(const QString& line) {
-    QStringList parts = line.trimmed().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-    if (parts.size() >= 9) {
-        return parts.mid(8).join(" ");
-    }
-    return QString();
-}
-
-static QDateTime parseListTime(const QString& line) {
-    QRegularExpression re(R"(\S+\s+\d+\s+\S+\s+\S+\s+\d+\s+(\w{3})\s+(\d{1,2})\s+([\d:]+)\s+(.+))");
-    QRegularExpressionMatch match = re.match(line.trimmed());
-    if (!match.hasMatch()) return QDateTime();
-
-    QString monthStr = match.captured(1);
-    int day = match.captured(2).toInt();
-    QString timeOrYear = match.captured(3);
-
-    QStringList months = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
-    int month = months.indexOf(monthStr) + 1;
-    if (month == 0) return QDateTime();
-
-    QDate date;
-    QTime time;
-
-    if (timeOrYear.contains(':')) {
-        time = QTime::fromString(timeOrYear, "hh:mm");
-        int currentYear = QDate::currentDate().year();
-        date = QDate(currentYear, month, day);
-        if (date > QDate::currentDate()) {
-            date = QDate(currentYear - 1, month, day);
-        }
-    } else {
-        int year = timeOrYear.toInt();
-        date = QDate(year, month, day);
-        time = QTime(0, 0);
-    }
-
-    return QDateTime(date, time);
-}
-
 static size_t listWriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     size_t total = size * nmemb;
     QByteArray* buffer = static_cast<QByteArray*>(userp);
@@ -121,10 +49,90 @@ size_t writeData(void* ptr, size_t size, size_t nmemb, QFile* stream) {
     return size * nmemb;
 }
 
+// 远程文件所在目录（保留首 '/'，与 URL 路径的相对/绝对语义一致）
+static QString remoteParentDir(const QString& remoteFilePath) {
+    const int slash = remoteFilePath.lastIndexOf('/');
+    return slash > 0 ? remoteFilePath.left(slash) : QString();
+}
+
+// 在给定句柄上一次性创建一组远程目录（含各级父目录），已在 known 中的跳过。
+// 所有 MKD 作为同一请求的 QUOTE 前置命令发送，'*' 前缀忽略"目录已存在"错误；
+// 取代逐文件 CURLOPT_FTP_CREATE_MISSING_DIRS 的逐级 CWD/MKD 往返
+static CURLcode ensureRemoteDirs(CURL* curl, const QString& host, quint16 port,
+                                 QSet<QString>& known, const QStringList& dirs) {
+    QStringList toCreate;
+    for (const QString& dir : dirs) {
+        const QStringList parts = dir.split('/', Qt::SkipEmptyParts);
+        QString prefix = dir.startsWith('/') ? QStringLiteral("/") : QString();
+        for (const QString& part : parts) {
+            prefix += part;
+            if (!known.contains(prefix)) {
+                known.insert(prefix);
+                toCreate << prefix;
+            }
+            prefix += '/';
+        }
+    }
+    if (toCreate.isEmpty()) return CURLE_OK;
+
+    std::stable_sort(toCreate.begin(), toCreate.end(), [](const QString& a, const QString& b) {
+        return a.count('/') < b.count('/');
+    });
+
+    struct curl_slist* commands = nullptr;
+    for (const QString& dir : toCreate) {
+        commands = curl_slist_append(commands, ("*MKD " + dir).toUtf8().constData());
+    }
+
+    QUrl url;
+    url.setScheme("ftp");
+    url.setHost(host);
+    url.setPort(port);
+    url.setPath("/");
+    const QByteArray urlBytes = url.toString(QUrl::FullyEncoded).toUtf8();
+
+    curl_easy_setopt(curl, CURLOPT_URL, urlBytes.constData());
+    curl_easy_setopt(curl, CURLOPT_UPLOAD, 0L);
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_QUOTE, commands);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    curl_easy_setopt(curl, CURLOPT_QUOTE, nullptr);
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 0L);
+    curl_slist_free_all(commands);
+
+    if (res != CURLE_OK) {
+        for (const QString& dir : toCreate) known.remove(dir);
+    }
+    return res;
+}
+
 FtpManager::FtpManager(const QString& host, quint16 port) 
     : m_host(host), m_port(port) {}
 
-FtpManager::~FtpManager() { clearCredentials(); }
+FtpManager::~FtpManager() {
+    closeSession();
+    clearCredentials();
+}
+
+CURL* FtpManager::session() {
+    if (m_session) {
+        // 仅重置选项，已建立的控制连接保留在句柄连接缓存中
+        curl_easy_reset(m_session);
+    } else {
+        m_session = curl_easy_init();
+    }
+    return m_session;
+}
+
+void FtpManager::closeSession() {
+    if (m_session) {
+        curl_easy_cleanup(m_session);
+        m_session = nullptr;
+    }
+    m_knownDirs.clear();
+}
 
 void FtpManager::setCredentials(const QString& user, const QString& pass) {
     m_user = user;
@@ -138,6 +146,7 @@ void FtpManager::clearCredentials() {
 }
 
 void FtpManager::setHost(const QString& host, quint16 port) {
+    if (host != m_host || port != m_port) closeSession();
     m_host = host;
     m_port = port;
 }
@@ -185,6 +194,7 @@ bool FtpManager::uploadToTarget(const QString& target, const QStringList& items,
     QString host = target.contains(':') ? target.split(':').first() : target;
     quint16 port = target.contains(':') ? target.split(':').last().toUInt() : 21;
 
+    // 一个句柄 = 一条已登录的控制连接，整台设备的所有文件都在其上顺序 STOR
     CURL* curl = curl_easy_init();
     if (!curl) {
         return false;
@@ -194,113 +204,92 @@ bool FtpManager::uploadToTarget(const QString& target, const QStringList& items,
     curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
     curl_easy_setopt(curl, CURLOPT_USERPWD, userPass.c_str());
     curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
+    // 目录已预先创建，直接对完整路径 STOR，省去逐级 CWD
+    curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
 
     bool allSuccess = true;
 
+    // 先展开为 (本地文件, 远程文件) 列表，收集所有远程目录
+    QList<QPair<QString, QString>> uploads;
+    QStringList dirs;
+    auto addUpload = [&](const QString& localFile, const QString& remoteFile) {
+        uploads.append(qMakePair(localFile, remoteFile));
+        const QString dir = remoteParentDir(remoteFile);
+        if (!dir.isEmpty() && !dirs.contains(dir)) dirs << dir;
+    };
+
     for (const QString& item : items) {
         QFileInfo fi(item);
         if (fi.isFile()) {
-            try {
-                QFile file(item);
-                if (!file.open(QIODevice::ReadOnly)) {
-                    allSuccess = false;
-                    continue;
+            QString remoteFilePath = remotePath;
+            if (!remoteFilePath.endsWith('/')) remoteFilePath += '/';
+            remoteFilePath += fi.fileName();
+            addUpload(item, remoteFilePath);
+        } else if (fi.isDir()) {
+            QDirIterator it(item, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                it.next();
+                QFileInfo subFi = it.fileInfo();
+                if (subFi.isFile()) {
+                    QString relPath = QDir(item).relativeFilePath(subFi.absoluteFilePath());
+                    QString remoteFilePath = remotePath;
+                    if (!remoteFilePath.endsWith('/')) remoteFilePath += '/';
+                    remoteFilePath += QDir(item).dirName() + "/" + relPath;
+                    addUpload(subFi.absoluteFilePath(), remoteFilePath);
                 }
+            }
+        }
+    }
 
-                QString remoteFilePath = remotePath;
-                if (!remoteFilePath.endsWith('/')) remoteFilePath += '/';
-                remoteFilePath += fi.fileName();
+    QSet<QString> knownDirs;
+    if (ensureRemoteDirs(curl, host, port, knownDirs, dirs) != CURLE_OK) {
+        qWarning() << "FtpManager::uploadToTarget 创建远程目录失败, target:" << target;
+        curl_easy_cleanup(curl);
+        return false;
+    }
 
-                QUrl url;
-                url.setScheme("ftp");
-                url.setHost(host);
-                url.setPort(port);
-                url.setPath("/" + remoteFilePath);
+    for (const auto& upload : uploads) {
+        try {
+            QFile file(upload.first);
+            if (!file.open(QIODevice::ReadOnly)) {
+                allSuccess = false;
+                continue;
+            }
 
-                QString urlStr = url.toString(QUrl::FullyEncoded);
+            QUrl url;
+            url.setScheme("ftp");
+            url.setHost(host);
+            url.setPort(port);
+            url.setPath("/" + upload.second);
 
-                FtpContext ctx;
-                ctx.file = &file;
-                ctx.total = file.size();
+            QString urlStr = url.toString(QUrl::FullyEncoded);
 
-                curl_easy_setopt(curl, CURLOPT_URL, urlStr.toUtf8().constData());
-                curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
-                curl_easy_setopt(curl, CURLOPT_READFUNCTION, readCallback);
-                curl_easy_setopt(curl, CURLOPT_READDATA, &ctx);
-                curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(file.size()));
-                curl_easy_setopt(curl, CURLOPT_FTP_CREATE_MISSING_DIRS, 1L);
-                curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
+            FtpContext ctx;
+            ctx.file = &file;
+            ctx.total = file.size();
 
-                CURLcode res = curl_easy_perform(curl);
-                file.close();
+            curl_easy_setopt(curl, CURLOPT_URL, urlStr.toUtf8().constData());
+            curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, readCallback);
+            curl_easy_setopt(curl, CURLOPT_READDATA, &ctx);
+            curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(file.size()));
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
 
-                if (res != CURLE_OK) {
-                    allSuccess = false;
-                }
-            } catch (const std::exception& e) {
-                allSuccess = false;
-                qWarning() << "FtpManager::uploadToTarget file exception:" << e.what()
-                           << "file:" << item << "target:" << target;
-            } catch (...) {
+            CURLcode res = curl_easy_perform(curl);
+            file.close();
+
+            if (res != CURLE_OK) {
                 allSuccess = false;
-                qWarning() << "FtpManager::uploadToTarget unknown exception, file:" << item << "target:" << target;
-            }
-        } else if (fi.isDir()) {
-            QDirIterator it(item, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
-                QDirIterator::Subdirectories);
-            while (it.hasNext()) {
-                it.next();
-                QFileInfo subFi = it.fileInfo();
-                if (subFi.isFile()) {
-                    try {
-                        QFile file(subFi.absoluteFilePath());
-                        if (!file.open(QIODevice::ReadOnly)) {
-                            allSuccess = false;
-                            continue;
-                        }
-
-                        QString relPath = QDir(item).relativeFilePath(subFi.absoluteFilePath());
-                        QString remoteFilePath = remotePath;
-                        if (!remoteFilePath.endsWith('/')) remoteFilePath += '/';
-                        remoteFilePath += QDir(item).dirName() + "/" + relPath;
-
-                        QUrl url;
-                        url.setScheme("ftp");
-                        url.setHost(host);
-                        url.setPort(port);
-                        url.setPath("/" + remoteFilePath);
-
-                        QString urlStr = url.toString(QUrl::FullyEncoded);
-
-                        FtpContext ctx;
-                        ctx.file = &file;
-                        ctx.total = file.size();
-
-                        curl_easy_setopt(curl, CURLOPT_URL, urlStr.toUtf8().constData());
-                        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
-                        curl_easy_setopt(curl, CURLOPT_READFUNCTION, readCallback);
-                        curl_easy_setopt(curl, CURLOPT_READDATA, &ctx);
-                        curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(file.size()));
-                        curl_easy_setopt(curl, CURLOPT_FTP_CREATE_MISSING_DIRS, 1L);
-                        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
-
-                        CURLcode res = curl_easy_perform(curl);
-                        file.close();
-
-                        if (res != CURLE_OK) {
-                            allSuccess = false;
-                        }
-                    } catch (const std::exception& e) {
-                        allSuccess = false;
-                        qWarning() << "FtpManager::uploadToTarget dir file exception:" << e.what()
-                                   << "file:" << subFi.absoluteFilePath() << "target:" << target;
-                    } catch (...) {
-                        allSuccess = false;
-                        qWarning() << "FtpManager::uploadToTarget unknown dir exception, file:"
-                                   << subFi.absoluteFilePath() << "target:" << target;
-                    }
-                }
             }
+        } catch (const std::exception& e) {
+            allSuccess = false;
+            qWarning() << "FtpManager::uploadToTarget file exception:" << e.what()
+                       << "file:" << upload.first << "target:" << target;
+        } catch (...) {
+            allSuccess = false;
+            qWarning() << "FtpManager::uploadToTarget unknown exception, file:" << upload.first
+                       << "target:" << target;
         }
     }
 
@@ -331,28 +320,42 @@ void FtpManager::uploadFile(const QString& localPath, const QString& remoteDirec
     ctx.total = file.size();
     ctx.progress = progress;
 
-    CURL* curl = curl_easy_init();
+    // 复用持久会话：同一 FtpManager 的连续上传不再重复 TCP 握手与登录
+    CURL* curl = session();
     if (!curl) {
         file.close();
         throw std::runtime_error("curl_easy_init() 失败");
     }
 
+    const std::string userPass = (m_user + ":" + m_pass).toStdString();
+    curl_easy_setopt(curl, CURLOPT_USERPWD, userPass.c_str());
+    curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    // 父目录本会话内只创建一次
+    CURLcode res = ensureRemoteDirs(curl, m_host, m_port, m_knownDirs,
+                                    QStringList{ remoteParentDir(remoteFilePath) });
+    if (res != CURLE_OK) {
+        file.close();
+        std::string errorMsg = "创建远程目录失败: ";
+        errorMsg += curl_easy_strerror(res);
+        throw std::runtime_error(errorMsg);
+    }
+
     curl_easy_setopt(curl, CURLOPT_URL, urlBytes.constData());
     curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
     curl_easy_setopt(curl, CURLOPT_READFUNCTION, readCallback);
     curl_easy_setopt(curl, CURLOPT_READDATA, &ctx);
     curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(file.size()));
-    curl_easy_setopt(curl, CURLOPT_FTP_CREATE_MISSING_DIRS, 1L);
+    curl_easy_setopt(curl, CURLOPT_FTP_FILEMETHOD, static_cast<long>(CURLFTPMETHOD_NOCWD));
     curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progressCallback);
     curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &ctx);
     curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
-    curl_easy_setopt(curl, CURLOPT_USERPWD, (m_user + ":" + m_pass).toStdString().c_str());
-    curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
 
-    CURLcode res = curl_easy_perform(curl);
+    res = curl_easy_perform(curl);
     file.close();
-    curl_easy_cleanup(curl);
+    RemoteTreeCache::instance().invalidate(cacheKey(), remoteParentDir(remoteFilePath));
 
     if (res != CURLE_OK) {
         std::string errorMsg = "libcurl 上传失败 (";
@@ -369,6 +372,9 @@ void FtpManager::uploadFolder(const QString& localPath, const QString& remoteBas
         throw std::runtime_error("本地文件夹不存在: " + localPath.toStdString());
     }
 
+    // 先收集文件与远程目录，目录一次性创建，随后在同一会话上逐个上传
+    QList<QPair<QString, QString>> uploads;
+    QStringList dirs;
     QDirIterator it(localPath, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
         QDirIterator::Subdirectories);
     while (it.hasNext()) {
@@ -378,30 +384,56 @@ void FtpManager::uploadFolder(const QString& localPath, const QString& remoteBas
             QString filePath = fi.absolutePath();
             QString relPath = localDir.relativeFilePath(filePath);
             QString remoteFile = remoteBasePath + "/" + localDir.dirName() + "/" + relPath;
-            uploadFile(fi.absoluteFilePath(), remoteFile);
+            uploads.append(qMakePair(fi.absoluteFilePath(), remoteFile));
+            // 与 uploadFile 内 buildRemoteFilePath 的规范化保持一致
+            const QString dir = remoteParentDir(buildRemoteFilePath(remoteFile, fi.absoluteFilePath()));
+            if (!dir.isEmpty() && !dirs.contains(dir)) dirs << dir;
         }
     }
+
+    CURL* curl = session();
+    if (!curl) {
+        throw std::runtime_error("curl_easy_init() 失败");
+    }
+    const std::string userPass = (m_user + ":" + m_pass).toStdString();
+    curl_easy_setopt(curl, CURLOPT_USERPWD, userPass.c_str());
+    curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
+    CURLcode res = ensureRemoteDirs(curl, m_host, m_port, m_knownDirs, dirs);
+    RemoteTreeCache::instance().invalidate(cacheKey(), remoteBasePath, true);
+    if (res != CURLE_OK) {
+        std::string errorMsg = "创建远程目录失败: ";
+        errorMsg += curl_easy_strerror(res);
+        throw std::runtime_error(errorMsg);
+    }
+
+    for (const auto& upload : uploads) {
+        uploadFile(upload.first, upload.second);
+    }
 }
 
-void FtpManager::clearRemoteDirectory(const QString& remoteDir) {
+FtpTreeStats FtpManager::clearRemoteDirectory(const QString& remoteDir) {
+    m_knownDirs.clear();  // 目录可能被删除，已知目录缓存作废
     QString cleanDir = remoteDir;
-    if (cleanDir.startsWith('/')) cleanDir = cleanDir.mid(1);
-    if (cleanDir.endsWith('/')) cleanDir.chop(1);
+    while (cleanDir.startsWith('/')) cleanDir = cleanDir.mid(1);
+    while (cleanDir.endsWith('/')) cleanDir.chop(1);
     if (cleanDir.isEmpty()) {
         throw std::runtime_error("不能清空根目录 '/'");
     }
 
-    // 列出目录内容并逐一删除
-    QStringList entries = listFtpDirectory(cleanDir);
-    for (const QString& entry : entries) {
-        // 跳过 . 和 ..
-        if (entry == "." || entry == "..") continue;
-
-        // 尝试作为文件删除，失败则尝试作为目录删除
-        if (!deleteFtpFile(cleanDir, entry)) {
-            deleteFtpDirectory(cleanDir, entry);
-        }
+    // 递归清空：每个目录只列一次，删除按批走 QUOTE 序列，多个目录/批次并行
+    const std::string base = QString("ftp://%1:%2").arg(m_host).arg(m_port).toStdString();
+    const std::string userPwd = (m_user + ":" + m_pass).toStdString();
+    FtpRemoteTree tree(base, [userPwd](CURL* curl) {
+        curl_easy_setopt(curl, CURLOPT_USERPWD, userPwd.c_str());
+        curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    });
+    const bool ok = tree.clear(cleanDir.toStdString());
+    RemoteTreeCache::instance().invalidate(cacheKey(), cleanDir, true);
+    if (!ok) {
+        throw std::runtime_error(tree.lastError());
     }
+    return tree.stats();
 }
 
 bool FtpManager::deleteFtpFile(const QString& parentDir, const QString& filename) {
@@ -440,10 +472,12 @@ bool FtpManager::deleteFtpFile(const QString& parentDir, const QString& filename
     curl_slist_free_all(commands);
     curl_easy_cleanup(curl);
 
+    if (res == CURLE_OK) RemoteTreeCache::instance().invalidate(cacheKey(), parentDir);
     return res == CURLE_OK;
 }
 
 bool FtpManager::deleteFtpDirectory(const QString& parentDir, const QString& dirname) {
+    m_knownDirs.clear();  // 目录可能被删除，已知目录缓存作废
     // 构建完整的 FTP URL
     QString cleanDir = parentDir;
     if (!cleanDir.startsWith('/')) cleanDir.prepend('/');
@@ -479,6 +513,10 @@ bool FtpManager::deleteFtpDirectory(const QString& parentDir, const QString& dir
     curl_slist_free_all(commands);
     curl_easy_cleanup(curl);
 
+    if (res == CURLE_OK) {
+        RemoteTreeCache::instance().invalidate(cacheKey(), parentDir + "/" + dirname, true);
+        RemoteTreeCache::instance().invalidate(cacheKey(), parentDir);
+    }
     return res == CURLE_OK;
 }
 
@@ -518,6 +556,10 @@ bool FtpManager::renameFtpFile(const QString& parentDir, const QString& oldName,
     curl_slist_free_all(commands);
     curl_easy_cleanup(curl);
 
+    if (res == CURLE_OK) {
+        RemoteTreeCache::instance().invalidate(cacheKey(), parentDir + "/" + oldName, true);
+        RemoteTreeCache::instance().invalidate(cacheKey(), parentDir);
+    }
     return res == CURLE_OK;
 }
 
@@ -534,7 +576,8 @@ QList<FtpFileInfo> FtpManager::listFtpDirectoryDetailed(const QString& remoteDir
     // 构建完整的 FTP URL
     QString cleanDir = remoteDir;
     if (!cleanDir.startsWith('/')) cleanDir.prepend('/');
-    
+    if (!cleanDir.endsWith('/')) cleanDir += '/';
+
     QUrl url;
     url.setScheme("ftp");
     url.setHost(m_host);
@@ -542,59 +585,102 @@ QList<FtpFileInfo> FtpManager::listFtpDirectoryDetailed(const QString& remoteDir
     url.setPath(cleanDir);
     QString urlStr = url.toString(QUrl::FullyEncoded);
     QByteArray urlBytes = urlStr.toUtf8();
+    const std::string userPass = (m_user + ":" + m_pass).toStdString();
 
-    // 用于接收目录列表数据的缓冲区
-    QByteArray buffer;
+    // MLSD 支持情况按服务器记录：每次刷新都会新建 FtpManager，不能只记在实例上
+    RemoteTreeCache& cache = RemoteTreeCache::instance();
+    const QString server = QString("%1:%2").arg(m_host).arg(m_port);
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("curl_easy_init() 失败");
-    }
+    for (;;) {
+        // 优先 MLSD（类型/大小/时间为机器可读格式），服务器不支持时回退 LIST
+        const int support = cache.mlsdSupport(server);
+        const bool mlsd = support != 0;
 
-    // 设置 FTP LIST 选项
-    curl_easy_setopt(curl, CURLOPT_URL, urlBytes.constData());
-    curl_easy_setopt(curl, CURLOPT_USERPWD, (m_user + ":" + m_pass).toStdString().c_str());
-    curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, listWriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
-    curl_easy_setopt(curl, CURLOPT_DIRLISTONLY, 0L);  // 获取详细列表
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+        // 用于接收目录列表数据的缓冲区
+        QByteArray buffer;
 
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            throw std::runtime_error("curl_easy_init() 失败");
+        }
 
-    if (res != CURLE_OK) {
-        std::string errorMsg = "libcurl 列目录失败 (";
-        errorMsg += std::to_string(res);
-        errorMsg += "): ";
-        errorMsg += curl_easy_strerror(res);
-        throw std::runtime_error(errorMsg);
+        curl_easy_setopt(curl, CURLOPT_URL, urlBytes.constData());
+        curl_easy_setopt(curl, CURLOPT_USERPWD, userPass.c_str());
+        curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, listWriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
+        curl_easy_setopt(curl, CURLOPT_DIRLISTONLY, 0L);  // 获取详细列表
+        if (mlsd) curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "MLSD");
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+
+        CURLcode res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+
+        if (res != CURLE_OK) {
+            if (mlsd && support < 0) {
+                cache.setMlsdSupport(server, false);
+                continue;
+            }
+            std::string errorMsg = "libcurl 列目录失败 (";
+            errorMsg += std::to_string(res);
+            errorMsg += "): ";
+            errorMsg += curl_easy_strerror(res);
+            throw std::runtime_error(errorMsg);
+        }
+        if (mlsd && support < 0) cache.setMlsdSupport(server, true);
+
+        cleanDir.chop(1);
+        FtpListParser parser(mlsd ? FtpListParser::Format::Mlsd : FtpListParser::Format::List);
+        return parser.parse(buffer, cleanDir.isEmpty() ? QStringLiteral("/") : cleanDir);
     }
+}
+
+QList<FtpFileInfo> FtpManager::listFtpDirectoryCached(const QString& remoteDir, bool forceRefresh,
+                                                      RemoteTreeCache::Delta* delta) {
+    return RemoteTreeCache::instance().list(cacheKey(), remoteDir,
+        [this](const QString& dir) { return listFtpDirectoryDetailed(dir); },
+        forceRefresh, delta);
+}
 
-    // 解析目录列表
-    QList<FtpFileInfo> result;
-    QString listData = QString::fromUtf8(buffer);
-    QStringList lines = listData.split('\n', Qt::SkipEmptyParts);
+QString FtpManager::cacheKey() const {
+    return QString("%1@%2:%3").arg(m_user, m_host).arg(m_port);
+}
 
-    for (const QString& line : lines) {
-        FtpFileInfo info;
-        info.remotePath = cleanDir;
-        info.name = parseListFilename(line);
-        info.size = parseListSize(line);
-        info.lastModified = parseListTime(line);
-        info.isDirectory = parseListIsDir(line);
-        info.permissions = parseListPermissions(line);
+// 下载进度：续传时 curl 只报告本次的量，加上起点换算为整文件进度
+struct DownloadProgress {
+    FtpManager::ProgressCallback callback;
+    qint64 offset = 0;
+};
 
-        if (!info.name.isEmpty()) {
-            result.append(info);
-        }
+static int downloadProgressCallback(void* clientp, curl_off_t dltotal, curl_off_t dlnow,
+                                    curl_off_t /*ultotal*/, curl_off_t /*ulnow*/) {
+    auto* p = static_cast<DownloadProgress*>(clientp);
+    if (p->callback && dltotal > 0) {
+        p->callback(p->offset + static_cast<qint64>(dlnow), p->offset + static_cast<qint64>(dltotal));
     }
+    return 0;
+}
 
-    return result;
+// 网络中断/超时类错误可以续传；认证、路径错误重试无意义
+static bool isResumableError(CURLcode res) {
+    switch (res) {
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_GOT_NOTHING:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_FTP_ACCEPT_TIMEOUT:
+    case CURLE_FTP_CANT_GET_HOST:
+    case CURLE_FTP_WEIRD_PASV_REPLY:
+        return true;
+    default:
+        return false;
+    }
 }
 
-void FtpManager::downloadFile(const QString& remotePath, const QString& localPath,
+qint64 FtpManager::downloadFile(const QString& remotePath, const QString& localPath,
     const ProgressCallback& progress) {
     
     // 构建完整的 FTP URL
@@ -606,73 +692,121 @@ void FtpManager::downloadFile(const QString& remotePath, const QString& localPat
     QString urlStr = url.toString(QUrl::FullyEncoded);
     QByteArray urlBytes = urlStr.toUtf8();
 
-    // 打开本地文件用于写入
-    QFile file(localPath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        throw std::runtime_error("无法打开本地文件: " + localPath.toStdString());
-    }
-
     CURL* curl = curl_easy_init();
     if (!curl) {
-        file.close();
         throw std::runtime_error("curl_easy_init() 失败");
     }
 
-    // 设置下载选项
-    curl_easy_setopt(curl, CURLOPT_URL, urlBytes.constData());
-    curl_easy_setopt(curl, CURLOPT_USERPWD, (m_user + ":" + m_pass).toStdString().c_str());
+    const std::string userPass = (m_user + ":" + m_pass).toStdString();
+    curl_easy_setopt(curl, CURLOPT_USERPWD, userPass.c_str());
     curl_easy_setopt(curl, CURLOPT_PROTOCOLS_STR, "ftp,ftps");
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeData);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &file);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
     curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
 
-    // 设置进度回调
+    // 先以 SIZE + MDTM 取远端大小与修改时间，用于续传判断与最终校验（服务器不支持时为 -1）
+    curl_off_t expected = -1;
+    curl_off_t mtime = -1;
+    curl_easy_setopt(curl, CURLOPT_URL, urlBytes.constData());
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    if (curl_easy_perform(curl) == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &expected);
+        curl_easy_getinfo(curl, CURLINFO_FILETIME_T, &mtime);
+    }
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 0L);
+    curl_easy_setopt(curl, CURLOPT_FILETIME, 0L);
+
+    // 总超时改为停滞判定：链路 60 秒无数据才失败，大文件不会因耗时长被中断
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 0L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeData);
+
+    DownloadProgress prog{ progress, 0 };
     if (progress) {
-        // 创建回调包装器
-        struct ProgressWrapper {
-            ProgressCallback callback;
-        };
-        ProgressWrapper* wrapper = new ProgressWrapper{progress};
-        
-        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, [](void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) -> int {
-            auto* w = static_cast<ProgressWrapper*>(clientp);
-            if (w->callback && dltotal > 0) {
-                w->callback(static_cast<qint64>(dlnow), static_cast<qint64>(dltotal));
-            }
-            return 0;
-        });
-        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, wrapper);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, downloadProgressCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &prog);
         curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
-        
-        // 执行下载
-        CURLcode res = curl_easy_perform(curl);
-        
-        delete wrapper;
-        file.close();
-        curl_easy_cleanup(curl);
+    }
 
-        if (res != CURLE_OK) {
-            std::string errorMsg = "libcurl 下载失败 (";
-            errorMsg += std::to_string(res);
-            errorMsg += "): ";
-            errorMsg += curl_easy_strerror(res);
-            throw std::runtime_error(errorMsg);
+    // 写入 .part 临时文件，中断后从其长度续传（REST）；校验大小后再替换目标文件。
+    // 旁路 .part.meta 记录远端大小与修改时间：两者都与当前一致才信任残留的 .part，
+    // 任一未知或不一致（远端已换版本）则丢弃，从头下载
+    const QString partPath = localPath + ".part";
+    const QString metaPath = partPath + ".meta";
+    const QByteArray version = QByteArray::number(static_cast<qint64>(expected)) + ' '
+                             + QByteArray::number(static_cast<qint64>(mtime));
+    const bool versionKnown = expected >= 0 && mtime >= 0;
+    QFile meta(metaPath);
+    const bool sameVersion = versionKnown && meta.open(QIODevice::ReadOnly)
+                          && meta.readAll().trimmed() == version;
+    meta.close();
+    if (!sameVersion) {
+        QFile::remove(partPath);
+        QFile::remove(metaPath);
+        if (versionKnown && meta.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            meta.write(version + '\n');
+            meta.close();
         }
-    } else {
-        // 无进度回调
-        CURLcode res = curl_easy_perform(curl);
-        file.close();
-        curl_easy_cleanup(curl);
+    }
 
-        if (res != CURLE_OK) {
-            std::string errorMsg = "libcurl 下载失败 (";
-            errorMsg += std::to_string(res);
-            errorMsg += "): ";
-            errorMsg += curl_easy_strerror(res);
-            throw std::runtime_error(errorMsg);
+    const int kMaxAttempts = 5;
+    qint64 resumedFrom = 0;
+    CURLcode res = CURLE_OK;
+
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+        if (attempt > 0) {
+            QThread::sleep(static_cast<unsigned long>(attempt));
         }
+
+        qint64 offset = QFileInfo::exists(partPath) ? QFileInfo(partPath).size() : 0;
+        if (expected >= 0 && offset > expected) offset = 0;
+        if (attempt == 0) resumedFrom = offset;
+
+        if (expected > 0 && offset == expected) {
+            res = CURLE_OK;
+            break;  // 同一版本上次已完整下载，只差改名
+        }
+
+        QFile file(partPath);
+        if (!file.open(offset > 0 ? (QIODevice::WriteOnly | QIODevice::Append)
+                                  : (QIODevice::WriteOnly | QIODevice::Truncate))) {
+            curl_easy_cleanup(curl);
+            throw std::runtime_error("无法打开本地文件: " + localPath.toStdString());
+        }
+
+        prog.offset = offset;
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &file);
+        curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(offset));
+
+        res = curl_easy_perform(curl);
+        file.close();
+        if (res == CURLE_OK || !isResumableError(res)) break;
+    }
+    curl_easy_cleanup(curl);
+
+    if (res != CURLE_OK) {
+        std::string errorMsg = "libcurl 下载失败 (";
+        errorMsg += std::to_string(res);
+        errorMsg += "): ";
+        errorMsg += curl_easy_strerror(res);
+        throw std::runtime_error(errorMsg);
+    }
+
+    if (expected >= 0 && QFileInfo(partPath).size() != expected) {
+        // 内容已不可信，不留给下次续传
+        QFile::remove(partPath);
+        QFile::remove(metaPath);
+        throw std::runtime_error("下载校验失败: 本地大小与远端不一致");
+    }
+
+    QFile::remove(localPath);
+    if (!QFile::rename(partPath, localPath)) {
+        throw std::runtime_error("下载完成但重命名失败: " + localPath.toStdString());
     }
+    QFile::remove(metaPath);
+    return resumedFrom;
 }
 
 size_t FtpManager::progressCallback(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
@@ -4,17 +4,12 @@
 #include <QFile>
 #include <QList>
 #include <QDateTime>
+#include <QSet>
 #include <functional>
 #include <curl/curl.h>
-
-struct FtpFileInfo {
-    QString remotePath;
-    QString name;
-    QDateTime lastModified;
-    qint64 size = -1;
-    bool isDirectory = false;
-    QString permissions; // FTP LIST 权限字符串（首字符 d=目录, -=文件）
-};
+#include "../adapter/FtpRemoteTree.h"
+#include "FtpListParser.h"
+#include "RemoteTreeCache.h"
 
 class FtpManager {
 public:
@@ -23,6 +18,10 @@ public:
     explicit FtpManager(const QString& host = "", quint16 port = 21);
     ~FtpManager();
 
+    // 持有持久 curl 会话，禁止拷贝
+    FtpManager(const FtpManager&) = delete;
+    FtpManager& operator=(const FtpManager&) = delete;
+
     void setCredentials(const QString& user, const QString& pass);
     void clearCredentials();
     void setHost(const QString& host, quint16 port);
@@ -35,15 +34,24 @@ public:
         const ProgressCallback& progress = {});
     void uploadFolder(const QString& localPath, const QString& remoteBasePath);
 
-    void clearRemoteDirectory(const QString& remoteDir);
+    // 递归清空远程目录内容（保留目录本身）；有条目删不掉时抛出 std::runtime_error
+    FtpTreeStats clearRemoteDirectory(const QString& remoteDir);
     bool deleteFtpFile(const QString& parentDir, const QString& filename);
     bool deleteFtpDirectory(const QString& parentDir, const QString& dirname);
     bool renameFtpFile(const QString& parentDir, const QString& oldName,
                        const QString& newName);
     QStringList listFtpDirectory(const QString& remoteDir);
     QList<FtpFileInfo> listFtpDirectoryDetailed(const QString& remoteDir);
+    // 经 RemoteTreeCache 的目录列表：TTL 内直接返回缓存，过期时增量刷新
+    QList<FtpFileInfo> listFtpDirectoryCached(const QString& remoteDir, bool forceRefresh = false,
+                                              RemoteTreeCache::Delta* delta = nullptr);
+    // 远程树缓存中本设备的键（user@host:port）
+    QString cacheKey() const;
 
-    void downloadFile(const QString& remotePath, const QString& localPath,
+    // 断点续传下载：先写 localPath.part，中断后从已下载长度续传，校验远端大小后改名；
+    // 残留的 .part 仅在远端大小与修改时间都与 .part.meta 记录一致时复用
+    // 返回本次调用开始时复用的已下载字节数（0 = 全新下载）
+    qint64 downloadFile(const QString& remotePath, const QString& localPath,
         const ProgressCallback& progress = {});
     static size_t progressCallback(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 
@@ -52,9 +60,15 @@ private:
     bool uploadToTarget(const QString& target, const QStringList& items, const QString& remotePath,
         const QString& user, const QString& pass);
 
+    // 持久会话：uploadFile/uploadFolder 复用同一句柄与已登录的控制连接
+    CURL* session();
+    void closeSession();
+
 private:
     QString m_host;
     quint16 m_port;
     QString m_user;
     QString m_pass;
+    CURL* m_session = nullptr;
+    QSet<QString> m_knownDirs;  // 当前会话内已创建/确认存在的远程目录
 };
@@ -0,0 +1,184 @@
+#include "LocalHashIndex.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrent>
+#include <vector>
+
+static const quint32 kIndexMagic = 0x48494458; // "HIDX"
+static const quint32 kIndexVersion = 1;
+
+LocalHashIndex& LocalHashIndex::instance()
+{
+    static LocalHashIndex s([] {
+        const QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(base);
+        return base + QStringLiteral("/hash_index.bin");
+    }());
+    return s;
+}
+
+LocalHashIndex::LocalHashIndex(const QString& indexPath)
+    : m_indexPath(indexPath)
+{
+    load();
+}
+
+QString LocalHashIndex::computeHash(const QString& filePath, qint64* bytesRead)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const qint64 size = file.size();
+
+    if (size >= kMapThreshold) {
+        // 大文件：内存映射后分段喂给哈希，避免整块读入堆内存
+        if (uchar* data = file.map(0, size)) {
+            const qint64 kChunk = 8 << 20;
+            for (qint64 off = 0; off < size; off += kChunk) {
+                const qint64 n = qMin(kChunk, size - off);
+                hash.addData(QByteArrayView(reinterpret_cast<const char*>(data + off), n));
+            }
+            file.unmap(data);
+            if (bytesRead) *bytesRead = size;
+            return QString::fromLatin1(hash.result().toHex());
+        }
+        // 映射失败（如网络盘）→ 退回流式读取
+    }
+
+    if (!hash.addData(&file)) return QString();
+    if (bytesRead) *bytesRead = size;
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString LocalHashIndex::hashOf(const QString& filePath)
+{
+    const QFileInfo fi(filePath);
+    if (!fi.isFile()) return QString();
+
+    const QString key = fi.absoluteFilePath();
+    const qint64 size = fi.size();
+    const qint64 mtimeMs = fi.lastModified().toMSecsSinceEpoch();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.constFind(key);
+        if (it != m_entries.constEnd() && it->size == size && it->mtimeMs == mtimeMs) {
+            m_stats.hits++;
+            return it->hash;
+        }
+    }
+
+    // 锁外计算，允许多个线程同时哈希不同文件
+    qint64 bytes = 0;
+    const QString h = computeHash(key, &bytes);
+    if (h.isEmpty()) return h;
+
+    QMutexLocker locker(&m_mutex);
+    m_stats.misses++;
+    m_stats.bytesHashed += bytes;
+    m_entries.insert(key, Entry{ size, mtimeMs, h });
+    m_dirty = true;
+    return h;
+}
+
+QHash<QString, QString> LocalHashIndex::hashAll(const QStringList& filePaths)
+{
+    std::vector<QString> results(static_cast<size_t>(filePaths.size()));
+    std::vector<int> indices(static_cast<size_t>(filePaths.size()));
+    for (int i = 0; i < filePaths.size(); ++i) indices[static_cast<size_t>(i)] = i;
+
+    QtConcurrent::blockingMap(indices, [&](int i) {
+        results[static_cast<size_t>(i)] = hashOf(filePaths.at(i));
+    });
+
+    QHash<QString, QString> out;
+    out.reserve(filePaths.size());
+    for (int i = 0; i < filePaths.size(); ++i) {
+        if (!results[static_cast<size_t>(i)].isEmpty()) {
+            out.insert(filePaths.at(i), results[static_cast<size_t>(i)]);
+        }
+    }
+    return out;
+}
+
+bool LocalHashIndex::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_indexPath.isEmpty() || !m_dirty) return true;
+
+    // QSaveFile：写完再原子替换，中途崩溃不损坏旧索引
+    QSaveFile file(m_indexPath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kIndexMagic << kIndexVersion << static_cast<quint32>(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        out << it.key() << it->size << it->mtimeMs << it->hash;
+    }
+    if (out.status() != QDataStream::Ok || !file.commit()) return false;
+
+    m_dirty = false;
+    return true;
+}
+
+bool LocalHashIndex::load()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_dirty = false;
+    if (m_indexPath.isEmpty()) return true;
+
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version >> count;
+    if (magic != kIndexMagic || version != kIndexVersion) return false;
+
+    m_entries.reserve(static_cast<qsizetype>(count));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        Entry e;
+        in >> key >> e.size >> e.mtimeMs >> e.hash;
+        if (in.status() == QDataStream::Ok) m_entries.insert(key, e);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+int LocalHashIndex::prune()
+{
+    QMutexLocker locker(&m_mutex);
+    int removed = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!QFileInfo::exists(it.key())) {
+            it = m_entries.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    if (removed > 0) m_dirty = true;
+    return removed;
+}
+
+LocalHashIndex::Stats LocalHashIndex::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+int LocalHashIndex::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_entries.size());
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+
+// 本地文件内容哈希索引：(绝对路径, 大小, 修改时间) → MD5
+// 文件大小与修改时间均未变时直接复用缓存，不再重新读取文件；
+// 索引持久化到 AppDataLocation/hash_index.bin，跨会话有效。线程安全。
+class LocalHashIndex {
+public:
+    // 进程级默认索引（首次访问时从默认位置加载）
+    static LocalHashIndex& instance();
+
+    // 测试可指定索引文件路径；空路径 → 不持久化
+    explicit LocalHashIndex(const QString& indexPath);
+    ~LocalHashIndex() = default;
+
+    LocalHashIndex(const LocalHashIndex&) = delete;
+    LocalHashIndex& operator=(const LocalHashIndex&) = delete;
+
+    // 取单个文件哈希（MD5 小写十六进制），文件不可读返回空串
+    QString hashOf(const QString& filePath);
+
+    // 批量取哈希：未命中的文件在全局线程池中并行计算
+    QHash<QString, QString> hashAll(const QStringList& filePaths);
+
+    // 持久化（仅在有变更时写盘）/ 重新加载
+    bool save();
+    bool load();
+
+    // 移除已不存在的文件条目，返回移除数
+    int prune();
+
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 bytesHashed = 0;
+    };
+    Stats stats() const;
+    int size() const;
+
+    // 直接计算文件哈希（大文件内存映射读取），不经过缓存
+    static QString computeHash(const QString& filePath, qint64* bytesRead = nullptr);
+
+    // 超过此大小的文件使用内存映射
+    static constexpr qint64 kMapThreshold = 1 << 20;
+
+private:
+    struct Entry {
+        qint64 size = -1;
+        qint64 mtimeMs = 0;
+        QString hash;
+    };
+
+    QString m_indexPath;
+    QHash<QString, Entry> m_entries;   // key: 绝对路径
+    Stats m_stats;
+    bool m_dirty = false;
+    mutable QMutex m_mutex;
+};
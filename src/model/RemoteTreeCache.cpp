@@ -0,0 +1,173 @@
+#include "RemoteTreeCache.h"
+#include <QMutexLocker>
+
+RemoteTreeCache& RemoteTreeCache::instance()
+{
+    static RemoteTreeCache cache;
+    return cache;
+}
+
+RemoteTreeCache::RemoteTreeCache(qint64 ttlMs)
+    : m_ttlMs(ttlMs)
+{
+    m_clock.start();
+}
+
+void RemoteTreeCache::setTtl(qint64 ttlMs)
+{
+    QMutexLocker lock(&m_mutex);
+    m_ttlMs = ttlMs;
+}
+
+qint64 RemoteTreeCache::ttl() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_ttlMs;
+}
+
+QString RemoteTreeCache::normalize(const QString& dir)
+{
+    int b = 0, e = dir.size();
+    while (b < e && dir[b] == QLatin1Char('/')) ++b;
+    while (e > b && dir[e - 1] == QLatin1Char('/')) --e;
+    return (b == 0 && e == dir.size()) ? dir : dir.mid(b, e - b);
+}
+
+QString RemoteTreeCache::childPath(const QString& dir, const QString& name)
+{
+    return dir.isEmpty() ? name : dir + QLatin1Char('/') + name;
+}
+
+void RemoteTreeCache::dropSubtree(DirMap& dirs, const QString& dir)
+{
+    const QString prefix = dir.isEmpty() ? QString() : dir + QLatin1Char('/');
+    for (auto it = dirs.begin(); it != dirs.end();) {
+        if (it.key() == dir || it.key().startsWith(prefix)) {
+            it = dirs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QList<FtpFileInfo> RemoteTreeCache::list(const QString& device, const QString& dir,
+                                         const Lister& lister, bool forceRefresh, Delta* delta)
+{
+    const QString key = normalize(dir);
+    {
+        QMutexLocker lock(&m_mutex);
+        const auto dev = m_devices.constFind(device);
+        if (!forceRefresh && dev != m_devices.constEnd()) {
+            const auto node = dev->constFind(key);
+            if (node != dev->constEnd() && !node->stale
+                && m_clock.elapsed() - node->fetchedAt < m_ttlMs) {
+                if (delta) {
+                    *delta = Delta();
+                    delta->fromCache = true;
+                }
+                return node->entries;
+            }
+        }
+    }
+
+    // 访问服务器不持锁，其它目录的查询不受阻塞
+    QList<FtpFileInfo> fresh = lister(key);
+
+    QMutexLocker lock(&m_mutex);
+    DirMap& dirs = m_devices[device];
+    Delta d;
+
+    const auto old = dirs.constFind(key);
+    if (old != dirs.constEnd()) {
+        // 持有旧列表副本（隐式共享）：下面删除子树会移动哈希表中的节点
+        const QList<FtpFileInfo> previous = old->entries;
+        QHash<QString, const FtpFileInfo*> before;
+        before.reserve(previous.size());
+        for (const auto& e : previous) before.insert(e.name, &e);
+
+        for (const auto& e : fresh) {
+            const auto prev = before.find(e.name);
+            if (prev == before.end()) {
+                d.added++;
+                continue;
+            }
+            const FtpFileInfo* p = prev.value();
+            if (p->isDirectory && !e.isDirectory) {
+                dropSubtree(dirs, childPath(key, e.name));
+            } else if (p->isDirectory && e.lastModified != p->lastModified) {
+                // 子目录内容可能已变：标记过期，未变的子目录缓存保留
+                const auto child = dirs.find(childPath(key, e.name));
+                if (child != dirs.end()) child->stale = true;
+            }
+            if (p->size != e.size || p->lastModified != e.lastModified
+                || p->isDirectory != e.isDirectory) {
+                d.changed++;
+            }
+            before.erase(prev);
+        }
+        d.removed = before.size();
+        for (auto it = before.cbegin(); it != before.cend(); ++it) {
+            if (it.value()->isDirectory) dropSubtree(dirs, childPath(key, it.key()));
+        }
+    } else {
+        d.added = fresh.size();
+    }
+
+    Node& node = dirs[key];
+    node.entries = fresh;
+    node.fetchedAt = m_clock.elapsed();
+    node.stale = false;
+    if (delta) *delta = d;
+    return fresh;
+}
+
+bool RemoteTreeCache::peek(const QString& device, const QString& dir, QList<FtpFileInfo>& out) const
+{
+    QMutexLocker lock(&m_mutex);
+    const auto dev = m_devices.constFind(device);
+    if (dev == m_devices.constEnd()) return false;
+    const auto node = dev->constFind(normalize(dir));
+    if (node == dev->constEnd()) return false;
+    out = node->entries;
+    return true;
+}
+
+void RemoteTreeCache::invalidate(const QString& device, const QString& dir, bool recursive)
+{
+    QMutexLocker lock(&m_mutex);
+    const auto dev = m_devices.find(device);
+    if (dev == m_devices.end()) return;
+    const QString key = normalize(dir);
+    if (recursive) {
+        dropSubtree(*dev, key);
+        return;
+    }
+    const auto node = dev->find(key);
+    if (node != dev->end()) node->stale = true;
+}
+
+void RemoteTreeCache::invalidateDevice(const QString& device)
+{
+    QMutexLocker lock(&m_mutex);
+    m_devices.remove(device);
+}
+
+void RemoteTreeCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_devices.clear();
+    m_mlsd.clear();
+}
+
+int RemoteTreeCache::mlsdSupport(const QString& server) const
+{
+    QMutexLocker lock(&m_mutex);
+    const auto it = m_mlsd.constFind(server);
+    return it == m_mlsd.constEnd() ? -1 : (*it ? 1 : 0);
+}
+
+void RemoteTreeCache::setMlsdSupport(const QString& server, bool supported)
+{
+    QMutexLocker lock(&m_mutex);
+    m_mlsd.insert(server, supported);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "FtpListParser.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <functional>
+
+// 远程目录树缓存：按 (设备, 目录) 缓存目录列表，TTL 内直接复用，不再访问服务器。
+// 刷新某个目录时与旧列表比对（增量刷新）：
+//   - 消失（或变成文件）的子目录连同其子树缓存一并丢弃
+//   - 修改时间变化的子目录标记为过期，下次访问时重新列出
+//   - 其余子目录的缓存保持有效
+// 本程序自身改动远程目录（上传/删除/重命名）后应调用 invalidate。线程安全。
+class RemoteTreeCache {
+public:
+    // 列出单个目录；失败时抛出异常（原样传给调用者，缓存不变）
+    using Lister = std::function<QList<FtpFileInfo>(const QString& dir)>;
+
+    // 一次 list() 的结果相对旧缓存的变化
+    struct Delta {
+        bool fromCache = false;   // 命中缓存，未访问服务器
+        int added = 0;
+        int removed = 0;
+        int changed = 0;          // 大小或修改时间变化
+    };
+
+    static constexpr qint64 kDefaultTtlMs = 30 * 1000;
+
+    // 进程级默认缓存
+    static RemoteTreeCache& instance();
+
+    explicit RemoteTreeCache(qint64 ttlMs = kDefaultTtlMs);
+
+    RemoteTreeCache(const RemoteTreeCache&) = delete;
+    RemoteTreeCache& operator=(const RemoteTreeCache&) = delete;
+
+    void setTtl(qint64 ttlMs);
+    qint64 ttl() const;
+
+    // TTL 内且未过期时返回缓存；否则调用 lister 重新列出并增量更新子树
+    QList<FtpFileInfo> list(const QString& device, const QString& dir, const Lister& lister,
+                            bool forceRefresh = false, Delta* delta = nullptr);
+
+    // 只查缓存（不论是否过期），未缓存返回 false
+    bool peek(const QString& device, const QString& dir, QList<FtpFileInfo>& out) const;
+
+    // 标记目录过期；recursive 时连同其子树一并丢弃
+    void invalidate(const QString& device, const QString& dir, bool recursive = false);
+    void invalidateDevice(const QString& device);
+    void clear();
+
+    // 服务器是否支持 MLSD（按 host:port 记录，跨 FtpManager 实例复用）：
+    // -1 未知 / 0 否 / 1 是；目录缓存失效不影响此记录，clear() 时一并清除
+    int mlsdSupport(const QString& server) const;
+    void setMlsdSupport(const QString& server, bool supported);
+
+    // 目录路径规范化："/a/b/" → "a/b"，根目录为空串
+    static QString normalize(const QString& dir);
+
+private:
+    struct Node {
+        QList<FtpFileInfo> entries;
+        qint64 fetchedAt = 0;
+        bool stale = false;
+    };
+    using DirMap = QHash<QString, Node>;
+
+    static QString childPath(const QString& dir, const QString& name);
+    static void dropSubtree(DirMap& dirs, const QString& dir);
+
+    mutable QMutex m_mutex;
+    QHash<QString, DirMap> m_devices;   // 设备 → (目录 → 列表)
+    QHash<QString, bool> m_mlsd;        // host:port → 是否支持 MLSD
+    qint64 m_ttlMs;
+    QElapsedTimer m_clock;
+};
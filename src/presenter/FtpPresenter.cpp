@@ -48,10 +48,13 @@ void FtpPresenter::onEventPosted(const DeployEvent& event) {
                 try {
                     FtpManager cleaner(host, 21);
                     cleaner.setCredentials(user, pass);
-                    cleaner.clearRemoteDirectory(remotePath);
+                    const FtpTreeStats stats = cleaner.clearRemoteDirectory(remotePath);
                     EventBus::instance()->postEvent(
                         DeployEvent(DeployEvent::LogMessage,
-                            QString("🧹 已清空 %1:%2").arg(host).arg(remotePath)));
+                            QString("🧹 已清空 %1:%2（%3 个文件、%4 个目录，列目录 %5 次，耗时 %6 ms）")
+                                .arg(host).arg(remotePath)
+                                .arg(stats.filesDeleted).arg(stats.dirsDeleted)
+                                .arg(stats.dirsListed).arg(stats.totalMs)));
                 } catch (const std::exception& ex) {
                     EventBus::instance()->postEvent(
                         DeployEvent(DeployEvent::LogMessage,
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ArchiveStager.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 压缩包部署暂存实现 — ustar 打包 + 分块并行 gzip。
+ */
+
+#include "ArchiveStager.h"
+#include <QByteArray>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <set>
+
+// ============================================================================
+// CRC-32
+// ============================================================================
+
+uint32_t ArchiveStager::crc32(const char* data, size_t len, uint32_t crc)
+{
+    static const auto table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+namespace {
+
+const size_t kTarBlock = 512;
+
+// ============================================================================
+// tar（ustar + GNU 长路径扩展）
+// ============================================================================
+
+// 八进制数字段（width 含结尾 '\0'）；超出范围时使用 GNU base-256 编码
+void putNumber(char* field, size_t width, uint64_t value)
+{
+    const uint64_t limit = uint64_t(1) << (3 * (width - 1));
+    if (value < limit) {
+        field[width - 1] = '\0';
+        for (size_t i = width - 1; i-- > 0;) {
+            field[i] = static_cast<char>('0' + (value & 7));
+            value >>= 3;
+        }
+    } else {
+        std::memset(field, 0, width);
+        field[0] = static_cast<char>(0x80);
+        for (size_t i = width - 1; i > 0 && value; --i) {
+            field[i] = static_cast<char>(value & 0xFF);
+            value >>= 8;
+        }
+    }
+}
+
+void makeHeader(char* h, const std::string& name, const std::string& prefix, uint64_t size,
+                int64_t mtime, char type, unsigned mode)
+{
+    std::memset(h, 0, kTarBlock);
+    std::memcpy(h, name.data(), std::min<size_t>(100, name.size()));
+    putNumber(h + 100, 8, mode);
+    putNumber(h + 108, 8, 0);   // uid
+    putNumber(h + 116, 8, 0);   // gid
+    putNumber(h + 124, 12, size);
+    putNumber(h + 136, 12, mtime > 0 ? static_cast<uint64_t>(mtime) : 0);
+    h[156] = type;
+    std::memcpy(h + 257, "ustar", 6);
+    std::memcpy(h + 263, "00", 2);
+    std::memcpy(h + 345, prefix.data(), std::min<size_t>(155, prefix.size()));
+
+    // 校验和：计算时校验和字段按 8 个空格计
+    std::memset(h + 148, ' ', 8);
+    unsigned sum = 0;
+    for (size_t i = 0; i < kTarBlock; ++i) sum += static_cast<unsigned char>(h[i]);
+    for (int i = 5; i >= 0; --i) {
+        h[148 + i] = static_cast<char>('0' + (sum & 7));
+        sum >>= 3;
+    }
+    h[154] = '\0';
+    h[155] = ' ';
+}
+
+// ustar 路径拆分：name ≤ 100、prefix ≤ 155，在 '/' 处切分
+bool splitUstar(const std::string& path, std::string& prefix, std::string& name)
+{
+    if (path.size() <= 100) {
+        prefix.clear();
+        name = path;
+        return true;
+    }
+    for (size_t pos = path.find('/'); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+        const size_t tail = path.size() - pos - 1;
+        if (tail == 0 || tail > 100) continue;
+        if (pos > 155) return false;
+        prefix = path.substr(0, pos);
+        name = path.substr(pos + 1);
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// gzip 成员：qCompress 输出为 4 字节大端原长 + zlib 流（2 字节头 + deflate + adler32），
+// 取出其中的 deflate 数据，补 gzip 头尾即为独立成员；多成员顺序拼接仍是合法 gzip 文件
+// ============================================================================
+
+void putLe32(QByteArray& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out.append(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+QByteArray gzipMember(const QByteArray& raw, int level)
+{
+    const QByteArray z = qCompress(raw, level);
+    QByteArray out;
+    if (z.size() < 10) return out;
+
+    static const char kHeader[10] = { 0x1f, static_cast<char>(0x8b), 8, 0, 0, 0, 0, 0, 0,
+                                      static_cast<char>(0xff) };
+    out.reserve(z.size() + 8);
+    out.append(kHeader, sizeof(kHeader));
+    out.append(z.constData() + 6, z.size() - 10);
+    putLe32(out, ArchiveStager::crc32(raw.constData(), static_cast<size_t>(raw.size())));
+    putLe32(out, static_cast<uint32_t>(raw.size()));
+    return out;
+}
+
+// 流式打包器：tar 数据攒满一块即提交压缩，结果按提交顺序写出
+class Packer {
+public:
+    Packer(FILE* out, int level)
+        : m_out(out)
+        , m_level(level)
+        , m_window(static_cast<size_t>(std::max(2, QThreadPool::globalInstance()->maxThreadCount() * 2)))
+    {
+        m_block.reserve(static_cast<qsizetype>(ArchiveStager::kBlockSize + kTarBlock));
+    }
+
+    void append(const char* data, size_t len)
+    {
+        m_block.append(data, static_cast<qsizetype>(len));
+        if (static_cast<size_t>(m_block.size()) >= ArchiveStager::kBlockSize) submit();
+    }
+
+    void pad(uint64_t written)
+    {
+        static const char kZeros[kTarBlock] = {};
+        const size_t rem = static_cast<size_t>(written % kTarBlock);
+        if (rem) append(kZeros, kTarBlock - rem);
+    }
+
+    bool finish()
+    {
+        // tar 结尾：两个全零块
+        static const char kZeros[kTarBlock * 2] = {};
+        append(kZeros, sizeof(kZeros));
+        if (!m_block.isEmpty()) submit();
+        drain(0);
+        return !m_failed;
+    }
+
+    // 丢弃在途任务（取消/出错时）
+    void abandon()
+    {
+        for (auto& f : m_inflight) f.waitForFinished();
+        m_inflight.clear();
+    }
+
+    uint64_t written() const { return m_written; }
+    bool failed() const { return m_failed; }
+
+private:
+    void submit()
+    {
+        const int level = m_level;
+        m_inflight.push_back(QtConcurrent::run([raw = std::move(m_block), level] {
+            return gzipMember(raw, level);
+        }));
+        m_block = QByteArray();
+        m_block.reserve(static_cast<qsizetype>(ArchiveStager::kBlockSize + kTarBlock));
+        drain(m_window);
+    }
+
+    void drain(size_t keep)
+    {
+        while (m_inflight.size() > keep) {
+            const QByteArray member = m_inflight.front().result();
+            m_inflight.pop_front();
+            if (m_failed) continue;
+            if (member.isEmpty()
+                || fwrite(member.constData(), 1, static_cast<size_t>(member.size()), m_out)
+                       != static_cast<size_t>(member.size())) {
+                m_failed = true;
+                continue;
+            }
+            m_written += static_cast<uint64_t>(member.size());
+        }
+    }
+
+    FILE* m_out;
+    int m_level;
+    size_t m_window;
+    QByteArray m_block;
+    std::deque<QFuture<QByteArray>> m_inflight;
+    uint64_t m_written = 0;
+    bool m_failed = false;
+};
+
+void appendEntry(Packer& packer, const std::string& path, uint64_t size, int64_t mtime,
+                 char type, unsigned mode)
+{
+    char header[kTarBlock];
+    std::string prefix, name;
+    if (!splitUstar(path, prefix, name)) {
+        // GNU 长路径：先写 ././@LongLink 条目承载完整路径
+        makeHeader(header, "././@LongLink", std::string(), path.size() + 1, 0, 'L', 0644);
+        packer.append(header, kTarBlock);
+        packer.append(path.c_str(), path.size() + 1);
+        packer.pad(path.size() + 1);
+        prefix.clear();
+        name = path.substr(0, 100);
+    }
+    makeHeader(header, name, prefix, size, mtime, type, mode);
+    packer.append(header, kTarBlock);
+}
+
+} // namespace
+
+ArchiveStager::Result ArchiveStager::build(const std::vector<LocalFile>& files,
+                                           const std::string& outPath,
+                                           const std::atomic<bool>* cancelled, int level)
+{
+    Result result;
+
+    FILE* out = fopen(outPath.c_str(), "wb");
+    if (!out) {
+        result.error = "无法创建压缩包: " + outPath;
+        return result;
+    }
+
+    Packer packer(out, level);
+    std::set<std::string> dirs;
+    std::vector<char> buf(256 * 1024);
+
+    for (const auto& f : files) {
+        if (cancelled && *cancelled) {
+            result.error = "已取消";
+            break;
+        }
+
+        // 父目录条目（部分精简 tar 实现不会自动创建中间目录）
+        for (size_t pos = f.relPath.find('/'); pos != std::string::npos;
+             pos = f.relPath.find('/', pos + 1)) {
+            const std::string dir = f.relPath.substr(0, pos + 1);
+            if (dirs.insert(dir).second) appendEntry(packer, dir, 0, f.mtime, '5', 0755);
+        }
+
+        FILE* in = fopen(f.localPath.c_str(), "rb");
+        if (!in) {
+            result.error = "无法打开本地文件: " + f.localPath;
+            break;
+        }
+        appendEntry(packer, f.relPath, f.size, f.mtime, '0', 0644);
+
+        uint64_t copied = 0;
+        while (copied < f.size) {
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(buf.size(), f.size - copied));
+            const size_t n = fread(buf.data(), 1, want, in);
+            if (n == 0) break;
+            packer.append(buf.data(), n);
+            copied += n;
+        }
+        fclose(in);
+        if (copied != f.size) {
+            result.error = "文件在打包过程中被修改: " + f.localPath;
+            break;
+        }
+        packer.pad(f.size);
+
+        result.rawBytes += f.size;
+        result.lastEntry = f.relPath;
+        result.lastEntrySize = f.size;
+    }
+
+    bool ok = result.error.empty() && packer.finish();
+    if (!ok) packer.abandon();
+    if (fclose(out) != 0) ok = false;
+
+    if (!ok) {
+        if (result.error.empty()) result.error = "写入压缩包失败: " + outPath;
+        std::remove(outPath.c_str());
+        return result;
+    }
+
+    result.ok = true;
+    result.archiveBytes = packer.written();
+    return result;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ArchiveStager.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 压缩包部署暂存 — 将待部署文件流式打包为 tar，按块在多核上并行压缩为
+ *              多成员 gzip（与 pigz 输出格式相同，tar -xzf / gunzip 可直接解压），
+ *              每台设备只需上传一个文件，避免大量小文件逐个往返。
+ */
+
+#pragma once
+#include "DeployManifest.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ArchiveStager {
+public:
+    struct Result {
+        bool ok = false;
+        std::string error;
+        uint64_t rawBytes = 0;        // 文件内容总字节
+        uint64_t archiveBytes = 0;    // 压缩包字节
+        std::string lastEntry;        // 包内最后一个文件
+        uint64_t lastEntrySize = 0;
+    };
+
+    // 每个 gzip 成员对应的未压缩 tar 数据量
+    static constexpr size_t kBlockSize = 1 << 20;
+
+    // 按 files 的 relPath 布局打包到 outPath（.tar.gz）。
+    // 压缩在全局线程池并行执行，在途块数有上限，内存占用与文件总量无关
+    static Result build(const std::vector<LocalFile>& files, const std::string& outPath,
+                        const std::atomic<bool>* cancelled = nullptr, int level = 6);
+
+    // CRC-32（IEEE 802.3，与 gzip 尾部一致）；crc 传入上一段结果可分段计算
+    static uint32_t crc32(const char* data, size_t len, uint32_t crc = 0);
+};
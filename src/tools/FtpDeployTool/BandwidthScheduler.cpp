@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: BandwidthScheduler.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 部署带宽调度实现 — 令牌桶配额与自适应并发。
+ */
+
+#include "BandwidthScheduler.h"
+#include <algorithm>
+
+// 每台在途设备至少分到的全局带宽：低于此值的并发只会拉长单设备会话，
+// 还可能触发传输层的低速超时
+static const uint64_t kMinDeviceShare = 16 * 1024;
+
+// ============================================================================
+// TokenBucket
+// ============================================================================
+
+TokenBucket::TokenBucket(uint64_t rate, uint64_t burst)
+    : m_rate(rate)
+    , m_burst(static_cast<double>(burst ? burst : std::max<uint64_t>(rate / 10, 16 * 1024)))
+    , m_tokens(m_burst)
+    , m_last(Clock::now())
+{
+}
+
+uint64_t TokenBucket::available(Clock::time_point now)
+{
+    if (m_rate == 0) return UINT64_MAX;
+    if (now > m_last) {
+        const double elapsed = std::chrono::duration<double>(now - m_last).count();
+        m_tokens = std::min(m_burst, m_tokens + elapsed * static_cast<double>(m_rate));
+        m_last = now;
+    }
+    return static_cast<uint64_t>(m_tokens);
+}
+
+void TokenBucket::consume(uint64_t n)
+{
+    if (m_rate == 0) return;
+    m_tokens -= static_cast<double>(n);
+}
+
+// ============================================================================
+// BandwidthScheduler
+// ============================================================================
+
+BandwidthScheduler::BandwidthScheduler(size_t deviceCount, uint64_t globalRate,
+                                       uint64_t perDeviceRate, int maxConcurrency)
+    : m_perDeviceRate(perDeviceRate)
+    , m_maxConcurrency(std::max(1, maxConcurrency))
+    , m_global(globalRate)
+    , m_devices(deviceCount, TokenBucket(perDeviceRate))
+    , m_windowStart(Clock::now())
+{
+    if (globalRate == 0) {
+        m_target = m_maxConcurrency;
+        m_slowStart = false;
+    } else if (perDeviceRate > 0) {
+        // 两级都限速：恰好占满全局预算所需的设备数作为起点
+        const uint64_t n = (globalRate + perDeviceRate - 1) / perDeviceRate;
+        m_target = static_cast<int>(std::min<uint64_t>(n, static_cast<uint64_t>(m_maxConcurrency)));
+        m_slowStart = false;
+    } else {
+        m_target = 1;
+    }
+
+    if (globalRate > 0) {
+        const uint64_t cap = std::max<uint64_t>(1, globalRate / kMinDeviceShare);
+        m_target = static_cast<int>(std::min<uint64_t>(static_cast<uint64_t>(m_target), cap));
+    }
+    m_target = std::max(1, m_target);
+}
+
+size_t BandwidthScheduler::acquire(size_t device, size_t want)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto now = Clock::now();
+
+    uint64_t grant = want;
+    if (device < m_devices.size()) {
+        grant = std::min(grant, m_devices[device].available(now));
+    }
+    const uint64_t globalAvail = m_global.available(now);
+    if (globalAvail < grant) {
+        grant = globalAvail;
+        m_windowGlobalDenied = true;
+    }
+
+    if (grant > 0) {
+        if (device < m_devices.size()) m_devices[device].consume(grant);
+        m_global.consume(grant);
+        m_windowBytes += grant;
+    }
+
+    adaptLocked(now);
+    return static_cast<size_t>(grant);
+}
+
+void BandwidthScheduler::adaptLocked(Clock::time_point now)
+{
+    const auto elapsed = now - m_windowStart;
+    if (elapsed < kWindow) return;
+
+    if (!m_global.unlimited()) {
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        const double util = static_cast<double>(m_windowBytes)
+                          / (static_cast<double>(m_global.rate()) * seconds);
+        const int cap = static_cast<int>(std::min<uint64_t>(
+            static_cast<uint64_t>(m_maxConcurrency),
+            std::max<uint64_t>(1, m_global.rate() / kMinDeviceShare)));
+
+        if (m_windowGlobalDenied) {
+            // 已触顶：保持当前并发，此后只做加性增长
+            m_slowStart = false;
+        } else if (util < 0.9 && m_active >= m_target && m_target < cap) {
+            // 预算未用满且准入门是瓶颈：增加在途设备
+            m_target = std::min(cap, m_slowStart ? m_target * 2 : m_target + 1);
+            m_admitCv.notify_all();
+        }
+    }
+
+    m_windowStart = now;
+    m_windowBytes = 0;
+    m_windowGlobalDenied = false;
+}
+
+bool BandwidthScheduler::admit(const std::atomic<bool>& cancelled)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_active >= m_target) {
+        if (cancelled) return false;
+        // 超时醒来：检查取消，并在无传输调用 acquire 时推进自适应窗口
+        m_admitCv.wait_for(lock, std::chrono::milliseconds(100));
+        adaptLocked(Clock::now());
+    }
+    if (cancelled) return false;
+    m_active++;
+    return true;
+}
+
+void BandwidthScheduler::release()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_active > 0) m_active--;
+    m_admitCv.notify_one();
+}
+
+int BandwidthScheduler::targetConcurrency() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_target;
+}
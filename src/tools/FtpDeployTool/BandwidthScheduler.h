@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: BandwidthScheduler.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 部署带宽调度 — 全局 + 单设备令牌桶，所有并发传输按字节申请配额；
+ *              受全局上限约束时按实际利用率自适应调整同时在途的设备数，
+ *              使部署流量贴近预算而不挤占产线 Modbus/OPC UA 通信。
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 令牌桶：rate 字节/秒持续补充，桶容量 burst。非线程安全（由调度器加锁）
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // rate = 0 表示不限速；burst = 0 时取 rate/10（至少 16 KiB）
+    explicit TokenBucket(uint64_t rate = 0, uint64_t burst = 0);
+
+    bool unlimited() const { return m_rate == 0; }
+    uint64_t rate() const { return m_rate; }
+
+    // 补充到 now 后的可用令牌数（不限速时返回 UINT64_MAX）
+    uint64_t available(Clock::time_point now);
+    void consume(uint64_t n);
+
+private:
+    uint64_t m_rate;
+    double m_burst;
+    double m_tokens;
+    Clock::time_point m_last;
+};
+
+class BandwidthScheduler {
+public:
+    using Clock = TokenBucket::Clock;
+
+    // globalRate / perDeviceRate: 字节/秒，0 = 不限
+    // maxConcurrency: 同时在途设备数上限（自适应只在 [1, maxConcurrency] 内调整）
+    BandwidthScheduler(size_t deviceCount, uint64_t globalRate, uint64_t perDeviceRate,
+                       int maxConcurrency);
+
+    BandwidthScheduler(const BandwidthScheduler&) = delete;
+    BandwidthScheduler& operator=(const BandwidthScheduler&) = delete;
+
+    bool limited() const { return !m_global.unlimited() || m_perDeviceRate > 0; }
+
+    // 为设备 device 申请至多 want 字节配额，返回本次可发送字节数（0 = 暂无配额）。线程安全
+    size_t acquire(size_t device, size_t want);
+
+    // 设备级准入：阻塞直到在途设备数低于目标并发；cancelled 置位时返回 false
+    bool admit(const std::atomic<bool>& cancelled);
+    // 设备部署结束（与成功的 admit 配对）
+    void release();
+
+    int targetConcurrency() const;
+
+    // 自适应统计窗口
+    static constexpr std::chrono::milliseconds kWindow{1000};
+
+private:
+    void adaptLocked(Clock::time_point now);
+
+    const uint64_t m_perDeviceRate;
+    const int m_maxConcurrency;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_admitCv;
+    TokenBucket m_global;
+    std::vector<TokenBucket> m_devices;
+
+    int m_target;
+    int m_active = 0;
+    bool m_slowStart = true;           // 首次触顶前按倍数增长
+
+    Clock::time_point m_windowStart;
+    uint64_t m_windowBytes = 0;
+    bool m_windowGlobalDenied = false; // 窗口内是否因全局配额不足被限流
+};
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: DeployManifest.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 增量部署清单实现 — 序列化/解析、本地树展开、差异计划。
+ */
+
+#include "DeployManifest.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+
+const char* const DeployManifest::kFileName = ".deploymaster_manifest";
+
+static const char kHeader[] = "# DeployMaster manifest v1";
+
+void DeployManifest::insert(ManifestEntry entry)
+{
+    std::string key = entry.path;
+    m_entries[key] = std::move(entry);
+}
+
+void DeployManifest::remove(const std::string& path)
+{
+    m_entries.erase(path);
+}
+
+const ManifestEntry* DeployManifest::find(const std::string& path) const
+{
+    auto it = m_entries.find(path);
+    return it == m_entries.end() ? nullptr : &it->second;
+}
+
+std::string DeployManifest::serialize() const
+{
+    std::ostringstream oss;
+    oss << kHeader << '\n';
+    for (const auto& kv : m_entries) {
+        const ManifestEntry& e = kv.second;
+        oss << e.hash << '\t' << e.size << '\t' << e.mtime << '\t' << e.path << '\n';
+    }
+    return oss.str();
+}
+
+DeployManifest DeployManifest::parse(const std::string& text)
+{
+    DeployManifest m;
+    std::istringstream iss(text);
+    std::string line;
+
+    if (!std::getline(iss, line)) return m;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line != kHeader) return m;
+
+    while (std::getline(iss, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        // 路径放在最后一列，允许包含空格
+        size_t t1 = line.find('\t');
+        if (t1 == std::string::npos) continue;
+        size_t t2 = line.find('\t', t1 + 1);
+        if (t2 == std::string::npos) continue;
+        size_t t3 = line.find('\t', t2 + 1);
+        if (t3 == std::string::npos || t3 + 1 >= line.size()) continue;
+
+        ManifestEntry e;
+        e.hash = line.substr(0, t1);
+        try {
+            e.size = std::stoull(line.substr(t1 + 1, t2 - t1 - 1));
+            e.mtime = std::stoll(line.substr(t2 + 1, t3 - t2 - 1));
+        } catch (...) {
+            continue;
+        }
+        e.path = line.substr(t3 + 1);
+        m.insert(std::move(e));
+    }
+    return m;
+}
+
+static int64_t fileMtime(const std::filesystem::path& p, std::error_code& ec)
+{
+    const auto ft = std::filesystem::last_write_time(p, ec);
+    if (ec) return 0;
+    return std::chrono::duration_cast<std::chrono::seconds>(ft.time_since_epoch()).count();
+}
+
+std::vector<LocalFile> DeployManifest::scanLocal(const std::vector<std::string>& localItems,
+                                                std::vector<std::string>* unreadable)
+{
+    namespace fs = std::filesystem;
+    std::vector<LocalFile> out;
+    auto fail = [unreadable](const std::string& path) {
+        if (unreadable) unreadable->push_back(path);
+    };
+
+    for (const auto& item : localItems) {
+        std::error_code ec;
+        if (fs::is_directory(item, ec)) {
+            std::string cleanLocal = item;
+            while (!cleanLocal.empty() && (cleanLocal.back() == '/' || cleanLocal.back() == '\\')) {
+                cleanLocal.pop_back();
+            }
+            const fs::path base(cleanLocal);
+            const std::string folderName = base.filename().string();
+
+            for (fs::recursive_directory_iterator it(base, ec), endIt; !ec && it != endIt;
+                 it.increment(ec)) {
+                std::error_code fec;
+                const bool regular = it->is_regular_file(fec);
+                if (fec) {
+                    fail(it->path().string());
+                    continue;
+                }
+                if (!regular) continue;
+
+                LocalFile f;
+                f.localPath = it->path().string();
+                std::string rel = fs::relative(it->path(), base, fec).generic_string();
+                if (!fec) f.size = it->file_size(fec);
+                if (fec) {
+                    fail(f.localPath);
+                    continue;
+                }
+                f.relPath = folderName + "/" + rel;
+                f.mtime = fileMtime(it->path(), fec);
+                out.push_back(std::move(f));
+            }
+            // 目录无法打开或遍历中途出错：其余内容未知
+            if (ec) fail(item);
+        } else if (!ec && fs::is_regular_file(item, ec)) {
+            LocalFile f;
+            f.localPath = item;
+            f.relPath = fs::path(item).filename().string();
+            f.size = fs::file_size(item, ec);
+            if (ec) {
+                fail(item);
+                continue;
+            }
+            f.mtime = fileMtime(item, ec);
+            out.push_back(std::move(f));
+        } else {
+            // 不存在、无权限或不是普通文件/目录
+            fail(item);
+        }
+    }
+
+    // 清单文件本身不参与部署
+    out.erase(std::remove_if(out.begin(), out.end(), [](const LocalFile& f) {
+                  return f.relPath == DeployManifest::kFileName;
+              }),
+              out.end());
+    return out;
+}
+
+std::string DeployManifest::hashFile(const std::string& path)
+{
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly)) return {};
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file)) return {};
+    return hash.result().toHex().toStdString();
+}
+
+DeployPlan planDelta(const std::vector<LocalFile>& local, const DeployManifest& remote,
+                     bool deleteRemoved, const HashProvider& hashOf)
+{
+    DeployPlan plan;
+
+    for (const auto& f : local) {
+        ManifestEntry entry;
+        entry.path = f.relPath;
+        entry.size = f.size;
+        entry.mtime = f.mtime;
+
+        const ManifestEntry* r = remote.find(f.relPath);
+        bool upload = false;
+
+        if (!r) {
+            plan.added++;
+            upload = true;
+        } else if (r->size != f.size) {
+            plan.changed++;
+            upload = true;
+        } else if (r->mtime == f.mtime && !r->hash.empty()) {
+            entry.hash = r->hash;
+        } else {
+            entry.hash = hashOf(f);
+            if (entry.hash.empty() || entry.hash != r->hash) {
+                plan.changed++;
+                upload = true;
+            }
+        }
+
+        if (upload) {
+            if (entry.hash.empty()) entry.hash = hashOf(f);
+            plan.toUpload.push_back(f);
+            plan.uploadBytes += f.size;
+        } else {
+            plan.unchanged++;
+            plan.skippedBytes += f.size;
+        }
+        plan.result.insert(std::move(entry));
+    }
+
+    for (const auto& kv : remote.entries()) {
+        if (plan.result.find(kv.first)) continue;
+        if (deleteRemoved) {
+            plan.toDelete.push_back(kv.first);
+        } else {
+            plan.result.insert(kv.second);
+        }
+    }
+
+    return plan;
+}
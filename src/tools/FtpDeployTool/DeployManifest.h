@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: DeployManifest.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 增量部署清单 — 记录设备上已部署文件的 (相对路径, 大小, mtime, 内容哈希)，
+ *              与本地部署树比较生成上传/删除计划。清单以文本形式保存在设备
+ *              远程部署目录下（kFileName），多台上位机部署同一设备时结果一致。
+ */
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// 清单条目：path 为相对远程部署目录的路径（'/' 分隔）
+struct ManifestEntry {
+    std::string path;
+    uint64_t size = 0;
+    int64_t mtime = 0;      // 本地文件修改时间（秒）
+    std::string hash;       // 内容哈希（MD5 十六进制）
+};
+
+// 本地待部署文件（展开后的单个文件）
+struct LocalFile {
+    std::string localPath;
+    std::string relPath;    // 与上传后远程布局一致的相对路径
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+class DeployManifest {
+public:
+    // 设备上清单文件名（位于远程部署目录下）
+    static const char* const kFileName;
+
+    void insert(ManifestEntry entry);
+    void remove(const std::string& path);
+    const ManifestEntry* find(const std::string& path) const;
+    const std::map<std::string, ManifestEntry>& entries() const { return m_entries; }
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+
+    // 文本序列化：首行版本标识，之后每行 "hash\tsize\tmtime\tpath"
+    std::string serialize() const;
+    // 解析失败的行被忽略；版本不识别时返回空清单（按全量部署处理）
+    static DeployManifest parse(const std::string& text);
+
+    // 展开本地部署项：单文件 → 文件名；文件夹 → 文件夹名/相对路径
+    // 与 FtpAdapter::uploadFile / uploadFolder 的远程布局保持一致
+    // unreadable: 追加不存在或无法读取的部署项/文件路径（这些路径不在返回列表中）
+    static std::vector<LocalFile> scanLocal(const std::vector<std::string>& localItems,
+                                            std::vector<std::string>* unreadable = nullptr);
+
+    // 计算文件内容哈希（MD5 十六进制），失败返回空串
+    static std::string hashFile(const std::string& path);
+
+private:
+    std::map<std::string, ManifestEntry> m_entries;
+};
+
+// 增量部署计划
+struct DeployPlan {
+    std::vector<LocalFile> toUpload;      // 新增 + 变更
+    std::vector<std::string> toDelete;    // 本地已删除、需在设备上删除的相对路径
+    size_t added = 0;
+    size_t changed = 0;
+    size_t unchanged = 0;
+    uint64_t uploadBytes = 0;
+    uint64_t skippedBytes = 0;
+    DeployManifest result;                // 计划全部执行成功后设备应有的清单
+};
+
+using HashProvider = std::function<std::string(const LocalFile&)>;
+
+// 比较本地文件与设备清单：
+//   - 清单中无此路径 → 新增；大小不同 → 变更
+//   - 大小与 mtime 均相同且清单有哈希 → 视为未变，不计算哈希
+//   - 仅 mtime 不同 → 计算哈希，与清单一致则未变（只刷新 mtime）
+// deleteRemoved = false 时，设备上多出的文件保留在结果清单中
+DeployPlan planDelta(const std::vector<LocalFile>& local, const DeployManifest& remote,
+                     bool deleteRemoved, const HashProvider& hashOf);
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: DeployVerifier.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 部署后完整性校验实现 — 大小比对、批量摘要比对、md5sum 输出解析。
+ */
+
+#include "DeployVerifier.h"
+#include "ArchiveStager.h"
+#include <QFile>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+namespace {
+
+std::string toLower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+// 摘要比较：忽略大小写；CRC-32 部分服务器不补前导零
+bool sameDigest(const std::string& algorithm, const std::string& a, const std::string& b)
+{
+    std::string x = toLower(a);
+    std::string y = toLower(b);
+    if (algorithm == "crc32") {
+        x.erase(0, std::min(x.find_first_not_of('0'), x.size()));
+        y.erase(0, std::min(y.find_first_not_of('0'), y.size()));
+    }
+    return x == y;
+}
+
+bool isHex(char c)
+{
+    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+} // namespace
+
+DeployVerifier::DeployVerifier(HashProvider md5Of)
+    : m_md5Of(std::move(md5Of))
+{
+}
+
+VerifyReport DeployVerifier::verify(const std::vector<LocalFile>& files, const RemotePathOf& remotePathOf,
+                                    const RemoteProbe& probe, const std::atomic<bool>* cancelled)
+{
+    VerifyReport report;
+    const bool useHash = static_cast<bool>(probe.hash) && !probe.algorithm.empty();
+    if (useHash) report.algorithm = probe.algorithm;
+
+    auto isCancelled = [cancelled] { return cancelled && cancelled->load(); };
+
+    // 第一轮：SIZE 逐个比对，往返代价低，可先筛掉缺失/截断的文件
+    struct Candidate {
+        const LocalFile* file;
+        std::string remotePath;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& f : files) {
+        if (isCancelled()) return report;
+        const std::string remote = remotePathOf(f);
+        ++report.checked;
+
+        uint64_t size = 0;
+        if (!probe.size(remote, size)) {
+            report.mismatches.push_back({ f, remote, "远端文件不存在或无法获取大小" });
+        } else if (size != f.size) {
+            report.mismatches.push_back({ f, remote, "大小不一致: 本地 " + std::to_string(f.size)
+                                                         + "，远端 " + std::to_string(size) });
+        } else if (useHash) {
+            candidates.push_back({ &f, remote });
+        }
+    }
+
+    // 第二轮：大小一致的文件按批取远端摘要；取不到摘要的文件只算通过了大小比对
+    for (size_t begin = 0; begin < candidates.size(); begin += kHashBatch) {
+        if (isCancelled()) break;
+        const size_t end = std::min(candidates.size(), begin + kHashBatch);
+
+        std::vector<std::string> paths;
+        paths.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) paths.push_back(candidates[i].remotePath);
+
+        std::map<std::string, std::string> remoteDigests;
+        probe.hash(paths, remoteDigests);
+
+        for (size_t i = begin; i < end; ++i) {
+            const Candidate& c = candidates[i];
+            auto it = remoteDigests.find(c.remotePath);
+            if (it == remoteDigests.end() || it->second.empty()) continue;
+            const std::string local = localDigest(*c.file, probe.algorithm);
+            if (local.empty()) continue;
+
+            ++report.hashed;
+            if (!sameDigest(probe.algorithm, local, it->second)) {
+                report.mismatches.push_back({ *c.file, c.remotePath,
+                                              probe.algorithm + " 不一致: 本地 " + local
+                                                  + "，远端 " + toLower(it->second) });
+            }
+        }
+    }
+    return report;
+}
+
+std::string DeployVerifier::localDigest(const LocalFile& file, const std::string& algorithm)
+{
+    if (algorithm == "md5") {
+        return m_md5Of ? toLower(m_md5Of(file)) : DeployManifest::hashFile(file.localPath);
+    }
+    if (algorithm != "crc32") return {};
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_crcCache.find(file.localPath);
+        if (it != m_crcCache.end()) return it->second;
+    }
+    // 锁外计算：多台设备同时校验同一文件时可能重复计算一次，结果相同
+    const std::string crc = fileCrc32(file.localPath);
+    if (!crc.empty()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_crcCache.emplace(file.localPath, crc);
+    }
+    return crc;
+}
+
+std::string DeployVerifier::fileCrc32(const std::string& path)
+{
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly)) return {};
+
+    std::vector<char> buf(ArchiveStager::kBlockSize);
+    uint32_t crc = 0;
+    for (;;) {
+        const qint64 n = file.read(buf.data(), static_cast<qint64>(buf.size()));
+        if (n < 0) return {};
+        if (n == 0) break;
+        crc = ArchiveStager::crc32(buf.data(), static_cast<size_t>(n), crc);
+    }
+
+    char hex[9];
+    std::snprintf(hex, sizeof(hex), "%08x", crc);
+    return hex;
+}
+
+std::map<std::string, std::string> DeployVerifier::parseMd5sum(const std::string& output)
+{
+    std::map<std::string, std::string> out;
+    size_t pos = 0;
+    while (pos < output.size()) {
+        size_t eol = output.find('\n', pos);
+        if (eol == std::string::npos) eol = output.size();
+        std::string line = output.substr(pos, eol - pos);
+        pos = eol + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        // 文件名含 '\' 或换行时 md5sum 在行首加 '\'，文件名中以 \\ 与 \n 转义
+        const bool escaped = !line.empty() && line[0] == '\\';
+        const size_t h = escaped ? 1 : 0;
+        if (line.size() < h + 32 + 2) continue;
+        if (!std::all_of(line.begin() + h, line.begin() + h + 32, isHex)) continue;
+        if (line[h + 32] != ' ' || (line[h + 33] != ' ' && line[h + 33] != '*')) continue;
+
+        std::string name = line.substr(h + 34);
+        if (name.empty()) continue;
+        if (escaped) {
+            std::string plain;
+            for (size_t i = 0; i < name.size(); ++i) {
+                if (name[i] == '\\' && i + 1 < name.size()) {
+                    plain += name[i + 1] == 'n' ? '\n' : name[i + 1];
+                    ++i;
+                } else {
+                    plain += name[i];
+                }
+            }
+            name = std::move(plain);
+        }
+        out[name] = toLower(line.substr(h, 32));
+    }
+    return out;
+}
+
+std::string DeployVerifier::md5sumCommand(const std::vector<std::string>& remotePaths)
+{
+    std::string cmd = "md5sum --";
+    for (const auto& path : remotePaths) {
+        cmd += ' ' + shellQuote(path);
+    }
+    cmd += " 2>/dev/null";
+    return cmd;
+}
+
+std::string DeployVerifier::shellQuote(const std::string& text)
+{
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    quoted += '\'';
+    return quoted;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: DeployVerifier.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 部署后完整性校验 — 逐文件比对远端大小与远端摘要（FTP HASH/XMD5/XCRC
+ *              或 Shell md5sum）和本地摘要，给出不一致文件列表供后端定点重传。
+ *              远端探测由调用方注入，本类不依赖具体协议；多设备共用一个实例。
+ */
+
+#pragma once
+#include "DeployManifest.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 单个文件的校验失败项
+struct VerifyMismatch {
+    LocalFile file;
+    std::string remotePath;
+    std::string reason;
+};
+
+// 单台设备的校验结果
+struct VerifyReport {
+    size_t checked = 0;        // 参与校验的文件数
+    size_t hashed = 0;         // 经摘要比对的文件数（其余只比对了大小）
+    std::string algorithm;     // "md5" / "crc32"；空 = 仅比对大小
+    std::vector<VerifyMismatch> mismatches;
+
+    bool ok() const { return mismatches.empty(); }
+};
+
+// 远端探测：size 必填；hash 为空时只比对大小
+struct RemoteProbe {
+    std::function<bool(const std::string& remotePath, uint64_t& size)> size;
+    // 批量取远端摘要（小写十六进制），取不到的路径不写入 out
+    std::function<void(const std::vector<std::string>& remotePaths,
+                       std::map<std::string, std::string>& out)> hash;
+    std::string algorithm;     // hash 的算法："md5" / "crc32"
+};
+
+class DeployVerifier {
+public:
+    using RemotePathOf = std::function<std::string(const LocalFile&)>;
+
+    // 每次批量取远端摘要的文件数（Shell 命令行长度与取消响应的折中）
+    static constexpr size_t kHashBatch = 64;
+
+    // md5Of: 本地 MD5（通常取自持久化的 LocalHashIndex）；crc32 由本类计算并缓存
+    explicit DeployVerifier(HashProvider md5Of);
+
+    // 先逐个比对大小，大小一致的文件再批量比对摘要；取消后未比对的文件不计入结果
+    VerifyReport verify(const std::vector<LocalFile>& files, const RemotePathOf& remotePathOf,
+                        const RemoteProbe& probe,
+                        const std::atomic<bool>* cancelled = nullptr);
+
+    // 本地摘要（小写十六进制），算法不识别或读取失败时返回空串；线程安全
+    std::string localDigest(const LocalFile& file, const std::string& algorithm);
+
+    // 整个文件的 CRC-32（与 XCRC 一致），读取失败返回空串
+    static std::string fileCrc32(const std::string& path);
+
+    // 解析 md5sum 输出（"hex  path" / "hex *path"，含 '\' 转义的文件名），
+    // 回显、提示符等无关行忽略；返回 path → 小写十六进制
+    static std::map<std::string, std::string> parseMd5sum(const std::string& output);
+
+    // 构造 md5sum 命令：路径逐个单引号转义，stderr 丢弃（缺失的文件不出现在结果中）
+    static std::string md5sumCommand(const std::vector<std::string>& remotePaths);
+
+    // POSIX shell 单引号转义：整体包在 '' 内，内部的 ' 写作 '\''
+    static std::string shellQuote(const std::string& text);
+
+private:
+    HashProvider m_md5Of;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::string> m_crcCache;  // localPath → crc32
+};
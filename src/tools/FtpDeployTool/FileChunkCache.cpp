@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: FileChunkCache.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 多设备扇出上传共享分块缓存实现。
+ */
+
+#include "FileChunkCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+FileChunkCache::FileChunkCache(int readers, size_t chunkSize, uint64_t maxBytes)
+    : m_readers(std::max(1, readers))
+    , m_chunkSize(std::max<size_t>(1, chunkSize))
+    , m_maxBytes(maxBytes)
+{
+}
+
+FileChunkCache::Chunk FileChunkCache::readChunk(const std::string& path, uint64_t index) const
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return nullptr;
+
+    auto buf = std::make_shared<std::vector<char>>(m_chunkSize);
+    const uint64_t offset = index * m_chunkSize;
+#ifdef _WIN32
+    const bool sought = _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    const bool sought = fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    size_t n = 0;
+    if (sought) n = fread(buf->data(), 1, m_chunkSize, file);
+    const bool failed = !sought || ferror(file);
+    fclose(file);
+    if (failed) return nullptr;
+
+    buf->resize(n);
+    buf->shrink_to_fit();
+    return buf;
+}
+
+FileChunkCache::~FileChunkCache()
+{
+    std::deque<LoadJob> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        jobs.swap(m_jobs);
+    }
+    m_jobCv.notify_all();
+    if (m_loader.joinable()) m_loader.join();
+    for (auto& job : jobs) job.loader->set_value(nullptr);
+}
+
+FileChunkCache::Chunk FileChunkCache::load(const Key& key, std::promise<Chunk>& loader)
+{
+    Chunk chunk = readChunk(key.first, key.second);
+    {
+        // 先登记再唤醒等待者：等待者拿到块后可能立即 release，须能认出这一份
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (!chunk) {
+            // 失败不缓存，后续读者重试（等待中的读者拿到 nullptr，不再 release）
+            if (it != m_entries.end()) {
+                m_lru.erase(it->second.lru);
+                m_entries.erase(it);
+            }
+        } else {
+            m_stats.diskBytes += chunk->size();
+            if (it != m_entries.end()) {
+                it->second.loaded = chunk;
+                it->second.bytes = chunk->size();
+                m_stats.residentBytes += chunk->size();
+                evictLocked();
+            }
+        }
+    }
+    loader.set_value(chunk);
+    return chunk;
+}
+
+FileChunkCache::Chunk FileChunkCache::acquire(const std::string& path, uint64_t index)
+{
+    const Key key(path, index);
+    std::promise<Chunk> loader;
+    std::shared_future<Chunk> data;
+    bool owner = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+            ++it->second.holders;
+            ++it->second.served;
+            data = it->second.data;
+        } else {
+            Entry e;
+            e.data = loader.get_future().share();
+            e.holders = 1;
+            e.served = 1;
+            m_lru.push_front(key);
+            e.lru = m_lru.begin();
+            data = e.data;
+            m_entries.emplace(key, std::move(e));
+            owner = true;
+        }
+    }
+
+    // 锁外读盘，不同块可并行读取
+    if (owner) load(key, loader);
+
+    Chunk chunk = data.get();
+    if (chunk) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.servedBytes += chunk->size();
+    }
+    return chunk;
+}
+
+FileChunkCache::Chunk FileChunkCache::tryAcquire(const std::string& path, uint64_t index,
+                                                 std::shared_future<Chunk>* pending)
+{
+    const Key key(path, index);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        *pending = queueLoadLocked(key);
+        return nullptr;
+    }
+    Entry& e = it->second;
+    if (!e.loaded) {
+        // 读取中：不占引用，就绪后调用方重试
+        *pending = e.data;
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, e.lru);
+    ++e.holders;
+    ++e.served;
+    m_stats.servedBytes += e.bytes;
+    return e.loaded;
+}
+
+void FileChunkCache::prefetch(const std::string& path, uint64_t index)
+{
+    const Key key(path, index);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.find(key) == m_entries.end()) queueLoadLocked(key);
+}
+
+std::shared_future<FileChunkCache::Chunk> FileChunkCache::queueLoadLocked(const Key& key)
+{
+    auto loader = std::make_shared<std::promise<Chunk>>();
+    Entry e;
+    e.data = loader->get_future().share();
+    m_lru.push_front(key);
+    e.lru = m_lru.begin();
+    std::shared_future<Chunk> data = e.data;
+    m_entries.emplace(key, std::move(e));
+
+    m_jobs.push_back({key, std::move(loader)});
+    if (!m_loader.joinable()) m_loader = std::thread(&FileChunkCache::loaderLoop, this);
+    m_jobCv.notify_one();
+    return data;
+}
+
+void FileChunkCache::loaderLoop()
+{
+    for (;;) {
+        LoadJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobCv.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        load(job.key, *job.loader);
+    }
+}
+
+void FileChunkCache::release(const std::string& path, uint64_t index, const Chunk& chunk)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(Key(path, index));
+    // 持有期间该块被淘汰过：缓存中是另一份（或正在重读），与本次引用无关
+    if (it == m_entries.end() || !chunk || it->second.loaded != chunk) return;
+    Entry& e = it->second;
+    if (--e.holders > 0 || e.served < m_readers) return;
+
+    m_stats.residentBytes -= e.bytes;
+    m_lru.erase(it->second.lru);
+    m_entries.erase(it);
+}
+
+void FileChunkCache::evictLocked()
+{
+    // 从最久未用端淘汰已读完的块；读取中的块（bytes == 0）跳过。
+    // 已持有块的读者不受影响（shared_ptr 保活），之后的读者重新读盘
+    auto it = m_lru.end();
+    while (m_stats.residentBytes > m_maxBytes && it != m_lru.begin()) {
+        --it;
+        auto entry = m_entries.find(*it);
+        if (entry == m_entries.end() || entry->second.bytes == 0) continue;
+        m_stats.residentBytes -= entry->second.bytes;
+        m_entries.erase(entry);
+        it = m_lru.erase(it);
+    }
+}
+
+FileChunkCache::Stats FileChunkCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+// ============================================================================
+// ChunkStream
+// ============================================================================
+
+ChunkStream::ChunkStream(std::shared_ptr<FileChunkCache> cache, std::string path, uint64_t size)
+    : m_cache(std::move(cache))
+    , m_path(std::move(path))
+    , m_size(size)
+{
+}
+
+ChunkStream::~ChunkStream()
+{
+    dropChunk();
+}
+
+void ChunkStream::dropChunk()
+{
+    if (!m_chunk) return;
+    m_cache->release(m_path, m_chunkIndex, m_chunk);
+    m_chunk.reset();
+}
+
+size_t ChunkStream::fetch(uint64_t index)
+{
+    if (m_failed) return kFailed;
+    if (m_chunk && m_chunkIndex == index) return 0;
+    dropChunk();
+
+    if (m_pending.valid() && m_pendingIndex == index) {
+        if (m_pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return kPending;
+        // 加载结束：失败直接报错；成功则下面登记引用（期间被淘汰时会重新加载）
+        if (!m_pending.get()) {
+            m_pending = {};
+            m_failed = true;
+            return kFailed;
+        }
+    }
+
+    m_chunk = m_cache->tryAcquire(m_path, index, &m_pending);
+    if (!m_chunk) {
+        m_pendingIndex = index;
+        return kPending;
+    }
+    m_pending = {};
+    m_chunkIndex = index;
+
+    // 当前块交给设备发送期间，下一块在读盘线程上准备好
+    const uint64_t next = index + 1;
+    if (next * m_cache->chunkSize() < m_size) m_cache->prefetch(m_path, next);
+    return 0;
+}
+
+bool ChunkStream::ready()
+{
+    if (m_pos >= m_size) return true;
+    return fetch(m_pos / m_cache->chunkSize()) != kPending;
+}
+
+size_t ChunkStream::read(char* buf, size_t len)
+{
+    size_t copied = 0;
+    const size_t chunkSize = m_cache->chunkSize();
+
+    while (copied < len && m_pos < m_size) {
+        const uint64_t index = m_pos / chunkSize;
+        const size_t status = fetch(index);
+        if (status == kFailed) return kFailed;
+        // 下一块未就绪：先交出已拷贝的部分
+        if (status == kPending) return copied > 0 ? copied : kPending;
+
+        const size_t within = static_cast<size_t>(m_pos - index * chunkSize);
+        if (within >= m_chunk->size()) {
+            // 文件在部署过程中被截短
+            return kFailed;
+        }
+        const size_t n = std::min(len - copied, m_chunk->size() - within);
+        std::memcpy(buf + copied, m_chunk->data() + within, n);
+        copied += n;
+        m_pos += n;
+    }
+
+    // 读到末尾即释放，不等析构
+    if (m_pos >= m_size) dropChunk();
+    return copied;
+}
+
+bool ChunkStream::seek(uint64_t offset)
+{
+    if (offset > m_size) return false;
+    m_pos = offset;
+    return true;
+}
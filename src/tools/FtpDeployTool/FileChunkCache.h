@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: FileChunkCache.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 多设备扇出上传的共享分块缓存 — 同一文件块只从磁盘读取一次，
+ *              由所有设备的上传流共享。按实际持有者引用计数：预期读者全部用过
+ *              后立即回收，其余无人持有的块留待后到的读者复用，受容量上限淘汰。
+ *              磁盘读取量为 O(文件)，而非 O(文件 × 设备)。
+ *              上传流在传输引擎线程上以非阻塞方式取块：块由后台读盘线程加载，
+ *              未就绪时上传暂停重试，读取当前块时预取下一块。
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class FileChunkCache {
+public:
+    using Chunk = std::shared_ptr<const std::vector<char>>;
+
+    static constexpr size_t kDefaultChunkSize = 1 << 20;           // 1 MiB
+    static constexpr uint64_t kDefaultMaxBytes = 128ull << 20;     // 128 MiB
+
+    // readers: 预期读取每个块的读者数（通常为设备数）；块被取满该次数且无人持有时
+    //          立即回收。实际读者更少（增量部署、取消）时块留在缓存里，由容量上限淘汰
+    // maxBytes: 常驻块总字节上限；超出时淘汰最久未用的块（慢设备之后会重新读盘）
+    explicit FileChunkCache(int readers, size_t chunkSize = kDefaultChunkSize,
+                            uint64_t maxBytes = kDefaultMaxBytes);
+    ~FileChunkCache();   // 停止读盘线程，未完成的加载以失败结束
+
+    FileChunkCache(const FileChunkCache&) = delete;
+    FileChunkCache& operator=(const FileChunkCache&) = delete;
+
+    // 取 path 的第 index 块并持有一个引用；首个请求者读盘，并发请求者等待同一次读取。
+    // 读取失败返回 nullptr（不持有引用）；文件末尾的块可能短于 chunkSize
+    Chunk acquire(const std::string& path, uint64_t index);
+    // 非阻塞版本：块已就绪时同 acquire；否则返回 nullptr，并交给读盘线程加载
+    // （pending 置为该次加载的结果，结果为 nullptr 表示读取失败）
+    Chunk tryAcquire(const std::string& path, uint64_t index, std::shared_future<Chunk>* pending);
+    // 块不在缓存中时交给读盘线程加载，不持有引用
+    void prefetch(const std::string& path, uint64_t index);
+    // 归还 acquire 得到的 chunk；该块已被淘汰（缓存中为重新读取的另一份）时忽略
+    void release(const std::string& path, uint64_t index, const Chunk& chunk);
+
+    size_t chunkSize() const { return m_chunkSize; }
+
+    struct Stats {
+        uint64_t diskBytes = 0;     // 实际从磁盘读取
+        uint64_t servedBytes = 0;   // 交给各读者的总量
+        uint64_t residentBytes = 0; // 当前常驻
+    };
+    Stats stats() const;
+
+private:
+    using Key = std::pair<std::string, uint64_t>;
+    struct Entry {
+        std::shared_future<Chunk> data;
+        Chunk loaded;               // 读取完成后的块（区分淘汰后的重读）
+        int holders = 0;            // 已 acquire 尚未 release 的读者数
+        int served = 0;             // 累计 acquire 次数
+        uint64_t bytes = 0;         // 读取完成后的块大小（未完成为 0）
+        std::list<Key>::iterator lru;
+    };
+
+    struct LoadJob {
+        Key key;
+        std::shared_ptr<std::promise<Chunk>> loader;
+    };
+
+    Chunk readChunk(const std::string& path, uint64_t index) const;
+    // 读盘并登记结果，再唤醒等待者（锁外调用）
+    Chunk load(const Key& key, std::promise<Chunk>& loader);
+    // 新建读取中的条目并排入读盘线程
+    std::shared_future<Chunk> queueLoadLocked(const Key& key);
+    void loaderLoop();
+    void evictLocked();
+
+    const int m_readers;
+    const size_t m_chunkSize;
+    const uint64_t m_maxBytes;
+
+    mutable std::mutex m_mutex;
+    std::map<Key, Entry> m_entries;
+    std::list<Key> m_lru;           // 前端 = 最近使用
+    Stats m_stats;
+
+    std::deque<LoadJob> m_jobs;     // 读盘线程首次排队时启动
+    std::condition_variable m_jobCv;
+    std::thread m_loader;
+    bool m_stopping = false;
+};
+
+// 单个上传流在共享缓存上的顺序读取游标（每个设备每个文件一个）。
+// read 不阻塞：返回 kFailed 表示读取失败，kPending 表示所需块仍在加载（稍后重试）；
+// seek 用于断点续传定位。非线程安全
+class ChunkStream {
+public:
+    static constexpr size_t kFailed = SIZE_MAX;
+    static constexpr size_t kPending = SIZE_MAX - 1;
+
+    ChunkStream(std::shared_ptr<FileChunkCache> cache, std::string path, uint64_t size);
+    ~ChunkStream();
+
+    ChunkStream(const ChunkStream&) = delete;
+    ChunkStream& operator=(const ChunkStream&) = delete;
+
+    size_t read(char* buf, size_t len);
+    // 当前位置的块已可读（或已到末尾、读取已失败，read 会立即给出结果）
+    bool ready();
+    bool seek(uint64_t offset);
+    uint64_t size() const { return m_size; }
+
+private:
+    void dropChunk();
+    // 确保持有 index 块；返回 0 表示就绪，否则返回 kFailed / kPending
+    size_t fetch(uint64_t index);
+
+    std::shared_ptr<FileChunkCache> m_cache;
+    std::string m_path;
+    uint64_t m_size;
+    uint64_t m_pos = 0;
+    FileChunkCache::Chunk m_chunk;
+    uint64_t m_chunkIndex = 0;
+    std::shared_future<FileChunkCache::Chunk> m_pending;
+    uint64_t m_pendingIndex = 0;
+    bool m_failed = false;          // 读盘失败后不再重试，本次上传以失败结束
+};
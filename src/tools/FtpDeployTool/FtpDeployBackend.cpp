@@ -9,17 +9,23 @@
  * Author: turnarond
  *
  * Description: FTP 部署 Tool 后端实现 — 通过 ProtocolRegistry 获取 FtpAdapter，
- *              使用 QtConcurrent::run 异步上传到所有绑定设备。
+ *              使用 QtConcurrent::run 异步上传到所有绑定设备；设备级工作线程
+ *              从共享索引领取设备，同时在途设备数受 m_maxConcurrency 限制。
  */
 
 #include "FtpDeployBackend.h"
 #include "adapter/ProtocolRegistry.h"
 #include "adapter/FtpAdapter.h"
+#include "model/LocalHashIndex.h"
 #include <QtConcurrent/QtConcurrent>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
 #include <lwlog/lwlog.h>
 #include <thread>
 #include <chrono>
 #include <filesystem>
+#include <algorithm>
+#include <mutex>
 
 FtpDeployBackend::FtpDeployBackend()
 {
@@ -61,6 +67,139 @@ void FtpDeployBackend::applyConfig(const lwserverbase::config::ConfigValue& /*co
     // 从 ConfigManager 读取运行时配置变更（后续扩展）
 }
 
+// ============================================================================
+// 跨设备进度聚合：按字节汇总所有设备的已发送量，整数百分比变化时才回调
+// ============================================================================
+
+namespace {
+
+class DeployProgress {
+public:
+    DeployProgress(size_t deviceCount, uint64_t bytesPerDevice,
+                   std::function<void(int)> cb)
+        : m_sent(deviceCount, 0)
+        , m_perDevice(bytesPerDevice)
+        , m_total(bytesPerDevice * deviceCount)
+        , m_cb(std::move(cb))
+    {
+    }
+
+    void update(size_t device, uint64_t sent)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_perDevice > 0 && sent > m_perDevice) sent = m_perDevice;
+        if (sent <= m_sent[device]) return;
+        m_sum += sent - m_sent[device];
+        m_sent[device] = sent;
+        emitLocked();
+    }
+
+    // 设备结束（成功/失败/取消）计为满额，保证整体进度最终到 100%
+    void finish(size_t device)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished++;
+        if (m_perDevice > 0 && m_sent[device] < m_perDevice) {
+            m_sum += m_perDevice - m_sent[device];
+            m_sent[device] = m_perDevice;
+        }
+        emitLocked();
+    }
+
+private:
+    void emitLocked()
+    {
+        int pct;
+        if (m_total > 0) {
+            pct = static_cast<int>(m_sum * 100 / m_total);
+        } else {
+            // 空文件列表：按完成设备数计
+            pct = static_cast<int>(m_finished * 100 / m_sent.size());
+        }
+        if (pct != m_lastPct) {
+            m_lastPct = pct;
+            if (m_cb) m_cb(pct);
+        }
+    }
+
+    std::mutex m_mutex;
+    std::vector<uint64_t> m_sent;
+    uint64_t m_perDevice;
+    uint64_t m_total;
+    uint64_t m_sum = 0;
+    size_t m_finished = 0;
+    int m_lastPct = -1;
+    std::function<void(int)> m_cb;
+};
+
+// 统计待上传的总字节数（目录递归，不可访问的条目忽略）
+uint64_t plannedBytes(const std::vector<std::string>& localFiles)
+{
+    namespace fs = std::filesystem;
+    uint64_t total = 0;
+    for (const auto& file : localFiles) {
+        std::error_code ec;
+        if (fs::is_directory(file, ec)) {
+            for (fs::recursive_directory_iterator it(file, ec), endIt; !ec && it != endIt;
+                 it.increment(ec)) {
+                std::error_code sec;
+                if (it->is_regular_file(sec)) {
+                    const auto sz = it->file_size(sec);
+                    if (!sec) total += sz;
+                }
+            }
+        } else if (!ec) {
+            const auto sz = fs::file_size(file, ec);
+            if (!ec) total += sz;
+        }
+    }
+    return total;
+}
+
+// 远程部署目录下的相对路径 → 完整远程路径
+std::string joinRemote(const std::string& base, const std::string& rel)
+{
+    std::string out = base;
+    while (!out.empty() && out.back() == '/') out.pop_back();
+    return out + "/" + rel;
+}
+
+} // namespace
+
+void FtpDeployBackend::setDeltaDeploy(bool enabled, bool deleteRemoved)
+{
+    m_deltaDeploy = enabled;
+    m_deleteRemoved = deleteRemoved;
+}
+
+void FtpDeployBackend::setBandwidthLimit(uint64_t globalBytesPerSec, uint64_t perDeviceBytesPerSec)
+{
+    m_globalRate = globalBytesPerSec;
+    m_perDeviceRate = perDeviceBytesPerSec;
+}
+
+void FtpDeployBackend::setArchiveDeploy(bool enabled, const std::string& shellProtocol,
+                                        const std::string& extractCommand)
+{
+    m_archiveDeploy = enabled;
+    m_shellProtocol = shellProtocol;
+    m_extractCommand = extractCommand.empty() ? kDefaultExtractCommand : extractCommand;
+}
+
+void FtpDeployBackend::setVerifyDeploy(bool enabled, const std::string& hashVia, int maxRetries)
+{
+    m_verifyDeploy = enabled;
+    m_verifyHashVia = hashVia.empty() ? "ftp" : hashVia;
+    m_verifyRetries = std::max(0, maxRetries);
+}
+
+void FtpDeployBackend::setMaxConcurrency(int n)
+{
+    if (n < 1) n = 1;
+    if (n > kMaxConcurrency) n = kMaxConcurrency;
+    m_maxConcurrency = n;
+}
+
 void FtpDeployBackend::startUpload(const std::vector<std::string>& localFiles,
                                     const std::string& remotePath,
                                     bool clearBeforeDeploy,
@@ -79,8 +218,6 @@ void FtpDeployBackend::startUpload(const std::vector<std::string>& localFiles,
     }
 
     m_uploadFuture = QtConcurrent::run([this, localFiles, useFtps, port]() {
-        namespace fs = std::filesystem;
-
         std::vector<std::string> successes, failures;
 
         if (m_devices.empty()) {
@@ -89,114 +226,184 @@ void FtpDeployBackend::startUpload(const std::vector<std::string>& localFiles,
             return;
         }
 
-        for (size_t i = 0; i < m_devices.size(); ++i) {
-            if (m_cancelled) break;
+        const size_t deviceCount = m_devices.size();
+        const int workers = static_cast<int>(
+            std::min<size_t>(deviceCount, static_cast<size_t>(m_maxConcurrency)));
 
-            auto device = m_devices[i];  // 拷贝，允许覆盖端口
+        if (m_logCb) {
+            m_logCb("开始部署: " + std::to_string(deviceCount) + " 台设备，并发 "
+                    + std::to_string(workers));
+        }
 
-            // 使用 Tool 级端口覆盖设备默认端口（端口由各 Tool 自行配置）
-            if (port > 0) {
-                device.port = port;
-            }
+        // 本地树只展开一次；增量哈希取自持久化本地索引，跨设备、跨会话复用
+        std::vector<LocalFile> files;
+        const HashProvider hashOf = [](const LocalFile& f) {
+            return LocalHashIndex::instance().hashOf(QString::fromStdString(f.localPath)).toStdString();
+        };
+        const bool delta = m_deltaDeploy && !m_archiveDeploy;
+        if (m_deltaDeploy && m_archiveDeploy && m_logCb) {
+            m_logCb("压缩包部署模式下忽略增量部署");
+        }
 
-            std::string deviceKey = device.ip + ":" + std::to_string(device.port);
+        // 压缩包模式：先在本地暂存目录打包（多核并行压缩），各设备只上传这一个文件
+        QTemporaryDir stageDir;
+        uint64_t perDeviceBytes = 0;
+        m_unreadable.clear();
+        if (m_archiveDeploy) {
+            files = DeployManifest::scanLocal(localFiles, &m_unreadable);
+            if (!stageDir.isValid()) {
+                if (m_logCb) m_logCb("无法创建本地暂存目录");
+                if (m_finishedCb) m_finishedCb(false, successes, failures);
+                return;
+            }
 
-            // 从 ProtocolRegistry 创建 FTP 适配器
-            auto adapter = ProtocolRegistry::instance()->create("ftp");
-            if (!adapter) {
-                if (m_logCb) m_logCb("FTP 适配器不可用: " + deviceKey);
-                failures.push_back(deviceKey);
-                continue;
+            QElapsedTimer timer;
+            timer.start();
+            const std::string archivePath =
+                stageDir.filePath(QString::fromUtf8(kArchiveName)).toStdString();
+            m_archive = ArchiveStager::build(files, archivePath, &m_cancelled);
+            if (!m_archive.ok) {
+                if (m_logCb) m_logCb("打包失败: " + m_archive.error);
+                if (m_finishedCb) m_finishedCb(false, successes, failures);
+                return;
             }
+            m_archiveFile = LocalFile();
+            m_archiveFile.localPath = archivePath;
+            m_archiveFile.relPath = kArchiveName;
+            m_archiveFile.size = m_archive.archiveBytes;
+            perDeviceBytes = m_archive.archiveBytes;
 
-            auto* ftp = dynamic_cast<FtpAdapter*>(adapter.get());
-            if (!ftp) {
-                if (m_logCb) m_logCb("FTP 适配器类型转换失败: " + deviceKey);
-                failures.push_back(deviceKey);
-                continue;
+            if (m_logCb) {
+                m_logCb("打包完成: " + std::to_string(files.size()) + " 个文件，"
+                        + std::to_string(m_archive.rawBytes) + " → "
+                        + std::to_string(m_archive.archiveBytes) + " 字节，耗时 "
+                        + std::to_string(timer.elapsed()) + " ms");
             }
+        } else {
+            perDeviceBytes = plannedBytes(localFiles);
+        }
 
-            if (useFtps) {
-                ftp->setUseFtps(true);
-                if (m_logCb) m_logCb("FTPS 模式已启用: " + deviceKey);
+        DeployProgress progress(deviceCount, perDeviceBytes, m_progressCb);
+
+        // 带宽预算：所有设备的传输从同一组令牌桶申请配额
+        m_bandwidth.reset();
+        if (m_globalRate > 0 || m_perDeviceRate > 0) {
+            m_bandwidth = std::make_unique<BandwidthScheduler>(deviceCount, m_globalRate,
+                                                               m_perDeviceRate, workers);
+            if (m_logCb) {
+                m_logCb("带宽限制: 全局 " + std::to_string(m_globalRate / 1024) + " KB/s，单设备 "
+                        + std::to_string(m_perDeviceRate / 1024) + " KB/s（0 = 不限），初始并发 "
+                        + std::to_string(m_bandwidth->targetConcurrency()));
             }
+        }
+
+        // 多设备并发：每个文件块只读盘一次，由各设备上传流共享，读者全部用过即回收；
+        // 限速时同样经缓存读取，以便按配额分段发送
+        m_chunkCache.reset();
+        if (workers > 1 || m_bandwidth) {
+            m_chunkCache = std::make_shared<FileChunkCache>(static_cast<int>(deviceCount));
+        }
+
+        if (!m_archiveDeploy && (delta || m_chunkCache || m_verifyDeploy)) {
+            files = DeployManifest::scanLocal(localFiles, &m_unreadable);
+        }
+        for (const auto& path : m_unreadable) {
+            if (m_logCb) m_logCb("无法访问路径: " + path);
+        }
+        if (delta || (m_verifyDeploy && m_verifyHashVia != "none")) {
 
-            // 连接设备
-            if (m_logCb) m_logCb("正在连接: " + deviceKey + " ...");
-            if (!ftp->connect(device, m_auth)) {
-                if (m_logCb) m_logCb("连接失败: " + deviceKey + " — " + ftp->lastError());
-                failures.push_back(deviceKey);
-                continue;
+            // 首次扫描多核并行计算；已索引且大小/修改时间未变的文件直接命中
+            QStringList paths;
+            paths.reserve(static_cast<qsizetype>(files.size()));
+            for (const auto& f : files) paths << QString::fromStdString(f.localPath);
+            const auto before = LocalHashIndex::instance().stats();
+            LocalHashIndex::instance().hashAll(paths);
+            LocalHashIndex::instance().save();
+            const auto after = LocalHashIndex::instance().stats();
+
+            if (m_logCb) {
+                m_logCb(std::string(delta ? "增量部署" : "部署后校验") + ": 本地共 "
+                        + std::to_string(files.size()) + " 个文件，哈希缓存命中 "
+                        + std::to_string(after.hits - before.hits) + "，新计算 "
+                        + std::to_string(after.misses - before.misses));
             }
+        }
 
-            if (m_logCb) m_logCb("已连接: " + deviceKey);
+        // 校验器在设备间共享：本地摘要每个文件只算一次
+        m_verifier.reset();
+        m_verifySummary.assign(deviceCount, std::string());
+        if (m_verifyDeploy) {
+            m_verifier = std::make_unique<DeployVerifier>(hashOf);
+        }
+
+        // 每台设备的结果：0 = 未开始（取消），1 = 成功，2 = 失败
+        enum Outcome : int { NotStarted = 0, Succeeded = 1, Failed = 2 };
+        std::vector<int> outcomes(deviceCount, NotStarted);
+        std::vector<std::string> keys(deviceCount);
+        std::atomic<size_t> nextIndex{0};
 
-            // 可选：部署前清空远程目录
-            if (m_clearBeforeDeploy) {
-                if (m_logCb) m_logCb("清空远程目录: " + deviceKey + m_remotePath);
-                if (!ftp->clearRemoteDirectory(m_remotePath)) {
-                    if (m_logCb) m_logCb("清空目录失败: " + deviceKey + " — " + ftp->lastError());
-                    // 清空失败不中止，继续上传
+        auto worker = [&]() {
+            for (;;) {
+                if (m_cancelled) return;
+                // 限速时按自适应并发准入，其余工作线程在此等待
+                if (m_bandwidth && !m_bandwidth->admit(m_cancelled)) return;
+                const size_t i = nextIndex.fetch_add(1);
+                if (i >= deviceCount) {
+                    if (m_bandwidth) m_bandwidth->release();
+                    return;
                 }
-            }
 
-            // 设置进度回调
-            ftp->setProgressCallback([this](int pct) {
-                if (m_progressCb) m_progressCb(pct);
-            });
-
-            // 上传所有文件/文件夹
-            bool allOk = true;
-            for (const auto& file : localFiles) {
-                if (m_cancelled) break;
-
-                std::error_code ec;
-
-                if (fs::is_directory(file, ec)) {
-                    // 文件夹：递归上传整个目录
-                    std::string folderName = fs::path(file).filename().string();
-                    if (m_logCb) m_logCb("上传文件夹: " + folderName + " -> " + deviceKey);
-
-                    if (ftp->uploadFolder(file, m_remotePath)) {
-                        if (m_logCb) m_logCb(folderName + " 上传完成 (" + deviceKey + ")");
-                    } else {
-                        if (m_logCb) m_logCb(folderName + " 上传失败: " + ftp->lastError());
-                        allOk = false;
-                    }
-                } else if (!ec) {
-                    // 单文件上传
-                    std::string fileName = file;
-                    size_t lastSlash = file.find_last_of("/\\");
-                    if (lastSlash != std::string::npos) {
-                        fileName = file.substr(lastSlash + 1);
-                    }
-
-                    std::string remoteFile = m_remotePath;
-                    if (!remoteFile.empty() && remoteFile.back() != '/') {
-                        remoteFile += '/';
-                    }
-                    remoteFile += fileName;
-
-                    if (m_logCb) m_logCb("上传: " + fileName + " -> " + deviceKey);
-
-                    if (ftp->uploadFile(file, remoteFile)) {
-                        if (m_logCb) m_logCb(fileName + " 上传完成 (" + deviceKey + ")");
-                    } else {
-                        if (m_logCb) m_logCb(fileName + " 上传失败: " + ftp->lastError());
-                        allOk = false;
-                    }
-                } else {
-                    if (m_logCb) m_logCb("无法访问路径: " + file);
-                    allOk = false;
+                auto device = m_devices[i];  // 拷贝，允许覆盖端口
+
+                // 使用 Tool 级端口覆盖设备默认端口（端口由各 Tool 自行配置）
+                if (port > 0) {
+                    device.port = port;
                 }
+                keys[i] = device.ip + ":" + std::to_string(device.port);
+
+                const bool ok = deployToDevice(i, device, localFiles, useFtps,
+                    [&progress, i](uint64_t sent) { progress.update(i, sent); },
+                    files, hashOf);
+                outcomes[i] = ok ? Succeeded : Failed;
+                progress.finish(i);
+                if (m_bandwidth) m_bandwidth->release();
             }
+        };
+
+        m_workerPool.setMaxThreadCount(workers);
+        std::vector<QFuture<void>> running;
+        running.reserve(workers);
+        for (int w = 0; w < workers; ++w) {
+            running.push_back(QtConcurrent::run(&m_workerPool, worker));
+        }
+        for (auto& f : running) {
+            f.waitForFinished();
+        }
 
-            ftp->disconnect();
+        if (m_chunkCache) {
+            const auto st = m_chunkCache->stats();
+            if (m_logCb) {
+                m_logCb("本地读取 " + std::to_string(st.diskBytes) + " 字节，向各设备发送 "
+                        + std::to_string(st.servedBytes) + " 字节");
+            }
+            m_chunkCache.reset();
+        }
+        m_bandwidth.reset();
 
-            if (allOk) {
-                successes.push_back(deviceKey);
-            } else {
-                failures.push_back(deviceKey);
+        if (m_verifier) {
+            if (m_logCb) m_logCb("校验汇总:");
+            for (const auto& line : m_verifySummary) {
+                if (!line.empty() && m_logCb) m_logCb("  - " + line);
+            }
+            m_verifier.reset();
+        }
+
+        // 按设备绑定顺序汇总，与逐台部署时的列表顺序一致
+        for (size_t i = 0; i < deviceCount; ++i) {
+            if (outcomes[i] == Succeeded) {
+                successes.push_back(keys[i]);
+            } else if (outcomes[i] == Failed) {
+                failures.push_back(keys[i]);
             }
         }
 
@@ -215,6 +422,598 @@ void FtpDeployBackend::startUpload(const std::vector<std::string>& localFiles,
     });
 }
 
+bool FtpDeployBackend::deployToDevice(size_t deviceIndex, const DeviceInfo& device,
+                                      const std::vector<std::string>& localFiles,
+                                      bool useFtps,
+                                      const std::function<void(uint64_t)>& onBytes,
+                                      const std::vector<LocalFile>& files,
+                                      const HashProvider& hashOf)
+{
+    const std::string deviceKey = device.ip + ":" + std::to_string(device.port);
+
+    // 从 ProtocolRegistry 创建 FTP 适配器
+    auto adapter = ProtocolRegistry::instance()->create("ftp");
+    if (!adapter) {
+        if (m_logCb) m_logCb("FTP 适配器不可用: " + deviceKey);
+        return false;
+    }
+
+    auto* ftp = dynamic_cast<FtpAdapter*>(adapter.get());
+    if (!ftp) {
+        if (m_logCb) m_logCb("FTP 适配器类型转换失败: " + deviceKey);
+        return false;
+    }
+
+    if (useFtps) {
+        ftp->setUseFtps(true);
+        if (m_logCb) m_logCb("FTPS 模式已启用: " + deviceKey);
+    }
+
+    // 取消时中止本设备正在进行的传输，而不是等当前文件传完
+    ftp->setCancelFlag(&m_cancelled);
+
+    // 连接设备
+    if (m_logCb) m_logCb("正在连接: " + deviceKey + " ...");
+    if (!ftp->connect(device, m_auth)) {
+        if (m_logCb) m_logCb("连接失败: " + deviceKey + " — " + ftp->lastError());
+        return false;
+    }
+
+    if (m_logCb) m_logCb("已连接: " + deviceKey);
+
+    // 可选：部署前清空远程目录
+    if (m_clearBeforeDeploy) {
+        if (m_logCb) m_logCb("清空远程目录: " + deviceKey + m_remotePath);
+        const bool cleared = ftp->clearRemoteDirectory(m_remotePath);
+        const FtpTreeStats& stats = ftp->lastTreeStats();
+        if (!cleared) {
+            if (m_logCb) m_logCb("清空目录失败: " + deviceKey + " — " + ftp->lastError());
+            // 清空失败不中止，继续上传
+        } else if (m_logCb) {
+            m_logCb("清空完成: " + deviceKey + " — " + std::to_string(stats.filesDeleted) + " 个文件、"
+                    + std::to_string(stats.dirsDeleted) + " 个目录，列目录 "
+                    + std::to_string(stats.dirsListed) + " 次，列表 " + std::to_string(stats.listMs)
+                    + " ms / 删除 " + std::to_string(stats.deleteMs) + " ms");
+        }
+    }
+
+    bool allOk;
+    if (m_archiveDeploy) {
+        ftp->setBytesCallback(onBytes);
+        allOk = uploadArchive(ftp, deviceIndex, device, deviceKey);
+        // 解压覆盖后旧清单已失效
+        if (!removeStaleManifest(ftp, deviceKey)) allOk = false;
+        // 校验解压出的各文件；不一致的文件单独经 FTP 重传，不再重新打包
+        if (allOk && m_verifier && !m_cancelled) {
+            allOk = verifyDeployed(ftp, deviceIndex, device, files, deviceKey);
+        }
+    } else if (m_deltaDeploy) {
+        allOk = uploadDelta(ftp, deviceIndex, device, files, hashOf, deviceKey, onBytes);
+    } else {
+        // 字节级进度交给聚合器，单文件百分比不再直接上报（多设备并发时会互相覆盖）
+        ftp->setBytesCallback(onBytes);
+        allOk = m_chunkCache ? uploadShared(ftp, deviceIndex, files, deviceKey)
+                             : uploadAll(ftp, localFiles, deviceKey);
+        // 全量覆盖后旧清单已失效，删除以免后续增量部署误判
+        const bool manifestRemoved = removeStaleManifest(ftp, deviceKey);
+        // 校验覆盖全部文件并重传不一致的文件；上传阶段的失败（如 uploadAll 中无法访问的
+        // 本地路径）不在 files 内、校验无从发现，因此与校验结果合并，不被覆盖
+        if (m_verifier && !m_cancelled) {
+            allOk = verifyDeployed(ftp, deviceIndex, device, files, deviceKey) && allOk;
+        }
+        allOk = allOk && manifestRemoved;
+    }
+
+    // 本地扫描漏掉的路径未部署到设备，与 uploadAll 一样按失败处理
+    if (!m_unreadable.empty()) {
+        if (m_logCb) {
+            m_logCb(std::to_string(m_unreadable.size()) + " 个本地路径无法访问，部署不完整: "
+                    + deviceKey);
+        }
+        allOk = false;
+    }
+
+    // 清单删除与校验复用上传的登录会话，全部完成后再断开（断开会清除密码）
+    ftp->disconnect();
+    return allOk;
+}
+
+bool FtpDeployBackend::removeStaleManifest(FtpAdapter* ftp, const std::string& deviceKey)
+{
+    // 清单不存在视为成功；删除失败则设备上残留与实际文件不符的清单，
+    // 下次增量部署会据此跳过已变更的文件，因此按部署失败处理
+    if (ftp->deleteFile(joinRemote(m_remotePath, DeployManifest::kFileName), true)) {
+        return true;
+    }
+    if (m_logCb) m_logCb("旧部署清单删除失败 (" + deviceKey + "): " + ftp->lastError());
+    return false;
+}
+
+bool FtpDeployBackend::uploadDelta(FtpAdapter* ftp, size_t device, const DeviceInfo& deviceInfo,
+                                   const std::vector<LocalFile>& files,
+                                   const HashProvider& hashOf, const std::string& deviceKey,
+                                   const std::function<void(uint64_t)>& onBytes)
+{
+    const std::string manifestPath = joinRemote(m_remotePath, DeployManifest::kFileName);
+
+    // 读取设备清单；部署前已清空目录或清单不存在时按全量处理
+    DeployManifest remote;
+    if (!m_clearBeforeDeploy) {
+        std::string text;
+        if (ftp->readRemoteFile(manifestPath, text)) {
+            remote = DeployManifest::parse(text);
+        } else if (m_logCb) {
+            m_logCb("未找到部署清单，本次全量上传: " + deviceKey);
+        }
+    }
+
+    // 有本地路径无法访问时不删除远端文件：扫描结果缺项，不能据此判定为已移除
+    DeployPlan plan = planDelta(files, remote, m_deleteRemoved && m_unreadable.empty(), hashOf);
+    if (m_logCb) {
+        m_logCb("增量计划 (" + deviceKey + "): 新增 " + std::to_string(plan.added)
+                + ", 变更 " + std::to_string(plan.changed)
+                + ", 未变 " + std::to_string(plan.unchanged)
+                + ", 删除 " + std::to_string(plan.toDelete.size())
+                + ", 跳过 " + std::to_string(plan.skippedBytes) + " 字节");
+    }
+
+    // 跳过的字节计入进度，保证各设备进度口径一致
+    const uint64_t skipped = plan.skippedBytes;
+    if (onBytes) onBytes(skipped);
+    ftp->setBytesCallback([onBytes, skipped](uint64_t sent) {
+        if (onBytes) onBytes(skipped + sent);
+    });
+
+    std::vector<std::string> dirs;
+    for (const auto& f : plan.toUpload) {
+        const std::string remoteFile = joinRemote(m_remotePath, f.relPath);
+        dirs.push_back(remoteFile.substr(0, remoteFile.find_last_of('/')));
+    }
+    std::sort(dirs.begin(), dirs.end());
+    dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+    if (!dirs.empty() && !ftp->makeDirectories(dirs)) {
+        if (m_logCb) m_logCb("创建远程目录失败 (" + deviceKey + "): " + ftp->lastError());
+        return false;
+    }
+
+    bool allOk = true;
+    size_t done = 0;
+    std::vector<LocalFile> uploaded;
+    for (; done < plan.toUpload.size(); ++done) {
+        if (m_cancelled) break;
+
+        const LocalFile& f = plan.toUpload[done];
+        if (uploadOne(ftp, device, f, joinRemote(m_remotePath, f.relPath))) {
+            if (m_logCb) m_logCb(f.relPath + " 上传完成 (" + deviceKey + ")");
+            uploaded.push_back(f);
+        } else {
+            if (m_logCb) m_logCb(f.relPath + " 上传失败 (" + deviceKey + "): " + ftp->lastError());
+            // 从清单移除，下次部署重新上传
+            plan.result.remove(f.relPath);
+            allOk = false;
+        }
+    }
+    // 取消后未上传的文件同样从清单移除
+    for (size_t i = done; i < plan.toUpload.size(); ++i) {
+        plan.result.remove(plan.toUpload[i].relPath);
+    }
+
+    // 本次上传的文件在回写清单前校验；重传后仍不一致的从清单移除，下次部署重新上传
+    if (m_verifier && !m_cancelled && !uploaded.empty()) {
+        std::vector<std::string> failedRel;
+        if (!verifyDeployed(ftp, device, deviceInfo, uploaded, deviceKey, &failedRel)) {
+            for (const auto& rel : failedRel) plan.result.remove(rel);
+            allOk = false;
+        }
+    }
+
+    for (const auto& rel : plan.toDelete) {
+        const ManifestEntry* old = remote.find(rel);
+        if (m_cancelled) {
+            if (old) plan.result.insert(*old);
+            continue;
+        }
+        if (ftp->deleteFile(joinRemote(m_remotePath, rel))) {
+            if (m_logCb) m_logCb("已删除: " + rel + " (" + deviceKey + ")");
+        } else {
+            if (m_logCb) m_logCb("删除失败: " + rel + " (" + deviceKey + "): " + ftp->lastError());
+            // 保留在清单中，下次部署重试删除
+            if (old) plan.result.insert(*old);
+            allOk = false;
+        }
+    }
+
+    // 回写清单；失败只影响下次增量判断（退化为全量），不算部署失败
+    if (!ftp->writeRemoteFile(manifestPath, plan.result.serialize())) {
+        if (m_logCb) m_logCb("部署清单写入失败 (" + deviceKey + "): " + ftp->lastError());
+    }
+
+    return allOk;
+}
+
+bool FtpDeployBackend::uploadArchive(FtpAdapter* ftp, size_t device, const DeviceInfo& deviceInfo,
+                                     const std::string& deviceKey)
+{
+    const std::string remoteArchive = joinRemote(m_remotePath, kArchiveName);
+
+    if (!ftp->makeDirectories({ m_remotePath })) {
+        if (m_logCb) m_logCb("创建远程目录失败 (" + deviceKey + "): " + ftp->lastError());
+        return false;
+    }
+
+    if (m_logCb) m_logCb("上传压缩包 -> " + deviceKey);
+    if (!uploadOne(ftp, device, m_archiveFile, remoteArchive)) {
+        if (m_logCb) m_logCb("压缩包上传失败 (" + deviceKey + "): " + ftp->lastError());
+        return false;
+    }
+    if (m_cancelled) return false;
+
+    const bool ok = extractArchive(ftp, deviceInfo, remoteArchive, deviceKey);
+    if (ok && m_logCb) m_logCb("解压完成 (" + deviceKey + ")");
+
+    // 无论解压成败都清理远程压缩包，避免占用设备存储
+    ftp->deleteFile(remoteArchive);
+    return ok;
+}
+
+std::shared_ptr<IProtocolAdapter> FtpDeployBackend::connectShell(const std::string& protocol,
+                                                                 const DeviceInfo& deviceInfo,
+                                                                 const std::string& deviceKey)
+{
+    auto shell = ProtocolRegistry::instance()->create(protocol);
+    if (!shell) {
+        if (m_logCb) m_logCb(protocol + " 适配器不可用: " + deviceKey);
+        return nullptr;
+    }
+
+    // 端口按协议区分：telnet 23；ssh 置 0 由 SshAdapter 使用默认 22
+    DeviceInfo dev = deviceInfo;
+    dev.protocol = protocol;
+    dev.port = protocol == "ssh" ? 0 : 23;
+    if (!shell->connect(dev, m_auth)) {
+        if (m_logCb) m_logCb(protocol + " 连接失败 (" + deviceKey + "): " + shell->lastError());
+        return nullptr;
+    }
+    return shell;
+}
+
+bool FtpDeployBackend::extractArchive(FtpAdapter* ftp, const DeviceInfo& deviceInfo,
+                                      const std::string& remoteArchive, const std::string& deviceKey)
+{
+    auto shell = connectShell(m_shellProtocol, deviceInfo, deviceKey);
+    if (!shell) {
+        if (m_logCb) m_logCb("无法远程解压: " + deviceKey);
+        return false;
+    }
+
+    // 完成判据：解压命令结束后把退出码写入状态文件（解压命令之后才写，出现即表示已结束），
+    // 经 FTP 轮询读取。Telnet 无退出码且命令返回时解压可能仍在进行，不能以响应返回为准
+    const std::string statusPath = joinRemote(m_remotePath, kExtractStatusName);
+    if (!ftp->deleteFile(statusPath, true)) {
+        if (m_logCb) m_logCb("无法清理解压状态文件 (" + deviceKey + "): " + ftp->lastError());
+        shell->disconnect();
+        return false;
+    }
+
+    // 路径按 shell 单引号转义后再代入，含空格、引号等字符的目录名不会被拆开或注入命令
+    std::string cmd = m_extractCommand;
+    auto substitute = [&cmd](const std::string& key, const std::string& value) {
+        for (size_t pos = cmd.find(key); pos != std::string::npos;
+             pos = cmd.find(key, pos + value.size())) {
+            cmd.replace(pos, key.size(), value);
+        }
+    };
+    substitute("{archive}", DeployVerifier::shellQuote(remoteArchive));
+    substitute("{dir}", DeployVerifier::shellQuote(m_remotePath));
+    cmd += "; echo $? > " + DeployVerifier::shellQuote(statusPath);
+    if (m_logCb) m_logCb("远程解压 (" + deviceKey + "): " + cmd);
+
+    Request req;
+    req.path = cmd;
+    req.timeoutMs = kExtractTimeoutMs;
+    const Response resp = shell->request(req).get();
+    if (!resp.success) {
+        if (m_logCb) m_logCb("解压命令执行失败 (" + deviceKey + "): " + resp.errorMessage);
+        shell->disconnect();
+        return false;
+    }
+
+    // 轮询期间保持 shell 连接，避免会话关闭中断解压
+    QElapsedTimer timer;
+    timer.start();
+    bool finished = false;
+    std::string status;
+    while (!m_cancelled && timer.elapsed() < kExtractTimeoutMs) {
+        if (ftp->readRemoteFile(statusPath, status) && !status.empty() && status.back() == '\n') {
+            finished = true;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    bool ok = false;
+    if (!finished) {
+        if (m_logCb && !m_cancelled) {
+            m_logCb("解压未完成 (" + deviceKey + ")：超时未收到完成标记"
+                    + (resp.data.empty() ? std::string() : "，设备输出: " + resp.data));
+        }
+    } else {
+        while (!status.empty() && (status.back() == '\n' || status.back() == '\r')) status.pop_back();
+        ok = status == "0";
+        if (!ok && m_logCb) {
+            m_logCb("解压失败 (" + deviceKey + ")，退出码 " + status
+                    + (resp.data.empty() ? std::string() : ": " + resp.data));
+        }
+    }
+    ftp->deleteFile(statusPath, true);
+
+    shell->disconnect();
+    return ok;
+}
+
+bool FtpDeployBackend::uploadOne(FtpAdapter* ftp, size_t device, const LocalFile& file,
+                                 const std::string& remotePath)
+{
+    if (!m_chunkCache) {
+        return ftp->uploadFile(file.localPath, remotePath);
+    }
+    return uploadFromCache(ftp, device, file, remotePath, m_chunkCache);
+}
+
+bool FtpDeployBackend::reuploadOne(FtpAdapter* ftp, size_t device, const LocalFile& file,
+                                   const std::string& remotePath)
+{
+    if (!m_bandwidth) {
+        return ftp->uploadFile(file.localPath, remotePath);
+    }
+    return uploadFromCache(ftp, device, file, remotePath, std::make_shared<FileChunkCache>(1));
+}
+
+bool FtpDeployBackend::uploadFromCache(FtpAdapter* ftp, size_t device, const LocalFile& file,
+                                       const std::string& remotePath,
+                                       const std::shared_ptr<FileChunkCache>& cache)
+{
+    ChunkStream stream(cache, file.localPath, file.size);
+    UploadSource source;
+    source.size = file.size;
+    source.read = [this, &stream, device](char* buf, size_t len) -> size_t {
+        // 读回调在传输引擎线程上执行：块仍在读盘时暂停本传输，不阻塞其他设备
+        if (!stream.ready()) return UploadSource::kPause;
+        if (m_bandwidth) {
+            // 按配额截断本次读取；暂无配额时暂停本传输，稍后由传输引擎重试
+            len = m_bandwidth->acquire(device, len);
+            if (len == 0) return UploadSource::kPause;
+        }
+        const size_t n = stream.read(buf, len);
+        return n == ChunkStream::kPending ? UploadSource::kPause : n;
+    };
+    source.seek = [&stream](uint64_t offset) { return stream.seek(offset); };
+    return ftp->uploadFromSource(source, remotePath);
+}
+
+bool FtpDeployBackend::verifyDeployed(FtpAdapter* ftp, size_t device, const DeviceInfo& deviceInfo,
+                                      const std::vector<LocalFile>& files, const std::string& deviceKey,
+                                      std::vector<std::string>* failedRel)
+{
+    auto failAll = [&](const std::string& why) {
+        m_verifySummary[device] = deviceKey + ": " + why;
+        if (failedRel) {
+            for (const auto& f : files) failedRel->push_back(f.relPath);
+        }
+        return false;
+    };
+
+    // 上传阶段连接中断时按原凭据重新登录
+    if (!ftp->isConnected() && !ftp->connect(deviceInfo, m_auth)) {
+        if (m_logCb) m_logCb("校验连接失败 (" + deviceKey + "): " + ftp->lastError());
+        return failAll("校验连接失败");
+    }
+
+    RemoteProbe probe;
+    probe.size = [ftp](const std::string& path, uint64_t& size) {
+        return ftp->remoteFileSize(path, size);
+    };
+
+    std::shared_ptr<IProtocolAdapter> shell;
+    if (m_verifyHashVia == "ftp") {
+        probe.algorithm = ftp->checksumAlgorithm();
+        if (probe.algorithm.empty()) {
+            if (m_logCb) m_logCb("服务器不支持 HASH/XMD5/XCRC，仅比对大小 (" + deviceKey + ")");
+        } else {
+            probe.hash = [ftp](const std::vector<std::string>& paths,
+                               std::map<std::string, std::string>& out) {
+                for (const auto& path : paths) {
+                    std::string hex;
+                    if (ftp->remoteChecksum(path, hex)) out[path] = hex;
+                }
+            };
+        }
+    } else if (m_verifyHashVia == "ssh" || m_verifyHashVia == "telnet") {
+        shell = connectShell(m_verifyHashVia, deviceInfo, deviceKey);
+        if (!shell) {
+            if (m_logCb) m_logCb("无法执行 md5sum，仅比对大小 (" + deviceKey + ")");
+        } else {
+            probe.algorithm = "md5";
+            IProtocolAdapter* sh = shell.get();
+            probe.hash = [sh](const std::vector<std::string>& paths,
+                              std::map<std::string, std::string>& out) {
+                Request req;
+                req.path = DeployVerifier::md5sumCommand(paths);
+                req.timeoutMs = kVerifyShellTimeoutMs;
+                const Response resp = sh->request(req).get();
+                if (!resp.success) return;
+                for (auto& [path, hex] : DeployVerifier::parseMd5sum(resp.data)) {
+                    out[path] = std::move(hex);
+                }
+            };
+        }
+    }
+
+    const auto remotePathOf = [this](const LocalFile& f) { return joinRemote(m_remotePath, f.relPath); };
+    auto logMismatches = [&](const VerifyReport& r) {
+        if (!m_logCb) return;
+        size_t n = 0;
+        for (const auto& m : r.mismatches) {
+            if (++n > kMaxLoggedMismatches) {
+                m_logCb("  ... 另有 " + std::to_string(r.mismatches.size() - kMaxLoggedMismatches)
+                        + " 个 (" + deviceKey + ")");
+                break;
+            }
+            m_logCb("  校验不一致 (" + deviceKey + "): " + m.file.relPath + " — " + m.reason);
+        }
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    VerifyReport report = m_verifier->verify(files, remotePathOf, probe, &m_cancelled);
+    const size_t initialMismatches = report.mismatches.size();
+    if (m_logCb) {
+        m_logCb("校验 (" + deviceKey + "): " + std::to_string(report.checked) + " 个文件，"
+                + (report.algorithm.empty() ? std::string("仅比对大小")
+                                            : report.algorithm + " 比对 " + std::to_string(report.hashed) + " 个")
+                + "，不一致 " + std::to_string(report.mismatches.size()) + "，耗时 "
+                + std::to_string(timer.elapsed()) + " ms");
+    }
+    logMismatches(report);
+
+    // 定点重传：只重传不一致的文件，重传后仅对这些文件再次校验
+    int round = 0;
+    while (!report.ok() && round < m_verifyRetries && !m_cancelled) {
+        ++round;
+        std::vector<LocalFile> retry;
+        std::vector<std::string> dirs;
+        for (const auto& m : report.mismatches) {
+            retry.push_back(m.file);
+            dirs.push_back(m.remotePath.substr(0, m.remotePath.find_last_of('/')));
+        }
+        std::sort(dirs.begin(), dirs.end());
+        dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+        if (m_logCb) {
+            m_logCb("重传 " + std::to_string(retry.size()) + " 个不一致文件，第 " + std::to_string(round)
+                    + " 轮 (" + deviceKey + ")");
+        }
+        if (!dirs.empty() && !ftp->makeDirectories(dirs) && m_logCb) {
+            m_logCb("创建远程目录失败 (" + deviceKey + "): " + ftp->lastError());
+        }
+
+        for (const auto& f : retry) {
+            if (m_cancelled) break;
+            if (!reuploadOne(ftp, device, f, remotePathOf(f)) && m_logCb) {
+                m_logCb(f.relPath + " 重传失败 (" + deviceKey + "): " + ftp->lastError());
+            }
+        }
+        if (m_cancelled) break;
+
+        const VerifyReport again = m_verifier->verify(retry, remotePathOf, probe, &m_cancelled);
+        report.mismatches = again.mismatches;
+        logMismatches(report);
+    }
+
+    if (shell) shell->disconnect();
+
+    std::string summary = deviceKey + ": 校验 " + std::to_string(report.checked) + " 个文件";
+    if (!report.algorithm.empty()) {
+        summary += "（" + report.algorithm + " 比对 " + std::to_string(report.hashed) + " 个）";
+    }
+    if (report.ok()) {
+        summary += initialMismatches == 0
+            ? "，全部一致"
+            : "，重传修复 " + std::to_string(initialMismatches) + " 个";
+    } else {
+        summary += "，" + std::to_string(report.mismatches.size()) + " 个不一致";
+        if (failedRel) {
+            for (const auto& m : report.mismatches) failedRel->push_back(m.file.relPath);
+        }
+    }
+    if (m_cancelled) summary += "（已取消）";
+    m_verifySummary[device] = summary;
+    return report.ok() && !m_cancelled;
+}
+
+bool FtpDeployBackend::uploadShared(FtpAdapter* ftp, size_t device, const std::vector<LocalFile>& files,
+                                    const std::string& deviceKey)
+{
+    std::vector<std::string> dirs;
+    for (const auto& f : files) {
+        const std::string remoteFile = joinRemote(m_remotePath, f.relPath);
+        dirs.push_back(remoteFile.substr(0, remoteFile.find_last_of('/')));
+    }
+    std::sort(dirs.begin(), dirs.end());
+    dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+    if (!dirs.empty() && !ftp->makeDirectories(dirs)) {
+        if (m_logCb) m_logCb("创建远程目录失败 (" + deviceKey + "): " + ftp->lastError());
+        return false;
+    }
+
+    bool allOk = true;
+    for (const auto& f : files) {
+        if (m_cancelled) break;
+
+        if (uploadOne(ftp, device, f, joinRemote(m_remotePath, f.relPath))) {
+            if (m_logCb) m_logCb(f.relPath + " 上传完成 (" + deviceKey + ")");
+        } else {
+            if (m_logCb) m_logCb(f.relPath + " 上传失败 (" + deviceKey + "): " + ftp->lastError());
+            allOk = false;
+        }
+    }
+
+    return allOk;
+}
+
+bool FtpDeployBackend::uploadAll(FtpAdapter* ftp, const std::vector<std::string>& localFiles,
+                                 const std::string& deviceKey)
+{
+    namespace fs = std::filesystem;
+
+    // 上传所有文件/文件夹
+    bool allOk = true;
+    for (const auto& file : localFiles) {
+        if (m_cancelled) break;
+
+        std::error_code ec;
+
+        if (fs::is_directory(file, ec)) {
+            // 文件夹：递归上传整个目录
+            std::string folderName = fs::path(file).filename().string();
+            if (m_logCb) m_logCb("上传文件夹: " + folderName + " -> " + deviceKey);
+
+            if (ftp->uploadFolder(file, m_remotePath)) {
+                if (m_logCb) m_logCb(folderName + " 上传完成 (" + deviceKey + ")");
+            } else {
+                if (m_logCb) m_logCb(folderName + " 上传失败 (" + deviceKey + "): " + ftp->lastError());
+                allOk = false;
+            }
+        } else if (!ec) {
+            // 单文件上传
+            std::string fileName = file;
+            size_t lastSlash = file.find_last_of("/\\");
+            if (lastSlash != std::string::npos) {
+                fileName = file.substr(lastSlash + 1);
+            }
+
+            std::string remoteFile = m_remotePath;
+            if (!remoteFile.empty() && remoteFile.back() != '/') {
+                remoteFile += '/';
+            }
+            remoteFile += fileName;
+
+            if (m_logCb) m_logCb("上传: " + fileName + " -> " + deviceKey);
+
+            if (ftp->uploadFile(file, remoteFile)) {
+                if (m_logCb) m_logCb(fileName + " 上传完成 (" + deviceKey + ")");
+            } else {
+                if (m_logCb) m_logCb(fileName + " 上传失败 (" + deviceKey + "): " + ftp->lastError());
+                allOk = false;
+            }
+        } else {
+            if (m_logCb) m_logCb("无法访问路径: " + file);
+            allOk = false;
+        }
+    }
+
+    return allOk;
+}
+
 void FtpDeployBackend::cancelUpload()
 {
     m_cancelled = true;
@@ -10,16 +10,32 @@
  *
  * Description: FTP 部署 Tool 后端 — 继承 ToolBackend，通过 ProtocolRegistry
  *              获取 FtpAdapter 实例，异步批量上传文件到所有绑定设备。
+ *              多设备按有界并发调度（同时在途设备数可配置），进度按字节跨设备聚合；
+ *              每台在途设备占用一个工作线程，同步阻塞在 CurlMultiEngine::perform 上；
+ *              多设备并发时各文件块经 FileChunkCache 只读盘一次，由所有设备共享；
+ *              可选全局/单设备带宽上限，由 BandwidthScheduler 令牌桶统一限速；
+ *              压缩包模式下先并行压缩为单个 .tar.gz，每台设备上传一次后经 Telnet/SSH 远程解压；
+ *              可选部署后校验（远端大小 + 摘要），不一致的文件定点重传。
  */
 
 #pragma once
 #include "framework/ToolBackend.h"
+#include "DeployManifest.h"
+#include "FileChunkCache.h"
+#include "BandwidthScheduler.h"
+#include "ArchiveStager.h"
+#include "DeployVerifier.h"
 #include <memory>
 #include <vector>
 #include <string>
 #include <functional>
 #include <atomic>
+#include <cstdint>
 #include <QFuture>
+#include <QThreadPool>
+
+class FtpAdapter;
+class IProtocolAdapter;
 
 class FtpDeployBackend : public ToolBackend {
 public:
@@ -49,6 +65,45 @@ public:
                      int port = 21);
     void cancelUpload();
 
+    // 同时在途的设备数上限（1 = 退化为逐台顺序部署），下次 startUpload 生效
+    void setMaxConcurrency(int n);
+    int maxConcurrency() const { return m_maxConcurrency; }
+
+    // 增量部署：按设备上的部署清单只上传新增/变更文件；
+    // deleteRemoved 时同步删除设备上本地已不存在的文件。下次 startUpload 生效
+    void setDeltaDeploy(bool enabled, bool deleteRemoved = false);
+
+    // 带宽上限（字节/秒，0 = 不限）：global 为所有设备合计，perDevice 为单台设备。
+    // 设置全局上限后同时在途设备数在 maxConcurrency 内自适应。下次 startUpload 生效
+    void setBandwidthLimit(uint64_t globalBytesPerSec, uint64_t perDeviceBytesPerSec);
+
+    // 压缩包部署：本地打包压缩为单个文件，每台设备上传一次后通过 shellProtocol
+    // （"telnet" / "ssh"）执行 extractCommand 解压；命令中 {archive} / {dir} 分别替换为
+    // 已按 shell 单引号转义的远程压缩包路径与远程部署目录（模板中无需再加引号）。
+    // 设备 shell 须为 POSIX sh 兼容（支持 ; 与 $?）。启用后忽略增量部署。下次 startUpload 生效
+    void setArchiveDeploy(bool enabled, const std::string& shellProtocol = "telnet",
+                          const std::string& extractCommand = kDefaultExtractCommand);
+
+    // 部署后校验：每台设备上传完成后逐文件比对远端大小与摘要，不一致的文件重传后再校验，
+    // 至多 maxRetries 轮；多轮后仍不一致的设备计入失败。hashVia 为远端摘要来源：
+    // "ftp"（HASH/XMD5/XCRC，服务器不支持时只比对大小）、"ssh" / "telnet"（md5sum）、"none"（只比对大小）。
+    // Shell 摘要假定 FTP 路径即设备文件系统路径（与远程解压一致）。下次 startUpload 生效
+    void setVerifyDeploy(bool enabled, const std::string& hashVia = "ftp",
+                         int maxRetries = kDefaultVerifyRetries);
+
+    static constexpr int kDefaultVerifyRetries = 2;
+    static constexpr int kVerifyShellTimeoutMs = 60000;
+    static constexpr size_t kMaxLoggedMismatches = 20;
+
+    static constexpr const char* kDefaultExtractCommand = "tar -xzf {archive} -C {dir}";
+    static constexpr const char* kArchiveName = ".deploymaster_stage.tar.gz";
+    static constexpr const char* kExtractStatusName = ".deploymaster_extract.status";
+    static constexpr int kExtractTimeoutMs = 300000;
+
+    static constexpr int kDefaultConcurrency = 4;
+    // 每台在途设备占一个工作线程，上限同时也是部署线程数上限
+    static constexpr int kMaxConcurrency = 64;
+
     // 进度回调设置（由 Widget 调用，跨线程安全）
     void setProgressCallback(std::function<void(int)> cb);
     void setLogCallback(std::function<void(const std::string&)> cb);
@@ -56,12 +111,78 @@ public:
                                                  const std::vector<std::string>&)> cb);
 
 private:
+    // 单台设备完整部署流程（连接 → 可选清空 → 上传 → 断开），返回是否全部成功
+    // onBytes: 本设备累计已上传字节（用于跨设备聚合进度）
+    // deviceIndex: 设备序号（带宽调度按序号区分设备）
+    bool deployToDevice(size_t deviceIndex, const DeviceInfo& device,
+                        const std::vector<std::string>& localFiles,
+                        bool useFtps,
+                        const std::function<void(uint64_t)>& onBytes,
+                        const std::vector<LocalFile>& files,
+                        const HashProvider& hashOf);
+    // 压缩包模式：上传暂存包 → 远程解压 → 校验 → 删除远程压缩包
+    bool uploadArchive(FtpAdapter* ftp, size_t device, const DeviceInfo& deviceInfo,
+                       const std::string& deviceKey);
+    // 通过 Telnet/SSH 在设备上执行解压命令，命令结束后写入退出码状态文件，经 FTP 轮询确认完成
+    bool extractArchive(FtpAdapter* ftp, const DeviceInfo& deviceInfo,
+                        const std::string& remoteArchive, const std::string& deviceKey);
+    // 全量/压缩包部署后删除设备上的旧部署清单，清单不存在视为成功
+    bool removeStaleManifest(FtpAdapter* ftp, const std::string& deviceKey);
+    // 全量上传 localFiles（单设备/顺序部署，直接读本地文件）
+    bool uploadAll(FtpAdapter* ftp, const std::vector<std::string>& localFiles,
+                   const std::string& deviceKey);
+    // 全量上传已展开的文件列表（多设备并发或限速时，经共享分块缓存读取）
+    bool uploadShared(FtpAdapter* ftp, size_t device, const std::vector<LocalFile>& files,
+                      const std::string& deviceKey);
+    // 上传单个文件：有共享缓存时从缓存读取（限速时按令牌配额发送），否则直接读本地文件
+    bool uploadOne(FtpAdapter* ftp, size_t device, const LocalFile& file,
+                   const std::string& remotePath);
+    // 增量上传：读取设备清单 → 生成差异计划 → 上传/删除 → 回写清单
+    bool uploadDelta(FtpAdapter* ftp, size_t device, const DeviceInfo& deviceInfo,
+                     const std::vector<LocalFile>& files,
+                     const HashProvider& hashOf, const std::string& deviceKey,
+                     const std::function<void(uint64_t)>& onBytes);
+    // 部署后校验 files，并定点重传不一致的文件；上传阶段已断开时重新连接。
+    // failedRel 返回多轮重传后仍不一致的相对路径
+    bool verifyDeployed(FtpAdapter* ftp, size_t device, const DeviceInfo& deviceInfo,
+                        const std::vector<LocalFile>& files, const std::string& deviceKey,
+                        std::vector<std::string>* failedRel = nullptr);
+    // 重传单个文件：不经多设备共享缓存（其读者计数已用尽），限速时经单读者缓存按配额发送
+    bool reuploadOne(FtpAdapter* ftp, size_t device, const LocalFile& file,
+                     const std::string& remotePath);
+    // 经指定分块缓存上传（限速时按令牌配额发送）
+    bool uploadFromCache(FtpAdapter* ftp, size_t device, const LocalFile& file,
+                         const std::string& remotePath, const std::shared_ptr<FileChunkCache>& cache);
+    // 连接 Telnet/SSH（telnet 23；ssh 置 0 由 SshAdapter 使用默认 22），失败返回空
+    std::shared_ptr<IProtocolAdapter> connectShell(const std::string& protocol,
+                                                   const DeviceInfo& deviceInfo,
+                                                   const std::string& deviceKey);
+
     std::vector<DeviceInfo> m_devices;
     AuthInfo m_auth;
     std::string m_remotePath;
     bool m_clearBeforeDeploy = false;
     bool m_rebootAfterDeploy = false;
     std::atomic<bool> m_cancelled{false};
+    int m_maxConcurrency = kDefaultConcurrency;
+    bool m_deltaDeploy = false;
+    bool m_deleteRemoved = false;
+    bool m_archiveDeploy = false;
+    std::string m_shellProtocol = "telnet";
+    std::string m_extractCommand = kDefaultExtractCommand;
+    bool m_verifyDeploy = false;
+    std::string m_verifyHashVia = "ftp";
+    int m_verifyRetries = kDefaultVerifyRetries;
+    std::unique_ptr<DeployVerifier> m_verifier;      // 本次部署的校验器（各设备共享本地摘要缓存）
+    std::vector<std::string> m_verifySummary;        // 各设备校验结论，按设备序号存放
+    std::vector<std::string> m_unreadable;           // 本次扫描无法访问的本地路径（各设备均按失败处理）
+    LocalFile m_archiveFile;                 // 本次部署的本地暂存包
+    ArchiveStager::Result m_archive;
+    uint64_t m_globalRate = 0;
+    uint64_t m_perDeviceRate = 0;
+    std::shared_ptr<FileChunkCache> m_chunkCache;  // 本次部署的共享分块缓存（单设备且不限速时为空）
+    std::unique_ptr<BandwidthScheduler> m_bandwidth;  // 本次部署的带宽调度（不限速时为空）
+    QThreadPool m_workerPool;      // 设备级工作线程池（与全局池隔离，避免占满 QtConcurrent 默认池）
     QFuture<void> m_uploadFuture;  // 追踪异步上传任务，析构前等待完成
 
     std::function<void(int)> m_progressCb;
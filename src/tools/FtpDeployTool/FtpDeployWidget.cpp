@@ -64,6 +64,91 @@ void FtpDeployWidget::setupUi()
     m_rebootCheck = new QCheckBox("部署完成后重启设备", this);
     configLayout->addWidget(m_rebootCheck, 2, 2, 1, 2);
 
+    // 行 3: 并发设备数
+    configLayout->addWidget(new QLabel("并发设备数:", this), 3, 0);
+    m_concurrencySpin = new QSpinBox(this);
+    m_concurrencySpin->setRange(1, FtpDeployBackend::kMaxConcurrency);
+    m_concurrencySpin->setValue(FtpDeployBackend::kDefaultConcurrency);
+    m_concurrencySpin->setToolTip("同时部署的设备数量上限，1 表示逐台顺序部署");
+    configLayout->addWidget(m_concurrencySpin, 3, 1);
+
+    // 行 4: 增量部署
+    m_deltaCheck = new QCheckBox("增量部署（仅上传变更文件）", this);
+    m_deltaCheck->setToolTip("按设备上的部署清单比较大小/修改时间/内容哈希，只上传新增或变更的文件");
+    configLayout->addWidget(m_deltaCheck, 4, 0, 1, 2);
+
+    m_deleteRemovedCheck = new QCheckBox("同步删除本地已移除的文件", this);
+    m_deleteRemovedCheck->setToolTip("增量部署时删除设备上存在、但本地部署项中已不存在的文件");
+    m_deleteRemovedCheck->setEnabled(false);
+    configLayout->addWidget(m_deleteRemovedCheck, 4, 2, 1, 2);
+    connect(m_deltaCheck, &QCheckBox::toggled, m_deleteRemovedCheck, &QCheckBox::setEnabled);
+
+    // 行 5: 带宽上限（KB/s，0 = 不限）
+    configLayout->addWidget(new QLabel("总带宽上限 (KB/s):", this), 5, 0);
+    m_globalRateSpin = new QSpinBox(this);
+    m_globalRateSpin->setRange(0, 1000000);
+    m_globalRateSpin->setSpecialValueText("不限");
+    m_globalRateSpin->setToolTip("所有设备合计的上传速率上限；设置后并发设备数在上限内自动调整，避免挤占产线通信");
+    configLayout->addWidget(m_globalRateSpin, 5, 1);
+
+    configLayout->addWidget(new QLabel("单设备上限 (KB/s):", this), 5, 2);
+    m_deviceRateSpin = new QSpinBox(this);
+    m_deviceRateSpin->setRange(0, 1000000);
+    m_deviceRateSpin->setSpecialValueText("不限");
+    m_deviceRateSpin->setToolTip("每台设备的上传速率上限");
+    configLayout->addWidget(m_deviceRateSpin, 5, 3);
+
+    // 行 6: 压缩包部署（本地打包 → 单文件上传 → 远程解压）
+    m_archiveCheck = new QCheckBox("压缩包部署（远程解压）", this);
+    m_archiveCheck->setToolTip("本地并行压缩为单个 .tar.gz，每台设备只上传一次，再通过 Telnet/SSH 在设备上解压；"
+                               "适合大量小文件或慢速链路，启用后不使用增量部署");
+    configLayout->addWidget(m_archiveCheck, 6, 0);
+
+    m_shellCombo = new QComboBox(this);
+    m_shellCombo->addItem("Telnet", "telnet");
+    m_shellCombo->addItem("SSH", "ssh");
+    m_shellCombo->setEnabled(false);
+    configLayout->addWidget(m_shellCombo, 6, 1);
+
+    m_extractCmdEdit = new QLineEdit(FtpDeployBackend::kDefaultExtractCommand, this);
+    m_extractCmdEdit->setToolTip("设备上的解压命令，{archive} 为远程压缩包路径，{dir} 为远程部署目录（均已加引号，无需再加）");
+    m_extractCmdEdit->setEnabled(false);
+    configLayout->addWidget(m_extractCmdEdit, 6, 2, 1, 2);
+
+    connect(m_archiveCheck, &QCheckBox::toggled, this, [this](bool on) {
+        m_shellCombo->setEnabled(on);
+        m_extractCmdEdit->setEnabled(on);
+        m_deltaCheck->setEnabled(!on);
+        m_deleteRemovedCheck->setEnabled(!on && m_deltaCheck->isChecked());
+    });
+
+    // 行 7: 部署后校验（远端大小 + 摘要，不一致的文件定点重传）
+    m_verifyCheck = new QCheckBox("部署后校验", this);
+    m_verifyCheck->setToolTip("上传完成后逐文件比对远端大小与摘要，不一致的文件自动重传，无需整体重新部署");
+    configLayout->addWidget(m_verifyCheck, 7, 0);
+
+    m_verifyHashCombo = new QComboBox(this);
+    m_verifyHashCombo->addItem("FTP 摘要 (HASH/XMD5/XCRC)", "ftp");
+    m_verifyHashCombo->addItem("SSH md5sum", "ssh");
+    m_verifyHashCombo->addItem("Telnet md5sum", "telnet");
+    m_verifyHashCombo->addItem("仅比对大小", "none");
+    m_verifyHashCombo->setToolTip("远端摘要来源；服务器不支持 FTP 摘要命令时自动退化为仅比对大小");
+    m_verifyHashCombo->setEnabled(false);
+    configLayout->addWidget(m_verifyHashCombo, 7, 1);
+
+    configLayout->addWidget(new QLabel("重传轮数:", this), 7, 2);
+    m_verifyRetrySpin = new QSpinBox(this);
+    m_verifyRetrySpin->setRange(0, 10);
+    m_verifyRetrySpin->setValue(FtpDeployBackend::kDefaultVerifyRetries);
+    m_verifyRetrySpin->setToolTip("校验不一致时重传并再次校验的最大轮数，0 表示只报告不重传");
+    m_verifyRetrySpin->setEnabled(false);
+    configLayout->addWidget(m_verifyRetrySpin, 7, 3);
+
+    connect(m_verifyCheck, &QCheckBox::toggled, this, [this](bool on) {
+        m_verifyHashCombo->setEnabled(on);
+        m_verifyRetrySpin->setEnabled(on);
+    });
+
     mainLayout->addWidget(configGroup);
 
     // === 操作区 ===
@@ -250,6 +335,17 @@ void FtpDeployWidget::onDeployClicked()
     appendLog(QString("文件数量: %1").arg(files.size()));
     emit toolStatusChanged("部署中...");
 
+    m_backend->setMaxConcurrency(m_concurrencySpin->value());
+    m_backend->setBandwidthLimit(static_cast<uint64_t>(m_globalRateSpin->value()) * 1024,
+                                 static_cast<uint64_t>(m_deviceRateSpin->value()) * 1024);
+    m_backend->setDeltaDeploy(m_deltaCheck->isChecked(),
+                              m_deltaCheck->isChecked() && m_deleteRemovedCheck->isChecked());
+    m_backend->setArchiveDeploy(m_archiveCheck->isChecked(),
+                                m_shellCombo->currentData().toString().toStdString(),
+                                m_extractCmdEdit->text().trimmed().toStdString());
+    m_backend->setVerifyDeploy(m_verifyCheck->isChecked(),
+                               m_verifyHashCombo->currentData().toString().toStdString(),
+                               m_verifyRetrySpin->value());
     m_backend->startUpload(
         files,
         m_remotePathEdit->text().toStdString(),
@@ -21,6 +21,7 @@
 #include <QCheckBox>
 #include <QListWidget>
 #include <QSpinBox>
+#include <QComboBox>
 #include <QGridLayout>
 
 class FtpDeployBackend;
@@ -58,6 +59,17 @@ private:
     // UI 控件
     QLineEdit*    m_remotePathEdit = nullptr;
     QSpinBox*     m_portSpin       = nullptr;
+    QSpinBox*     m_concurrencySpin = nullptr;
+    QSpinBox*     m_globalRateSpin = nullptr;
+    QSpinBox*     m_deviceRateSpin = nullptr;
+    QCheckBox*    m_archiveCheck   = nullptr;
+    QComboBox*    m_shellCombo     = nullptr;
+    QLineEdit*    m_extractCmdEdit = nullptr;
+    QCheckBox*    m_verifyCheck    = nullptr;
+    QComboBox*    m_verifyHashCombo = nullptr;
+    QSpinBox*     m_verifyRetrySpin = nullptr;
+    QCheckBox*    m_deltaCheck     = nullptr;
+    QCheckBox*    m_deleteRemovedCheck = nullptr;
     QCheckBox*    m_clearCheck     = nullptr;
     QCheckBox*    m_rebootCheck    = nullptr;
     QCheckBox*    m_ftpsCheck      = nullptr;
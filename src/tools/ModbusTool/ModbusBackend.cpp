@@ -1,16 +1,16 @@
 #include "ModbusBackend.h"
-#include <QUrl>
-#include <QVariant>
 #include <lwlog/lwlog.h>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
 
 ModbusBackend::ModbusBackend() {}
 
 ModbusBackend::~ModbusBackend()
 {
-    for (auto* c : m_clients) { c->disconnectDevice(); delete c; }
-    m_clients.clear();
+    clearPeriodic();
 }
 
 int ModbusBackend::svc()
@@ -25,23 +25,9 @@ void ModbusBackend::bindDevices(const std::vector<DeviceInfo>& devices) { m_devi
 void ModbusBackend::bindCredentials(const AuthInfo& auth) { m_auth = auth; }
 void ModbusBackend::applyConfig(const lwserverbase::config::ConfigValue&) {}
 
-QModbusTcpClient* ModbusBackend::getOrCreateClient(const QString& ip, int port)
+QModbusDataUnit::RegisterType ModbusBackend::registerTypeFromIndex(int index)
 {
-    QString key = ip + ":" + QString::number(port);
-    if (m_clients.contains(key)) return m_clients[key];
-
-    auto* client = new QModbusTcpClient();
-    client->setConnectionParameter(QModbusDevice::NetworkAddressParameter, QVariant(ip));
-    client->setConnectionParameter(QModbusDevice::NetworkPortParameter, QVariant(port));
-    client->setTimeout(3000);
-    client->setNumberOfRetries(2);
-    m_clients[key] = client;
-    return client;
-}
-
-static QModbusDataUnit::RegisterType mapRegType(int idx)
-{
-    switch (idx) {
+    switch (index) {
     case 0: return QModbusDataUnit::HoldingRegisters;
     case 1: return QModbusDataUnit::InputRegisters;
     case 2: return QModbusDataUnit::Coils;
@@ -49,67 +35,406 @@ static QModbusDataUnit::RegisterType mapRegType(int idx)
     }
 }
 
-void ModbusBackend::readAllRegisters(int slaveId, QModbusDataUnit::RegisterType regType, int startAddr, int count)
+ModbusTable ModbusBackend::tableFromRegisterType(QModbusDataUnit::RegisterType regType)
+{
+    switch (regType) {
+    case QModbusDataUnit::Coils: return ModbusTable::Coils;
+    case QModbusDataUnit::DiscreteInputs: return ModbusTable::DiscreteInputs;
+    case QModbusDataUnit::InputRegisters: return ModbusTable::InputRegisters;
+    default: return ModbusTable::HoldingRegisters;
+    }
+}
+
+static std::vector<ModbusTag> singleTag(int slaveId, QModbusDataUnit::RegisterType regType, int startAddr, int count)
+{
+    ModbusTag tag;
+    tag.unitId = static_cast<uint8_t>(slaveId);
+    tag.table = ModbusBackend::tableFromRegisterType(regType);
+    tag.address = static_cast<uint16_t>(startAddr);
+    tag.count = static_cast<uint32_t>(count);
+    return {tag};
+}
+
+static ModbusRequest blockRequest(const ModbusReadBlock& block)
+{
+    ModbusRequest req;
+    req.unitId = block.unitId;
+    req.table = block.table;
+    req.address = block.address;
+    req.count = block.count;
+    return req;
+}
+
+std::vector<DeviceInfo> ModbusBackend::targets() const
+{
+    if (m_transport != ModbusTransport::RtuSerial) return m_devices;
+    if (m_serialConfig.port.empty()) return {};
+    return { DeviceInfo{ m_serialConfig.port, 0, "modbus-rtu", "", "" } };
+}
+
+ModbusRtuBus& ModbusBackend::bus()
+{
+    if (!m_bus) {
+        m_bus = std::make_unique<ModbusRtuBus>(m_serialConfig);
+        const ModbusRtuTiming t = m_bus->timing();
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), "串口 %s %d %d%c%d，帧间静默 t3.5 = %.2fms",
+                      m_serialConfig.port.c_str(), m_serialConfig.baudRate, m_serialConfig.dataBits,
+                      m_serialConfig.parity, m_serialConfig.stopBits, t.t35Ns / 1e6);
+        log(buf);
+    }
+    return *m_bus;
+}
+
+int ModbusBackend::connectionFor(const DeviceInfo& dev)
 {
-    if (m_devices.empty()) {
-        if (m_logCb) m_logCb("无目标设备");
+    if (m_transport == ModbusTransport::RtuSerial) {
+        bus();
+        return 0;
+    }
+    const int port = dev.port > 0 ? dev.port : ModbusFrame::kDefaultTcpPort;
+    const int conn = m_poller.connection(dev.ip, port, m_transport == ModbusTransport::RtuOverTcp);
+    if (conn < 0) log("地址无法解析: " + dev.ip);
+    return conn;
+}
+
+void ModbusBackend::submit(int connectionId, const ModbusRequest& request, ModbusTcpPoller::Completion done)
+{
+    if (m_transport == ModbusTransport::RtuSerial) bus().submit(request, std::move(done));
+    else m_poller.submit(connectionId, request, std::move(done));
+}
+
+int ModbusBackend::addScanClass(std::chrono::microseconds period)
+{
+    if (m_transport == ModbusTransport::RtuSerial) return bus().addScanClass(period);
+    return m_poller.addScanClass(period);
+}
+
+void ModbusBackend::addPeriodic(int connectionId, const ModbusRequest& request, int scanClass,
+                                ModbusTcpPoller::Completion done)
+{
+    if (m_transport == ModbusTransport::RtuSerial) bus().addPeriodic(request, scanClass, std::move(done));
+    else m_poller.addPeriodic(connectionId, request, scanClass, std::move(done));
+}
+
+void ModbusBackend::clearPeriodic()
+{
+    m_poller.clearPeriodic();
+    if (m_bus) m_bus->clearPeriodic();
+}
+
+ModbusPollerStats ModbusBackend::pollerStats() const
+{
+    if (m_transport == ModbusTransport::RtuSerial) return m_bus ? m_bus->stats() : ModbusPollerStats();
+    return m_poller.stats();
+}
+
+void ModbusBackend::setTransport(ModbusTransport transport)
+{
+    if (transport == m_transport) return;
+    stopPolling();
+    m_transport = transport;
+}
+
+void ModbusBackend::setSerialConfig(const ModbusRtuBus::SerialConfig& config)
+{
+    const ModbusRtuBus::SerialConfig& cur = m_serialConfig;
+    if (config.port == cur.port && config.baudRate == cur.baudRate && config.parity == cur.parity
+        && config.dataBits == cur.dataBits && config.stopBits == cur.stopBits) {
         return;
     }
-    m_pendingReads = static_cast<int>(m_devices.size());
+    stopPolling();
+    m_bus.reset();   // 下次使用时按新参数重新打开
+    m_serialConfig = config;
+}
 
-    for (const auto& dev : m_devices) {
-        int port = dev.port > 0 ? dev.port : 502;
-        QString ip = QString::fromStdString(dev.ip);
-        auto* client = getOrCreateClient(ip, port);
-
-        auto doRead = [=](QModbusTcpClient* c) {
-            auto start = std::chrono::steady_clock::now();
-            QModbusDataUnit unit(regType, startAddr, static_cast<quint16>(count));
-            auto* reply = c->sendReadRequest(unit, slaveId);
-            if (!reply) { m_pendingReads--; return; }
-            QObject::connect(reply, &QModbusReply::finished, [=]() {
-                auto end = std::chrono::steady_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-                if (reply->error() == QModbusDevice::NoError) {
-                    if (m_resultCb) m_resultCb(dev.ip, reply->result().values(), elapsed);
-                } else {
-                    if (m_resultCb) m_resultCb(dev.ip, {}, elapsed);
+bool ModbusBackend::makePlan(const std::vector<ModbusTag>& tags, ModbusReadPlan& plan)
+{
+    if (targets().empty()) {
+        log("无目标设备");
+        return false;
+    }
+    plan = ModbusReadPlanner::plan(tags, m_plannerOptions);
+    if (plan.blocks.empty()) {
+        log("读取范围为空");
+        return false;
+    }
+    log("读取计划: " + plan.summary());
+    return true;
+}
+
+void ModbusBackend::readAllRegisters(int slaveId, QModbusDataUnit::RegisterType regType, int startAddr, int count)
+{
+    readTags(singleTag(slaveId, regType, startAddr, count));
+}
+
+void ModbusBackend::readTags(const std::vector<ModbusTag>& tags)
+{
+    auto plan = std::make_shared<ModbusReadPlan>();
+    if (!makePlan(tags, *plan)) return;
+    const auto offsets = std::make_shared<std::vector<size_t>>(plan->tagOffsets());
+    const std::vector<DeviceInfo> devices = targets();
+    m_pendingReads = static_cast<int>(devices.size());
+
+    // 每台设备一份汇总状态；完成回调都在引擎线程串行执行，无需加锁
+    struct DeviceRead {
+        std::string ip;
+        std::vector<uint16_t> values;
+        size_t remaining = 0;
+        bool failed = false;
+        int64_t maxLatencyUs = 0;
+    };
+
+    for (const auto& dev : devices) {
+        const int conn = connectionFor(dev);
+        if (conn < 0) {
+            if (m_resultCb) m_resultCb(dev.ip, {}, 0);
+            m_pendingReads--;
+            continue;
+        }
+        auto state = std::make_shared<DeviceRead>();
+        state->ip = dev.ip;
+        state->values.assign(plan->totalPoints(), 0);
+        state->remaining = plan->blocks.size();
+
+        for (size_t b = 0; b < plan->blocks.size(); ++b) {
+            submit(conn, blockRequest(plan->blocks[b]), [this, plan, offsets, state, b](const ModbusResult& r) {
+                if (r.ok) {
+                    plan->scatter(b, r.values, state->values.data(), *offsets);
+                } else if (!state->failed) {
+                    state->failed = true;
+                    log(state->ip + ": " + r.error);
+                }
+                state->maxLatencyUs = std::max(state->maxLatencyUs, r.latencyUs);
+                if (--state->remaining > 0) return;
+
+                const qint64 elapsed = state->maxLatencyUs / 1000;
+                if (m_resultCb) {
+                    if (state->failed) m_resultCb(state->ip, {}, elapsed);
+                    else m_resultCb(state->ip, QVector<quint16>(state->values.begin(), state->values.end()), elapsed);
                 }
                 m_pendingReads--;
-                reply->deleteLater();
             });
-        };
-
-        if (client->state() != QModbusDevice::ConnectedState) {
-            QObject::connect(client, &QModbusTcpClient::stateChanged,
-                [=](QModbusDevice::State state) {
-                    if (state == QModbusDevice::ConnectedState) doRead(client);
-                });
-            client->connectDevice();
-        } else {
-            doRead(client);
         }
     }
 }
 
 void ModbusBackend::writeRegister(const std::string& device, int slaveId, QModbusDataUnit::RegisterType regType, int addr, quint16 value)
 {
-    auto* client = getOrCreateClient(QString::fromStdString(device), 502);
-    QModbusDataUnit unit(regType, addr, 1);
-    unit.setValue(0, value);
+    DeviceInfo target{device, ModbusFrame::kDefaultTcpPort, "modbus", "", ""};
+    for (const auto& dev : m_devices) {
+        if (dev.ip == device) { target = dev; break; }
+    }
+    const int conn = connectionFor(target);
+    if (conn < 0) return;
+
+    ModbusRequest req;
+    req.unitId = static_cast<uint8_t>(slaveId);
+    req.table = tableFromRegisterType(regType);
+    req.address = static_cast<uint16_t>(addr);
+    req.write = true;
+    req.value = value;
+    if (ModbusFrame::writeFunction(req.table) == 0) {
+        log("该寄存器类型只读，无法写入");
+        return;
+    }
+    submit(conn, req, [this, device, addr](const ModbusResult& r) {
+        if (r.ok) log(device + ": 写入地址 " + std::to_string(addr) + " 成功");
+        else log(device + ": 写入失败 — " + r.error);
+    });
+}
+
+void ModbusBackend::startPolling(int slaveId, QModbusDataUnit::RegisterType regType, int startAddr, int count, int intervalMs)
+{
+    startPolling(singleTag(slaveId, regType, startAddr, count), intervalMs);
+}
+
+void ModbusBackend::startPolling(const std::vector<ModbusTag>& tags, int intervalMs)
+{
+    startPolling(std::vector<ModbusScanGroup>{ ModbusScanGroup{ tags, intervalMs } });
+}
+
+// 趋势列名：数据表前缀 + 地址，按标签顺序展开（与拼接结果一一对应）
+static std::vector<std::string> trendColumns(const ModbusReadPlan& plan)
+{
+    std::vector<std::string> columns;
+    columns.reserve(plan.totalPoints());
+    for (const auto& tag : plan.tags) {
+        const char* prefix = "HR";
+        switch (tag.table) {
+        case ModbusTable::Coils: prefix = "CO"; break;
+        case ModbusTable::DiscreteInputs: prefix = "DI"; break;
+        case ModbusTable::InputRegisters: prefix = "IR"; break;
+        case ModbusTable::HoldingRegisters: break;
+        }
+        for (uint32_t k = 0; k < tag.count; ++k) {
+            columns.push_back(std::to_string(tag.unitId) + ":" + prefix + std::to_string(tag.address + k));
+        }
+    }
+    return columns;
+}
+
+void ModbusBackend::startPolling(const std::vector<ModbusScanGroup>& groups)
+{
+    stopPolling();
+    const std::vector<DeviceInfo> devices = targets();
+    if (devices.empty()) {
+        log("无目标设备");
+        return;
+    }
 
-    auto doWrite = [=](QModbusTcpClient* c) {
-        auto* reply = c->sendWriteRequest(unit, slaveId);
-        if (reply) QObject::connect(reply, &QModbusReply::finished, reply, &QObject::deleteLater);
+    // 每个扫描组独立规划，对应引擎中的一个扫描等级
+    struct GroupPlan {
+        int scanClass = -1;
+        size_t valueOffset = 0;            // 在设备拼接结果中的起始位置
+        ModbusReadPlan plan;
+        std::vector<size_t> tagOffsets;
     };
+    auto plans = std::make_shared<std::vector<GroupPlan>>();
+    size_t totalPoints = 0;
+    size_t totalBlocks = 0;
+    std::vector<int> periodsMs;
+    for (const auto& group : groups) {
+        GroupPlan gp;
+        if (group.intervalMs <= 0 || !makePlan(group.tags, gp.plan)) continue;
+        gp.scanClass = addScanClass(std::chrono::milliseconds(group.intervalMs));
+        gp.valueOffset = totalPoints;
+        gp.tagOffsets = gp.plan.tagOffsets();
+        totalPoints += gp.plan.totalPoints();
+        totalBlocks += gp.plan.blocks.size();
+        periodsMs.push_back(group.intervalMs);
+        plans->push_back(std::move(gp));
+    }
+    if (plans->empty()) return;
 
-    if (client->state() != QModbusDevice::ConnectedState) {
-        QObject::connect(client, &QModbusTcpClient::stateChanged,
-            [=](QModbusDevice::State state) {
-                if (state == QModbusDevice::ConnectedState) doWrite(client);
-            });
-        client->connectDevice();
-    } else {
-        doWrite(client);
+    // 趋势缓冲：每台设备每组一个序列，按预算确定每序列容量后一次分配
+    std::vector<std::vector<std::string>> groupColumns;
+    size_t bytesPerSample = 0;
+    for (const auto& gp : *plans) {
+        groupColumns.push_back(trendColumns(gp.plan));
+        bytesPerSample += sizeof(int64_t) + sizeof(uint16_t) * groupColumns.back().size();
     }
+    bytesPerSample *= devices.size();
+    const size_t capacity = std::max<size_t>(1, std::min(m_trendCapacity, kTrendBudgetBytes / bytesPerSample));
+    if (capacity < m_trendCapacity) {
+        log("趋势容量受内存预算限制，每序列保留 " + std::to_string(capacity) + " 个样本");
+    }
+    auto trend = std::make_shared<ModbusTrendBuffer>(capacity);
+    m_trend = trend;
+    // 趋势时间戳 = 启动时的墙钟 + 单调时钟经过量：对齐日历时间，又不随系统校时回跳
+    const auto steadyBase = std::chrono::steady_clock::now();
+    const int64_t wallBaseUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // 一台设备一个扫描组的全部块各收到一次后，写入趋势并拼接该设备全部组的最新值上报
+    struct DevicePoll {
+        std::string ip;
+        std::vector<uint16_t> values;
+        std::vector<std::vector<bool>> received;     // [组][块]
+        std::vector<size_t> receivedCount;
+        std::vector<int64_t> maxLatencyUs;
+        std::vector<int> trendSeries;                // [组]
+    };
+
+    int deviceCount = 0;
+    for (const auto& dev : devices) {
+        const int conn = connectionFor(dev);
+        if (conn < 0) continue;
+        ++deviceCount;
+        auto state = std::make_shared<DevicePoll>();
+        state->ip = dev.ip;
+        state->values.assign(totalPoints, 0);
+        for (size_t g = 0; g < plans->size(); ++g) {
+            state->received.emplace_back((*plans)[g].plan.blocks.size(), false);
+            state->trendSeries.push_back(trend->addSeries(
+                dev.ip + "@" + std::to_string(periodsMs[g]) + "ms", groupColumns[g]));
+        }
+        state->receivedCount.assign(plans->size(), 0);
+        state->maxLatencyUs.assign(plans->size(), 0);
+
+        for (size_t g = 0; g < plans->size(); ++g) {
+            const GroupPlan& gp = (*plans)[g];
+            for (size_t b = 0; b < gp.plan.blocks.size(); ++b) {
+                addPeriodic(conn, blockRequest(gp.plan.blocks[b]), gp.scanClass,
+                            [this, plans, state, trend, steadyBase, wallBaseUs, g, b](const ModbusResult& r) {
+                    const GroupPlan& gp = (*plans)[g];
+                    auto resetGroup = [&]() {
+                        std::fill(state->received[g].begin(), state->received[g].end(), false);
+                        state->receivedCount[g] = 0;
+                        state->maxLatencyUs[g] = 0;
+                    };
+                    if (!r.ok) {
+                        resetGroup();
+                        if (m_resultCb) m_resultCb(state->ip, {}, r.latencyUs / 1000);
+                        return;
+                    }
+                    gp.plan.scatter(b, r.values, state->values.data() + gp.valueOffset, gp.tagOffsets);
+                    state->maxLatencyUs[g] = std::max(state->maxLatencyUs[g], r.latencyUs);
+                    if (!state->received[g][b]) {
+                        state->received[g][b] = true;
+                        ++state->receivedCount[g];
+                    }
+                    if (state->receivedCount[g] < gp.plan.blocks.size()) return;
+
+                    const int64_t nowUs = wallBaseUs + std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - steadyBase).count();
+                    trend->append(state->trendSeries[g], nowUs, state->values.data() + gp.valueOffset);
+                    if (m_resultCb) {
+                        m_resultCb(state->ip, QVector<quint16>(state->values.begin(), state->values.end()),
+                                   state->maxLatencyUs[g] / 1000);
+                    }
+                    resetGroup();
+                });
+            }
+        }
+    }
+    if (m_transport == ModbusTransport::RtuSerial) bus().resetStats();
+    else m_poller.resetStats();
+    m_polling = true;
+
+    std::string periods;
+    for (int ms : periodsMs) periods += (periods.empty() ? "" : "/") + std::to_string(ms) + "ms";
+    const std::string mode = m_transport == ModbusTransport::Tcp
+        ? "流水线深度 " + std::to_string(m_poller.pipelineDepth())
+        : std::string("RTU 一问一答");
+    log("周期轮询已启动: " + std::to_string(deviceCount) + " 个目标 × " + std::to_string(totalBlocks)
+        + " 个请求，扫描等级 " + periods + "，" + mode
+        + "，趋势缓冲 " + std::to_string(trend->memoryBytes() / 1024) + " KB");
+}
+
+void ModbusBackend::stopPolling()
+{
+    if (!m_polling) return;
+    const std::vector<ModbusScanClassStats> classes =
+        m_transport == ModbusTransport::RtuSerial ? bus().scanClassStats() : m_poller.scanClassStats();
+    clearPeriodic();
+    m_polling = false;
+
+    const ModbusPollerStats s = pollerStats();
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+                  "周期轮询已停止: 发出 %llu，成功 %llu，失败 %llu（超时 %llu），跳过 %llu；"
+                  "平均响应 %.2fms，调度延迟 平均 %.0fus / 最大 %lldus",
+                  static_cast<unsigned long long>(s.sent), static_cast<unsigned long long>(s.succeeded),
+                  static_cast<unsigned long long>(s.failed), static_cast<unsigned long long>(s.timeouts),
+                  static_cast<unsigned long long>(s.overruns), s.avgLatencyUs / 1000.0, s.avgLateUs,
+                  static_cast<long long>(s.maxLateUs));
+    LWLOG_I(buf);
+    log(buf);
+
+    // 各扫描等级：超限说明该等级周期短于实际往返耗时，应放宽周期或提高流水线深度
+    for (const auto& c : classes) {
+        if (c.items == 0) continue;
+        std::snprintf(buf, sizeof(buf),
+                      "  扫描等级 %lldms: %u 个请求，触发 %llu，超限 %llu，错过 %llu，最大延迟 %lldus",
+                      static_cast<long long>(c.periodUs / 1000), c.items,
+                      static_cast<unsigned long long>(c.fired), static_cast<unsigned long long>(c.overruns),
+                      static_cast<unsigned long long>(c.missed), static_cast<long long>(c.maxLateUs));
+        log(buf);
+    }
+}
+
+void ModbusBackend::setPipelineDepth(int depth)
+{
+    m_poller.setPipelineDepth(depth);
 }
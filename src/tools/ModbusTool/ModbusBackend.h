@@ -1,11 +1,23 @@
 #pragma once
 #include "framework/ToolBackend.h"
-#include <QModbusTcpClient>
+#include "ModbusTcpPoller.h"
+#include "ModbusRtuBus.h"
+#include "ModbusReadPlanner.h"
+#include "ModbusTrendBuffer.h"
 #include <QModbusDataUnit>
-#include <QTimer>
-#include <QMap>
+#include <QVector>
 #include <functional>
 #include <atomic>
+#include <memory>
+
+// 传输方式：Modbus TCP、经串口服务器透传的 RTU over TCP、本机串口 RTU
+enum class ModbusTransport { Tcp, RtuOverTcp, RtuSerial };
+
+// 扫描组：一组标签按同一周期轮询（对应引擎的一个扫描等级）
+struct ModbusScanGroup {
+    std::vector<ModbusTag> tags;
+    int intervalMs = 1000;
+};
 
 class ModbusBackend : public ToolBackend {
 public:
@@ -24,24 +36,77 @@ public:
     void bindCredentials(const AuthInfo& auth) override;
     void applyConfig(const lwserverbase::config::ConfigValue& config) override;
 
-    // 回调
+    // 回调（均在轮询引擎线程触发，UI 侧需自行排队到主线程）
     using LogCallback = std::function<void(const std::string&)>;
     using ResultCallback = std::function<void(const std::string& device, const QVector<quint16>& values, qint64 elapsedMs)>;
     void setLogCallback(LogCallback cb) { m_logCb = std::move(cb); }
     void setResultCallback(ResultCallback cb) { m_resultCb = std::move(cb); }
 
+    // 界面寄存器类型下拉框索引 → QModbusDataUnit 类型（Holding / Input / Coils / Discrete）
+    static QModbusDataUnit::RegisterType registerTypeFromIndex(int index);
+
+    static ModbusTable tableFromRegisterType(QModbusDataUnit::RegisterType regType);
+
+    // 读取经 ModbusReadPlanner 规划：超过协议上限的数量自动拆分，多个标签合并为尽量少的请求。
+    // 结果回调的 values 为全部标签按顺序拼接，任一请求失败则该设备本次结果为空
     void readAllRegisters(int slaveId, QModbusDataUnit::RegisterType regType, int startAddr, int count);
+    void readTags(const std::vector<ModbusTag>& tags);
     void writeRegister(const std::string& device, int slaveId, QModbusDataUnit::RegisterType regType, int addr, quint16 value);
 
+    // 周期轮询全部设备：每个扫描组一个扫描等级，等级内请求在周期内均匀错开，由引擎线程按截止时间调度。
+    // 任一组本轮读齐即上报该设备全部组的最新拼接值
+    void startPolling(int slaveId, QModbusDataUnit::RegisterType regType, int startAddr, int count, int intervalMs);
+    void startPolling(const std::vector<ModbusTag>& tags, int intervalMs);
+    void startPolling(const std::vector<ModbusScanGroup>& groups);
+    void stopPolling();
+    bool isPolling() const { return m_polling; }
+
+    // 合并阈值：空洞不超过此点数的范围合并读取（0 = 仅合并相邻范围）
+    void setPlannerOptions(const ModbusReadPlanner::Options& options) { m_plannerOptions = options; }
+    // 每条连接的流水线深度（同时在途的事务数，仅 Modbus TCP 生效）
+    void setPipelineDepth(int depth);
+
+    // 切换传输方式或串口参数会先停止轮询。串口模式下目标只有该串口一条总线，
+    // 绑定的设备列表不参与，各从站由标签的从站地址区分
+    void setTransport(ModbusTransport transport);
+    ModbusTransport transport() const { return m_transport; }
+    void setSerialConfig(const ModbusRtuBus::SerialConfig& config);
+
+    // 趋势：startPolling 时为每台设备的每个扫描组建立一个序列，轮询结果直接写入（不分配内存）。
+    // 每序列保留 capacity 个样本；总量超过 kTrendBudgetBytes 时按比例缩减容量
+    void setTrendCapacity(size_t capacity) { m_trendCapacity = capacity; }
+    std::shared_ptr<const ModbusTrendBuffer> trend() const { return m_trend; }
+    static constexpr size_t kDefaultTrendCapacity = 36000;                 // 10Hz 一小时
+    static constexpr size_t kTrendBudgetBytes = size_t(256) * 1024 * 1024;
+    ModbusPollerStats pollerStats() const;
+
 private:
-    QModbusTcpClient* getOrCreateClient(const QString& ip, int port);
+    // 当前传输方式下的轮询目标；串口模式为以串口名标识的单一目标
+    std::vector<DeviceInfo> targets() const;
+    ModbusRtuBus& bus();
+    int connectionFor(const DeviceInfo& dev);
+    // 按传输方式分派到 TCP 引擎或串口总线
+    void submit(int connectionId, const ModbusRequest& request, ModbusTcpPoller::Completion done);
+    int addScanClass(std::chrono::microseconds period);
+    void addPeriodic(int connectionId, const ModbusRequest& request, int scanClass, ModbusTcpPoller::Completion done);
+    void clearPeriodic();
+    bool makePlan(const std::vector<ModbusTag>& tags, ModbusReadPlan& plan);
+    void log(const std::string& msg) const { if (m_logCb) m_logCb(msg); }
 
     std::vector<DeviceInfo> m_devices;
     AuthInfo m_auth;
     std::atomic<bool> m_cancelled{false};
 
-    QMap<QString, QModbusTcpClient*> m_clients;
     LogCallback m_logCb;
     ResultCallback m_resultCb;
-    int m_pendingReads = 0;
+    std::atomic<int> m_pendingReads{0};
+    bool m_polling = false;
+    ModbusReadPlanner::Options m_plannerOptions;
+    size_t m_trendCapacity = kDefaultTrendCapacity;
+    std::shared_ptr<ModbusTrendBuffer> m_trend;
+    ModbusTransport m_transport = ModbusTransport::Tcp;
+    ModbusRtuBus::SerialConfig m_serialConfig;
+    // 最后声明、最先析构：引擎 / 总线线程停止后才释放回调
+    std::unique_ptr<ModbusRtuBus> m_bus;     // 串口模式下首次使用时按 m_serialConfig 打开
+    ModbusTcpPoller m_poller;
 };
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusFrame.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 帧编解码实现。
+ */
+
+#include "ModbusFrame.h"
+#include <cstring>
+
+namespace {
+
+void put16(uint8_t* p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v & 0xFF);
+}
+
+uint16_t get16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+// CRC-16/MODBUS（反射多项式 0xA001）按字节查表，编译期生成
+struct CrcTable {
+    uint16_t entries[256];
+    constexpr CrcTable() : entries() {
+        for (int i = 0; i < 256; ++i) {
+            uint16_t crc = static_cast<uint16_t>(i);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1u) ? static_cast<uint16_t>((crc >> 1) ^ 0xA001u) : static_cast<uint16_t>(crc >> 1);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+constexpr CrcTable kCrcTable;
+
+} // namespace
+
+uint8_t ModbusFrame::readFunction(ModbusTable table)
+{
+    switch (table) {
+    case ModbusTable::Coils:            return 0x01;
+    case ModbusTable::DiscreteInputs:   return 0x02;
+    case ModbusTable::HoldingRegisters: return 0x03;
+    case ModbusTable::InputRegisters:   return 0x04;
+    }
+    return 0;
+}
+
+uint8_t ModbusFrame::writeFunction(ModbusTable table)
+{
+    switch (table) {
+    case ModbusTable::Coils:            return 0x05;
+    case ModbusTable::HoldingRegisters: return 0x06;
+    default:                            return 0;
+    }
+}
+
+size_t ModbusFrame::encodeReadPdu(uint8_t* out, ModbusTable table, uint16_t address, uint16_t count)
+{
+    out[0] = readFunction(table);
+    put16(out + 1, address);
+    put16(out + 3, count);
+    return kRequestPduSize;
+}
+
+size_t ModbusFrame::encodeWritePdu(uint8_t* out, ModbusTable table, uint16_t address, uint16_t value)
+{
+    out[0] = writeFunction(table);
+    put16(out + 1, address);
+    // FC05 线圈：ON = 0xFF00，OFF = 0x0000
+    put16(out + 3, table == ModbusTable::Coils ? (value ? 0xFF00 : 0x0000) : value);
+    return kRequestPduSize;
+}
+
+size_t ModbusFrame::encodeTcpFrame(uint8_t* out, uint16_t transactionId, uint8_t unitId,
+                                   const uint8_t* pdu, size_t pduSize)
+{
+    put16(out, transactionId);
+    put16(out + 2, 0);                                       // 协议 ID：Modbus
+    put16(out + 4, static_cast<uint16_t>(pduSize + 1));      // 长度：单元 ID + PDU
+    out[6] = unitId;
+    std::memcpy(out + kMbapHeaderSize, pdu, pduSize);
+    return kMbapHeaderSize + pduSize;
+}
+
+int ModbusFrame::tcpFrameLength(const uint8_t* data, size_t available)
+{
+    if (available < kMbapHeaderSize) return 0;
+    const uint16_t protocol = get16(data + 2);
+    const uint16_t length = get16(data + 4);
+    if (protocol != 0 || length < 2 || length > kMaxPduSize + 1) return -1;
+    return static_cast<int>(kMbapHeaderSize - 1 + length);
+}
+
+uint16_t ModbusFrame::crc16(const uint8_t* data, size_t size)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc = static_cast<uint16_t>((crc >> 8) ^ kCrcTable.entries[(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+size_t ModbusFrame::encodeRtuFrame(uint8_t* out, uint8_t unitId, const uint8_t* pdu, size_t pduSize)
+{
+    out[0] = unitId;
+    std::memcpy(out + 1, pdu, pduSize);
+    const uint16_t crc = crc16(out, pduSize + 1);
+    out[pduSize + 1] = static_cast<uint8_t>(crc & 0xFF);
+    out[pduSize + 2] = static_cast<uint8_t>(crc >> 8);
+    return pduSize + kRtuOverhead;
+}
+
+int ModbusFrame::rtuResponseLength(const uint8_t* data, size_t available, uint8_t requestFunction)
+{
+    if (available < 2) return 0;
+    const uint8_t fc = data[1];
+    if (fc == (requestFunction | 0x80)) return 5;              // 地址 + 功能码 + 异常码 + CRC
+    if (fc != requestFunction) return -1;
+    switch (fc) {
+    case 0x01: case 0x02: case 0x03: case 0x04:
+        if (available < 3) return 0;
+        return 5 + data[2];                                    // 地址 + 功能码 + 字节数 + 数据 + CRC
+    case 0x05: case 0x06: case 0x0F: case 0x10:
+        return 8;                                              // 回显地址与值/数量
+    default:
+        return -1;
+    }
+}
+
+bool ModbusFrame::checkRtuCrc(const uint8_t* frame, size_t size)
+{
+    if (size < kRtuOverhead + 1) return false;
+    const uint16_t crc = crc16(frame, size - 2);
+    return frame[size - 2] == (crc & 0xFF) && frame[size - 1] == (crc >> 8);
+}
+
+ModbusRtuTiming ModbusFrame::rtuTiming(int baudRate, int bitsPerChar)
+{
+    ModbusRtuTiming t;
+    if (baudRate <= 0) return t;
+    t.charNs = static_cast<int64_t>(bitsPerChar) * 1000000000LL / baudRate;
+    if (baudRate > kRtuFixedTimingBaud) {
+        t.t15Ns = kRtuFixedT15Ns;
+        t.t35Ns = kRtuFixedT35Ns;
+    } else {
+        t.t15Ns = static_cast<int64_t>(bitsPerChar) * 1500000000LL / baudRate;
+        t.t35Ns = static_cast<int64_t>(bitsPerChar) * 3500000000LL / baudRate;
+    }
+    return t;
+}
+
+bool ModbusFrame::decodeReadResponse(const uint8_t* pdu, size_t pduSize, ModbusTable table,
+                                     uint16_t count, uint16_t* values, std::string& error)
+{
+    const uint8_t fc = readFunction(table);
+    if (pduSize >= 2 && pdu[0] == (fc | 0x80)) {
+        error = exceptionText(pdu[1]);
+        return false;
+    }
+    if (pduSize < 2 || pdu[0] != fc) {
+        error = "响应功能码不匹配";
+        return false;
+    }
+    const size_t byteCount = pdu[1];
+    const size_t expected = isBitTable(table) ? (count + 7u) / 8u : count * 2u;
+    if (byteCount != expected || pduSize < 2 + byteCount) {
+        error = "响应长度不符 (" + std::to_string(byteCount) + " 字节，应为 " + std::to_string(expected) + ")";
+        return false;
+    }
+    const uint8_t* data = pdu + 2;
+    if (isBitTable(table)) {
+        for (uint16_t i = 0; i < count; ++i) {
+            values[i] = (data[i / 8] >> (i % 8)) & 1u;
+        }
+    } else {
+        for (uint16_t i = 0; i < count; ++i) {
+            values[i] = get16(data + i * 2);
+        }
+    }
+    return true;
+}
+
+bool ModbusFrame::decodeWriteResponse(const uint8_t* pdu, size_t pduSize, const uint8_t* requestPdu,
+                                      std::string& error)
+{
+    if (pduSize >= 2 && pdu[0] == (requestPdu[0] | 0x80)) {
+        error = exceptionText(pdu[1]);
+        return false;
+    }
+    if (pduSize != kRequestPduSize || std::memcmp(pdu, requestPdu, kRequestPduSize) != 0) {
+        error = "写响应与请求不一致";
+        return false;
+    }
+    return true;
+}
+
+std::string ModbusFrame::exceptionText(uint8_t code)
+{
+    switch (code) {
+    case 0x01: return "异常 01: 非法功能码";
+    case 0x02: return "异常 02: 非法数据地址";
+    case 0x03: return "异常 03: 非法数据值";
+    case 0x04: return "异常 04: 从站设备故障";
+    case 0x05: return "异常 05: 已确认，处理中";
+    case 0x06: return "异常 06: 从站设备忙";
+    case 0x08: return "异常 08: 存储奇偶校验错误";
+    case 0x0A: return "异常 0A: 网关路径不可用";
+    case 0x0B: return "异常 0B: 网关目标设备无响应";
+    default:   return "异常 " + std::to_string(code);
+    }
+}
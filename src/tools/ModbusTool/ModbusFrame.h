@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusFrame.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 帧编解码 — 读/写请求 PDU、Modbus TCP (MBAP) 与 RTU
+ *              (CRC16) 封装与拆帧、RTU 字符时序、响应解析与异常码。
+ *              直接写入调用方缓冲区，不分配内存。
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Modbus 数据表（决定功能码与数据宽度）
+enum class ModbusTable : uint8_t {
+    Coils,              // 0x 线圈（读 FC01 / 写 FC05）
+    DiscreteInputs,     // 1x 离散输入（FC02）
+    InputRegisters,     // 3x 输入寄存器（FC04）
+    HoldingRegisters    // 4x 保持寄存器（读 FC03 / 写 FC06）
+};
+
+// RTU 字符时序（纳秒）：由波特率与每字符位数推算；19200 以上按规范取固定值
+struct ModbusRtuTiming {
+    int64_t charNs = 0;        // 传输一个字符的时间
+    int64_t t15Ns = 0;         // 帧内字符最大间隔
+    int64_t t35Ns = 0;         // 帧间最小静默
+};
+
+class ModbusFrame {
+public:
+    // 协议上限（Modbus Application Protocol V1.1b3）
+    static constexpr int kMaxReadRegisters = 125;
+    static constexpr int kMaxReadBits = 2000;
+    static constexpr size_t kMbapHeaderSize = 7;     // 事务 ID + 协议 ID + 长度 + 单元 ID
+    static constexpr size_t kMaxPduSize = 253;
+    static constexpr size_t kMaxTcpFrameSize = kMbapHeaderSize + kMaxPduSize;
+    static constexpr size_t kRequestPduSize = 5;     // 功能码 + 地址 + 数量/值
+    static constexpr int kDefaultTcpPort = 502;
+    static constexpr size_t kRtuOverhead = 3;                    // 从站地址 + CRC16
+    static constexpr size_t kMaxRtuFrameSize = 1 + kMaxPduSize + 2;
+    static constexpr int kRtuFixedTimingBaud = 19200;            // 高于此波特率时 t1.5/t3.5 取固定值
+    static constexpr int64_t kRtuFixedT15Ns = 750000;
+    static constexpr int64_t kRtuFixedT35Ns = 1750000;
+
+    static bool isBitTable(ModbusTable table) {
+        return table == ModbusTable::Coils || table == ModbusTable::DiscreteInputs;
+    }
+    static int maxReadCount(ModbusTable table) {
+        return isBitTable(table) ? kMaxReadBits : kMaxReadRegisters;
+    }
+    static uint8_t readFunction(ModbusTable table);
+    // 单点写功能码（FC05 / FC06）；只读表返回 0
+    static uint8_t writeFunction(ModbusTable table);
+
+    // --- PDU（写入 out，返回字节数 kRequestPduSize） ---
+    static size_t encodeReadPdu(uint8_t* out, ModbusTable table, uint16_t address, uint16_t count);
+    static size_t encodeWritePdu(uint8_t* out, ModbusTable table, uint16_t address, uint16_t value);
+
+    // --- Modbus TCP：MBAP 头 + PDU（out 至少 kMbapHeaderSize + pduSize），返回总字节数 ---
+    static size_t encodeTcpFrame(uint8_t* out, uint16_t transactionId, uint8_t unitId,
+                                 const uint8_t* pdu, size_t pduSize);
+
+    // 流式拆帧：data 中第一帧的总长度；头部未收齐返回 0，协议 ID / 长度非法返回 -1
+    static int tcpFrameLength(const uint8_t* data, size_t available);
+    static uint16_t tcpTransactionId(const uint8_t* frame) {
+        return static_cast<uint16_t>(frame[0] << 8 | frame[1]);
+    }
+    static uint8_t tcpUnitId(const uint8_t* frame) { return frame[6]; }
+
+    // --- Modbus RTU：从站地址 + PDU + CRC16（低字节在前） ---
+    static uint16_t crc16(const uint8_t* data, size_t size);
+    // out 至少 kRtuOverhead + pduSize，返回总字节数
+    static size_t encodeRtuFrame(uint8_t* out, uint8_t unitId, const uint8_t* pdu, size_t pduSize);
+    // RTU 无长度字段：按请求功能码推算响应帧总长度。头部未收齐返回 0，功能码不符 / 不支持返回 -1
+    static int rtuResponseLength(const uint8_t* data, size_t available, uint8_t requestFunction);
+    static bool checkRtuCrc(const uint8_t* frame, size_t size);
+    // bitsPerChar = 起始位 + 数据位 + 校验位 + 停止位（规范要求 11）
+    static ModbusRtuTiming rtuTiming(int baudRate, int bitsPerChar = 11);
+
+    // --- 响应解析 ---
+    // 读响应 PDU → values（count 个，位表每位展开为 0/1），失败时 error 为原因（含异常码说明）
+    static bool decodeReadResponse(const uint8_t* pdu, size_t pduSize, ModbusTable table,
+                                   uint16_t count, uint16_t* values, std::string& error);
+    // 写响应：回显请求即成功
+    static bool decodeWriteResponse(const uint8_t* pdu, size_t pduSize, const uint8_t* requestPdu,
+                                    std::string& error);
+    static std::string exceptionText(uint8_t code);
+};
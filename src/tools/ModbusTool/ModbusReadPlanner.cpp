@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusReadPlanner.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 读取计划实现。
+ */
+
+#include "ModbusReadPlanner.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t kAddressSpace = 65536;
+
+struct Range {
+    uint32_t begin;
+    uint32_t end;      // 不含
+};
+
+} // namespace
+
+ModbusReadPlan ModbusReadPlanner::plan(const std::vector<ModbusTag>& input, const Options& options)
+{
+    ModbusReadPlan result;
+    result.tags = input;
+    ModbusPlanStats& stats = result.stats;
+    stats.tags = static_cast<uint32_t>(input.size());
+
+    for (auto& tag : result.tags) {
+        const uint32_t room = kAddressSpace - tag.address;
+        if (tag.count > room) {
+            tag.count = room;
+            ++stats.clippedTags;
+        }
+        const uint32_t max = static_cast<uint32_t>(ModbusFrame::maxReadCount(tag.table));
+        stats.naiveRequests += (tag.count + max - 1) / max;
+    }
+
+    // 按 (从站, 数据表, 地址) 排序，同组标签连续
+    std::vector<uint32_t> order(result.tags.size());
+    std::iota(order.begin(), order.end(), 0u);
+    const auto& tags = result.tags;
+    std::sort(order.begin(), order.end(), [&tags](uint32_t a, uint32_t b) {
+        const ModbusTag& x = tags[a];
+        const ModbusTag& y = tags[b];
+        if (x.unitId != y.unitId) return x.unitId < y.unitId;
+        if (x.table != y.table) return x.table < y.table;
+        return x.address < y.address;
+    });
+
+    // 每块对应的分片，最后按块顺序展平
+    std::vector<std::vector<ModbusTagSlice>> blockSlices;
+
+    size_t groupBegin = 0;
+    while (groupBegin < order.size()) {
+        const ModbusTag& first = tags[order[groupBegin]];
+        size_t groupEnd = groupBegin;
+        while (groupEnd < order.size() && tags[order[groupEnd]].unitId == first.unitId
+               && tags[order[groupEnd]].table == first.table) {
+            ++groupEnd;
+        }
+
+        const uint32_t max = static_cast<uint32_t>(ModbusFrame::maxReadCount(first.table));
+        const uint32_t gap = ModbusFrame::isBitTable(first.table) ? options.maxGapBits : options.maxGapRegisters;
+
+        // 1. 标签覆盖范围求并集
+        std::vector<Range> covered;
+        for (size_t i = groupBegin; i < groupEnd; ++i) {
+            const ModbusTag& t = tags[order[i]];
+            if (t.count == 0) continue;
+            const uint32_t b = t.address;
+            const uint32_t e = b + t.count;
+            if (!covered.empty() && b <= covered.back().end) {
+                covered.back().end = std::max(covered.back().end, e);
+            } else {
+                covered.push_back({b, e});
+            }
+        }
+
+        // 2. 贪心装块：空洞不超过 gap 且块未满时并入当前块，块满（达到协议上限）即关闭。
+        //    后段只能部分装入时，仅当其本身超过上限（无论如何都要拆分）才跨空洞并入，
+        //    否则单独成块，避免白读空洞
+        const size_t firstBlock = result.blocks.size();
+        bool open = false;
+        Range cur{0, 0};
+        auto closeBlock = [&]() {
+            ModbusReadBlock block;
+            block.unitId = first.unitId;
+            block.table = first.table;
+            block.address = static_cast<uint16_t>(cur.begin);
+            block.count = static_cast<uint16_t>(cur.end - cur.begin);
+            result.blocks.push_back(block);
+            open = false;
+        };
+        for (const Range& seg : covered) {
+            uint32_t s = seg.begin;
+            while (s < seg.end) {
+                const bool fits = seg.end <= cur.begin + max || seg.end - s > max;
+                if (open && s - cur.end <= gap && s < cur.begin + max && fits) {
+                    stats.gapPoints += s - cur.end;
+                    cur.end = std::min(seg.end, cur.begin + max);
+                } else {
+                    if (open) closeBlock();
+                    open = true;
+                    cur = {s, std::min(seg.end, s + max)};
+                }
+                s = cur.end;
+                if (cur.end - cur.begin == max) closeBlock();
+            }
+        }
+        if (open) closeBlock();
+
+        // 3. 标签 → 块分片（块按地址有序且互不重叠）
+        blockSlices.resize(result.blocks.size());
+        for (size_t i = groupBegin; i < groupEnd; ++i) {
+            const uint32_t tagIndex = order[i];
+            const ModbusTag& t = tags[tagIndex];
+            if (t.count == 0) continue;
+            const uint32_t b = t.address;
+            const uint32_t e = b + t.count;
+            auto it = std::lower_bound(result.blocks.begin() + static_cast<std::ptrdiff_t>(firstBlock),
+                                       result.blocks.end(), b,
+                                       [](const ModbusReadBlock& blk, uint32_t addr) {
+                                           return static_cast<uint32_t>(blk.address) + blk.count <= addr;
+                                       });
+            for (; it != result.blocks.end(); ++it) {
+                const uint32_t bb = it->address;
+                const uint32_t be = bb + it->count;
+                if (bb >= e) break;
+                const uint32_t from = std::max(b, bb);
+                const uint32_t to = std::min(e, be);
+                ModbusTagSlice slice;
+                slice.tag = tagIndex;
+                slice.tagOffset = from - b;
+                slice.blockOffset = static_cast<uint16_t>(from - bb);
+                slice.count = static_cast<uint16_t>(to - from);
+                blockSlices[static_cast<size_t>(it - result.blocks.begin())].push_back(slice);
+            }
+        }
+
+        groupBegin = groupEnd;
+    }
+
+    for (size_t i = 0; i < result.blocks.size(); ++i) {
+        result.blocks[i].firstSlice = static_cast<uint32_t>(result.slices.size());
+        result.blocks[i].sliceCount = static_cast<uint32_t>(blockSlices[i].size());
+        result.slices.insert(result.slices.end(), blockSlices[i].begin(), blockSlices[i].end());
+    }
+    stats.requests = static_cast<uint32_t>(result.blocks.size());
+    return result;
+}
+
+size_t ModbusReadPlan::totalPoints() const
+{
+    size_t total = 0;
+    for (const auto& t : tags) total += t.count;
+    return total;
+}
+
+std::vector<size_t> ModbusReadPlan::tagOffsets() const
+{
+    std::vector<size_t> offsets(tags.size());
+    size_t pos = 0;
+    for (size_t i = 0; i < tags.size(); ++i) {
+        offsets[i] = pos;
+        pos += tags[i].count;
+    }
+    return offsets;
+}
+
+void ModbusReadPlan::scatter(size_t blockIndex, const uint16_t* values, uint16_t* out,
+                             const std::vector<size_t>& offsets) const
+{
+    const ModbusReadBlock& block = blocks[blockIndex];
+    for (uint32_t i = 0; i < block.sliceCount; ++i) {
+        const ModbusTagSlice& s = slices[block.firstSlice + i];
+        std::memcpy(out + offsets[s.tag] + s.tagOffset, values + s.blockOffset, s.count * sizeof(uint16_t));
+    }
+}
+
+std::string ModbusReadPlan::summary() const
+{
+    std::string text = std::to_string(stats.tags) + " 个标签 → " + std::to_string(stats.requests) + " 个请求";
+    text += "（节省 " + std::to_string(stats.saved()) + " 个";
+    if (stats.gapPoints > 0) text += "，多读 " + std::to_string(stats.gapPoints) + " 点";
+    text += "）";
+    if (stats.clippedTags > 0) text += "，" + std::to_string(stats.clippedTags) + " 个标签超出地址空间已截断";
+    return text;
+}
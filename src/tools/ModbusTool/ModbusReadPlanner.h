@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusReadPlanner.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 读取计划 — 将任意 (从站, 数据表, 地址, 数量) 标签集合
+ *              合并为尽量少的读请求：相邻/重叠范围合并，间隔不超过阈值时连同空洞
+ *              一并读取，超出协议上限 (125 寄存器 / 2000 位) 的范围按上限拆分。
+ *              响应按计划分发回各标签。
+ */
+
+#pragma once
+#include "ModbusFrame.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 标签：用户关心的一段连续地址
+struct ModbusTag {
+    uint8_t unitId = 1;
+    ModbusTable table = ModbusTable::HoldingRegisters;
+    uint16_t address = 0;
+    uint32_t count = 1;        // 可超过单次读取上限；地址空间末尾之外的部分被截掉
+};
+
+// 一次实际发出的读请求
+struct ModbusReadBlock {
+    uint8_t unitId = 1;
+    ModbusTable table = ModbusTable::HoldingRegisters;
+    uint16_t address = 0;
+    uint16_t count = 0;
+    uint32_t firstSlice = 0;   // 在 ModbusReadPlan::slices 中的起始下标
+    uint32_t sliceCount = 0;
+};
+
+// 块内一段数据 → 标签内一段数据
+struct ModbusTagSlice {
+    uint32_t tag = 0;
+    uint32_t tagOffset = 0;
+    uint16_t blockOffset = 0;
+    uint16_t count = 0;
+};
+
+struct ModbusPlanStats {
+    uint32_t tags = 0;
+    uint32_t naiveRequests = 0;    // 每个标签单独读取（超限按上限拆分）所需的请求数
+    uint32_t requests = 0;         // 计划实际请求数
+    uint32_t gapPoints = 0;        // 为合并而多读的空洞点数
+    uint32_t clippedTags = 0;      // 超出地址空间被截断的标签数
+    uint32_t saved() const { return naiveRequests > requests ? naiveRequests - requests : 0; }
+};
+
+struct ModbusReadPlan {
+    std::vector<ModbusTag> tags;           // 规整后的标签（count 已截断），下标与输入一致
+    std::vector<ModbusReadBlock> blocks;
+    std::vector<ModbusTagSlice> slices;    // 按块分组存放
+    ModbusPlanStats stats;
+
+    // 所有标签点数之和（按标签顺序拼接时的总长度）
+    size_t totalPoints() const;
+    // 标签在拼接结果中的起始偏移
+    std::vector<size_t> tagOffsets() const;
+
+    // 将块 blockIndex 的响应 values 写入拼接结果 out（长度 totalPoints()）
+    void scatter(size_t blockIndex, const uint16_t* values, uint16_t* out,
+                 const std::vector<size_t>& offsets) const;
+
+    // 例："12 个标签 → 3 个请求（节省 9 个，多读 40 点）"
+    std::string summary() const;
+};
+
+class ModbusReadPlanner {
+public:
+    // 合并阈值：两段之间的空洞不超过此点数时合并为一个请求。
+    // 一次额外往返远比几十个寄存器的字节开销昂贵；设为 0 则只合并相邻/重叠范围
+    // （部分设备读取未映射地址会返回异常 02，此时应关闭空洞合并）
+    static constexpr uint32_t kDefaultMaxGapRegisters = 32;
+    static constexpr uint32_t kDefaultMaxGapBits = 256;
+
+    struct Options {
+        uint32_t maxGapRegisters = kDefaultMaxGapRegisters;
+        uint32_t maxGapBits = kDefaultMaxGapBits;
+    };
+
+    static ModbusReadPlan plan(const std::vector<ModbusTag>& tags, const Options& options);
+    static ModbusReadPlan plan(const std::vector<ModbusTag>& tags) { return plan(tags, Options()); }
+};
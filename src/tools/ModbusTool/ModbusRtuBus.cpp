@@ -0,0 +1,474 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusRtuBus.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus RTU 串口总线仲裁实现。
+ */
+
+#include "ModbusRtuBus.h"
+#include "ModbusTaskTable.h"
+#include "lwconn_serial.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using Clock = ModbusRtuBus::Clock;
+
+int64_t microsBetween(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+int millisUntil(Clock::time_point from, Clock::time_point to)
+{
+    const auto us = microsBetween(from, to);
+    return us <= 0 ? 0 : static_cast<int>((us + 999) / 1000);
+}
+
+} // namespace
+
+struct ModbusRtuBus::Impl {
+    using Pending = ModbusPendingBase;
+
+    SerialConfig m_config;
+    ModbusRtuTiming m_timing;
+    std::unique_ptr<LWConnBase> m_serial;
+
+    // --- 跨线程状态（m_mutex 保护） ---
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Pending> m_queue;
+    ModbusTaskTable m_tasks;
+    bool m_releaseCallbacks = false;      // 有任务被移除，回调对象待总线线程释放
+    bool m_stop = false;
+
+    // 持有期间执行完成回调；removePeriodic / clearPeriodic 在其他线程调用时先取得它，
+    // 保证返回后不再回调。加锁顺序：m_callbackMutex → m_mutex
+    std::mutex m_callbackMutex;
+
+    std::atomic<int> m_timeoutMs{kDefaultTimeoutMs};
+    std::atomic<int> m_turnaroundMs{kDefaultTurnaroundMs};
+
+    ModbusPollCounters m_counters;
+
+    // --- 仅总线线程访问 ---
+    Clock::time_point m_lastActivity;     // 总线上最后一个字符（收或发）的时刻
+    Clock::time_point m_retryAt;
+    std::array<uint8_t, ModbusFrame::kMaxRtuFrameSize> m_tx{};
+    std::array<uint8_t, ModbusFrame::kMaxRtuFrameSize> m_rx{};
+    std::array<uint16_t, ModbusFrame::kMaxReadBits> m_values{};   // 读结果解码缓冲
+
+    std::thread m_thread;
+    std::thread::id m_threadId;
+
+    Impl(const SerialConfig& config, std::unique_ptr<LWConnBase> port)
+        : m_config(config)
+        , m_timing(ModbusFrame::rtuTiming(config.baudRate, config.bitsPerChar()))
+        , m_serial(std::move(port))
+    {
+        // 等总线线程记下自己的 ID 再返回：此后 onBusThread 在任意线程调用都可靠
+        std::promise<void> started;
+        std::future<void> ready = started.get_future();
+        m_thread = std::thread([this, &started]() {
+            m_threadId = std::this_thread::get_id();
+            started.set_value();
+            run();
+        });
+        ready.wait();
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+        m_serial->stop();
+    }
+
+    bool onBusThread() const { return std::this_thread::get_id() == m_threadId; }
+
+    // ============================================================
+    // 完成
+    // ============================================================
+
+    void finish(Pending& p, ModbusResult& result) {
+        m_counters.recordResult(result.ok);
+        std::lock_guard<std::mutex> callbackLock(m_callbackMutex);
+        if (p.taskId >= 0) {
+            ModbusTaskTable::Task* task = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                task = m_tasks.complete(p);
+            }
+            if (!task) return;
+            result.lateUs = p.lateUs;
+            if (task->done) task->done(result);
+        } else if (p.done) {
+            p.done(result);
+        }
+    }
+
+    void fail(Pending& p, const std::string& error) {
+        ModbusResult result;
+        result.error = error;
+        finish(p, result);
+    }
+
+    // 需持有 m_mutex：到期的周期任务排入队尾
+    void fireDueTasks(Clock::time_point now) {
+        m_tasks.fireDue<Pending>(now, m_counters, [this](const ModbusTaskTable::Task&, Pending&& p) {
+            m_queue.push_back(std::move(p));
+        });
+    }
+
+    // 需持有 m_mutex：丢弃排队中尚未发出的周期请求（任务移除后不应再占用总线）
+    template <typename Pred>
+    void purgeQueued(Pred&& pred) {
+        m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), pred), m_queue.end());
+    }
+
+    // 需持有 m_mutex：释放已移除任务的回调对象并回收其 ID（此时没有回调在执行）
+    void releaseCallbacks() {
+        if (!m_releaseCallbacks) return;
+        m_tasks.releaseAll();
+        m_releaseCallbacks = false;
+    }
+
+    // ============================================================
+    // 总线时序
+    // ============================================================
+
+    // 睡到距目标不足 kSpinUs，其余以 yield 等待；RTU 帧间静默在 19200 波特率以上只有 1.75ms
+    void waitUntil(Clock::time_point target) {
+        for (;;) {
+            const auto now = Clock::now();
+            if (now >= target) return;
+            if (microsBetween(now, target) > kSpinUs) {
+                std::this_thread::sleep_until(target - std::chrono::microseconds(kSpinUs));
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    Clock::duration frameTime(size_t bytes) const {
+        return std::chrono::nanoseconds(m_timing.charNs * static_cast<int64_t>(bytes));
+    }
+
+    bool ensureOpen(Clock::time_point now, std::string& error) {
+        if (m_serial->isConnected()) return true;
+        if (now < m_retryAt) {
+            error = "串口 " + m_config.port + " 未打开，等待重试";
+            return false;
+        }
+        if (m_serial->start() != LWConnError::SUCCESS) {
+            m_retryAt = now + std::chrono::milliseconds(kReopenDelayMs);
+            error = "打开串口 " + m_config.port + " 失败";
+            return false;
+        }
+        m_lastActivity = Clock::now();
+        return true;
+    }
+
+    void closePort(Clock::time_point now) {
+        m_serial->disconnect();
+        m_retryAt = now + std::chrono::milliseconds(kReopenDelayMs);
+    }
+
+    // 丢弃到达的字节，直到连续 quietMs 无数据；嘈杂线路上最多等待一个应答超时
+    void discardUntilQuiet(int quietMs) {
+        const auto limit = Clock::now() + std::chrono::milliseconds(m_timeoutMs.load());
+        while (Clock::now() < limit) {
+            size_t n = 0;
+            m_serial->receive(reinterpret_cast<char*>(m_rx.data()), m_rx.size(), n, quietMs);
+            if (n == 0) return;
+        }
+    }
+
+    // ============================================================
+    // 事务
+    // ============================================================
+
+    void transact(Pending& p) {
+        const ModbusRequest& req = p.request;
+        const bool broadcast = req.unitId == 0;
+        if (broadcast && !req.write) {
+            fail(p, "广播地址只能写入");
+            return;
+        }
+        if (!req.valid()) {
+            fail(p, req.write ? "该数据表不可写" : "读取数量超出范围");
+            return;
+        }
+        std::string error;
+        if (!ensureOpen(Clock::now(), error)) {
+            fail(p, error);
+            return;
+        }
+
+        uint8_t pdu[ModbusFrame::kRequestPduSize];
+        if (req.write) {
+            ModbusFrame::encodeWritePdu(pdu, req.table, req.address, req.value);
+        } else {
+            ModbusFrame::encodeReadPdu(pdu, req.table, req.address, req.count);
+        }
+        const size_t txSize = ModbusFrame::encodeRtuFrame(m_tx.data(), req.unitId, pdu, sizeof(pdu));
+
+        // 帧间至少 t3.5 静默，否则从站会把两帧当作一帧
+        waitUntil(m_lastActivity + std::chrono::nanoseconds(m_timing.t35Ns));
+        m_serial->clearReceiveBuffer();   // 丢弃上一事务超时后迟到的字节
+        const auto sentAt = Clock::now();
+        ++m_counters.sent;
+        if (m_serial->send(reinterpret_cast<const char*>(m_tx.data()), txSize, m_timeoutMs) != LWConnError::SUCCESS) {
+            closePort(Clock::now());
+            fail(p, "串口 " + m_config.port + " 发送失败");
+            return;
+        }
+        // send 返回时数据可能仍在驱动缓冲区，按波特率推算最后一个字符离开线路的时刻
+        const auto txDone = std::max(Clock::now(), sentAt + frameTime(txSize));
+        m_lastActivity = txDone;
+
+        if (broadcast) {
+            waitUntil(txDone + std::chrono::milliseconds(m_turnaroundMs.load()));
+            m_lastActivity = Clock::now();
+            ModbusResult result;
+            result.ok = true;
+            result.latencyUs = microsBetween(sentAt, m_lastActivity);
+            finish(p, result);
+            return;
+        }
+
+        const auto deadline = txDone + std::chrono::milliseconds(m_timeoutMs.load());
+        const int interCharMs = std::max(kMinInterCharTimeoutMs,
+                                         static_cast<int>((m_timing.t15Ns + 999999) / 1000000));
+        size_t got = 0;
+        int frameLen = 0;
+        while (frameLen <= 0 || got < static_cast<size_t>(frameLen)) {
+            const auto now = Clock::now();
+            // 首字节前等待应答超时；帧开始后字符间隔超过阈值即判定断帧
+            const int waitMs = got == 0 ? millisUntil(now, deadline) : interCharMs;
+            if (got == 0 && waitMs == 0) {
+                error = "应答超时";
+                ++m_counters.timeouts;
+                break;
+            }
+            size_t n = 0;
+            const LWConnError rc = m_serial->receive(reinterpret_cast<char*>(m_rx.data() + got),
+                                                    m_rx.size() - got, n, waitMs);
+            if (n > 0) {
+                got += n;
+                m_lastActivity = Clock::now();
+                frameLen = ModbusFrame::rtuResponseLength(m_rx.data(), got, pdu[0]);
+                if (frameLen < 0 || static_cast<size_t>(frameLen) > m_rx.size()) {
+                    error = "RTU 应答与请求不匹配";
+                    break;
+                }
+                continue;
+            }
+            if (rc == LWConnError::TIMEOUT || rc == LWConnError::SUCCESS) {
+                if (got > 0) {
+                    error = "RTU 应答不完整（字符间隔超时）";
+                    break;
+                }
+                continue;
+            }
+            closePort(Clock::now());
+            error = "串口 " + m_config.port + " 接收失败";
+            break;
+        }
+
+        const auto now = Clock::now();
+        if (error.empty()) {
+            if (m_rx[0] != req.unitId) {
+                error = "RTU 应答从站地址不符";
+            } else if (!ModbusFrame::checkRtuCrc(m_rx.data(), static_cast<size_t>(frameLen))) {
+                error = "RTU 应答 CRC 校验失败";
+            }
+        }
+        if (!error.empty()) {
+            // 从站可能仍在发送：等线路安静后再重新计 t3.5，避免残余字节被当作下一个应答
+            if (m_serial->isConnected()) discardUntilQuiet(interCharMs);
+            m_lastActivity = Clock::now();
+            fail(p, error);
+            return;
+        }
+
+        ModbusResult result;
+        result.latencyUs = microsBetween(sentAt, now);
+        const uint8_t* respPdu = m_rx.data() + 1;
+        const size_t respSize = static_cast<size_t>(frameLen) - ModbusFrame::kRtuOverhead;
+        if (req.write) {
+            result.ok = ModbusFrame::decodeWriteResponse(respPdu, respSize, pdu, result.error);
+        } else {
+            result.ok = ModbusFrame::decodeReadResponse(respPdu, respSize, req.table, req.count,
+                                                        m_values.data(), result.error);
+            if (result.ok) {
+                result.values = m_values.data();
+                result.count = req.count;
+            }
+        }
+        m_counters.recordResponse(result.latencyUs);
+        finish(p, result);
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            releaseCallbacks();
+            fireDueTasks(Clock::now());
+            if (m_queue.empty()) {
+                const auto wakeAt = m_tasks.empty() ? Clock::now() + std::chrono::seconds(1)
+                                                    : m_tasks.nextDeadline();
+                // 距截止时间很近时不进入条件变量等待，保证周期任务的发出时刻
+                if (microsBetween(Clock::now(), wakeAt) > kSpinUs) {
+                    m_cv.wait_until(lock, wakeAt - std::chrono::microseconds(kSpinUs));
+                } else {
+                    lock.unlock();
+                    waitUntil(wakeAt);
+                    lock.lock();
+                }
+                continue;
+            }
+            Pending p = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+            transact(p);
+            lock.lock();
+        }
+    }
+};
+
+// ============================================================
+// 公共接口
+// ============================================================
+
+ModbusRtuBus::ModbusRtuBus(const SerialConfig& config)
+    : ModbusRtuBus(config, std::make_unique<LWSerial>("modbus-rtu:" + config.port, config.port, config.baudRate,
+                                                      config.parity, config.dataBits, config.stopBits))
+{
+}
+
+ModbusRtuBus::ModbusRtuBus(const SerialConfig& config, std::unique_ptr<LWConnBase> port)
+    : m_impl(std::make_unique<Impl>(config, std::move(port)))
+{
+}
+
+ModbusRtuBus::~ModbusRtuBus() = default;
+
+const ModbusRtuBus::SerialConfig& ModbusRtuBus::config() const
+{
+    return m_impl->m_config;
+}
+
+ModbusRtuTiming ModbusRtuBus::timing() const
+{
+    return m_impl->m_timing;
+}
+
+void ModbusRtuBus::setTimeoutMs(int ms)
+{
+    m_impl->m_timeoutMs = ms > 0 ? ms : kDefaultTimeoutMs;
+}
+
+void ModbusRtuBus::setTurnaroundMs(int ms)
+{
+    m_impl->m_turnaroundMs = ms > 0 ? ms : kDefaultTurnaroundMs;
+}
+
+void ModbusRtuBus::submit(const ModbusRequest& request, Completion done)
+{
+    Impl::Pending p;
+    p.request = request;
+    p.done = std::move(done);
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        m_impl->m_queue.push_back(std::move(p));
+    }
+    m_impl->m_cv.notify_one();
+}
+
+int ModbusRtuBus::addScanClass(std::chrono::microseconds period)
+{
+    if (period.count() <= 0) return -1;
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        id = m_impl->m_tasks.allocateClassId();
+        m_impl->m_tasks.addClass(id, period, Clock::now());
+    }
+    m_impl->m_cv.notify_one();
+    return id;
+}
+
+int ModbusRtuBus::addPeriodic(const ModbusRequest& request, int scanClass, Completion done)
+{
+    if (scanClass < 0 || !request.valid()) return -1;
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        id = m_impl->m_tasks.allocateTaskId();
+        m_impl->m_tasks.add(id, -1, request, std::move(done), scanClass, Clock::now());
+    }
+    m_impl->m_cv.notify_one();
+    return id;
+}
+
+void ModbusRtuBus::removePeriodic(int taskId)
+{
+    // 在回调内（总线线程）调用时回调锁已由本线程持有
+    std::unique_lock<std::mutex> callbackLock(m_impl->m_callbackMutex, std::defer_lock);
+    if (!m_impl->onBusThread()) callbackLock.lock();
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        if (!m_impl->m_tasks.remove(taskId, Clock::now())) return;
+        m_impl->purgeQueued([taskId](const auto& p) { return p.taskId == taskId; });
+        m_impl->m_releaseCallbacks = true;
+    }
+    m_impl->m_cv.notify_one();   // 尽快释放回调对象并回收 ID
+}
+
+void ModbusRtuBus::clearPeriodic()
+{
+    std::unique_lock<std::mutex> callbackLock(m_impl->m_callbackMutex, std::defer_lock);
+    if (!m_impl->onBusThread()) callbackLock.lock();
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+        m_impl->m_tasks.clear();
+        m_impl->purgeQueued([](const auto& p) { return p.taskId >= 0; });
+        m_impl->m_releaseCallbacks = true;
+    }
+    m_impl->m_cv.notify_one();
+}
+
+std::vector<ModbusScanClassStats> ModbusRtuBus::scanClassStats() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    return m_impl->m_tasks.classStats();
+}
+
+ModbusPollerStats ModbusRtuBus::stats() const
+{
+    return m_impl->m_counters.snapshot();
+}
+
+void ModbusRtuBus::resetStats()
+{
+    m_impl->m_counters.reset();
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    m_impl->m_tasks.resetStats();
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusRtuBus.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus RTU 串口总线仲裁 — 一条串口线一个实例，独立线程按先到先发
+ *              逐个完成事务（RTU 为半双工主从总线，同一时刻只能有一个请求在途）。
+ *              帧间按波特率推算的 t3.5 静默，应答按功能码推算长度拆帧并校验 CRC。
+ *              周期任务与 ModbusTcpPoller 一样按扫描等级由 ModbusScanScheduler 调度。
+ */
+
+#pragma once
+#include "ModbusTcpPoller.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+class LWConnBase;
+
+class ModbusRtuBus {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 完成回调在总线线程执行，不得阻塞（会占住总线）
+    using Completion = ModbusTcpPoller::Completion;
+
+    struct SerialConfig {
+        std::string port;              // 如 COM3、/dev/ttyUSB0
+        int baudRate = 9600;
+        char parity = 'N';             // N / E / O
+        int dataBits = 8;
+        int stopBits = 1;
+
+        int bitsPerChar() const { return 1 + dataBits + (parity == 'N' ? 0 : 1) + stopBits; }
+    };
+
+    explicit ModbusRtuBus(const SerialConfig& config);
+    // 使用调用方提供的端口（须为半双工串行链路）；config 只用于推算帧时序与错误信息
+    ModbusRtuBus(const SerialConfig& config, std::unique_ptr<LWConnBase> port);
+    ~ModbusRtuBus();   // 停止总线线程并关闭串口，未完成的请求不再回调
+
+    ModbusRtuBus(const ModbusRtuBus&) = delete;
+    ModbusRtuBus& operator=(const ModbusRtuBus&) = delete;
+
+    const SerialConfig& config() const;
+    ModbusRtuTiming timing() const;
+
+    // 单个请求的应答超时（自请求帧发送完毕起算）
+    void setTimeoutMs(int ms);
+    // 广播（从站地址 0）写入后的等待时间，期间从站处理请求，总线不发新帧
+    void setTurnaroundMs(int ms);
+
+    // 提交一次性请求（线程安全）；从站地址 0 为广播，只允许写入，成功即视为完成。
+    // 请求无效（见 ModbusRequest::valid）时以失败回调
+    void submit(const ModbusRequest& request, Completion done);
+
+    // 扫描等级与周期任务，语义同 ModbusTcpPoller
+    int addScanClass(std::chrono::microseconds period);
+    int addPeriodic(const ModbusRequest& request, int scanClass, Completion done);
+    // 移除周期任务；返回后该任务不再回调（在完成回调内调用时同样成立）
+    void removePeriodic(int taskId);
+    void clearPeriodic();         // 同时清除全部扫描等级
+
+    std::vector<ModbusScanClassStats> scanClassStats() const;
+    ModbusPollerStats stats() const;
+    void resetStats();
+
+    static constexpr int kDefaultTimeoutMs = 1000;
+    static constexpr int kDefaultTurnaroundMs = 100;
+    // 帧内字符间隔判定下限：USB 转串口与操作系统按毫秒级批量交付数据，
+    // 低于此值会把正常应答误判为断帧
+    static constexpr int kMinInterCharTimeoutMs = 20;
+    static constexpr int kReopenDelayMs = 1000;
+    static constexpr int kSpinUs = 2000;   // 距目标时刻不足此值时不再睡眠，让出 CPU 等待
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
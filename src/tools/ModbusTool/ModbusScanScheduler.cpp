@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusScanScheduler.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 扫描调度实现。
+ */
+
+#include "ModbusScanScheduler.h"
+#include <algorithm>
+#include <functional>
+
+void ModbusScanScheduler::addClass(int classId, std::chrono::microseconds period, Clock::time_point now)
+{
+    if (classId < 0 || period.count() <= 0) return;
+    if (m_classes.size() <= static_cast<size_t>(classId)) m_classes.resize(static_cast<size_t>(classId) + 1);
+    ScanClass& cls = m_classes[static_cast<size_t>(classId)];
+    cls = ScanClass();
+    cls.active = true;
+    cls.period = period;
+    cls.epoch = now;
+    cls.stats.periodUs = period.count();
+}
+
+void ModbusScanScheduler::add(int item, int classId, Clock::time_point now)
+{
+    if (item < 0 || classId < 0 || static_cast<size_t>(classId) >= m_classes.size()) return;
+    ScanClass& cls = m_classes[static_cast<size_t>(classId)];
+    if (!cls.active) return;
+    if (m_items.size() <= static_cast<size_t>(item)) m_items.resize(static_cast<size_t>(item) + 1);
+    if (m_items[static_cast<size_t>(item)].active) remove(item, now);
+
+    Item& it = m_items[static_cast<size_t>(item)];
+    it = Item();
+    it.active = true;
+    it.classId = classId;
+    it.due = Clock::time_point::min();   // 尚无截止时间，重新分布时必然入堆
+    cls.items.push_back(item);
+    ++m_activeItems;
+    markDirty(cls, now);
+}
+
+void ModbusScanScheduler::remove(int item, Clock::time_point now)
+{
+    if (item < 0 || static_cast<size_t>(item) >= m_items.size()) return;
+    Item& it = m_items[static_cast<size_t>(item)];
+    if (!it.active) return;
+    it.active = false;
+    ScanClass& cls = m_classes[static_cast<size_t>(it.classId)];
+    cls.items.erase(std::remove(cls.items.begin(), cls.items.end(), item), cls.items.end());
+    --m_activeItems;
+    markDirty(cls, now);
+}
+
+void ModbusScanScheduler::clear()
+{
+    m_classes.clear();
+    m_items.clear();
+    m_heap.clear();
+    m_activeItems = 0;
+    m_dirty = false;
+    m_totalOverruns = 0;
+}
+
+void ModbusScanScheduler::complete(int item)
+{
+    if (item >= 0 && static_cast<size_t>(item) < m_items.size()) m_items[static_cast<size_t>(item)].busy = false;
+}
+
+ModbusScanScheduler::Clock::time_point ModbusScanScheduler::nextDeadline()
+{
+    settle();
+    // 丢弃堆顶的失效条目，避免按已移除 / 已改期条目的时间提前唤醒
+    while (!m_heap.empty()) {
+        const Deadline& d = m_heap.front();
+        const Item& it = m_items[static_cast<size_t>(d.item)];
+        if (it.active && it.due == d.due) break;
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Deadline>());
+        m_heap.pop_back();
+    }
+    return m_heap.front().due;
+}
+
+void ModbusScanScheduler::markDirty(ScanClass& cls, Clock::time_point now)
+{
+    cls.stats.items = static_cast<uint32_t>(cls.items.size());
+    cls.dirty = true;
+    cls.rebalanceAt = now;
+    m_dirty = true;
+}
+
+void ModbusScanScheduler::settle()
+{
+    if (!m_dirty) return;
+    m_dirty = false;
+    for (ScanClass& cls : m_classes) {
+        if (!cls.dirty) continue;
+        cls.dirty = false;
+        rebalance(cls, cls.rebalanceAt);
+    }
+    if (m_heap.size() > m_activeItems * 2 + kHeapSlack) rebuildHeap();
+}
+
+void ModbusScanScheduler::rebalance(ScanClass& cls, Clock::time_point now)
+{
+    // 第 k 个条目的相位 = period * k / N，截止时间取 epoch + m*period + 相位 中不早于 now 的最小值。
+    // 截止时间有变的条目追加新的堆条目，旧条目出堆时按 it.due 不符丢弃
+    const int64_t period = cls.period.count();
+    const auto n = static_cast<int64_t>(cls.items.size());
+    const int64_t sinceEpoch = std::chrono::duration_cast<std::chrono::microseconds>(now - cls.epoch).count();
+    for (int64_t k = 0; k < n; ++k) {
+        const int64_t offset = period * k / n;
+        int64_t rounds = 0;
+        if (sinceEpoch > offset) rounds = (sinceEpoch - offset + period - 1) / period;
+        const int item = cls.items[static_cast<size_t>(k)];
+        const auto due = cls.epoch + std::chrono::microseconds(rounds * period + offset);
+        Item& it = m_items[static_cast<size_t>(item)];
+        if (it.due == due) continue;
+        // 刚触发过（含仍在执行）的条目：新位置早于上次触发后一个周期时保留原截止时间，
+        // 否则同一条目会在不足一个周期内再次请求
+        if (due < it.lastFire + cls.period) continue;
+        it.due = due;
+        pushDeadline(item);
+    }
+}
+
+void ModbusScanScheduler::pushDeadline(int item)
+{
+    m_heap.push_back(Deadline{ m_items[static_cast<size_t>(item)].due, item });
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<Deadline>());
+}
+
+void ModbusScanScheduler::rebuildHeap()
+{
+    m_heap.clear();
+    for (size_t i = 0; i < m_items.size(); ++i) {
+        if (m_items[i].active) m_heap.push_back(Deadline{ m_items[i].due, static_cast<int>(i) });
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), std::greater<Deadline>());
+}
+
+size_t ModbusScanScheduler::collectDue(Clock::time_point now, std::vector<Fire>& out)
+{
+    out.clear();
+    settle();
+    while (!m_heap.empty() && m_heap.front().due <= now) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Deadline>());
+        Deadline d = m_heap.back();
+        m_heap.pop_back();
+
+        Item& it = m_items[static_cast<size_t>(d.item)];
+        if (!it.active || it.due != d.due) continue;
+        ScanClass& cls = m_classes[static_cast<size_t>(it.classId)];
+
+        if (it.busy) {
+            ++cls.stats.overruns;
+            ++m_totalOverruns;
+        } else {
+            const int64_t late = std::chrono::duration_cast<std::chrono::microseconds>(now - it.due).count();
+            cls.stats.maxLateUs = std::max(cls.stats.maxLateUs, late);
+            ++cls.stats.fired;
+            it.busy = true;
+            it.lastFire = now;
+            out.push_back(Fire{ d.item, late });
+        }
+
+        // 下一轮按绝对时间推进；落后超过一个周期时跳过错过的轮次
+        it.due += cls.period;
+        if (it.due <= now) {
+            const auto skipped = (now - it.due) / cls.period + 1;
+            cls.stats.missed += static_cast<uint64_t>(skipped);
+            m_totalOverruns += static_cast<uint64_t>(skipped);
+            it.due += cls.period * skipped;
+        }
+        pushDeadline(d.item);
+    }
+    return out.size();
+}
+
+std::vector<ModbusScanClassStats> ModbusScanScheduler::stats() const
+{
+    std::vector<ModbusScanClassStats> result;
+    result.reserve(m_classes.size());
+    for (const auto& cls : m_classes) result.push_back(cls.stats);
+    return result;
+}
+
+void ModbusScanScheduler::resetStats()
+{
+    for (auto& cls : m_classes) {
+        const int64_t period = cls.stats.periodUs;
+        const uint32_t items = cls.stats.items;
+        cls.stats = ModbusScanClassStats();
+        cls.stats.periodUs = period;
+        cls.stats.items = items;
+    }
+    m_totalOverruns = 0;
+}
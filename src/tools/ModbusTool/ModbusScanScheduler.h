@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusScanScheduler.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 扫描调度 — 按扫描等级（如 50ms / 500ms / 5s）组织周期条目，
+ *              截止时间最小堆驱动。同一等级内的条目相位在周期内均匀错开，避免同一
+ *              时刻突发；条目到期时上一轮仍未完成计为超限并跳过本轮。
+ *              不含线程与 I/O，由调用方（ModbusTcpPoller 引擎线程）驱动。
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct ModbusScanClassStats {
+    int64_t periodUs = 0;
+    uint32_t items = 0;
+    uint64_t fired = 0;
+    uint64_t overruns = 0;     // 到期时上一轮尚未完成，本轮跳过
+    uint64_t missed = 0;       // 调度落后超过一个周期而整轮错过
+    int64_t maxLateUs = 0;     // 实际触发时刻晚于计划时刻的最大值
+};
+
+class ModbusScanScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Fire {
+        int item;
+        int64_t lateUs;
+    };
+
+    // 类与条目 ID 由调用方分配（小的非负整数，按下标存储）
+    void addClass(int classId, std::chrono::microseconds period, Clock::time_point now);
+    // 加入/移除条目后，该等级内全部条目的相位重新均匀分布（新位置早于上次触发后一个周期的
+    // 条目保留原截止时间，不会提前再次触发）。重新分布推迟到下一次
+    // collectDue / nextDeadline 统一进行，连续登记 N 个条目只计算一次；
+    // 旧的截止时间条目留在堆中，出堆时按失效丢弃
+    void add(int item, int classId, Clock::time_point now);
+    void remove(int item, Clock::time_point now);
+    void clear();              // 同时清零累计超限
+
+    // 条目本轮请求已完成（成功或失败），下次到期可再次触发
+    void complete(int item);
+
+    // 取出 now 时刻到期的条目（out 先清空），忙碌条目计入超限而不返回
+    size_t collectDue(Clock::time_point now, std::vector<Fire>& out);
+
+    bool empty() const { return m_activeItems == 0; }
+    // 最早的截止时间；调用前须确认 !empty()
+    Clock::time_point nextDeadline();
+
+    std::vector<ModbusScanClassStats> stats() const;
+    uint64_t totalOverruns() const { return m_totalOverruns; }   // 全部等级 overruns + missed 累计
+    void resetStats();
+
+private:
+    struct ScanClass {
+        bool active = false;
+        std::chrono::microseconds period{0};
+        Clock::time_point epoch;
+        std::vector<int> items;          // 加入顺序即相位顺序
+        ModbusScanClassStats stats;
+        bool dirty = false;              // 条目有增减，相位待重新分布
+        Clock::time_point rebalanceAt;   // 最近一次增减的时刻
+    };
+
+    struct Item {
+        bool active = false;
+        bool busy = false;
+        int classId = -1;
+        Clock::time_point due;
+        Clock::time_point lastFire = Clock::time_point::min();
+    };
+
+    struct Deadline {
+        Clock::time_point due;
+        int item;
+        bool operator>(const Deadline& o) const { return due > o.due; }
+    };
+
+    void markDirty(ScanClass& cls, Clock::time_point now);
+    void settle();
+    void rebalance(ScanClass& cls, Clock::time_point now);
+    void pushDeadline(int item);
+    void rebuildHeap();
+
+    // 堆中失效条目超过有效条目数加此值时整体重建，避免反复增删后堆无限增长
+    static constexpr size_t kHeapSlack = 64;
+
+    std::vector<ScanClass> m_classes;
+    std::vector<Item> m_items;
+    std::vector<Deadline> m_heap;
+    size_t m_activeItems = 0;
+    bool m_dirty = false;
+    uint64_t m_totalOverruns = 0;
+};
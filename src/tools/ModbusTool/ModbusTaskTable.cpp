@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusTaskTable.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 周期任务表与运行统计实现。
+ */
+
+#include "ModbusTaskTable.h"
+
+// ============================================================
+// 运行统计
+// ============================================================
+
+void ModbusPollCounters::recordLate(int64_t lateUs)
+{
+    ++lateSamples;
+    lateSumUs += lateUs;
+    int64_t prev = maxLateUs.load();
+    while (lateUs > prev && !maxLateUs.compare_exchange_weak(prev, lateUs)) {}
+}
+
+ModbusPollerStats ModbusPollCounters::snapshot() const
+{
+    ModbusPollerStats s;
+    s.sent = sent;
+    s.succeeded = succeeded;
+    s.failed = failed;
+    s.timeouts = timeouts;
+    s.overruns = overruns;
+    s.maxLateUs = maxLateUs;
+    const uint64_t samples = lateSamples;
+    if (samples > 0) s.avgLateUs = static_cast<double>(lateSumUs) / samples;
+    const uint64_t n = responses;
+    if (n > 0) s.avgLatencyUs = static_cast<double>(latencySumUs) / n;
+    return s;
+}
+
+void ModbusPollCounters::reset()
+{
+    sent = 0;
+    succeeded = 0;
+    failed = 0;
+    timeouts = 0;
+    overruns = 0;
+    lateSamples = 0;
+    responses = 0;
+    lateSumUs = 0;
+    maxLateUs = 0;
+    latencySumUs = 0;
+}
+
+// ============================================================
+// 周期任务表
+// ============================================================
+
+int ModbusTaskTable::allocateTaskId()
+{
+    if (m_freeIds.empty()) return m_nextTaskId++;
+    const int id = m_freeIds.back();
+    m_freeIds.pop_back();
+    return id;
+}
+
+void ModbusTaskTable::addClass(int classId, std::chrono::microseconds period, Clock::time_point now)
+{
+    m_scheduler.addClass(classId, period, now);
+}
+
+void ModbusTaskTable::add(int id, int target, const ModbusRequest& request, Completion done, int scanClass,
+                          Clock::time_point now)
+{
+    if (id < 0) return;
+    if (m_tasks.size() <= static_cast<size_t>(id)) m_tasks.resize(static_cast<size_t>(id) + 1);
+    Task& task = m_tasks[static_cast<size_t>(id)];
+    task.target = target;
+    task.request = request;
+    task.done = std::move(done);
+    ++task.generation;
+    task.active = true;
+    task.released = false;
+    m_scheduler.add(id, scanClass, now);
+}
+
+bool ModbusTaskTable::remove(int id, Clock::time_point now)
+{
+    if (id < 0 || static_cast<size_t>(id) >= m_tasks.size()) return false;
+    Task& task = m_tasks[static_cast<size_t>(id)];
+    if (!task.active) return false;
+    task.active = false;
+    m_scheduler.remove(id, now);
+    return true;
+}
+
+void ModbusTaskTable::clear()
+{
+    for (Task& task : m_tasks) task.active = false;
+    m_scheduler.clear();
+    m_seenOverruns = 0;
+    m_nextClassId = 0;
+}
+
+void ModbusTaskTable::release(int id)
+{
+    if (id < 0 || static_cast<size_t>(id) >= m_tasks.size()) return;
+    Task& task = m_tasks[static_cast<size_t>(id)];
+    if (task.active || task.released || task.generation == 0) return;
+    task.done = nullptr;
+    task.released = true;
+    m_freeIds.push_back(id);
+}
+
+void ModbusTaskTable::releaseAll()
+{
+    for (size_t id = 0; id < m_tasks.size(); ++id) release(static_cast<int>(id));
+}
+
+ModbusTaskTable::Task* ModbusTaskTable::complete(const ModbusPendingBase& p)
+{
+    if (p.taskId < 0 || static_cast<size_t>(p.taskId) >= m_tasks.size()) return nullptr;
+    Task& task = m_tasks[static_cast<size_t>(p.taskId)];
+    if (!task.active || task.generation != p.generation) return nullptr;
+    m_scheduler.complete(p.taskId);
+    return &task;
+}
+
+void ModbusTaskTable::resetStats()
+{
+    m_scheduler.resetStats();
+    m_seenOverruns = 0;
+}
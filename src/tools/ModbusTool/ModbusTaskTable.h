@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusTaskTable.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 轮询引擎公共部分 — 周期任务表（ID 分配与复用、代次、扫描调度、
+ *              到期展开）与运行统计，ModbusTcpPoller 与 ModbusRtuBus 共用。
+ *              自身不加锁，由各引擎按自己的线程模型保护。
+ */
+
+#pragma once
+#include "ModbusScanScheduler.h"
+#include "ModbusTcpPoller.h"
+#include <atomic>
+#include <deque>
+#include <vector>
+
+// 运行统计（引擎线程写，任意线程读）
+struct ModbusPollCounters {
+    std::atomic<uint64_t> sent{0}, succeeded{0}, failed{0}, timeouts{0}, overruns{0};
+    std::atomic<uint64_t> lateSamples{0};
+    std::atomic<uint64_t> responses{0};
+    std::atomic<int64_t> lateSumUs{0}, maxLateUs{0}, latencySumUs{0};
+
+    void recordResult(bool ok) { ++(ok ? succeeded : failed); }
+    void recordResponse(int64_t latencyUs) {
+        ++responses;
+        latencySumUs += latencyUs;
+    }
+    void recordLate(int64_t lateUs);
+
+    ModbusPollerStats snapshot() const;
+    void reset();
+};
+
+// 排队 / 在途请求的公共部分；引擎按需派生追加自己的字段
+struct ModbusPendingBase {
+    ModbusRequest request;
+    ModbusTcpPoller::Completion done;   // 一次性请求的回调（周期任务为空，按 taskId 查找）
+    int taskId = -1;
+    uint32_t generation = 0;            // 发出时任务的代次：ID 被复用后旧事务不回调新任务
+    int64_t lateUs = 0;
+};
+
+class ModbusTaskTable {
+public:
+    using Clock = ModbusScanScheduler::Clock;
+    using Completion = ModbusTcpPoller::Completion;
+
+    struct Task {
+        int target = -1;                // 所属连接（TCP 轮询引擎）；串口总线不用
+        ModbusRequest request;
+        Completion done;
+        uint32_t generation = 0;        // 每次加入时递增；0 表示 ID 已分配但尚未加入
+        bool active = false;
+        bool released = false;          // 回调对象已释放、ID 已回到空闲表
+    };
+
+    // --- ID 池：可与下面的任务操作由不同的锁保护（TCP 引擎在调用方线程分配 ID） ---
+    int allocateTaskId();
+    int allocateClassId() { return m_nextClassId++; }
+
+    // --- 任务与调度 ---
+    void addClass(int classId, std::chrono::microseconds period, Clock::time_point now);
+    void add(int id, int target, const ModbusRequest& request, Completion done, int scanClass,
+             Clock::time_point now);
+    // 任务立即失效（不再触发、在途事务不再回调）；返回任务此前是否有效
+    bool remove(int id, Clock::time_point now);
+    // 全部任务失效并清除扫描等级，等级 ID 从头分配；同时访问 ID 池
+    void clear();
+    // 释放已移除任务的回调对象并回收 ID。须在该任务没有回调执行时调用，同时访问 ID 池
+    void release(int id);
+    void releaseAll();
+
+    // 一轮请求完成：任务仍有效且代次一致时解除其忙碌标记并返回任务，否则返回 nullptr
+    Task* complete(const ModbusPendingBase& p);
+
+    // 取出 now 时刻到期的任务，逐个生成排队项交给 emit(const Task&, Pending&&)；
+    // 发出延迟与超限计入 counters
+    template <typename Pending, typename Emit>
+    void fireDue(Clock::time_point now, ModbusPollCounters& counters, Emit&& emit) {
+        m_scheduler.collectDue(now, m_fires);
+        for (const auto& fire : m_fires) {
+            const Task& task = m_tasks[static_cast<size_t>(fire.item)];
+            Pending p;
+            p.request = task.request;
+            p.taskId = fire.item;
+            p.generation = task.generation;
+            p.lateUs = fire.lateUs;
+            counters.recordLate(p.lateUs);
+            emit(task, std::move(p));
+        }
+        const uint64_t overruns = m_scheduler.totalOverruns();
+        counters.overruns += overruns - m_seenOverruns;
+        m_seenOverruns = overruns;
+    }
+
+    bool empty() const { return m_scheduler.empty(); }
+    Clock::time_point nextDeadline() { return m_scheduler.nextDeadline(); }
+    std::vector<ModbusScanClassStats> classStats() const { return m_scheduler.stats(); }
+    void resetStats();
+
+private:
+    std::deque<Task> m_tasks;           // deque：扩容时已有元素地址不变（串口总线在锁外执行回调）
+    std::vector<int> m_freeIds;
+    int m_nextTaskId = 0;
+    int m_nextClassId = 0;
+    ModbusScanScheduler m_scheduler;
+    std::vector<ModbusScanScheduler::Fire> m_fires;
+    uint64_t m_seenOverruns = 0;
+};
@@ -0,0 +1,758 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusTcpPoller.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus TCP 轮询引擎实现 — 单线程 poll 循环（Linux 为 ppoll，微秒级超时），
+ *              非阻塞 socket、事务槽位、截止时间最小堆。
+ */
+
+#include "ModbusTcpPoller.h"
+#include "ModbusTaskTable.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using socket_t = SOCKET;
+const socket_t kInvalidSocket = INVALID_SOCKET;
+using PollFd = WSAPOLLFD;
+void closeSocket(socket_t s) { ::closesocket(s); }
+bool wouldBlock() { const int e = WSAGetLastError(); return e == WSAEWOULDBLOCK || e == WSAEINPROGRESS; }
+void setNonBlocking(socket_t s) { u_long on = 1; ::ioctlsocket(s, FIONBIO, &on); }
+constexpr int kSendFlags = 0;
+#else
+using socket_t = int;
+const socket_t kInvalidSocket = -1;
+using PollFd = pollfd;
+void closeSocket(socket_t s) { ::close(s); }
+bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS; }
+void setNonBlocking(socket_t s) { ::fcntl(s, F_SETFL, ::fcntl(s, F_GETFL) | O_NONBLOCK); }
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+#endif
+
+using Clock = ModbusTcpPoller::Clock;
+
+int64_t microsBetween(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+} // namespace
+
+struct ModbusTcpPoller::Impl {
+    // --- 已发出、等待应答的事务 ---
+    struct Pending : ModbusPendingBase {
+        uint16_t transactionId = 0;
+        uint8_t pdu[ModbusFrame::kRequestPduSize] = {};
+        Clock::time_point sentAt;
+        Clock::time_point deadline;
+        bool used = false;
+    };
+
+    enum class State { Idle, Connecting, Connected };
+
+    struct Connection {
+        std::string key;
+        bool rtu = false;             // RTU over TCP：无事务 ID，按长度与 CRC 拆帧
+        sockaddr_storage addr{};
+        int addrLen = 0;
+        socket_t sock = kInvalidSocket;
+        State state = State::Idle;
+        bool wanted = false;          // 有请求需要连接（断开后按 retryAt 重连）
+        Clock::time_point connectDeadline;
+        Clock::time_point retryAt;
+        std::deque<Pending> waiting;                                // 尚未发出
+        std::array<Pending, kMaxPipelineDepth> slots;               // 在途事务
+        int inflight = 0;
+        uint16_t nextTransactionId = 1;
+        int consecutiveTimeouts = 0;
+        std::vector<uint8_t> rx;
+        std::vector<uint8_t> tx;
+        size_t txSent = 0;
+    };
+
+    // --- 跨线程状态 ---
+    std::mutex m_cmdMutex;
+    std::vector<std::function<void()>> m_commands;
+    std::unordered_map<std::string, int> m_connectionIds;   // host:port[/rtu] → ID（m_cmdMutex 保护）
+    std::atomic<int> m_depth{kDefaultPipelineDepth};
+    std::atomic<int> m_timeoutMs{kDefaultTimeoutMs};
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+    std::thread::id m_threadId;
+
+    ModbusPollCounters m_counters;
+
+    // 周期任务表：ID 池（分配在调用方线程）由 m_cmdMutex 保护，任务与调度只在引擎线程访问
+    ModbusTaskTable m_tasks;
+
+    // --- 仅引擎线程访问 ---
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    std::array<uint16_t, ModbusFrame::kMaxReadBits> m_values{};   // 读结果解码缓冲
+
+#ifdef _WIN32
+    SOCKET m_wakeSock = INVALID_SOCKET;   // 连接到自身的回环 UDP 套接字
+    bool m_wsaStarted = false;
+#else
+    int m_wakePipe[2] = { -1, -1 };
+#endif
+
+    Impl() {
+#ifdef _WIN32
+        WSADATA wsa;
+        m_wsaStarted = WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+        m_wakeSock = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int len = sizeof(addr);
+        ::bind(m_wakeSock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::getsockname(m_wakeSock, reinterpret_cast<sockaddr*>(&addr), &len);
+        ::connect(m_wakeSock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        setNonBlocking(m_wakeSock);
+#else
+        if (::pipe(m_wakePipe) == 0) {
+            setNonBlocking(m_wakePipe[0]);
+            setNonBlocking(m_wakePipe[1]);
+        }
+#endif
+        // 等引擎线程记下自己的 ID 再返回：此后任意线程调用 postAndWait 都能看到它
+        std::promise<void> started;
+        std::future<void> ready = started.get_future();
+        m_thread = std::thread([this, &started]() {
+            m_threadId = std::this_thread::get_id();
+            started.set_value();
+            run();
+        });
+        ready.wait();
+    }
+
+    ~Impl() {
+        m_stop = true;
+        wake();
+        if (m_thread.joinable()) m_thread.join();
+        for (auto& c : m_connections) {
+            if (c->sock != kInvalidSocket) closeSocket(c->sock);
+        }
+#ifdef _WIN32
+        if (m_wakeSock != INVALID_SOCKET) ::closesocket(m_wakeSock);
+        if (m_wsaStarted) WSACleanup();
+#else
+        for (int fd : m_wakePipe) {
+            if (fd >= 0) ::close(fd);
+        }
+#endif
+    }
+
+    void wake() {
+        const char one = 1;
+#ifdef _WIN32
+        ::send(m_wakeSock, &one, 1, 0);
+#else
+        (void)!::write(m_wakePipe[1], &one, 1);
+#endif
+    }
+
+    void drainWake() {
+        char buf[64];
+#ifdef _WIN32
+        while (::recv(m_wakeSock, buf, sizeof(buf), 0) > 0) {}
+#else
+        while (::read(m_wakePipe[0], buf, sizeof(buf)) > 0) {}
+#endif
+    }
+
+    void post(std::function<void()> cmd) {
+        {
+            std::lock_guard<std::mutex> lock(m_cmdMutex);
+            m_commands.push_back(std::move(cmd));
+        }
+        wake();
+    }
+
+    // 投递并等待执行完毕（在引擎线程内调用时直接执行）
+    void postAndWait(std::function<void()> cmd) {
+        if (std::this_thread::get_id() == m_threadId) {
+            cmd();
+            return;
+        }
+        std::promise<void> done;
+        std::future<void> finished = done.get_future();
+        post([&cmd, &done]() { cmd(); done.set_value(); });
+        finished.wait();
+    }
+
+    // ============================================================
+    // 完成
+    // ============================================================
+
+    void finish(Pending& p, ModbusResult& result) {
+        m_counters.recordResult(result.ok);
+        if (p.taskId >= 0) {
+            ModbusTaskTable::Task* task = m_tasks.complete(p);
+            if (!task) return;
+            result.lateUs = p.lateUs;
+            if (task->done) task->done(result);
+        } else if (p.done) {
+            p.done(result);
+        }
+    }
+
+    void fail(Pending& p, const std::string& error) {
+        ModbusResult result;
+        result.error = error;
+        finish(p, result);
+    }
+
+    void enqueue(Connection& c, Pending&& p) {
+        c.waiting.push_back(std::move(p));
+        c.wanted = true;
+    }
+
+    // 连接断开：在途与排队的请求全部以失败完成，有新请求时在 retryAt 之后重连
+    void dropConnection(Connection& c, const std::string& error, Clock::time_point now) {
+        if (c.sock != kInvalidSocket) closeSocket(c.sock);
+        c.sock = kInvalidSocket;
+        c.state = State::Idle;
+        c.retryAt = now + std::chrono::milliseconds(kReconnectDelayMs);
+        c.rx.clear();
+        c.tx.clear();
+        c.txSent = 0;
+        c.consecutiveTimeouts = 0;
+        c.wanted = false;
+        for (Pending& p : c.slots) {
+            if (!p.used) continue;
+            p.used = false;
+            fail(p, error);
+        }
+        c.inflight = 0;
+        failWaiting(c, error);
+    }
+
+    void failWaiting(Connection& c, const std::string& error) {
+        std::deque<Pending> waiting;
+        waiting.swap(c.waiting);
+        for (Pending& p : waiting) fail(p, error);
+    }
+
+    // ============================================================
+    // 连接管理
+    // ============================================================
+
+    void startConnect(Connection& c, Clock::time_point now) {
+        c.sock = ::socket(c.addr.ss_family, SOCK_STREAM, IPPROTO_TCP);
+        if (c.sock == kInvalidSocket) {
+            dropConnection(c, "创建 socket 失败", now);
+            return;
+        }
+        setNonBlocking(c.sock);
+        int one = 1;
+        // 小帧逐个发出，不等 Nagle 合并
+        ::setsockopt(c.sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+#ifdef SO_NOSIGPIPE
+        ::setsockopt(c.sock, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        const int rc = ::connect(c.sock, reinterpret_cast<const sockaddr*>(&c.addr), c.addrLen);
+        if (rc == 0) {
+            c.state = State::Connected;
+        } else if (wouldBlock()) {
+            c.state = State::Connecting;
+            c.connectDeadline = now + std::chrono::milliseconds(kConnectTimeoutMs);
+        } else {
+            dropConnection(c, "连接 " + c.key + " 失败", now);
+        }
+    }
+
+    void finishConnect(Connection& c, Clock::time_point now) {
+        int soError = 0;
+        socklen_t len = sizeof(soError);
+        ::getsockopt(c.sock, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&soError), &len);
+        if (soError != 0) {
+            dropConnection(c, "连接 " + c.key + " 被拒绝或不可达", now);
+            return;
+        }
+        c.state = State::Connected;
+    }
+
+    // ============================================================
+    // 发送 / 接收
+    // ============================================================
+
+    // 从排队请求中补满流水线；RTU 帧无事务 ID，应答只能按顺序对应，深度固定为 1
+    void fillPipeline(Connection& c, Clock::time_point now) {
+        const int depth = c.rtu ? 1 : std::clamp(m_depth.load(), 1, kMaxPipelineDepth);
+        const auto timeout = std::chrono::milliseconds(m_timeoutMs.load());
+        while (c.inflight < depth && !c.waiting.empty()) {
+            auto slot = std::find_if(c.slots.begin(), c.slots.end(), [](const Pending& p) { return !p.used; });
+            *slot = std::move(c.waiting.front());
+            c.waiting.pop_front();
+            Pending& p = *slot;
+            p.used = true;
+            p.transactionId = c.nextTransactionId++;
+            if (c.nextTransactionId == 0) c.nextTransactionId = 1;
+            if (p.request.write) {
+                ModbusFrame::encodeWritePdu(p.pdu, p.request.table, p.request.address, p.request.value);
+            } else {
+                ModbusFrame::encodeReadPdu(p.pdu, p.request.table, p.request.address, p.request.count);
+            }
+            const size_t at = c.tx.size();
+            if (c.rtu) {
+                c.tx.resize(at + ModbusFrame::kRtuOverhead + ModbusFrame::kRequestPduSize);
+                ModbusFrame::encodeRtuFrame(c.tx.data() + at, p.request.unitId, p.pdu, ModbusFrame::kRequestPduSize);
+            } else {
+                c.tx.resize(at + ModbusFrame::kMbapHeaderSize + ModbusFrame::kRequestPduSize);
+                ModbusFrame::encodeTcpFrame(c.tx.data() + at, p.transactionId, p.request.unitId,
+                                            p.pdu, ModbusFrame::kRequestPduSize);
+            }
+            p.sentAt = now;
+            p.deadline = now + timeout;
+            ++c.inflight;
+            ++m_counters.sent;
+        }
+    }
+
+    void flush(Connection& c, Clock::time_point now) {
+        while (c.txSent < c.tx.size()) {
+            const auto n = ::send(c.sock, reinterpret_cast<const char*>(c.tx.data() + c.txSent),
+                                  static_cast<int>(c.tx.size() - c.txSent), kSendFlags);
+            if (n > 0) {
+                c.txSent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && wouldBlock()) return;   // 等 POLLOUT
+            dropConnection(c, "发送到 " + c.key + " 失败", now);
+            return;
+        }
+        c.tx.clear();
+        c.txSent = 0;
+    }
+
+    void receive(Connection& c, Clock::time_point now) {
+        uint8_t buf[4096];
+        for (;;) {
+            const auto n = ::recv(c.sock, reinterpret_cast<char*>(buf), sizeof(buf), 0);
+            if (n > 0) {
+                c.rx.insert(c.rx.end(), buf, buf + n);
+                if (static_cast<size_t>(n) < sizeof(buf)) break;
+                continue;
+            }
+            if (n < 0 && wouldBlock()) break;
+            dropConnection(c, "设备 " + c.key + " 关闭了连接", now);
+            return;
+        }
+        if (c.rtu) {
+            receiveRtu(c, now);
+            return;
+        }
+
+        size_t pos = 0;
+        while (pos < c.rx.size()) {
+            const int frameLen = ModbusFrame::tcpFrameLength(c.rx.data() + pos, c.rx.size() - pos);
+            if (frameLen < 0) {
+                dropConnection(c, "收到非法 Modbus TCP 帧", now);
+                return;
+            }
+            if (frameLen == 0 || pos + static_cast<size_t>(frameLen) > c.rx.size()) break;
+            handleFrame(c, c.rx.data() + pos, static_cast<size_t>(frameLen), now);
+            pos += static_cast<size_t>(frameLen);
+        }
+        c.rx.erase(c.rx.begin(), c.rx.begin() + static_cast<std::ptrdiff_t>(pos));
+    }
+
+    // RTU over TCP：唯一在途事务的功能码决定应答长度；无在途事务时收到的是迟到应答，丢弃
+    void receiveRtu(Connection& c, Clock::time_point now) {
+        auto slot = std::find_if(c.slots.begin(), c.slots.end(), [](const Pending& p) { return p.used; });
+        if (slot == c.slots.end()) {
+            c.rx.clear();
+            return;
+        }
+        Pending& p = *slot;
+        const int frameLen = ModbusFrame::rtuResponseLength(c.rx.data(), c.rx.size(), p.pdu[0]);
+        if (frameLen == 0 || (frameLen > 0 && c.rx.size() < static_cast<size_t>(frameLen))) return;
+
+        std::string error;
+        if (frameLen < 0 || c.rx[0] != p.request.unitId) {
+            error = "RTU 应答与请求不匹配";
+        } else if (!ModbusFrame::checkRtuCrc(c.rx.data(), static_cast<size_t>(frameLen))) {
+            error = "RTU 应答 CRC 校验失败";
+        }
+        if (!error.empty()) {
+            // 帧边界已不可信：清空缓冲，本事务失败
+            c.rx.clear();
+            p.used = false;
+            --c.inflight;
+            fail(p, error);
+            return;
+        }
+        completeSlot(c, p, c.rx.data() + 1, static_cast<size_t>(frameLen) - ModbusFrame::kRtuOverhead, now);
+        c.rx.clear();   // 一问一答，应答之后不应再有数据
+    }
+
+    void handleFrame(Connection& c, const uint8_t* frame, size_t size, Clock::time_point now) {
+        const uint16_t tid = ModbusFrame::tcpTransactionId(frame);
+        auto slot = std::find_if(c.slots.begin(), c.slots.end(),
+                                 [tid](const Pending& p) { return p.used && p.transactionId == tid; });
+        if (slot == c.slots.end()) return;   // 已超时放弃的事务的迟到应答
+        completeSlot(c, *slot, frame + ModbusFrame::kMbapHeaderSize, size - ModbusFrame::kMbapHeaderSize, now);
+    }
+
+    void completeSlot(Connection& c, Pending& p, const uint8_t* pdu, size_t pduSize, Clock::time_point now) {
+        p.used = false;
+        --c.inflight;
+        c.consecutiveTimeouts = 0;
+
+        ModbusResult result;
+        result.latencyUs = microsBetween(p.sentAt, now);
+        if (p.request.write) {
+            result.ok = ModbusFrame::decodeWriteResponse(pdu, pduSize, p.pdu, result.error);
+        } else {
+            result.ok = ModbusFrame::decodeReadResponse(pdu, pduSize, p.request.table, p.request.count,
+                                                        m_values.data(), result.error);
+            if (result.ok) {
+                result.values = m_values.data();
+                result.count = p.request.count;
+            }
+        }
+        m_counters.recordResponse(result.latencyUs);
+        finish(p, result);
+    }
+
+    void checkTimeouts(Connection& c, Clock::time_point now) {
+        for (Pending& p : c.slots) {
+            if (!p.used || now < p.deadline) continue;
+            p.used = false;
+            --c.inflight;
+            ++m_counters.timeouts;
+            ++c.consecutiveTimeouts;
+            if (c.rtu) c.rx.clear();   // 半帧不能与下一个应答拼接
+            fail(p, "应答超时");
+        }
+        if (c.consecutiveTimeouts >= kMaxConsecutiveTimeouts) {
+            dropConnection(c, "连续应答超时，重建连接", now);
+        }
+    }
+
+    // ============================================================
+    // 周期任务
+    // ============================================================
+
+    void fireDueTasks(Clock::time_point now) {
+        m_tasks.fireDue<Pending>(now, m_counters, [this](const ModbusTaskTable::Task& task, Pending&& p) {
+            enqueue(*m_connections[static_cast<size_t>(task.target)], std::move(p));
+        });
+    }
+
+    // ============================================================
+    // 事件循环
+    // ============================================================
+
+    void runCommands() {
+        std::vector<std::function<void()>> commands;
+        {
+            std::lock_guard<std::mutex> lock(m_cmdMutex);
+            commands.swap(m_commands);
+        }
+        for (auto& cmd : commands) cmd();
+    }
+
+    void run() {
+#ifndef _WIN32
+#ifndef MSG_NOSIGNAL
+        signal(SIGPIPE, SIG_IGN);
+#endif
+#endif
+        std::vector<PollFd> fds;
+        std::vector<Connection*> polled;
+        while (!m_stop) {
+            runCommands();
+            Clock::time_point now = Clock::now();
+            fireDueTasks(now);
+
+            Clock::time_point wakeAt = now + std::chrono::seconds(1);
+            if (!m_tasks.empty()) wakeAt = std::min(wakeAt, m_tasks.nextDeadline());
+
+            fds.clear();
+            polled.clear();
+#ifdef _WIN32
+            fds.push_back(PollFd{ m_wakeSock, POLLRDNORM, 0 });
+#else
+            fds.push_back(PollFd{ m_wakePipe[0], POLLIN, 0 });
+#endif
+            for (auto& conn : m_connections) {
+                Connection& c = *conn;
+                if (c.state == State::Idle && c.wanted) {
+                    if (now >= c.retryAt) {
+                        startConnect(c, now);
+                    } else {
+                        // 重连等待期内不积压：请求立即失败，周期任务下一轮再试
+                        failWaiting(c, "设备 " + c.key + " 未连接，等待重连");
+                    }
+                }
+                if (c.state == State::Connecting && now >= c.connectDeadline) {
+                    dropConnection(c, "连接 " + c.key + " 超时", now);
+                }
+                if (c.state == State::Connected) {
+                    checkTimeouts(c, now);
+                }
+                if (c.state == State::Connected) {
+                    fillPipeline(c, now);
+                    if (!c.tx.empty()) flush(c, now);
+                }
+
+                if (c.state == State::Idle) {
+                    if (c.wanted) wakeAt = std::min(wakeAt, c.retryAt);
+                    continue;
+                }
+                short events = 0;
+                if (c.state == State::Connecting) {
+                    events = POLLOUT;
+                    wakeAt = std::min(wakeAt, c.connectDeadline);
+                } else {
+                    events = POLLIN;
+                    if (!c.tx.empty()) events |= POLLOUT;
+                    for (const Pending& p : c.slots) {
+                        if (p.used) wakeAt = std::min(wakeAt, p.deadline);
+                    }
+                }
+                fds.push_back(PollFd{ c.sock, events, 0 });
+                polled.push_back(&c);
+            }
+
+            if (!waitEvents(fds, wakeAt)) continue;
+
+            if (fds[0].revents) drainWake();
+            now = Clock::now();
+            for (size_t i = 0; i < polled.size(); ++i) {
+                Connection& c = *polled[i];
+                const short revents = fds[i + 1].revents;
+                if (!revents || c.sock != fds[i + 1].fd) continue;
+                if (c.state == State::Connecting) {
+                    finishConnect(c, now);
+                    continue;
+                }
+                if (revents & (POLLIN | POLLERR | POLLHUP)) receive(c, now);
+                if (c.state == State::Connected && (revents & POLLOUT) && !c.tx.empty()) flush(c, now);
+            }
+        }
+    }
+
+    // 等待 socket 事件直到 wakeAt；有事件返回 true。
+    // Linux 用 ppoll 的纳秒超时直接睡到截止时间；其余平台 poll 只有毫秒精度，
+    // 最后不足 kSpinUs 的部分以 yield 等待，保证周期任务的发出时刻
+    bool waitEvents(std::vector<PollFd>& fds, Clock::time_point wakeAt) {
+        auto remaining = wakeAt - Clock::now();
+        if (remaining < Clock::duration::zero()) remaining = Clock::duration::zero();
+#if defined(__linux__)
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        return ::ppoll(fds.data(), fds.size(), &ts, nullptr) > 0;
+#else
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(remaining).count();
+        int timeoutMs = 0;
+        if (us > kSpinUs) timeoutMs = static_cast<int>((us - kSpinUs) / 1000);
+#ifdef _WIN32
+        const int n = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+#else
+        const int n = ::poll(fds.data(), static_cast<nfds_t>(fds.size()), timeoutMs);
+#endif
+        if (n > 0) return true;
+        if (us <= kSpinUs) {
+            while (Clock::now() < wakeAt && !m_stop) std::this_thread::yield();
+        }
+        return false;
+#endif
+    }
+};
+
+// ============================================================
+// 公共接口
+// ============================================================
+
+ModbusTcpPoller::ModbusTcpPoller()
+    : m_impl(std::make_unique<Impl>())
+{
+}
+
+ModbusTcpPoller::~ModbusTcpPoller() = default;
+
+int ModbusTcpPoller::connection(const std::string& host, int port, bool rtuOverTcp)
+{
+    const std::string key = host + ":" + std::to_string(port) + (rtuOverTcp ? "/rtu" : "");
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_cmdMutex);
+        auto it = m_impl->m_connectionIds.find(key);
+        if (it != m_impl->m_connectionIds.end()) return it->second;
+    }
+
+    // 地址解析在调用方线程完成，引擎线程不做阻塞 DNS
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0 || !result) {
+        return -1;
+    }
+    auto conn = std::make_unique<Impl::Connection>();
+    conn->key = key;
+    conn->rtu = rtuOverTcp;
+    std::memcpy(&conn->addr, result->ai_addr, result->ai_addrlen);
+    conn->addrLen = static_cast<int>(result->ai_addrlen);
+    ::freeaddrinfo(result);
+
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_cmdMutex);
+        auto it = m_impl->m_connectionIds.find(key);
+        if (it != m_impl->m_connectionIds.end()) return it->second;
+        id = static_cast<int>(m_impl->m_connectionIds.size());
+        m_impl->m_connectionIds.emplace(key, id);
+        // 与 ID 分配在同一把锁内入队，保证 m_connections 下标与 ID 一致
+        Impl::Connection* raw = conn.release();
+        m_impl->m_commands.push_back([this, raw]() {
+            m_impl->m_connections.emplace_back(raw);
+        });
+    }
+    m_impl->wake();
+    return id;
+}
+
+void ModbusTcpPoller::setPipelineDepth(int depth)
+{
+    m_impl->m_depth = std::clamp(depth, 1, kMaxPipelineDepth);
+    m_impl->wake();
+}
+
+int ModbusTcpPoller::pipelineDepth() const
+{
+    return m_impl->m_depth;
+}
+
+void ModbusTcpPoller::setTimeoutMs(int ms)
+{
+    m_impl->m_timeoutMs = ms > 0 ? ms : kDefaultTimeoutMs;
+}
+
+void ModbusTcpPoller::submit(int connectionId, const ModbusRequest& request, Completion done)
+{
+    m_impl->post([this, connectionId, request, done = std::move(done)]() mutable {
+        Impl::Pending p;
+        p.request = request;
+        p.done = std::move(done);
+        if (connectionId < 0 || connectionId >= static_cast<int>(m_impl->m_connections.size())) {
+            m_impl->fail(p, "无效的连接");
+            return;
+        }
+        if (!request.valid()) {
+            m_impl->fail(p, request.write ? "该数据表不可写" : "读取数量超出范围");
+            return;
+        }
+        m_impl->enqueue(*m_impl->m_connections[static_cast<size_t>(connectionId)], std::move(p));
+    });
+}
+
+int ModbusTcpPoller::addScanClass(std::chrono::microseconds period)
+{
+    if (period.count() <= 0) return -1;
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_cmdMutex);
+        id = m_impl->m_tasks.allocateClassId();
+    }
+    m_impl->post([this, id, period]() {
+        m_impl->m_tasks.addClass(id, period, Clock::now());
+    });
+    return id;
+}
+
+int ModbusTcpPoller::addPeriodic(int connectionId, const ModbusRequest& request, int scanClass, Completion done)
+{
+    if (connectionId < 0 || scanClass < 0 || !request.valid()) return -1;
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->m_cmdMutex);
+        id = m_impl->m_tasks.allocateTaskId();
+    }
+    m_impl->post([this, id, connectionId, request, scanClass, done = std::move(done)]() mutable {
+        m_impl->m_tasks.add(id, connectionId, request, std::move(done), scanClass, Clock::now());
+    });
+    return id;
+}
+
+void ModbusTcpPoller::removePeriodic(int taskId)
+{
+    m_impl->postAndWait([this, taskId]() {
+        if (!m_impl->m_tasks.remove(taskId, Clock::now())) return;
+        // 可能正处于该任务自己的回调中：回调对象与 ID 留到下一轮循环再释放
+        m_impl->post([this, taskId]() {
+            std::lock_guard<std::mutex> lock(m_impl->m_cmdMutex);
+            m_impl->m_tasks.release(taskId);
+        });
+    });
+}
+
+void ModbusTcpPoller::clearPeriodic()
+{
+    m_impl->postAndWait([this]() {
+        {
+            std::lock_guard<std::mutex> lock(m_impl->m_cmdMutex);
+            m_impl->m_tasks.clear();
+        }
+        m_impl->post([this]() {
+            std::lock_guard<std::mutex> lock(m_impl->m_cmdMutex);
+            m_impl->m_tasks.releaseAll();
+        });
+    });
+}
+
+std::vector<ModbusScanClassStats> ModbusTcpPoller::scanClassStats() const
+{
+    std::vector<ModbusScanClassStats> result;
+    m_impl->postAndWait([this, &result]() { result = m_impl->m_tasks.classStats(); });
+    return result;
+}
+
+ModbusPollerStats ModbusTcpPoller::stats() const
+{
+    return m_impl->m_counters.snapshot();
+}
+
+void ModbusTcpPoller::resetStats()
+{
+    m_impl->m_counters.reset();
+    m_impl->post([this]() { m_impl->m_tasks.resetStats(); });
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusTcpPoller.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus TCP 轮询引擎 — 独立 I/O 线程直接收发 Modbus TCP 帧，
+ *              每条连接按事务 ID 同时保持多个未应答请求（流水线深度可配），
+ *              周期任务按扫描等级由 ModbusScanScheduler 调度，不经过 GUI 事件循环。
+ *              连接也可工作在 RTU over TCP 模式（串口服务器透传 RTU 帧），
+ *              此时帧带 CRC、无事务 ID，每条连接严格一问一答。
+ */
+
+#pragma once
+#include "ModbusFrame.h"
+#include "ModbusScanScheduler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 单个 Modbus 请求（读一段 / 写一个点）
+struct ModbusRequest {
+    uint8_t unitId = 1;
+    ModbusTable table = ModbusTable::HoldingRegisters;
+    uint16_t address = 0;
+    uint16_t count = 1;        // 读取数量（写请求忽略）
+    bool write = false;
+    uint16_t value = 0;        // 写入值（线圈非 0 即 ON）
+
+    // 读取数量须在 1..maxReadCount(table) 之内（超出会越过解码缓冲），写入目标须为可写表
+    bool valid() const {
+        return write ? ModbusFrame::writeFunction(table) != 0
+                     : count > 0 && count <= ModbusFrame::maxReadCount(table);
+    }
+};
+
+// 请求结果；values 指向引擎内部缓冲区，仅在回调期间有效
+struct ModbusResult {
+    bool ok = false;
+    const uint16_t* values = nullptr;
+    uint16_t count = 0;
+    std::string error;
+    int64_t latencyUs = 0;     // 发出到收到响应
+    int64_t lateUs = 0;        // 周期任务：实际发出时刻晚于计划时刻的量
+};
+
+// 运行统计（累计值，resetStats 清零）
+struct ModbusPollerStats {
+    uint64_t sent = 0;
+    uint64_t succeeded = 0;
+    uint64_t failed = 0;           // 含超时、异常响应、连接断开
+    uint64_t timeouts = 0;
+    uint64_t overruns = 0;         // 周期任务到期时上一轮仍未完成、或调度落后而跳过的轮次
+    int64_t maxLateUs = 0;         // 周期任务最大发出延迟（调度抖动）
+    double avgLateUs = 0;
+    double avgLatencyUs = 0;
+};
+
+class ModbusTcpPoller {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 完成回调在引擎 I/O 线程执行，不得阻塞
+    using Completion = std::function<void(const ModbusResult&)>;
+
+    ModbusTcpPoller();
+    ~ModbusTcpPoller();   // 停止 I/O 线程并关闭全部连接，未完成的请求不再回调
+
+    ModbusTcpPoller(const ModbusTcpPoller&) = delete;
+    ModbusTcpPoller& operator=(const ModbusTcpPoller&) = delete;
+
+    // 取得（必要时登记）到 host:port 的连接，返回连接 ID；同一地址与模式返回同一 ID。
+    // rtuOverTcp：按 RTU 帧（地址 + PDU + CRC）收发，忽略流水线深度。
+    // 地址解析失败返回 -1。连接在有请求时建立，断开后自动重连
+    int connection(const std::string& host, int port = ModbusFrame::kDefaultTcpPort, bool rtuOverTcp = false);
+
+    // 每条 Modbus TCP 连接同时在途的事务数（1 = 严格一问一答），立即生效
+    void setPipelineDepth(int depth);
+    int pipelineDepth() const;
+    // 单个请求的应答超时
+    void setTimeoutMs(int ms);
+
+    // 提交一次性请求（线程安全）；请求无效（见 ModbusRequest::valid）时以失败回调
+    void submit(int connectionId, const ModbusRequest& request, Completion done);
+
+    // 扫描等级：一组周期相同的任务，返回等级 ID。等级内任务相位自动均匀错开
+    int addScanClass(std::chrono::microseconds period);
+    // 周期任务：按所属等级周期发出（绝对截止时间，不累积漂移）。
+    // 上一轮未完成时本轮跳过并计入 overruns。返回任务 ID，请求无效时返回 -1
+    int addPeriodic(int connectionId, const ModbusRequest& request, int scanClass, Completion done);
+    // 移除周期任务；返回后该任务不再回调（在完成回调内调用时同样成立）
+    void removePeriodic(int taskId);
+    void clearPeriodic();         // 同时清除全部扫描等级
+
+    // 各扫描等级的触发 / 超限 / 最大延迟统计（下标为等级 ID）
+    std::vector<ModbusScanClassStats> scanClassStats() const;
+
+    ModbusPollerStats stats() const;
+    void resetStats();
+
+    static constexpr int kDefaultPipelineDepth = 4;
+    static constexpr int kMaxPipelineDepth = 16;
+    static constexpr int kDefaultTimeoutMs = 1000;
+    static constexpr int kConnectTimeoutMs = 3000;
+    static constexpr int kReconnectDelayMs = 1000;
+    static constexpr int kMaxConsecutiveTimeouts = 3;   // 连续超时达到此数时重建连接
+    static constexpr int kSpinUs = 1000;                // 距截止时间不足此值时不再睡眠，让出 CPU 等待
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
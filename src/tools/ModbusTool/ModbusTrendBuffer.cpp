@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusTrendBuffer.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 列式时序缓冲实现。
+ */
+
+#include "ModbusTrendBuffer.h"
+#include <algorithm>
+#include <ostream>
+
+namespace {
+
+void putLe(std::ostream& out, uint64_t v, int bytes)
+{
+    char buf[8];
+    for (int i = 0; i < bytes; ++i) buf[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+    out.write(buf, bytes);
+}
+
+} // namespace
+
+ModbusTrendBuffer::ModbusTrendBuffer(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+int ModbusTrendBuffer::addSeries(const std::string& name, const std::vector<std::string>& columns)
+{
+    auto s = std::make_unique<Series>();
+    s->name = name;
+    s->columns = columns;
+    s->times.reset(new int64_t[m_capacity]());
+    s->values.reset(new uint16_t[m_capacity * std::max<size_t>(columns.size(), 1)]());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_series.push_back(std::move(s));
+    return static_cast<int>(m_series.size() - 1);
+}
+
+void ModbusTrendBuffer::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_series.clear();
+}
+
+void ModbusTrendBuffer::append(int series, int64_t timestampUs, const uint16_t* values)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (series < 0 || static_cast<size_t>(series) >= m_series.size()) return;
+    Series& s = *m_series[static_cast<size_t>(series)];
+    const size_t pos = s.head;
+    // 保持时间列有序：调用方时钟回拨时不让二分查找失效
+    if (s.count > 0) {
+        const int64_t last = s.times[pos == 0 ? m_capacity - 1 : pos - 1];
+        timestampUs = std::max(timestampUs, last);
+    }
+    s.times[pos] = timestampUs;
+    const size_t width = s.columns.size();
+    for (size_t c = 0; c < width; ++c) s.values[c * m_capacity + pos] = values[c];
+    s.head = pos + 1 == m_capacity ? 0 : pos + 1;
+    if (s.count < m_capacity) ++s.count;
+}
+
+int ModbusTrendBuffer::seriesCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(m_series.size());
+}
+
+std::string ModbusTrendBuffer::seriesName(int series) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Series* s = find(series);
+    return s ? s->name : std::string();
+}
+
+size_t ModbusTrendBuffer::columnCount(int series) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Series* s = find(series);
+    return s ? s->columns.size() : 0;
+}
+
+size_t ModbusTrendBuffer::size(int series) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Series* s = find(series);
+    return s ? s->count : 0;
+}
+
+size_t ModbusTrendBuffer::memoryBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t bytes = 0;
+    for (const auto& s : m_series) {
+        bytes += m_capacity * (sizeof(int64_t) + sizeof(uint16_t) * std::max<size_t>(s->columns.size(), 1));
+    }
+    return bytes;
+}
+
+const ModbusTrendBuffer::Series* ModbusTrendBuffer::find(int series) const
+{
+    if (series < 0 || static_cast<size_t>(series) >= m_series.size()) return nullptr;
+    return m_series[static_cast<size_t>(series)].get();
+}
+
+size_t ModbusTrendBuffer::physical(const Series& s, size_t logical) const
+{
+    // 逻辑下标 0 = 最旧样本
+    const size_t oldest = s.count < m_capacity ? 0 : s.head;
+    const size_t p = oldest + logical;
+    return p >= m_capacity ? p - m_capacity : p;
+}
+
+size_t ModbusTrendBuffer::lowerBound(const Series& s, int64_t t) const
+{
+    size_t lo = 0, hi = s.count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (s.times[physical(s, mid)] < t) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t ModbusTrendBuffer::upperBound(const Series& s, int64_t t) const
+{
+    size_t lo = 0, hi = s.count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (s.times[physical(s, mid)] <= t) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t ModbusTrendBuffer::query(int series, size_t column, int64_t fromUs, int64_t toUs,
+                                std::vector<int64_t>& times, std::vector<uint16_t>& values) const
+{
+    times.clear();
+    values.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Series* s = find(series);
+    if (!s || column >= s->columns.size() || fromUs > toUs) return 0;
+
+    const size_t begin = lowerBound(*s, fromUs);
+    const size_t end = upperBound(*s, toUs);
+    if (begin >= end) return 0;
+    times.reserve(end - begin);
+    values.reserve(end - begin);
+    const uint16_t* col = s->values.get() + column * m_capacity;
+    for (size_t i = begin; i < end; ++i) {
+        const size_t p = physical(*s, i);
+        times.push_back(s->times[p]);
+        values.push_back(col[p]);
+    }
+    return times.size();
+}
+
+std::vector<ModbusTrendBuffer::Bucket> ModbusTrendBuffer::downsample(int series, size_t column, int64_t fromUs,
+                                                                     int64_t toUs, int64_t bucketUs) const
+{
+    std::vector<Bucket> buckets;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Series* s = find(series);
+    if (!s || column >= s->columns.size() || fromUs > toUs || bucketUs <= 0) return buckets;
+
+    const size_t begin = lowerBound(*s, fromUs);
+    const size_t end = upperBound(*s, toUs);
+    const uint16_t* col = s->values.get() + column * m_capacity;
+    Bucket cur;
+    uint64_t sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+        const size_t p = physical(*s, i);
+        const int64_t start = fromUs + (s->times[p] - fromUs) / bucketUs * bucketUs;
+        const uint16_t v = col[p];
+        if (cur.count == 0 || start != cur.startUs) {
+            if (cur.count > 0) {
+                cur.avg = static_cast<double>(sum) / cur.count;
+                buckets.push_back(cur);
+            }
+            cur = Bucket();
+            cur.startUs = start;
+            cur.min = cur.max = v;
+            sum = 0;
+        }
+        ++cur.count;
+        cur.min = std::min(cur.min, v);
+        cur.max = std::max(cur.max, v);
+        sum += v;
+    }
+    if (cur.count > 0) {
+        cur.avg = static_cast<double>(sum) / cur.count;
+        buckets.push_back(cur);
+    }
+    return buckets;
+}
+
+bool ModbusTrendBuffer::snapshot(int series, int64_t fromUs, int64_t toUs, Snapshot& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Series* s = find(series);
+    if (!s) return false;
+
+    const size_t begin = lowerBound(*s, fromUs);
+    const size_t end = fromUs > toUs ? begin : upperBound(*s, toUs);
+    const size_t n = end - begin;
+    const size_t width = s->columns.size();
+    out.columns = s->columns;
+    out.times.resize(n);
+    out.values.resize(n * width);
+    for (size_t i = 0; i < n; ++i) out.times[i] = s->times[physical(*s, begin + i)];
+    for (size_t c = 0; c < width; ++c) {
+        const uint16_t* col = s->values.get() + c * m_capacity;
+        uint16_t* dst = out.values.data() + c * n;
+        for (size_t i = 0; i < n; ++i) dst[i] = col[physical(*s, begin + i)];
+    }
+    return true;
+}
+
+bool ModbusTrendBuffer::writeCsv(std::ostream& out, int series, int64_t fromUs, int64_t toUs) const
+{
+    Snapshot snap;
+    if (!snapshot(series, fromUs, toUs, snap)) return false;
+
+    out << "timestamp_us";
+    for (const auto& c : snap.columns) out << ',' << c;
+    out << '\n';
+    const size_t n = snap.times.size();
+    const size_t width = snap.columns.size();
+    for (size_t i = 0; i < n; ++i) {
+        out << snap.times[i];
+        for (size_t c = 0; c < width; ++c) out << ',' << snap.values[c * n + i];
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool ModbusTrendBuffer::writeBinary(std::ostream& out, int series, int64_t fromUs, int64_t toUs) const
+{
+    Snapshot snap;
+    if (!snapshot(series, fromUs, toUs, snap)) return false;
+
+    out.write("MBTR", 4);
+    putLe(out, kBinaryVersion, 2);
+    putLe(out, snap.columns.size(), 4);
+    putLe(out, snap.times.size(), 8);
+    for (int64_t t : snap.times) putLe(out, static_cast<uint64_t>(t), 8);
+    for (uint16_t v : snap.values) putLe(out, v, 2);
+    return static_cast<bool>(out);
+}
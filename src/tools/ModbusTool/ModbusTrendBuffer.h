@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: ModbusTrendBuffer.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: Modbus 轮询结果的列式时序缓冲 — 每个序列（一组同时采样的点，
+ *              如一台设备的一个扫描组）固定容量的环形缓冲，时间戳一列、每个点
+ *              各一列（SoA）。容量在 addSeries 时一次分配，append 不分配内存，
+ *              写满后覆盖最旧样本。支持时间范围查询、按时间桶 min/max/avg 降采样，
+ *              以及 CSV / 二进制导出。线程安全（引擎线程写、界面线程读）。
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ModbusTrendBuffer {
+public:
+    struct Bucket {
+        int64_t startUs = 0;       // 桶起始时间
+        uint32_t count = 0;        // 桶内样本数（为 0 的桶不输出）
+        uint16_t min = 0;
+        uint16_t max = 0;
+        double avg = 0;
+    };
+
+    // capacity：每个序列保留的样本数
+    explicit ModbusTrendBuffer(size_t capacity);
+
+    size_t capacity() const { return m_capacity; }
+    // 新增序列并一次性分配其全部存储，返回序列 ID；columns 为各点列名
+    int addSeries(const std::string& name, const std::vector<std::string>& columns);
+    void clear();                                     // 删除全部序列
+
+    // 追加一个样本：values 长度 = 列数。不分配内存。
+    // 时间戳应单调不减（查询按二分查找）；早于上一样本时按上一样本时间记录
+    void append(int series, int64_t timestampUs, const uint16_t* values);
+
+    int seriesCount() const;
+    std::string seriesName(int series) const;
+    size_t columnCount(int series) const;
+    size_t size(int series) const;                    // 当前样本数（≤ capacity）
+    size_t memoryBytes() const;                       // 已分配的样本存储字节数
+
+    // 时间范围 [fromUs, toUs] 内某列的样本，按时间升序写入 times / values，返回样本数
+    size_t query(int series, size_t column, int64_t fromUs, int64_t toUs,
+                 std::vector<int64_t>& times, std::vector<uint16_t>& values) const;
+    // 按 bucketUs 宽的时间桶降采样（桶从 fromUs 起对齐），空桶跳过
+    std::vector<Bucket> downsample(int series, size_t column, int64_t fromUs, int64_t toUs,
+                                   int64_t bucketUs) const;
+
+    // 导出时只在锁内复制所选范围的原始列数据，格式化与写出在锁外进行，不阻塞 append
+    // CSV：表头 timestamp_us,列名...，每行一个样本
+    bool writeCsv(std::ostream& out, int series, int64_t fromUs, int64_t toUs) const;
+    // 二进制（小端）："MBTR" | u16 版本 | u32 列数 | u64 样本数 | i64 时间戳 × N | 每列 u16 × N
+    bool writeBinary(std::ostream& out, int series, int64_t fromUs, int64_t toUs) const;
+
+    static constexpr uint16_t kBinaryVersion = 1;
+
+private:
+    struct Series {
+        std::string name;
+        std::vector<std::string> columns;
+        std::unique_ptr<int64_t[]> times;         // [capacity]
+        std::unique_ptr<uint16_t[]> values;       // [列][capacity]，按列连续
+        size_t head = 0;                          // 下一个写入位置
+        size_t count = 0;
+    };
+
+    // 导出用的范围副本：values 按列连续，每列 times.size() 个
+    struct Snapshot {
+        std::vector<std::string> columns;
+        std::vector<int64_t> times;
+        std::vector<uint16_t> values;
+    };
+    bool snapshot(int series, int64_t fromUs, int64_t toUs, Snapshot& out) const;
+
+    // 以下要求已持有 m_mutex
+    const Series* find(int series) const;
+    size_t physical(const Series& s, size_t logical) const;
+    size_t lowerBound(const Series& s, int64_t t) const;   // 第一个时间 ≥ t 的逻辑下标
+    size_t upperBound(const Series& s, int64_t t) const;   // 第一个时间 > t 的逻辑下标
+
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Series>> m_series;
+};
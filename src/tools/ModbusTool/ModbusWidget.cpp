@@ -7,6 +7,15 @@
 #include <QLabel>
 #include <QHeaderView>
 #include <QDateTime>
+#include <QTimer>
+#include <QRegularExpression>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QFile>
+#include <algorithm>
+#include <limits>
+#include <sstream>
 
 ModbusWidget::ModbusWidget(QWidget* parent) : ToolWidget(parent)
 {
@@ -26,7 +35,24 @@ ModbusWidget::ModbusWidget(QWidget* parent) : ToolWidget(parent)
             m_slaveIdSpin->setValue(h.value(QStringLiteral("slaveId")).toInt());
         if (m_intervalSpin)
             m_intervalSpin->setValue(h.value(QStringLiteral("intervalMs")).toInt());
+        if (m_depthSpin && h.contains(QStringLiteral("pipelineDepth")))
+            m_depthSpin->setValue(h.value(QStringLiteral("pipelineDepth")).toInt());
+        if (m_gapSpin && h.contains(QStringLiteral("maxGap")))
+            m_gapSpin->setValue(h.value(QStringLiteral("maxGap")).toInt());
+        if (m_rangeEdit)
+            m_rangeEdit->setText(h.value(QStringLiteral("ranges")).toString());
+        if (m_transportCombo && h.contains(QStringLiteral("transport")))
+            m_transportCombo->setCurrentIndex(h.value(QStringLiteral("transport")).toInt());
+        if (m_serialPortEdit)
+            m_serialPortEdit->setText(h.value(QStringLiteral("serialPort")).toString());
+        if (m_baudCombo && h.contains(QStringLiteral("baudRate")))
+            m_baudCombo->setCurrentText(QString::number(h.value(QStringLiteral("baudRate")).toInt()));
+        if (m_parityCombo && h.contains(QStringLiteral("parity")))
+            m_parityCombo->setCurrentIndex(h.value(QStringLiteral("parity")).toInt());
+        if (m_stopBitsCombo && h.contains(QStringLiteral("stopBits")))
+            m_stopBitsCombo->setCurrentIndex(h.value(QStringLiteral("stopBits")).toInt() == 2 ? 1 : 0);
     }
+    updateTransportControls();
 }
 
 void ModbusWidget::setupUi()
@@ -46,22 +72,73 @@ void ModbusWidget::setupUi()
     m_startAddrSpin = new QSpinBox(this); m_startAddrSpin->setRange(0, 65535); m_startAddrSpin->setValue(0);
     cfgLayout->addWidget(m_startAddrSpin);
     cfgLayout->addWidget(new QLabel("数量:", this));
-    m_countSpin = new QSpinBox(this); m_countSpin->setRange(1, 125); m_countSpin->setValue(10);
+    // 超过单次读取上限 (125 寄存器 / 2000 位) 时由读取计划自动拆分
+    m_countSpin = new QSpinBox(this); m_countSpin->setRange(1, 65535); m_countSpin->setValue(10);
     cfgLayout->addWidget(m_countSpin);
     cfgLayout->addWidget(new QLabel("从站ID:", this));
     m_slaveIdSpin = new QSpinBox(this); m_slaveIdSpin->setRange(1, 247); m_slaveIdSpin->setValue(1);
     cfgLayout->addWidget(m_slaveIdSpin);
     cfgLayout->addWidget(new QLabel("间隔(ms):", this));
-    m_intervalSpin = new QSpinBox(this); m_intervalSpin->setRange(100, 60000); m_intervalSpin->setValue(1000);
+    m_intervalSpin = new QSpinBox(this); m_intervalSpin->setRange(10, 60000); m_intervalSpin->setValue(1000);
     cfgLayout->addWidget(m_intervalSpin);
+    cfgLayout->addWidget(new QLabel("流水线:", this));
+    m_depthSpin = new QSpinBox(this);
+    m_depthSpin->setRange(1, ModbusTcpPoller::kMaxPipelineDepth);
+    m_depthSpin->setValue(ModbusTcpPoller::kDefaultPipelineDepth);
+    m_depthSpin->setToolTip("每条连接同时在途的请求数；1 = 一问一答（部分网关仅支持 1）");
+    cfgLayout->addWidget(m_depthSpin);
     mainLayout->addWidget(cfg);
 
+    // 多段地址：合并/拆分由读取计划完成
+    auto* rangeLayout = new QHBoxLayout();
+    rangeLayout->addWidget(new QLabel("范围列表:", this));
+    m_rangeEdit = new QLineEdit(this);
+    m_rangeEdit->setPlaceholderText("如 0-9@50, 100+20, 300@5000（@ 后为该段扫描周期 ms；留空则使用起始地址 + 数量）");
+    rangeLayout->addWidget(m_rangeEdit, 1);
+    rangeLayout->addWidget(new QLabel("合并间隔:", this));
+    m_gapSpin = new QSpinBox(this);
+    m_gapSpin->setRange(0, ModbusFrame::kMaxReadRegisters);
+    m_gapSpin->setValue(static_cast<int>(ModbusReadPlanner::kDefaultMaxGapRegisters));
+    m_gapSpin->setToolTip("两段地址间隔不超过此寄存器数时合并为一次读取（位表按 8 倍计）；\n"
+                          "0 = 仅合并相邻范围（设备读取未映射地址报异常 02 时使用）");
+    rangeLayout->addWidget(m_gapSpin);
+    mainLayout->addLayout(rangeLayout);
+
+    // 传输方式：RTU over TCP 使用设备列表中的地址（串口服务器），RTU 串口只使用本机串口
+    auto* transportLayout = new QHBoxLayout();
+    transportLayout->addWidget(new QLabel("传输:", this));
+    m_transportCombo = new QComboBox(this);
+    m_transportCombo->addItems({"Modbus TCP", "RTU over TCP", "RTU 串口"});
+    transportLayout->addWidget(m_transportCombo);
+    transportLayout->addWidget(new QLabel("串口:", this));
+    m_serialPortEdit = new QLineEdit(this);
+    m_serialPortEdit->setPlaceholderText("COM3 / /dev/ttyUSB0");
+    transportLayout->addWidget(m_serialPortEdit, 1);
+    transportLayout->addWidget(new QLabel("波特率:", this));
+    m_baudCombo = new QComboBox(this);
+    m_baudCombo->setEditable(true);
+    m_baudCombo->addItems({"1200", "2400", "4800", "9600", "19200", "38400", "57600", "115200"});
+    m_baudCombo->setCurrentText("9600");
+    transportLayout->addWidget(m_baudCombo);
+    transportLayout->addWidget(new QLabel("校验:", this));
+    m_parityCombo = new QComboBox(this);
+    m_parityCombo->addItems({"无 (N)", "偶 (E)", "奇 (O)"});
+    m_parityCombo->setCurrentIndex(1);   // Modbus RTU 规范默认偶校验
+    transportLayout->addWidget(m_parityCombo);
+    transportLayout->addWidget(new QLabel("停止位:", this));
+    m_stopBitsCombo = new QComboBox(this);
+    m_stopBitsCombo->addItems({"1", "2"});
+    transportLayout->addWidget(m_stopBitsCombo);
+    mainLayout->addLayout(transportLayout);
+
     // 操作区
     auto* act = new QHBoxLayout();
     m_readBtn = new QPushButton("读取", this);
     m_autoBtn = new QPushButton("自动刷新", this); m_autoBtn->setCheckable(true);
     m_writeBtn = new QPushButton("写入", this);
-    act->addWidget(m_readBtn); act->addWidget(m_autoBtn); act->addWidget(m_writeBtn);
+    m_exportBtn = new QPushButton("导出趋势", this);
+    m_exportBtn->setToolTip("导出自动刷新期间记录的趋势数据（每台设备每个扫描周期一个文件）");
+    act->addWidget(m_readBtn); act->addWidget(m_autoBtn); act->addWidget(m_writeBtn); act->addWidget(m_exportBtn);
     act->addStretch();
     mainLayout->addLayout(act);
 
@@ -78,12 +155,43 @@ void ModbusWidget::setupUi()
     m_logView->setMaximumHeight(100);
     mainLayout->addWidget(m_logView);
 
-    // 定时器
-    m_timer = new QTimer(this);
     connect(m_readBtn, &QPushButton::clicked, this, &ModbusWidget::onReadClicked);
     connect(m_autoBtn, &QPushButton::toggled, this, &ModbusWidget::onAutoRefreshToggled);
     connect(m_writeBtn, &QPushButton::clicked, this, &ModbusWidget::onWriteClicked);
-    connect(m_timer, &QTimer::timeout, this, &ModbusWidget::onTimerTick);
+    connect(m_exportBtn, &QPushButton::clicked, this, &ModbusWidget::onExportTrendClicked);
+    connect(m_depthSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int depth) {
+        if (m_backend) m_backend->setPipelineDepth(depth);
+    });
+    connect(m_transportCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) {
+        updateTransportControls();
+    });
+}
+
+void ModbusWidget::updateTransportControls()
+{
+    const int mode = m_transportCombo->currentIndex();
+    const bool serial = mode == static_cast<int>(ModbusTransport::RtuSerial);
+    m_serialPortEdit->setEnabled(serial);
+    m_baudCombo->setEnabled(serial);
+    m_parityCombo->setEnabled(serial);
+    m_stopBitsCombo->setEnabled(serial);
+    // RTU 无事务 ID，只能一问一答
+    m_depthSpin->setEnabled(mode == static_cast<int>(ModbusTransport::Tcp));
+}
+
+void ModbusWidget::applyTransport()
+{
+    if (!m_backend) return;
+    static const char kParity[] = {'N', 'E', 'O'};
+    ModbusRtuBus::SerialConfig cfg;
+    cfg.port = m_serialPortEdit->text().trimmed().toStdString();
+    bool ok = false;
+    const int baud = m_baudCombo->currentText().toInt(&ok);
+    if (ok && baud > 0) cfg.baudRate = baud;
+    cfg.parity = kParity[std::clamp(m_parityCombo->currentIndex(), 0, 2)];
+    cfg.stopBits = m_stopBitsCombo->currentIndex() == 1 ? 2 : 1;
+    m_backend->setSerialConfig(cfg);
+    m_backend->setTransport(static_cast<ModbusTransport>(m_transportCombo->currentIndex()));
 }
 
 void ModbusWidget::setBackend(ModbusBackend* backend)
@@ -93,72 +201,190 @@ void ModbusWidget::setBackend(ModbusBackend* backend)
     m_backend->setLogCallback([this](const std::string& msg) {
         QMetaObject::invokeMethod(this, [this, msg]() { appendLog(QString::fromStdString(msg)); }, Qt::QueuedConnection);
     });
+    m_backend->setPipelineDepth(m_depthSpin->value());
+    applyPlannerOptions();
+    applyTransport();
     m_backend->setResultCallback([this](const std::string& device, const QVector<quint16>& values, qint64 elapsedMs) {
-        QMetaObject::invokeMethod(this, [this, device, values, elapsedMs]() {
-            QString ip = QString::fromStdString(device);
-            auto items = m_resultTable->findItems(ip, Qt::MatchExactly);
-            QTableWidgetItem* item;
-            if (items.isEmpty()) {
-                int row = m_resultTable->rowCount();
-                m_resultTable->insertRow(row);
-                item = new QTableWidgetItem(ip);
-                m_resultTable->setItem(row, 0, item);
-                m_resultTable->setItem(row, 1, new QTableWidgetItem());
-            } else {
-                item = items.first();
-            }
-            QString valStr;
-            for (auto v : values) valStr += QString::number(v) + " ";
-            m_resultTable->item(item->row(), 1)->setText(valStr.trimmed() + " (" + QString::number(elapsedMs) + "ms)");
-        }, Qt::QueuedConnection);
+        queueResult(QString::fromStdString(device), values, elapsedMs);
     });
 }
 
-void ModbusWidget::onToolStart() { appendLog("Modbus 测试工具已就绪"); }
-void ModbusWidget::onToolStop() { appendLog("Modbus 测试工具已停止"); }
+void ModbusWidget::queueResult(const QString& device, const QVector<quint16>& values, qint64 elapsedMs)
+{
+    QMutexLocker lock(&m_pendingMutex);
+    m_pendingResults.insert(device, qMakePair(values, elapsedMs));
+    if (m_flushScheduled) return;
+    m_flushScheduled = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        QTimer::singleShot(kUiRefreshMs, this, &ModbusWidget::flushResults);
+    }, Qt::QueuedConnection);
+}
 
-void ModbusWidget::onReadClicked()
+void ModbusWidget::flushResults()
+{
+    QHash<QString, QPair<QVector<quint16>, qint64>> batch;
+    {
+        QMutexLocker lock(&m_pendingMutex);
+        batch.swap(m_pendingResults);
+        m_flushScheduled = false;
+    }
+    for (auto it = batch.cbegin(); it != batch.cend(); ++it) {
+        int row = m_rowByDevice.value(it.key(), -1);
+        if (row < 0) {
+            row = m_resultTable->rowCount();
+            m_resultTable->insertRow(row);
+            m_resultTable->setItem(row, 0, new QTableWidgetItem(it.key()));
+            m_resultTable->setItem(row, 1, new QTableWidgetItem());
+            m_rowByDevice.insert(it.key(), row);
+        }
+        QString valStr;
+        for (auto v : it.value().first) valStr += QString::number(v) + " ";
+        if (it.value().first.isEmpty()) valStr = "读取失败";
+        m_resultTable->item(row, 1)->setText(valStr.trimmed() + " (" + QString::number(it.value().second) + "ms)");
+    }
+}
+
+void ModbusWidget::clearResults()
 {
-    if (!m_backend) return;
-    // 保存当前从站配置
     {
-        QVariantMap v{
-            {QStringLiteral("regType"), m_regTypeCombo ? m_regTypeCombo->currentIndex() : 0},
-            {QStringLiteral("startAddr"), m_startAddrSpin ? m_startAddrSpin->value() : 0},
-            {QStringLiteral("count"), m_countSpin ? m_countSpin->value() : 10},
-            {QStringLiteral("slaveId"), m_slaveIdSpin ? m_slaveIdSpin->value() : 1},
-            {QStringLiteral("intervalMs"), m_intervalSpin ? m_intervalSpin->value() : 1000},
-            {QStringLiteral("updated_at"), QDateTime::currentMSecsSinceEpoch()}
-        };
-        const int sid = m_slaveIdSpin ? m_slaveIdSpin->value() : 1;
-        ConfigStore::instance().save(QStringLiteral("modbus.slave"),
-                                     QStringLiteral("slave:%1").arg(sid), v);
+        QMutexLocker lock(&m_pendingMutex);
+        m_pendingResults.clear();
     }
-    QModbusDataUnit::RegisterType t = static_cast<QModbusDataUnit::RegisterType>(m_regTypeCombo->currentIndex() + 1);
-    if (m_regTypeCombo->currentIndex() > 1) t = static_cast<QModbusDataUnit::RegisterType>(m_regTypeCombo->currentIndex());
+    m_rowByDevice.clear();
     m_resultTable->setRowCount(0);
+}
+
+void ModbusWidget::onToolStart() { appendLog("Modbus 测试工具已就绪"); }
+void ModbusWidget::onToolStop()
+{
+    if (m_autoBtn->isChecked()) m_autoBtn->setChecked(false);
+    appendLog("Modbus 测试工具已停止");
+}
+
+void ModbusWidget::saveSlaveConfig()
+{
+    QVariantMap v{
+        {QStringLiteral("regType"), m_regTypeCombo ? m_regTypeCombo->currentIndex() : 0},
+        {QStringLiteral("startAddr"), m_startAddrSpin ? m_startAddrSpin->value() : 0},
+        {QStringLiteral("count"), m_countSpin ? m_countSpin->value() : 10},
+        {QStringLiteral("slaveId"), m_slaveIdSpin ? m_slaveIdSpin->value() : 1},
+        {QStringLiteral("intervalMs"), m_intervalSpin ? m_intervalSpin->value() : 1000},
+        {QStringLiteral("pipelineDepth"), m_depthSpin ? m_depthSpin->value() : ModbusTcpPoller::kDefaultPipelineDepth},
+        {QStringLiteral("maxGap"), m_gapSpin ? m_gapSpin->value() : static_cast<int>(ModbusReadPlanner::kDefaultMaxGapRegisters)},
+        {QStringLiteral("ranges"), m_rangeEdit ? m_rangeEdit->text() : QString()},
+        {QStringLiteral("transport"), m_transportCombo ? m_transportCombo->currentIndex() : 0},
+        {QStringLiteral("serialPort"), m_serialPortEdit ? m_serialPortEdit->text() : QString()},
+        {QStringLiteral("baudRate"), m_baudCombo ? m_baudCombo->currentText().toInt() : 9600},
+        {QStringLiteral("parity"), m_parityCombo ? m_parityCombo->currentIndex() : 1},
+        {QStringLiteral("stopBits"), m_stopBitsCombo && m_stopBitsCombo->currentIndex() == 1 ? 2 : 1},
+        {QStringLiteral("updated_at"), QDateTime::currentMSecsSinceEpoch()}
+    };
+    const int sid = m_slaveIdSpin ? m_slaveIdSpin->value() : 1;
+    ConfigStore::instance().save(QStringLiteral("modbus.slave"),
+                                 QStringLiteral("slave:%1").arg(sid), v);
+}
+
+void ModbusWidget::applyPlannerOptions()
+{
+    if (!m_backend) return;
+    ModbusReadPlanner::Options opt;
+    opt.maxGapRegisters = static_cast<uint32_t>(m_gapSpin->value());
+    opt.maxGapBits = opt.maxGapRegisters * 8;
+    m_backend->setPlannerOptions(opt);
+}
+
+bool ModbusWidget::collectGroups(std::vector<ModbusScanGroup>& groups)
+{
+    groups.clear();
+    ModbusTag base;
+    base.unitId = static_cast<uint8_t>(m_slaveIdSpin->value());
+    base.table = ModbusBackend::tableFromRegisterType(
+        ModbusBackend::registerTypeFromIndex(m_regTypeCombo->currentIndex()));
+    const int defaultMs = m_intervalSpin->value();
+
+    const QString text = m_rangeEdit->text().trimmed();
+    if (text.isEmpty()) {
+        base.address = static_cast<uint16_t>(m_startAddrSpin->value());
+        base.count = static_cast<uint32_t>(m_countSpin->value());
+        groups.push_back(ModbusScanGroup{ {base}, defaultMs });
+        return true;
+    }
+
+    // 语法：起始-结束（含）、起始+数量、单个地址，逗号/分号/空白分隔；
+    // 可选后缀 @周期ms 指定扫描等级（如 0-9@50），无后缀使用“间隔”
+    const QStringList items = text.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+    for (const QString& entry : items) {
+        const QString item = entry.section('@', 0, 0);
+        bool ok1 = true, ok2 = true, ok3 = true;
+        uint first = 0, last = 0;
+        if (item.contains('-')) {
+            first = item.section('-', 0, 0).toUInt(&ok1);
+            last = item.section('-', 1).toUInt(&ok2);
+        } else if (item.contains('+')) {
+            first = item.section('+', 0, 0).toUInt(&ok1);
+            const uint n = item.section('+', 1).toUInt(&ok2);
+            ok2 = ok2 && n > 0;
+            last = first + n - 1;
+        } else {
+            first = last = item.toUInt(&ok1);
+        }
+        int periodMs = defaultMs;
+        if (entry.contains('@')) {
+            periodMs = entry.section('@', 1).toInt(&ok3);
+            ok3 = ok3 && periodMs >= m_intervalSpin->minimum();
+        }
+        if (!ok1 || !ok2 || !ok3 || first > 65535 || last < first) {
+            appendLog("无效的地址范围: " + entry);
+            return false;
+        }
+        ModbusTag tag = base;
+        tag.address = static_cast<uint16_t>(first);
+        tag.count = last - first + 1;
+
+        auto it = std::find_if(groups.begin(), groups.end(),
+                               [periodMs](const ModbusScanGroup& g) { return g.intervalMs == periodMs; });
+        if (it == groups.end()) groups.push_back(ModbusScanGroup{ {tag}, periodMs });
+        else it->tags.push_back(tag);
+    }
+    return true;
+}
+
+void ModbusWidget::onReadClicked()
+{
+    if (!m_backend) return;
+    std::vector<ModbusScanGroup> groups;
+    if (!collectGroups(groups)) return;
+    std::vector<ModbusTag> tags;
+    for (const auto& g : groups) tags.insert(tags.end(), g.tags.begin(), g.tags.end());
+    saveSlaveConfig();
+    applyPlannerOptions();
+    applyTransport();
+    clearResults();
     appendLog("开始读取...");
-    m_backend->readAllRegisters(m_slaveIdSpin->value(), t, m_startAddrSpin->value(), m_countSpin->value());
+    m_backend->readTags(tags);
 }
 
 void ModbusWidget::onAutoRefreshToggled(bool checked)
 {
+    if (!m_backend) return;
     if (checked) {
-        m_timer->start(m_intervalSpin->value());
+        std::vector<ModbusScanGroup> groups;
+        if (!collectGroups(groups)) {
+            m_autoBtn->setChecked(false);
+            return;
+        }
+        saveSlaveConfig();
+        applyPlannerOptions();
+        applyTransport();
+        clearResults();
+        m_backend->startPolling(groups);
         m_autoBtn->setText("停止刷新");
-        appendLog("自动刷新已开启");
     } else {
-        m_timer->stop();
+        m_backend->stopPolling();
         m_autoBtn->setText("自动刷新");
-        appendLog("自动刷新已停止");
     }
 }
 
-void ModbusWidget::onTimerTick()
-{
-    if (m_autoBtn->isChecked()) onReadClicked();
-}
-
 void ModbusWidget::onWriteClicked()
 {
     if (!m_backend) return;
@@ -166,6 +392,48 @@ void ModbusWidget::onWriteClicked()
     appendLog("写入功能请通过 Modbus 批量测试界面操作");
 }
 
+void ModbusWidget::onExportTrendClicked()
+{
+    if (!m_backend) return;
+    const auto trend = m_backend->trend();
+    if (!trend || trend->seriesCount() == 0) {
+        appendLog("暂无趋势数据，请先开启自动刷新");
+        return;
+    }
+
+    QString filter;
+    const QString base = QFileDialog::getSaveFileName(this, "导出趋势",
+        "modbus_trend_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"),
+        "CSV 文件 (*.csv);;二进制列式文件 (*.mbtr)", &filter);
+    if (base.isEmpty()) return;
+    const bool binary = filter.contains("mbtr");
+    const QString suffix = binary ? ".mbtr" : ".csv";
+    QFileInfo info(base);
+    const QString stem = info.dir().filePath(info.completeBaseName());
+
+    // 快照到内存后写文件，不阻塞引擎线程写入
+    const int64_t from = std::numeric_limits<int64_t>::min();
+    const int64_t to = std::numeric_limits<int64_t>::max();
+    int written = 0;
+    for (int i = 0; i < trend->seriesCount(); ++i) {
+        std::ostringstream out;
+        const bool ok = binary ? trend->writeBinary(out, i, from, to)
+                               : trend->writeCsv(out, i, from, to);
+        if (!ok) continue;
+        QString name = QString::fromStdString(trend->seriesName(i));
+        name.replace(QRegularExpression("[^0-9A-Za-z_.@-]"), "_");
+        QFile file(stem + "_" + name + suffix);
+        if (!file.open(QIODevice::WriteOnly)) {
+            appendLog("无法写入 " + file.fileName() + ": " + file.errorString());
+            continue;
+        }
+        const std::string data = out.str();
+        file.write(data.data(), static_cast<qint64>(data.size()));
+        ++written;
+    }
+    appendLog(QString("趋势已导出 %1 个文件到 %2").arg(written).arg(info.absolutePath()));
+}
+
 void ModbusWidget::appendLog(const QString& msg)
 {
     QString ts = QDateTime::currentDateTime().toString("hh:mm:ss");
@@ -6,9 +6,14 @@
 #include <QSpinBox>
 #include <QPushButton>
 #include <QTextEdit>
-#include <QTimer>
+#include <QLineEdit>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <vector>
 
 class ModbusBackend;
+struct ModbusScanGroup;
 
 class ModbusWidget : public ToolWidget {
     Q_OBJECT
@@ -26,12 +31,25 @@ public:
 private slots:
     void onReadClicked();
     void onAutoRefreshToggled(bool checked);
-    void onTimerTick();
     void onWriteClicked();
+    void onExportTrendClicked();
 
 private:
     void setupUi();
     void appendLog(const QString& msg);
+    void saveSlaveConfig();
+    // 汇总当前界面的读取标签并按扫描周期分组：范围列表非空时按列表，否则取 起始地址 + 数量
+    bool collectGroups(std::vector<ModbusScanGroup>& groups);
+    void applyPlannerOptions();
+    // 传输方式与串口参数下发到后端；同时按方式启用/禁用相关输入
+    void applyTransport();
+    void updateTransportControls();
+    // 结果由引擎线程高频回调，先合并到 m_pendingResults，再按 kUiRefreshMs 批量刷新表格
+    void queueResult(const QString& device, const QVector<quint16>& values, qint64 elapsedMs);
+    void flushResults();
+    void clearResults();
+
+    static constexpr int kUiRefreshMs = 100;
 
     ModbusBackend* m_backend = nullptr;
 
@@ -40,10 +58,23 @@ private:
     QSpinBox*      m_countSpin      = nullptr;
     QSpinBox*      m_slaveIdSpin    = nullptr;
     QSpinBox*      m_intervalSpin   = nullptr;
+    QSpinBox*      m_depthSpin      = nullptr;
+    QSpinBox*      m_gapSpin        = nullptr;
+    QLineEdit*     m_rangeEdit      = nullptr;
+    QComboBox*     m_transportCombo = nullptr;
+    QLineEdit*     m_serialPortEdit = nullptr;
+    QComboBox*     m_baudCombo      = nullptr;
+    QComboBox*     m_parityCombo    = nullptr;
+    QComboBox*     m_stopBitsCombo  = nullptr;
     QTableWidget*  m_resultTable    = nullptr;
     QPushButton*   m_readBtn        = nullptr;
     QPushButton*   m_writeBtn       = nullptr;
     QPushButton*   m_autoBtn        = nullptr;
+    QPushButton*   m_exportBtn      = nullptr;
     QTextEdit*     m_logView        = nullptr;
-    QTimer*        m_timer          = nullptr;
+
+    QMutex m_pendingMutex;
+    QHash<QString, QPair<QVector<quint16>, qint64>> m_pendingResults;
+    bool m_flushScheduled = false;
+    QHash<QString, int> m_rowByDevice;
 };
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: CommandPipeline.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 流水线命令提交实现 — 脚本拼接、按标记行拆分输出。
+ */
+
+#include "CommandPipeline.h"
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+// 在 from 之后查找单独成行的 marker，返回其行首位置；lineEnd 返回下一行起点
+size_t findMarkerLine(const std::string& text, const std::string& marker, size_t from, size_t& lineEnd)
+{
+    for (size_t pos = text.find(marker, from); pos != std::string::npos;
+         pos = text.find(marker, pos + 1)) {
+        if (pos > 0 && text[pos - 1] != '\n') continue;   // 回显 "echo 标记" 不在行首
+        const size_t after = pos + marker.size();
+        if (after < text.size() && text[after] != '\r' && text[after] != '\n') continue;
+        const size_t eol = text.find('\n', after);
+        lineEnd = eol == std::string::npos ? text.size() : eol + 1;
+        return pos;
+    }
+    return std::string::npos;
+}
+
+// 删除含 needle 的整行
+std::string dropLinesContaining(const std::string& text, const std::string& needle)
+{
+    std::string out;
+    out.reserve(text.size());
+    size_t pos = 0;
+    size_t hit = text.find(needle);
+    while (pos < text.size()) {
+        const size_t eol = text.find('\n', pos);
+        const size_t next = eol == std::string::npos ? text.size() : eol + 1;
+        if (hit != std::string::npos && hit < pos) hit = text.find(needle, pos);
+        if (hit == std::string::npos || hit >= next) {
+            out.append(text, pos, next - pos);
+        }
+        pos = next;
+    }
+    return out;
+}
+
+} // namespace
+
+PipelineScript CommandPipeline::build(const std::vector<std::string>& commands, const std::string& tag,
+                                      const std::string& newline)
+{
+    PipelineScript script;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const std::string marker = tag + "_" + std::to_string(i + 1) + "__";
+        script.text += commands[i] + newline + "echo " + marker;
+        if (i + 1 < commands.size()) script.text += newline;
+        script.markers.push_back(marker);
+    }
+    return script;
+}
+
+std::vector<PipelineResult> CommandPipeline::split(const std::string& output, const PipelineScript& script,
+                                                   size_t commandCount)
+{
+    std::vector<PipelineResult> results(commandCount);
+    size_t pos = 0;
+    for (size_t i = 0; i < commandCount; ++i) {
+        if (i >= script.markers.size()) {
+            // 脚本缺少该命令的标记：剩余输出归它，但无法判定完成
+            results[i].output = output.substr(pos);
+            break;
+        }
+        const std::string& marker = script.markers[i];
+        size_t lineEnd = 0;
+        const size_t at = findMarkerLine(output, marker, pos, lineEnd);
+        if (at == std::string::npos) {
+            // 标记未到达（超时/取消）：已收到的输出归当前命令，其后的命令无结果
+            results[i].output = dropLinesContaining(output.substr(pos), "echo " + marker);
+            break;
+        }
+        results[i].output = dropLinesContaining(output.substr(pos, at - pos), "echo " + marker);
+        results[i].completed = true;
+        pos = lineEnd;
+    }
+    return results;
+}
+
+std::string CommandPipeline::nextTag()
+{
+    static std::atomic<unsigned> counter{0};
+    // 时间分量避免与上次运行残留在终端里的标记重名
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    return "__DM_P" + std::to_string(ms % 100000) + "_" + std::to_string(++counter);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: CommandPipeline.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 流水线命令提交 — 把多条命令连同各自的 echo 标记拼成一个脚本一次写出，
+ *              再按标记行把设备输出拆回每条命令的结果。不依赖具体协议。
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+
+// 单条命令在流水线输出中的结果
+struct PipelineResult {
+    std::string output;
+    bool completed = false;   // 已见到该命令之后的标记
+};
+
+// 拼好的脚本：markers[i] 紧跟在第 i 条命令之后，最后一条也有，
+// 是否执行完毕一律以标记为准（适配器超时 / 通道提前关闭时不会误判完成）
+struct PipelineScript {
+    std::string text;
+    std::vector<std::string> markers;
+};
+
+class CommandPipeline {
+public:
+    // tag 区分同一会话中的不同批次；newline 为 Telnet "\r\n" / SSH "\n"
+    static PipelineScript build(const std::vector<std::string>& commands, const std::string& tag,
+                                const std::string& newline);
+
+    // 按单独成行的标记拆分输出，返回 commandCount 条结果。
+    // 终端回显的 "echo 标记" 行（连同其前的提示符）从所属命令的输出中剔除
+    static std::vector<PipelineResult> split(const std::string& output, const PipelineScript& script,
+                                             size_t commandCount);
+
+    // 批次标记前缀（进程内唯一）
+    static std::string nextTag();
+};
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: OutputCapture.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 单台设备输出捕获实现。
+ */
+
+#include "OutputCapture.h"
+
+OutputCapture::OutputCapture(size_t memoryCap, const QString& spillPath)
+    : m_memoryCap(memoryCap)
+{
+    if (!spillPath.isEmpty()) {
+        m_spill.setFileName(spillPath);
+        m_spill.open(QIODevice::WriteOnly | QIODevice::Truncate);   // 失败时 spillPath() 为空，由调用方报告
+    }
+}
+
+OutputCapture::~OutputCapture()
+{
+    if (m_spill.isOpen()) m_spill.close();
+}
+
+void OutputCapture::append(const char* data, size_t size)
+{
+    if (size == 0) return;
+    m_total += size;
+    if (m_spill.isOpen()) m_spill.write(data, static_cast<qint64>(size));
+
+    if (m_memoryCap == 0) {
+        m_ring.append(data, size);
+        return;
+    }
+    // 单次写入超过容量：只有最后 m_memoryCap 字节有意义
+    if (size >= m_memoryCap) {
+        m_ring.assign(data + size - m_memoryCap, m_memoryCap);
+        m_head = 0;
+        return;
+    }
+    // 未写满：直接追加，溢出部分转入覆盖
+    if (m_ring.size() < m_memoryCap) {
+        const size_t room = m_memoryCap - m_ring.size();
+        const size_t n = size < room ? size : room;
+        m_ring.append(data, n);
+        data += n;
+        size -= n;
+        if (size == 0) return;
+    }
+    // 已写满：从 m_head 处覆盖最早的数据
+    while (size > 0) {
+        const size_t n = size < m_memoryCap - m_head ? size : m_memoryCap - m_head;
+        m_ring.replace(m_head, n, data, n);
+        m_head = (m_head + n) % m_memoryCap;
+        data += n;
+        size -= n;
+    }
+}
+
+QString OutputCapture::spillPath() const
+{
+    return m_spill.isOpen() ? m_spill.fileName() : QString();
+}
+
+std::string OutputCapture::tail() const
+{
+    if (m_head == 0) return m_ring;
+    return m_ring.substr(m_head) + m_ring.substr(0, m_head);
+}
+
+std::string OutputCapture::text() const
+{
+    if (!truncated()) return tail();
+
+    std::string note = "[输出共 " + std::to_string(m_total) + " 字节，仅保留最后 "
+                     + std::to_string(m_ring.size()) + " 字节";
+    if (m_spill.isOpen()) {
+        note += "；完整输出: " + m_spill.fileName().toStdString();
+    }
+    note += "]\n";
+    return note + tail();
+}
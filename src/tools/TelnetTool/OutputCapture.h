@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: OutputCapture.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 单台设备的输出捕获 — 内存中只保留最后 memoryCap 字节（环形缓冲），
+ *              可选把完整输出落盘。输出再大，每台设备的内存占用也有上限。
+ */
+
+#pragma once
+#include <QFile>
+#include <QString>
+#include <string>
+
+class OutputCapture {
+public:
+    // memoryCap 为内存中保留的字节数（0 = 不限）；spillPath 非空时完整输出另写入该文件
+    explicit OutputCapture(size_t memoryCap, const QString& spillPath = QString());
+    ~OutputCapture();
+
+    OutputCapture(const OutputCapture&) = delete;
+    OutputCapture& operator=(const OutputCapture&) = delete;
+
+    void append(const char* data, size_t size);
+    void append(const std::string& data) { append(data.data(), data.size()); }
+
+    // 累计收到的字节数（含已被覆盖的部分）
+    quint64 totalBytes() const { return m_total; }
+    // 是否有输出因超出上限被丢弃
+    bool truncated() const { return m_memoryCap > 0 && m_total > m_memoryCap; }
+    // 落盘文件路径（未启用或打开失败时为空）
+    QString spillPath() const;
+
+    // 内存中保留的尾部输出
+    std::string tail() const;
+    // 供结果展示：被截断时在尾部前加一行说明
+    std::string text() const;
+
+private:
+    size_t m_memoryCap;
+    std::string m_ring;      // 环形缓冲，写满后从 m_head 处覆盖
+    size_t m_head = 0;       // 最早字节的位置（仅写满后有意义）
+    quint64 m_total = 0;
+    QFile m_spill;
+};
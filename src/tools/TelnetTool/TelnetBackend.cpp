@@ -15,10 +15,17 @@
 #include "TelnetBackend.h"
 #include "adapter/ProtocolRegistry.h"
 #include "adapter/TelnetAdapter.h"
+#include "adapter/SshAdapter.h"
+#include "CommandPipeline.h"
+#include "OutputCapture.h"
+#include <QDir>
 #include <QtConcurrent/QtConcurrent>
 #include <lwlog/lwlog.h>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 
 TelnetBackend::TelnetBackend()
 {
@@ -60,6 +67,23 @@ void TelnetBackend::applyConfig(const lwserverbase::config::ConfigValue& /*confi
     // 从 ConfigManager 读取运行时配置变更（后续扩展）
 }
 
+void TelnetBackend::setMaxConcurrency(int n)
+{
+    if (n < 1) n = 1;
+    if (n > kMaxConcurrency) n = kMaxConcurrency;
+    m_maxConcurrency = n;
+}
+
+void TelnetBackend::setDeviceTimeout(int sec)
+{
+    m_deviceTimeoutSec = sec > 0 ? sec : 0;
+}
+
+void TelnetBackend::setSshKeepAlive(int sec)
+{
+    SshSessionPool::instance().setIdleTimeout(sec);
+}
+
 void TelnetBackend::executeCommand(const std::vector<std::string>& ips,
                                    const std::vector<std::string>& commands,
                                    int timeoutSec)
@@ -73,8 +97,6 @@ void TelnetBackend::executeCommand(const std::vector<std::string>& ips,
 
     m_execFuture = QtConcurrent::run([this, ips, commands, timeoutSec]() {
         int totalCount = static_cast<int>(ips.size());
-        int successCount = 0;
-        int failureCount = 0;
 
         if (totalCount == 0) {
             if (m_logCb) m_logCb("错误：目标 IP 列表为空");
@@ -88,130 +110,279 @@ void TelnetBackend::executeCommand(const std::vector<std::string>& ips,
             return;
         }
 
+        const int workers = std::min(totalCount, m_maxConcurrency);
         if (m_logCb) {
             m_logCb("开始批量命令执行，目标设备: " + std::to_string(totalCount)
-                    + " 台，命令数: " + std::to_string(commands.size()));
+                    + " 台，命令数: " + std::to_string(commands.size())
+                    + "，并发: " + std::to_string(workers));
         }
 
-        // 逐台设备执行
-        for (const auto& ip : ips) {
-            if (m_cancelled) break;
+        // 工作线程从共享索引领取设备；结果在各设备完成时立即回调（完成顺序）
+        std::atomic<size_t> nextIndex{0};
+        std::atomic<int> successCount{0};
+        std::atomic<int> failureCount{0};
+
+        auto worker = [&]() {
+            for (;;) {
+                if (m_cancelled) return;
+                const size_t i = nextIndex.fetch_add(1);
+                if (i >= ips.size()) return;
+
+                const std::string& ip = ips[i];
+                const DeviceResult result = runOnDevice(ip, commands, timeoutSec);
+                if (result.success) {
+                    successCount++;
+                } else {
+                    failureCount++;
+                }
+                if (m_resultCb) {
+                    m_resultCb(ip, result.success, result.elapsedMs, result.output);
+                }
+            }
+        };
 
-            if (m_logCb) m_logCb("--- 设备: " + ip + " ---");
+        m_workerPool.setMaxThreadCount(workers);
+        std::vector<QFuture<void>> running;
+        running.reserve(static_cast<size_t>(workers));
+        for (int w = 0; w < workers; ++w) {
+            running.push_back(QtConcurrent::run(&m_workerPool, worker));
+        }
+        for (auto& f : running) {
+            f.waitForFinished();
+        }
 
-            // 从 ProtocolRegistry 创建协议适配器（telnet / ssh）
-            auto adapter = ProtocolRegistry::instance()->create(
-                m_selectedProtocol.toStdString());
-            if (!adapter) {
-                if (m_logCb) m_logCb(m_selectedProtocol.toStdString() + " 适配器不可用: " + ip);
-                if (m_resultCb) m_resultCb(ip, false, 0, "适配器不可用");
-                failureCount++;
-                continue;
-            }
+        // 最终回调
+        if (m_finishedCb) {
+            m_finishedCb(totalCount, successCount, failureCount);
+        }
 
-            // 构建设备信息
-            // C2: 端口按协议区分。telnet 固定 23；ssh 保持 0，
-            //     由 SshAdapter 回退到默认 22（原先硬编码 23 导致 SSH 连到 telnet 端口）
-            DeviceInfo dev;
-            dev.ip = ip;
-            if (m_selectedProtocol == "ssh") {
-                dev.port = 0;  // 交由 SshAdapter 使用默认 22
-            } else {
-                dev.port = 23;
-            }
-            dev.protocol = m_selectedProtocol.toStdString();
-
-            // 连接设备
-            if (m_logCb) m_logCb("正在连接: " + ip + " ...");
-            if (!adapter->connect(dev, m_auth)) {
-                std::string err = adapter->lastError().empty()
-                    ? "连接超时或被拒绝"
-                    : adapter->lastError();
-                if (m_logCb) m_logCb("连接失败: " + ip + " — " + err);
-                if (m_resultCb) m_resultCb(ip, false, 0, err);
-                failureCount++;
-                continue;
+        if (m_logCb) {
+            std::string summary = "批量命令执行完毕 — 总计: " + std::to_string(totalCount)
+                + ", 成功: " + std::to_string(successCount)
+                + ", 失败: " + std::to_string(failureCount);
+            if (m_cancelled) {
+                summary += ", 未执行: "
+                    + std::to_string(totalCount - successCount - failureCount);
             }
+            m_logCb(summary);
+        }
+    });
+}
 
-            if (m_logCb) m_logCb("已连接: " + ip);
+TelnetBackend::DeviceResult TelnetBackend::runOnDevice(const std::string& ip,
+                                                       const std::vector<std::string>& commands,
+                                                       int timeoutSec)
+{
+    DeviceResult result;
+    const auto startTime = std::chrono::steady_clock::now();
+    auto elapsedMs = [&startTime]() {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime).count());
+    };
+    const int deviceTimeoutMs = m_deviceTimeoutSec * 1000;
+
+    if (m_logCb) m_logCb("--- 设备: " + ip + " ---");
+
+    // 输出只在内存中保留有上限的尾部；落盘文件名中的 ':'（IPv6）换成 '_'
+    QString spillPath;
+    if (!m_spillDir.isEmpty()) {
+        spillPath = QDir(m_spillDir).filePath(QString::fromStdString(ip).replace(':', '_') + ".log");
+    }
+    OutputCapture capture(m_outputCap, spillPath);
+    if (!spillPath.isEmpty() && capture.spillPath().isEmpty() && m_logCb) {
+        m_logCb(ip + " 无法创建输出文件，完整输出不落盘: " + spillPath.toStdString());
+    }
+    auto appendOutput = [&](const std::string& chunk) {
+        if (chunk.empty()) return;
+        capture.append(chunk);
+        if (m_outputCb) m_outputCb(ip, chunk);
+    };
+
+    // 从 ProtocolRegistry 创建协议适配器（telnet / ssh）
+    auto adapter = ProtocolRegistry::instance()->create(
+        m_selectedProtocol.toStdString());
+    if (!adapter) {
+        if (m_logCb) m_logCb(m_selectedProtocol.toStdString() + " 适配器不可用: " + ip);
+        result.output = "适配器不可用";
+        return result;
+    }
 
-            // 测量执行耗时
-            auto startTime = std::chrono::steady_clock::now();
-            bool allOk = true;
-            std::string accumulatedOutput;
+    // 取消时中止本设备进行中的登录/命令等待，而不是等当前命令超时
+    adapter->setCancelFlag(&m_cancelled);
 
-            // 逐条命令执行
-            int timeoutMs = timeoutSec * 1000;
-            for (size_t ci = 0; ci < commands.size(); ++ci) {
-                if (m_cancelled) { allOk = false; break; }
+    // 逐条模式下长输出边到达边交出，适配器不再整段缓存；
+    // 流水线需按标记拆分完整输出，不设置
+    const bool pipelined = m_pipelined && commands.size() > 1;
+    if (!pipelined) {
+        adapter->setResponseSink([&appendOutput](const char* data, size_t size) {
+            appendOutput(std::string(data, size));
+        });
+    }
 
-                const auto& cmd = commands[ci];
+    // Telnet 按提示符 / 回显标记判定每条命令结束，无需固定等待
+    if (auto* telnet = dynamic_cast<TelnetAdapter*>(adapter.get())) {
+        if (!telnet->setPromptPattern(m_promptPattern) && m_logCb) {
+            m_logCb(ip + " " + telnet->lastError() + "，改为按静默间隔判定");
+            telnet->setPromptPattern(std::string());
+        }
+        telnet->setSentinelEcho(m_sentinelEcho);
+    }
 
-                Request req;
-                req.path = cmd;
-                req.timeoutMs = timeoutMs;
+    // 构建设备信息
+    // C2: 端口按协议区分。telnet 固定 23；ssh 保持 0，
+    //     由 SshAdapter 回退到默认 22（原先硬编码 23 导致 SSH 连到 telnet 端口）
+    DeviceInfo dev;
+    dev.ip = ip;
+    if (m_selectedProtocol == "ssh") {
+        dev.port = 0;  // 交由 SshAdapter 使用默认 22
+    } else {
+        dev.port = 23;
+    }
+    dev.protocol = m_selectedProtocol.toStdString();
+
+    // 连接设备
+    if (m_logCb) m_logCb("正在连接: " + ip + " ...");
+    if (!adapter->connect(dev, m_auth)) {
+        std::string err = adapter->lastError().empty()
+            ? "连接超时或被拒绝"
+            : adapter->lastError();
+        if (m_logCb) m_logCb("连接失败: " + ip + " — " + err);
+        result.elapsedMs = elapsedMs();
+        result.output = err;
+        return result;
+    }
 
-                if (m_logCb) m_logCb("执行命令[" + std::to_string(ci + 1) + "/"
-                                     + std::to_string(commands.size()) + "]: " + cmd);
+    if (m_logCb) {
+        auto* ssh = dynamic_cast<SshAdapter*>(adapter.get());
+        m_logCb(ssh && ssh->sessionReused() ? "已连接: " + ip + "（复用已认证 SSH 会话）"
+                                            : "已连接: " + ip);
+    }
 
-                auto future = adapter->request(req);
-                auto resp = future.get();  // 阻塞等待响应
+    bool allOk = true;
+    bool timedOut = false;
 
-                if (resp.success) {
-                    accumulatedOutput += resp.data;
-                    if (m_logCb) {
-                        m_logCb(ip + " 命令返回 " + std::to_string(resp.data.size()) + " 字节");
-                    }
-                } else {
-                    if (m_logCb) m_logCb("命令执行失败: " + cmd
-                                         + " — " + resp.errorMessage);
-                    accumulatedOutput += "[ERROR] " + resp.errorMessage + "\n";
-                    allOk = false;
-                }
+    const int timeoutMs = timeoutSec * 1000;
 
-                // 命令间短暂间隔，避免 Telnet 缓冲区混乱
-                if (ci + 1 < commands.size()) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                }
-            }
+    // 流水线：整批等待上限按命令数累计，同样受设备总超时约束；单条命令走逐条模式即可
+    if (pipelined) {
+        // 64 位累计后再收窄，命令多、单条超时长时不溢出
+        int64_t batchMs = static_cast<int64_t>(timeoutMs) * static_cast<int64_t>(commands.size());
+        if (deviceTimeoutMs > 0) {
+            batchMs = std::min<int64_t>(batchMs, deviceTimeoutMs - elapsedMs());
+        }
+        const int batchTimeoutMs = static_cast<int>(std::min<int64_t>(batchMs, INT_MAX));
+        if (batchTimeoutMs <= 0) {
+            timedOut = true;
+            allOk = false;
+        } else {
+            allOk = runPipelined(*adapter, ip, commands, batchTimeoutMs, appendOutput);
+            timedOut = !allOk && !m_cancelled && deviceTimeoutMs > 0 && elapsedMs() >= deviceTimeoutMs;
+        }
+    }
 
-            auto endTime = std::chrono::steady_clock::now();
-            int elapsedMs = static_cast<int>(
-                std::chrono::duration_cast<std::chrono::milliseconds>(
-                    endTime - startTime).count());
-
-            // 断开连接
-            adapter->disconnect();
-
-            if (allOk) {
-                successCount++;
-                if (m_logCb) m_logCb(ip + " 执行完成 (" + std::to_string(elapsedMs) + "ms)");
-            } else if (!m_cancelled) {
-                failureCount++;
-                if (m_logCb) m_logCb(ip + " 执行失败/异常");
-            } else {
-                failureCount++;
-                if (m_logCb) m_logCb(ip + " 已取消");
-            }
+    // 逐条命令执行；设置了设备总超时时，单条命令的等待不超过剩余时间
+    for (size_t ci = 0; !pipelined && ci < commands.size(); ++ci) {
+        if (m_cancelled) { allOk = false; break; }
 
-            // 报告单设备结果
-            if (m_resultCb) {
-                m_resultCb(ip, allOk && !m_cancelled, elapsedMs, accumulatedOutput);
-            }
+        int cmdTimeoutMs = timeoutMs;
+        if (deviceTimeoutMs > 0) {
+            const int remaining = deviceTimeoutMs - elapsedMs();
+            if (remaining <= 0) { timedOut = true; allOk = false; break; }
+            cmdTimeoutMs = std::min(cmdTimeoutMs, remaining);
         }
 
-        // 最终回调
-        if (m_finishedCb) {
-            m_finishedCb(totalCount, successCount, failureCount);
+        const auto& cmd = commands[ci];
+
+        Request req;
+        req.path = cmd;
+        req.timeoutMs = cmdTimeoutMs;
+
+        if (m_logCb) m_logCb(ip + " 执行命令[" + std::to_string(ci + 1) + "/"
+                             + std::to_string(commands.size()) + "]: " + cmd);
+
+        const quint64 before = capture.totalBytes();   // 长输出在 request 期间已经流式交出
+        auto future = adapter->request(req);
+        auto resp = future.get();  // 阻塞等待响应（取消时由适配器提前返回）
+
+        appendOutput(resp.data);
+        if (resp.success) {
+            if (m_logCb) {
+                m_logCb(ip + " 命令返回 " + std::to_string(capture.totalBytes() - before) + " 字节");
+            }
+        } else {
+            if (m_logCb) m_logCb(ip + " 命令执行失败: " + cmd
+                                 + " — " + resp.errorMessage);
+            appendOutput("[ERROR] " + resp.errorMessage + "\n");
+            allOk = false;
+            if (m_cancelled) break;
         }
+    }
 
+    // 断开连接
+    adapter->disconnect();
+    result.elapsedMs = elapsedMs();
+
+    if (timedOut) {
+        appendOutput("[ERROR] 设备总超时 (" + std::to_string(m_deviceTimeoutSec) + " s)\n");
+        if (m_logCb) m_logCb(ip + " 设备总超时 (" + std::to_string(result.elapsedMs) + "ms)");
+    } else if (allOk) {
+        if (m_logCb) m_logCb(ip + " 执行完成 (" + std::to_string(result.elapsedMs) + "ms)");
+    } else if (!m_cancelled) {
+        if (m_logCb) m_logCb(ip + " 执行失败/异常");
+    } else {
+        if (m_logCb) m_logCb(ip + " 已取消");
+    }
+
+    if (capture.truncated() && m_logCb) {
+        const QString path = capture.spillPath();
+        m_logCb(ip + " 输出共 " + std::to_string(capture.totalBytes()) + " 字节，超出上限仅保留尾部"
+                + (path.isEmpty() ? std::string() : "，完整输出: " + path.toStdString()));
+    }
+    result.output = capture.text();
+    result.success = allOk && !m_cancelled;
+    return result;
+}
+
+bool TelnetBackend::runPipelined(IProtocolAdapter& adapter, const std::string& ip,
+                                 const std::vector<std::string>& commands, int timeoutMs,
+                                 const std::function<void(const std::string&)>& output)
+{
+    auto* telnet = dynamic_cast<TelnetAdapter*>(&adapter);
+    const PipelineScript script = CommandPipeline::build(commands, CommandPipeline::nextTag(),
+                                                         telnet ? "\r\n" : "\n");
+
+    Request req;
+    req.path = script.text;
+    req.timeoutMs = timeoutMs;
+
+    if (m_logCb) m_logCb(ip + " 流水线提交 " + std::to_string(commands.size()) + " 条命令");
+
+    // Telnet 的提示符在第一条命令后就会出现，整批以适配器追加的回显标记收尾；
+    // SSH 整批作为一个 exec 执行，通道 EOF 即结束
+    if (telnet) telnet->setSentinelEcho(true);
+    const Response resp = adapter.request(req).get();
+    if (telnet) telnet->setSentinelEcho(m_sentinelEcho);
+
+    // 每条命令（含最后一条）是否完成都以其后的标记为准，不看适配器的整体结果
+    const std::vector<PipelineResult> parts = CommandPipeline::split(resp.data, script, commands.size());
+
+    bool allOk = true;
+    for (size_t ci = 0; ci < commands.size(); ++ci) {
+        const PipelineResult& part = parts[ci];
+        output(part.output);
+        if (!part.completed) allOk = false;
         if (m_logCb) {
-            std::string summary = "批量命令执行完毕 — 总计: " + std::to_string(totalCount)
-                + ", 成功: " + std::to_string(successCount)
-                + ", 失败: " + std::to_string(failureCount);
-            m_logCb(summary);
+            m_logCb(ip + " 命令[" + std::to_string(ci + 1) + "/" + std::to_string(commands.size())
+                    + "] " + commands[ci]
+                    + (part.completed ? " 返回 " + std::to_string(part.output.size()) + " 字节"
+                                      : std::string(" 未完成")));
         }
-    });
+    }
+    if (!resp.success) {
+        if (m_logCb) m_logCb(ip + " 流水线执行失败 — " + resp.errorMessage);
+        output("[ERROR] " + resp.errorMessage + "\n");
+    }
+    return allOk;
 }
 
 void TelnetBackend::cancel()
@@ -238,3 +409,9 @@ void TelnetBackend::setFinishedCallback(
 {
     m_finishedCb = std::move(cb);
 }
+
+void TelnetBackend::setOutputCallback(
+    std::function<void(const std::string& ip, const std::string& chunk)> cb)
+{
+    m_outputCb = std::move(cb);
+}
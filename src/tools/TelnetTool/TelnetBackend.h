@@ -9,11 +9,15 @@
  * Author: turnarond
  *
  * Description: Telnet 批量命令 Tool 后端 — 继承 ToolBackend，通过 ProtocolRegistry
- *              获取 TelnetAdapter 实例，异步批量执行命令到所有目标设备。
+ *              获取 TelnetAdapter / SshAdapter 实例，异步批量执行命令到所有目标设备。
+ *              多设备按有界并发执行（同时在线会话数可配置），单设备可设总超时，
+ *              结果按完成顺序回调；取消时进行中的会话立即中止。
+ *              每台设备的输出按块流式交付，内存中只保留有上限的尾部，可选完整落盘。
  */
 
 #pragma once
 #include "framework/ToolBackend.h"
+#include "adapter/TelnetAdapter.h"
 #include <memory>
 #include <vector>
 #include <string>
@@ -21,6 +25,7 @@
 #include <atomic>
 #include <QFuture>
 #include <QString>
+#include <QThreadPool>
 
 class TelnetBackend : public ToolBackend {
 public:
@@ -46,30 +51,91 @@ public:
 
     // --- Telnet 命令执行 ---
     // ips: 目标设备 IP 列表
-    // commands: 命令列表（换行分割，逐条执行）
+    // commands: 命令列表（换行分割，每台设备上逐条执行）
     // timeoutSec: 单条命令超时时间（秒）
     void executeCommand(const std::vector<std::string>& ips,
                         const std::vector<std::string>& commands,
                         int timeoutSec);
     void cancel();
 
+    // 同时执行的设备数上限（1 = 退化为逐台顺序执行），下次 executeCommand 生效
+    void setMaxConcurrency(int n);
+    int maxConcurrency() const { return m_maxConcurrency; }
+
+    // 单台设备总超时（秒，含连接与全部命令；0 = 不限，仅受单条命令超时约束），
+    // 下次 executeCommand 生效
+    void setDeviceTimeout(int sec);
+    int deviceTimeout() const { return m_deviceTimeoutSec; }
+
+    // Telnet 响应结束判据（见 TelnetAdapter::setPromptPattern / setSentinelEcho），
+    // SSH 不适用；下次 executeCommand 生效
+    void setPromptPattern(const std::string& pattern) { m_promptPattern = pattern; }
+    void setSentinelEcho(bool enabled) { m_sentinelEcho = enabled; }
+
+    // 流水线模式：一台设备的全部命令连同 echo 标记一次写出，再按标记拆分每条命令的结果，
+    // 整批只需一次往返。要求设备在上一条命令执行期间能缓存后续输入；下次 executeCommand 生效
+    void setPipelined(bool enabled) { m_pipelined = enabled; }
+    bool pipelined() const { return m_pipelined; }
+
+    // SSH 已认证会话在池中的保持时间（秒，0 = 用完即断开），立即生效；
+    // 保持期内再次对同一设备执行命令可跳过密钥交换与认证
+    void setSshKeepAlive(int sec);
+
+    // 单台设备在内存中保留的输出上限（字节，0 = 不限），超出部分只保留尾部；
+    // 下次 executeCommand 生效
+    void setOutputCap(size_t bytes) { m_outputCap = bytes; }
+    size_t outputCap() const { return m_outputCap; }
+
+    // 完整输出落盘目录（每台设备一个 <ip>.log，空 = 不落盘）；下次 executeCommand 生效
+    void setSpillDirectory(const QString& dir) { m_spillDir = dir; }
+
+    static constexpr int kDefaultConcurrency = 16;
+    static constexpr int kMaxConcurrency = 256;
+    static constexpr size_t kDefaultOutputCap = 1024 * 1024;
+
     // 回调设置（由 Widget 调用，跨线程安全）
     // logCb: 每步操作日志
     // resultCb: 单设备完成回调 (ip, success, elapsedMs, outputSummary)
     // finishedCb: 全部完成回调 (totalCount, successCount, failureCount)
+    // outputCb: 设备输出块回调 (ip, chunk)，执行期间随输出到达多次调用
     void setLogCallback(std::function<void(const std::string&)> cb);
     void setResultCallback(std::function<void(const std::string& ip, bool success,
                                                int elapsedMs, const std::string& output)> cb);
     void setFinishedCallback(std::function<void(int total, int success, int failed)> cb);
+    void setOutputCallback(std::function<void(const std::string& ip, const std::string& chunk)> cb);
 
 private:
+    struct DeviceResult {
+        bool success = false;
+        int elapsedMs = 0;
+        std::string output;
+    };
+
+    // 单台设备完整流程（创建适配器 → 连接 → 逐条执行 → 断开）
+    DeviceResult runOnDevice(const std::string& ip, const std::vector<std::string>& commands,
+                             int timeoutSec);
+    // 流水线执行（已连接），timeoutMs 为整批的等待上限，拆分后的输出交给 output；
+    // 全部命令完成返回 true
+    bool runPipelined(IProtocolAdapter& adapter, const std::string& ip,
+                      const std::vector<std::string>& commands, int timeoutMs,
+                      const std::function<void(const std::string&)>& output);
+
     std::vector<DeviceInfo> m_devices;
     AuthInfo m_auth;
     QString m_selectedProtocol = "telnet";
     std::atomic<bool> m_cancelled{false};
+    int m_maxConcurrency = kDefaultConcurrency;
+    int m_deviceTimeoutSec = 0;
+    std::string m_promptPattern = TelnetAdapter::kDefaultPromptPattern;
+    bool m_sentinelEcho = false;
+    bool m_pipelined = false;
+    size_t m_outputCap = kDefaultOutputCap;
+    QString m_spillDir;
+    QThreadPool m_workerPool;    // 设备级工作线程池（与全局池隔离，避免占满 QtConcurrent 默认池）
     QFuture<void> m_execFuture;  // 追踪异步执行任务，析构前等待完成
 
     std::function<void(const std::string&)> m_logCb;
     std::function<void(const std::string&, bool, int, const std::string&)> m_resultCb;
     std::function<void(int, int, int)> m_finishedCb;
+    std::function<void(const std::string&, const std::string&)> m_outputCb;
 };
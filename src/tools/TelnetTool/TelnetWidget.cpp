@@ -14,6 +14,7 @@
 
 #include "TelnetWidget.h"
 #include "TelnetBackend.h"
+#include "adapter/SshSessionPool.h"
 #include "ui/DeviceBusWidget.h"
 #include "config/ConfigStore.h"
 #include <QVBoxLayout>
@@ -30,6 +31,7 @@
 #include <QClipboard>
 #include <QSettings>
 #include <QCheckBox>
+#include <QDir>
 
 TelnetWidget::TelnetWidget(QWidget* parent)
     : ToolWidget(parent)
@@ -46,6 +48,22 @@ TelnetWidget::TelnetWidget(QWidget* parent)
         }
         if (m_timeoutSpin)
             m_timeoutSpin->setValue(h.value(QStringLiteral("timeoutSec")).toInt());
+        if (m_concurrencySpin && h.contains(QStringLiteral("concurrency")))
+            m_concurrencySpin->setValue(h.value(QStringLiteral("concurrency")).toInt());
+        if (m_deviceTimeoutSpin && h.contains(QStringLiteral("deviceTimeoutSec")))
+            m_deviceTimeoutSpin->setValue(h.value(QStringLiteral("deviceTimeoutSec")).toInt());
+        if (m_promptEdit && h.contains(QStringLiteral("promptPattern")))
+            m_promptEdit->setText(h.value(QStringLiteral("promptPattern")).toString());
+        if (m_sentinelCheck)
+            m_sentinelCheck->setChecked(h.value(QStringLiteral("sentinelEcho")).toBool());
+        if (m_pipelineCheck)
+            m_pipelineCheck->setChecked(h.value(QStringLiteral("pipelined")).toBool());
+        if (m_sshKeepAliveSpin && h.contains(QStringLiteral("sshKeepAliveSec")))
+            m_sshKeepAliveSpin->setValue(h.value(QStringLiteral("sshKeepAliveSec")).toInt());
+        if (m_outputCapSpin && h.contains(QStringLiteral("outputCapKB")))
+            m_outputCapSpin->setValue(h.value(QStringLiteral("outputCapKB")).toInt());
+        if (m_spillCheck)
+            m_spillCheck->setChecked(h.value(QStringLiteral("spillToDisk")).toBool());
     }
 }
 
@@ -74,6 +92,67 @@ void TelnetWidget::setupUi()
     m_timeoutSpin->setSuffix(" s");
     m_timeoutSpin->setToolTip("每条命令的最大等待超时时间");
     configLayout->addWidget(m_timeoutSpin);
+    configLayout->addSpacing(16);
+
+    configLayout->addWidget(new QLabel("设备总超时:", this));
+    m_deviceTimeoutSpin = new QSpinBox(this);
+    m_deviceTimeoutSpin->setRange(0, 3600);
+    m_deviceTimeoutSpin->setValue(0);
+    m_deviceTimeoutSpin->setSuffix(" s");
+    m_deviceTimeoutSpin->setSpecialValueText("不限");
+    m_deviceTimeoutSpin->setToolTip("单台设备从连接到全部命令执行完毕的最长时间，超时的设备记为失败");
+    configLayout->addWidget(m_deviceTimeoutSpin);
+    configLayout->addSpacing(16);
+
+    configLayout->addWidget(new QLabel("并发设备数:", this));
+    m_concurrencySpin = new QSpinBox(this);
+    m_concurrencySpin->setRange(1, TelnetBackend::kMaxConcurrency);
+    m_concurrencySpin->setValue(TelnetBackend::kDefaultConcurrency);
+    m_concurrencySpin->setToolTip("同时执行命令的设备数量上限，1 表示逐台顺序执行");
+    configLayout->addWidget(m_concurrencySpin);
+    configLayout->addSpacing(16);
+
+    configLayout->addWidget(new QLabel("提示符:", this));
+    m_promptEdit = new QLineEdit(QString::fromLatin1(TelnetAdapter::kDefaultPromptPattern), this);
+    m_promptEdit->setMaximumWidth(160);
+    m_promptEdit->setToolTip("Telnet 提示符正则，输出末尾匹配即认为命令执行完毕（如 SylixOS 为 \"-> $\"）；\n"
+                             "留空则按输出静默间隔判定");
+    configLayout->addWidget(m_promptEdit);
+
+    m_sentinelCheck = new QCheckBox("回显标记", this);
+    m_sentinelCheck->setToolTip("每条命令后追加 echo 标记行，收到标记即认为执行完毕；\n"
+                                "适用于提示符不固定的设备，设备需支持 echo 命令");
+    configLayout->addWidget(m_sentinelCheck);
+
+    m_pipelineCheck = new QCheckBox("流水线", this);
+    m_pipelineCheck->setToolTip("一次写出全部命令（每条后附 echo 标记），再按标记拆分各条命令的输出；\n"
+                                "每台设备只需一次往返，要求设备能在命令执行期间缓存后续输入");
+    configLayout->addWidget(m_pipelineCheck);
+    configLayout->addSpacing(16);
+
+    configLayout->addWidget(new QLabel("SSH 会话保持:", this));
+    m_sshKeepAliveSpin = new QSpinBox(this);
+    m_sshKeepAliveSpin->setRange(0, 3600);
+    m_sshKeepAliveSpin->setValue(SshSessionPool::kDefaultIdleTimeoutSec);
+    m_sshKeepAliveSpin->setSuffix(" s");
+    m_sshKeepAliveSpin->setSpecialValueText("不保持");
+    m_sshKeepAliveSpin->setToolTip("执行完毕后已认证的 SSH 会话保留的时间；期间再次对同一设备执行命令\n"
+                                   "直接复用会话，跳过密钥交换与认证");
+    configLayout->addWidget(m_sshKeepAliveSpin);
+    configLayout->addSpacing(16);
+
+    configLayout->addWidget(new QLabel("输出上限:", this));
+    m_outputCapSpin = new QSpinBox(this);
+    m_outputCapSpin->setRange(0, 1024 * 1024);
+    m_outputCapSpin->setValue(static_cast<int>(TelnetBackend::kDefaultOutputCap / 1024));
+    m_outputCapSpin->setSuffix(" KB");
+    m_outputCapSpin->setSpecialValueText("不限");
+    m_outputCapSpin->setToolTip("每台设备在内存中保留的输出量，超出部分只保留最后一段");
+    configLayout->addWidget(m_outputCapSpin);
+
+    m_spillCheck = new QCheckBox("完整输出落盘", this);
+    m_spillCheck->setToolTip("每台设备的完整输出另写入临时目录下的 <IP>.log，不受输出上限影响");
+    configLayout->addWidget(m_spillCheck);
     configLayout->addStretch();
 
     mainLayout->addWidget(configGroup);
@@ -167,7 +246,7 @@ void TelnetWidget::setBackend(TelnetBackend* backend)
                 QString qIp = QString::fromStdString(ip);
                 QString status = success ? "成功" : "失败";
                 QString outputPreview = QString::fromStdString(output)
-                    .left(100).replace('\n', ' ').replace('\r', "");
+                    .left(kPreviewChars).replace('\n', ' ').replace('\r', "");
 
                 // 更新已有行
                 bool found = false;
@@ -202,6 +281,24 @@ void TelnetWidget::setBackend(TelnetBackend* backend)
             }, Qt::QueuedConnection);
         });
 
+    // 执行期间的输出块只用于刷新预览列，每块只取末尾一小段跨线程传递
+    m_backend->setOutputCallback([this](const std::string& ip, const std::string& chunk) {
+        const size_t keep = static_cast<size_t>(kPreviewChars);
+        const std::string tail = chunk.size() > keep ? chunk.substr(chunk.size() - keep) : chunk;
+        QMetaObject::invokeMethod(this, [this, ip, tail]() {
+            const QString qIp = QString::fromStdString(ip);
+            for (int i = 0; i < m_resultTree->topLevelItemCount(); ++i) {
+                auto* item = m_resultTree->topLevelItem(i);
+                if (item->text(0) != qIp) continue;
+                if (item->text(1) == "等待执行") item->setText(1, "执行中");
+                const QString preview = QString::fromUtf8(tail.data(), static_cast<int>(tail.size()))
+                                            .replace('\n', ' ').replace('\r', "");
+                item->setText(3, (item->text(3) + preview).right(kPreviewChars));
+                break;
+            }
+        }, Qt::QueuedConnection);
+    });
+
     m_backend->setFinishedCallback(
         [this](int total, int success, int failed) {
             QMetaObject::invokeMethod(this, [this, total, success, failed]() {
@@ -250,6 +347,17 @@ void TelnetWidget::onExecuteClicked()
         QVariantMap v{
             {QStringLiteral("protocol"), m_protoCombo ? m_protoCombo->currentText() : QStringLiteral("Telnet")},
             {QStringLiteral("timeoutSec"), m_timeoutSpin ? m_timeoutSpin->value() : 10},
+            {QStringLiteral("concurrency"), m_concurrencySpin ? m_concurrencySpin->value()
+                                                              : TelnetBackend::kDefaultConcurrency},
+            {QStringLiteral("deviceTimeoutSec"), m_deviceTimeoutSpin ? m_deviceTimeoutSpin->value() : 0},
+            {QStringLiteral("promptPattern"), m_promptEdit ? m_promptEdit->text() : QString()},
+            {QStringLiteral("sentinelEcho"), m_sentinelCheck && m_sentinelCheck->isChecked()},
+            {QStringLiteral("pipelined"), m_pipelineCheck && m_pipelineCheck->isChecked()},
+            {QStringLiteral("sshKeepAliveSec"), m_sshKeepAliveSpin ? m_sshKeepAliveSpin->value()
+                                                                   : SshSessionPool::kDefaultIdleTimeoutSec},
+            {QStringLiteral("outputCapKB"), m_outputCapSpin ? m_outputCapSpin->value()
+                                                            : static_cast<int>(TelnetBackend::kDefaultOutputCap / 1024)},
+            {QStringLiteral("spillToDisk"), m_spillCheck && m_spillCheck->isChecked()},
             {QStringLiteral("updated_at"), QDateTime::currentMSecsSinceEpoch()}
         };
         ConfigStore::instance().save(QStringLiteral("telnet.prefs"),
@@ -355,7 +463,27 @@ void TelnetWidget::onExecuteClicked()
     // 传递协议选择给 Backend
     m_backend->setProtocol(m_protoCombo->currentText().toLower());
 
-    // 启动后端执行
+    // 启动后端执行（多设备并发，结果按完成顺序回填）
+    m_backend->setMaxConcurrency(m_concurrencySpin->value());
+    m_backend->setDeviceTimeout(m_deviceTimeoutSpin->value());
+    m_backend->setPromptPattern(m_promptEdit->text().trimmed().toStdString());
+    m_backend->setSentinelEcho(m_sentinelCheck->isChecked());
+    m_backend->setPipelined(m_pipelineCheck->isChecked());
+    m_backend->setSshKeepAlive(m_sshKeepAliveSpin->value());
+    m_backend->setOutputCap(static_cast<size_t>(m_outputCapSpin->value()) * 1024);
+
+    QString spillDir;
+    if (m_spillCheck->isChecked()) {
+        spillDir = QDir(QDir::tempPath()).filePath(
+            "DeployMaster/telnet_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+        if (QDir().mkpath(spillDir)) {
+            appendLog("完整输出写入: " + QDir::toNativeSeparators(spillDir));
+        } else {
+            appendLog("无法创建输出目录，不落盘: " + QDir::toNativeSeparators(spillDir));
+            spillDir.clear();
+        }
+    }
+    m_backend->setSpillDirectory(spillDir);
     m_backend->executeCommand(ips, commands, timeoutSec);
 }
 
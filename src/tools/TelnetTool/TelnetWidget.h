@@ -16,6 +16,8 @@
 #include "framework/ToolWidget.h"
 #include <QSpinBox>
 #include <QComboBox>
+#include <QLineEdit>
+#include <QCheckBox>
 #include <QPlainTextEdit>
 #include <QTextEdit>
 #include <QPushButton>
@@ -57,12 +59,22 @@ private:
     void appendLog(const QString& msg);
     void clearResults();
 
+    static constexpr int kPreviewChars = 100;   // 结果列表“输出”列的预览长度
+
     TelnetBackend* m_backend = nullptr;
     DeviceBusWidget* m_deviceBus = nullptr;
 
     // UI 控件
     QComboBox*       m_protoCombo     = nullptr;  // "Telnet" / "SSH"
     QSpinBox*        m_timeoutSpin    = nullptr;
+    QSpinBox*        m_deviceTimeoutSpin = nullptr;
+    QSpinBox*        m_concurrencySpin = nullptr;
+    QLineEdit*       m_promptEdit     = nullptr;  // Telnet 提示符正则
+    QCheckBox*       m_sentinelCheck  = nullptr;  // Telnet 回显标记判定
+    QCheckBox*       m_pipelineCheck  = nullptr;  // 流水线提交
+    QSpinBox*        m_sshKeepAliveSpin = nullptr;  // SSH 会话保持时间
+    QSpinBox*        m_outputCapSpin  = nullptr;  // 单设备输出保留上限（KB）
+    QCheckBox*       m_spillCheck     = nullptr;  // 完整输出落盘
     QPlainTextEdit*  m_cmdEdit        = nullptr;
     QPushButton*     m_executeBtn     = nullptr;
     QPushButton*     m_stopBtn        = nullptr;
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: RemoteFileTreeModel.cpp
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 远端预览文件树模型实现
+ */
+
+#include "RemoteFileTreeModel.h"
+#include "utils/FormatUtils.h"
+#include <QPointer>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+struct RemoteFileTreeModel::Node {
+    enum Kind { Root, Up, Entry };
+    enum State { NotFetched, Fetching, Fetched };
+
+    Kind kind = Entry;
+    State state = NotFetched;
+    FtpFileInfo info;
+    QString path;                  // 目录以 '/' 结尾
+    Node* parent = nullptr;
+    int row = 0;
+    std::vector<std::unique_ptr<Node>> children;
+    QList<FtpFileInfo> pending;    // 已列出、尚未插入模型的条目
+    qsizetype pendingPos = 0;
+
+    bool isDir() const { return kind != Entry || info.isDirectory; }
+    bool expandable() const { return kind != Up && isDir(); }
+    qsizetype pendingCount() const { return pending.size() - pendingPos; }
+};
+
+RemoteFileTreeModel::RemoteFileTreeModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+RemoteFileTreeModel::~RemoteFileTreeModel() = default;
+
+void RemoteFileTreeModel::setIcons(const QIcon& dirIcon, const QIcon& fileIcon)
+{
+    m_dirIcon = dirIcon;
+    m_fileIcon = fileIcon;
+}
+
+void RemoteFileTreeModel::setBatchSize(int rows)
+{
+    m_batchSize = std::max(1, rows);
+}
+
+void RemoteFileTreeModel::setLister(Lister lister)
+{
+    m_lister = std::move(lister);
+}
+
+void RemoteFileTreeModel::sortEntries(QList<FtpFileInfo>& entries)
+{
+    std::sort(entries.begin(), entries.end(), [](const FtpFileInfo& a, const FtpFileInfo& b) {
+        if (a.isDirectory != b.isDirectory)
+            return a.isDirectory > b.isDirectory; // 目录排在文件前
+        return a.name.compare(b.name, Qt::CaseInsensitive) < 0;
+    });
+}
+
+// ============================================================================
+// 重建 / 清空
+// ============================================================================
+
+void RemoteFileTreeModel::setRoot(const QString& label, const QString& rootPath,
+                                  const QList<FtpFileInfo>& entries, bool showParentEntry)
+{
+    beginResetModel();
+    ++m_generation;
+    m_label = label;
+
+    m_root = std::make_unique<Node>();
+    m_root->kind = Node::Root;
+    m_root->path = rootPath.endsWith('/') ? rootPath : rootPath + '/';
+
+    if (showParentEntry) {
+        // 返回上一级
+        QString parentPath = m_root->path;
+        parentPath.chop(1);
+        const int lastSlash = parentPath.lastIndexOf('/');
+        parentPath = lastSlash >= 0 ? parentPath.left(lastSlash + 1) : QStringLiteral("/");
+
+        auto up = std::make_unique<Node>();
+        up->kind = Node::Up;
+        up->path = parentPath;
+        up->parent = m_root.get();
+        m_root->children.push_back(std::move(up));
+    }
+
+    m_root->state = Node::Fetched;
+    m_root->pending = entries;
+    appendPending(m_root.get(), m_batchSize);
+    endResetModel();
+}
+
+void RemoteFileTreeModel::clear()
+{
+    beginResetModel();
+    ++m_generation;
+    m_root.reset();
+    m_label.clear();
+    endResetModel();
+}
+
+// ============================================================================
+// 分批插入 / 后台列出
+// ============================================================================
+
+void RemoteFileTreeModel::appendPending(Node* node, int count)
+{
+    const qsizetype n = std::min<qsizetype>(count, node->pendingCount());
+    node->children.reserve(node->children.size() + static_cast<size_t>(n));
+    for (qsizetype i = 0; i < n; ++i) {
+        auto child = std::make_unique<Node>();
+        child->info = node->pending.at(node->pendingPos + i);
+        child->path = node->path + child->info.name;
+        if (child->info.isDirectory) child->path += '/';
+        child->parent = node;
+        child->row = static_cast<int>(node->children.size());
+        node->children.push_back(std::move(child));
+    }
+    node->pendingPos += n;
+    if (node->pendingCount() == 0) {
+        node->pending.clear();
+        node->pendingPos = 0;
+    }
+}
+
+void RemoteFileTreeModel::insertBatch(Node* node)
+{
+    const int n = static_cast<int>(std::min<qsizetype>(m_batchSize, node->pendingCount()));
+    if (n <= 0) return;
+    const int first = static_cast<int>(node->children.size());
+    beginInsertRows(indexOf(node), first, first + n - 1);
+    appendPending(node, n);
+    endInsertRows();
+}
+
+void RemoteFileTreeModel::startFetch(Node* node)
+{
+    if (!m_lister) return;
+    node->state = Node::Fetching;
+    const QModelIndex idx = indexOf(node);
+    emit dataChanged(idx, idx, { Qt::DisplayRole });
+
+    const quint64 generation = m_generation;
+    const QString path = node->path;
+    const Lister lister = m_lister;
+    QPointer<RemoteFileTreeModel> self(this);
+    QtConcurrent::run([=]() {
+        QList<FtpFileInfo> entries;
+        QString error;
+        try {
+            entries = lister(path);
+            sortEntries(entries);   // 大目录排序也放在后台线程
+        } catch (const std::exception& ex) {
+            error = QString::fromStdString(ex.what());
+        } catch (...) {
+            error = QStringLiteral("未知错误");
+        }
+        if (self) {
+            QMetaObject::invokeMethod(self, [self, generation, node, entries, error]() {
+                if (self) self->onFetched(generation, node, entries, error);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void RemoteFileTreeModel::onFetched(quint64 generation, Node* node,
+                                    const QList<FtpFileInfo>& entries, const QString& error)
+{
+    // 模型已重建：node 已释放，结果作废
+    if (generation != m_generation) return;
+
+    const QModelIndex idx = indexOf(node);
+    if (!error.isEmpty()) {
+        node->state = Node::NotFetched;   // 再次展开时重试
+        emit dataChanged(idx, idx, { Qt::DisplayRole });
+        emit directoryFailed(node->path, error);
+        return;
+    }
+
+    node->state = Node::Fetched;
+    node->pending = entries;
+    node->pendingPos = 0;
+    emit dataChanged(idx, idx, { Qt::DisplayRole });
+    emit directoryLoaded(node->path, static_cast<int>(entries.size()));
+    insertBatch(node);
+}
+
+bool RemoteFileTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    const Node* node = nodeOf(parent);
+    if (!node || !node->expandable()) return false;
+    return node->state == Node::NotFetched || node->pendingCount() > 0;
+}
+
+void RemoteFileTreeModel::fetchMore(const QModelIndex& parent)
+{
+    Node* node = nodeOf(parent);
+    if (!node || !node->expandable()) return;
+    if (node->pendingCount() > 0) {
+        insertBatch(node);
+    } else if (node->state == Node::NotFetched) {
+        startFetch(node);
+    }
+}
+
+// ============================================================================
+// QAbstractItemModel
+// ============================================================================
+
+RemoteFileTreeModel::Node* RemoteFileTreeModel::nodeOf(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<Node*>(index.internalPointer()) : nullptr;
+}
+
+QModelIndex RemoteFileTreeModel::indexOf(Node* node) const
+{
+    return node ? createIndex(node->row, 0, node) : QModelIndex();
+}
+
+QModelIndex RemoteFileTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (column != 0 || row < 0) return QModelIndex();
+    if (!parent.isValid()) {
+        return (row == 0 && m_root) ? createIndex(0, 0, m_root.get()) : QModelIndex();
+    }
+    const Node* p = nodeOf(parent);
+    if (static_cast<size_t>(row) >= p->children.size()) return QModelIndex();
+    return createIndex(row, 0, p->children[static_cast<size_t>(row)].get());
+}
+
+QModelIndex RemoteFileTreeModel::parent(const QModelIndex& child) const
+{
+    const Node* node = nodeOf(child);
+    if (!node || !node->parent) return QModelIndex();
+    return indexOf(node->parent);
+}
+
+int RemoteFileTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) return 0;
+    if (!parent.isValid()) return m_root ? 1 : 0;
+    return static_cast<int>(nodeOf(parent)->children.size());
+}
+
+int RemoteFileTreeModel::columnCount(const QModelIndex& /*parent*/) const
+{
+    return 1;
+}
+
+bool RemoteFileTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    if (!parent.isValid()) return m_root != nullptr;
+    const Node* node = nodeOf(parent);
+    if (!node->expandable()) return false;
+    // 未列出前显示展开箭头；列出后为空则不再显示
+    return node->state != Node::Fetched || !node->children.empty() || node->pendingCount() > 0;
+}
+
+Qt::ItemFlags RemoteFileTreeModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) return Qt::NoItemFlags;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+QVariant RemoteFileTreeModel::data(const QModelIndex& index, int role) const
+{
+    const Node* node = nodeOf(index);
+    if (!node) return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        if (node->kind == Node::Root) return m_label;
+        if (node->kind == Node::Up) return QStringLiteral(".. (返回上一级)");
+        if (node->info.isDirectory) {
+            return node->state == Node::Fetching ? node->info.name + QStringLiteral(" (加载中…)")
+                                                 : node->info.name;
+        }
+        return QString("%1 (%2)").arg(node->info.name, formatFileSize(node->info.size));
+    case Qt::DecorationRole:
+        if (node->kind == Node::Root) return QVariant();
+        return node->isDir() ? m_dirIcon : m_fileIcon;
+    case PathRole:
+        return node->path;
+    case IsDirRole:
+        return node->isDir();
+    case IsRootRole:
+        return node->kind == Node::Root;
+    case NameRole:
+        return node->kind == Node::Entry ? QVariant(node->info.name) : QVariant();
+    case SizeRole:
+        return node->info.size;
+    default:
+        return QVariant();
+    }
+}
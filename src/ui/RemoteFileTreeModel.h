@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024-2026 turnarond.
+ * All rights reserved.
+ *
+ * File: RemoteFileTreeModel.h
+ *
+ * Date: 2026-10-17
+ *
+ * Author: turnarond
+ *
+ * Description: 远端预览文件树模型 — 子目录在展开时由后台线程列出（canFetchMore/fetchMore），
+ *              列表结果按批插入，滚动到底部再取下一批；十万级条目的目录也不阻塞界面。
+ */
+
+#pragma once
+#include <QAbstractItemModel>
+#include <QIcon>
+#include <QList>
+#include <QString>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "model/FtpListParser.h"
+
+class RemoteFileTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    // 与原 QStandardItemModel 版本的 UserRole 约定保持一致
+    enum Roles {
+        PathRole = Qt::UserRole,        // 完整远程路径（目录以 '/' 结尾）
+        IsDirRole = Qt::UserRole + 1,
+        IsRootRole = Qt::UserRole + 2,
+        NameRole = Qt::UserRole + 3,    // 原始文件名
+        SizeRole = Qt::UserRole + 4,
+    };
+
+    // 列出远程目录；在线程池中调用，失败时抛出异常
+    using Lister = std::function<QList<FtpFileInfo>(const QString& dir)>;
+
+    static constexpr int kDefaultBatchSize = 500;
+
+    explicit RemoteFileTreeModel(QObject* parent = nullptr);
+    ~RemoteFileTreeModel() override;
+
+    void setIcons(const QIcon& dirIcon, const QIcon& fileIcon);
+    void setBatchSize(int rows);
+    // 展开子目录时使用的列表函数
+    void setLister(Lister lister);
+
+    // 以已列出的根目录内容重建模型（entries 应已按 sortEntries 排序）；
+    // 只立即插入第一批，其余在视图滚动到底部时按批插入
+    void setRoot(const QString& label, const QString& rootPath, const QList<FtpFileInfo>& entries,
+                 bool showParentEntry);
+    void clear();
+
+    // 目录在前、文件在后，各自按名称（不区分大小写）排序；可在后台线程调用
+    static void sortEntries(QList<FtpFileInfo>& entries);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+signals:
+    void directoryLoaded(const QString& path, int entries);
+    void directoryFailed(const QString& path, const QString& error);
+
+private:
+    struct Node;
+
+    Node* nodeOf(const QModelIndex& index) const;
+    QModelIndex indexOf(Node* node) const;
+    void appendPending(Node* node, int count);
+    void insertBatch(Node* node);
+    void startFetch(Node* node);
+    void onFetched(quint64 generation, Node* node, const QList<FtpFileInfo>& entries,
+                   const QString& error);
+
+    std::unique_ptr<Node> m_root;
+    QString m_label;
+    Lister m_lister;
+    quint64 m_generation = 0;   // 每次重建递增，丢弃旧模型的在途列表结果
+    int m_batchSize = kDefaultBatchSize;
+    QIcon m_dirIcon;
+    QIcon m_fileIcon;
+};
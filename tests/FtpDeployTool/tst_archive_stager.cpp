@@ -0,0 +1,94 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QProcess>
+#include <QStandardPaths>
+#include "tools/FtpDeployTool/ArchiveStager.h"
+
+class TestArchiveStager : public QObject {
+    Q_OBJECT
+private slots:
+    void crc32CheckValue();
+    void archiveExtractsWithTar();
+    void missingFileFails();
+};
+
+static LocalFile writeFile(const QTemporaryDir& dir, const QString& rel, const QByteArray& data)
+{
+    const QString path = dir.filePath(rel);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile f(path);
+    if (f.open(QIODevice::WriteOnly)) f.write(data);
+
+    LocalFile lf;
+    lf.localPath = path.toStdString();
+    lf.relPath = rel.toStdString();
+    lf.size = static_cast<uint64_t>(data.size());
+    lf.mtime = 1700000000;
+    return lf;
+}
+
+void TestArchiveStager::crc32CheckValue()
+{
+    QCOMPARE(ArchiveStager::crc32("123456789", 9), uint32_t(0xCBF43926));
+    // 分段计算与整体一致
+    const uint32_t part = ArchiveStager::crc32("1234", 4);
+    QCOMPARE(ArchiveStager::crc32("56789", 5, part), uint32_t(0xCBF43926));
+}
+
+void TestArchiveStager::archiveExtractsWithTar()
+{
+    const QString tar = QStandardPaths::findExecutable(QStringLiteral("tar"));
+    if (tar.isEmpty()) QSKIP("tar not available");
+
+    QTemporaryDir src, out;
+    QByteArray big(3 * int(ArchiveStager::kBlockSize) + 77, Qt::Uninitialized);
+    for (int i = 0; i < big.size(); ++i) big[i] = static_cast<char>((i * 7) ^ (i >> 9));
+
+    const QString longRel = QStringLiteral("app/") + QString(120, QLatin1Char('d'))
+                          + QStringLiteral("/") + QString(90, QLatin1Char('f'));
+    std::vector<LocalFile> files{
+        writeFile(src, QStringLiteral("app/big.bin"), big),
+        writeFile(src, QStringLiteral("app/sub/a.txt"), "hello\n"),
+        writeFile(src, QStringLiteral("app/empty"), QByteArray()),
+        writeFile(src, longRel, "long\n"),
+    };
+
+    const std::string archive = src.filePath(QStringLiteral("stage.tar.gz")).toStdString();
+    const ArchiveStager::Result r = ArchiveStager::build(files, archive);
+    QVERIFY2(r.ok, r.error.c_str());
+    QCOMPARE(r.rawBytes, uint64_t(big.size() + 6 + 5));
+    QCOMPARE(QString::fromStdString(r.lastEntry), longRel);
+    QCOMPARE(r.archiveBytes, uint64_t(QFileInfo(QString::fromStdString(archive)).size()));
+
+    QProcess proc;
+    proc.start(tar, { QStringLiteral("-xzf"), QString::fromStdString(archive),
+                      QStringLiteral("-C"), out.path() });
+    QVERIFY(proc.waitForFinished(30000));
+    QCOMPARE(proc.exitCode(), 0);
+
+    QFile extracted(out.filePath(QStringLiteral("app/big.bin")));
+    QVERIFY(extracted.open(QIODevice::ReadOnly));
+    QCOMPARE(extracted.readAll(), big);
+    QVERIFY(QFileInfo::exists(out.filePath(QStringLiteral("app/empty"))));
+    QVERIFY(QFileInfo::exists(out.filePath(longRel)));
+}
+
+void TestArchiveStager::missingFileFails()
+{
+    QTemporaryDir dir;
+    LocalFile f;
+    f.localPath = dir.filePath(QStringLiteral("missing.bin")).toStdString();
+    f.relPath = "missing.bin";
+    f.size = 10;
+
+    const std::string archive = dir.filePath(QStringLiteral("stage.tar.gz")).toStdString();
+    const ArchiveStager::Result r = ArchiveStager::build({ f }, archive);
+    QVERIFY(!r.ok);
+    QVERIFY(!r.error.empty());
+    QVERIFY(!QFile::exists(QString::fromStdString(archive)));
+}
+
+QTEST_MAIN(TestArchiveStager)
+#include "tst_archive_stager.moc"
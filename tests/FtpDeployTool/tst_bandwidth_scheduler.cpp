@@ -0,0 +1,184 @@
+#include <QtTest>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "tools/FtpDeployTool/BandwidthScheduler.h"
+
+using namespace std::chrono_literals;
+
+class TestBandwidthScheduler : public QObject {
+    Q_OBJECT
+private slots:
+    void bucketBurstAndRefill();
+    void unlimitedBucket();
+    void perDeviceCap();
+    void globalCapSharedFairly();
+    void initialConcurrency();
+    void admitBlocksAtTarget();
+    void adaptiveGrowth();
+};
+
+using Clock = BandwidthScheduler::Clock;
+
+// 以 chunk 为单位反复申请配额直到 duration 用完，返回实际获批字节数
+static uint64_t pump(BandwidthScheduler& s, size_t device, Clock::duration duration, size_t chunk = 4096)
+{
+    uint64_t total = 0;
+    const auto end = Clock::now() + duration;
+    while (Clock::now() < end) {
+        const size_t n = s.acquire(device, chunk);
+        total += n;
+        if (n == 0) std::this_thread::sleep_for(1ms);
+    }
+    return total;
+}
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void TestBandwidthScheduler::bucketBurstAndRefill()
+{
+    TokenBucket bucket(100000, 10000);
+    const auto t0 = Clock::now();
+    QCOMPARE(bucket.available(t0), uint64_t(10000));
+
+    bucket.consume(10000);
+    QCOMPARE(bucket.available(t0), uint64_t(0));
+
+    // 50 ms 补充 rate × 0.05 = 5000 字节
+    const uint64_t refilled = bucket.available(t0 + 50ms);
+    QVERIFY(refilled >= 4999 && refilled <= 5000);
+
+    // 补充不超过桶容量
+    QCOMPARE(bucket.available(t0 + 10s), uint64_t(10000));
+
+    // 时间倒退不补充
+    bucket.consume(10000);
+    QCOMPARE(bucket.available(t0), uint64_t(0));
+}
+
+void TestBandwidthScheduler::unlimitedBucket()
+{
+    TokenBucket bucket;
+    QVERIFY(bucket.unlimited());
+    QCOMPARE(bucket.available(Clock::now()), UINT64_MAX);
+    bucket.consume(1 << 30);
+    QCOMPARE(bucket.available(Clock::now()), UINT64_MAX);
+
+    BandwidthScheduler s(2, 0, 0, 4);
+    QVERIFY(!s.limited());
+    QCOMPARE(s.acquire(0, 1 << 20), size_t(1 << 20));
+}
+
+void TestBandwidthScheduler::perDeviceCap()
+{
+    const uint64_t rate = 64 * 1024;
+    const uint64_t burst = 16 * 1024;           // rate/10 不足 16 KiB 时取 16 KiB
+    BandwidthScheduler s(2, 0, rate, 2);
+    QVERIFY(s.limited());
+
+    const auto start = Clock::now();
+    const uint64_t sent = pump(s, 0, 300ms);
+    const double elapsed = secondsSince(start);
+
+    QVERIFY(sent <= burst + static_cast<uint64_t>(rate * elapsed) + 4096);
+    QVERIFY(sent >= burst + static_cast<uint64_t>(rate * 0.3 * 0.8));
+
+    // 设备桶互相独立：设备 1 仍有整桶配额
+    QCOMPARE(s.acquire(1, burst), size_t(burst));
+}
+
+void TestBandwidthScheduler::globalCapSharedFairly()
+{
+    const uint64_t rate = 256 * 1024;
+    const uint64_t burst = rate / 10;
+    const int devices = 4;
+    BandwidthScheduler s(devices, rate, 0, devices);
+
+    // 先取空初始突发量，避免先启动的线程独占整桶
+    QCOMPARE(s.acquire(0, burst), size_t(burst));
+
+    std::vector<uint64_t> sent(devices, 0);
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for (int d = 0; d < devices; ++d) {
+        threads.emplace_back([&, d] { sent[d] = pump(s, static_cast<size_t>(d), 500ms); });
+    }
+    for (auto& t : threads) t.join();
+    const double elapsed = secondsSince(start);
+
+    const uint64_t total = std::accumulate(sent.begin(), sent.end(), uint64_t(0));
+    QVERIFY(total <= static_cast<uint64_t>(rate * elapsed) + devices * 4096);
+    QVERIFY(total >= static_cast<uint64_t>(rate * 0.5 * 0.8));
+
+    // 同样的申请节奏下各设备份额接近均分
+    const double mean = static_cast<double>(total) / devices;
+    for (uint64_t n : sent) {
+        QVERIFY(static_cast<double>(n) > mean * 0.5);
+        QVERIFY(static_cast<double>(n) < mean * 1.5);
+    }
+}
+
+void TestBandwidthScheduler::initialConcurrency()
+{
+    // 不限全局：直接取上限
+    QCOMPARE(BandwidthScheduler(10, 0, 32 * 1024, 3).targetConcurrency(), 3);
+    // 两级限速：恰好占满全局预算的设备数 ceil(100K / 30K) = 4
+    QCOMPARE(BandwidthScheduler(10, 100 * 1024, 30 * 1024, 8).targetConcurrency(), 4);
+    // 仅全局限速：慢启动从 1 开始
+    QCOMPARE(BandwidthScheduler(10, 1024 * 1024, 0, 8).targetConcurrency(), 1);
+    // 每台至少 16 KiB/s：32 KiB/s 最多 2 台
+    QCOMPARE(BandwidthScheduler(10, 32 * 1024, 8 * 1024, 8).targetConcurrency(), 2);
+}
+
+void TestBandwidthScheduler::admitBlocksAtTarget()
+{
+    BandwidthScheduler s(4, 0, 64 * 1024, 2);
+    std::atomic<bool> cancelled{false};
+    QVERIFY(s.admit(cancelled));
+    QVERIFY(s.admit(cancelled));
+
+    // 第三台在 release 之前阻塞
+    std::atomic<bool> admitted{false};
+    std::thread waiter([&] { admitted = s.admit(cancelled); });
+    std::this_thread::sleep_for(150ms);
+    QVERIFY(!admitted);
+    s.release();
+    waiter.join();
+    QVERIFY(admitted);
+
+    // 取消后等待中的准入返回 false
+    std::atomic<bool> result{true};
+    std::thread cancelledWaiter([&] { result = s.admit(cancelled); });
+    std::this_thread::sleep_for(50ms);
+    cancelled = true;
+    cancelledWaiter.join();
+    QVERIFY(!result);
+}
+
+void TestBandwidthScheduler::adaptiveGrowth()
+{
+    // 全局预算远未用满且准入门是瓶颈：每个统计窗口后在途设备数增长
+    BandwidthScheduler s(8, 4 * 1024 * 1024, 0, 8);
+    std::atomic<bool> cancelled{false};
+    QCOMPARE(s.targetConcurrency(), 1);
+    QVERIFY(s.admit(cancelled));
+
+    std::this_thread::sleep_for(BandwidthScheduler::kWindow + 50ms);
+    QCOMPARE(s.acquire(0, 1024), size_t(1024));
+    QCOMPARE(s.targetConcurrency(), 2);      // 慢启动翻倍
+
+    // 全局触顶的窗口之后保持并发
+    QVERIFY(s.admit(cancelled));
+    s.acquire(0, size_t(1) << 30);
+    std::this_thread::sleep_for(BandwidthScheduler::kWindow + 50ms);
+    s.acquire(0, 1);
+    QCOMPARE(s.targetConcurrency(), 2);
+}
+
+QTEST_MAIN(TestBandwidthScheduler)
+#include "tst_bandwidth_scheduler.moc"
@@ -0,0 +1,170 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include "tools/FtpDeployTool/DeployManifest.h"
+
+class TestDeployManifest : public QObject {
+    Q_OBJECT
+private slots:
+    void serializeRoundTrip();
+    void parseRejectsUnknownHeader();
+    void planClassifiesFiles();
+    void planDeleteRemoved();
+    void scanLocalLayout();
+    void scanLocalReportsMissing();
+};
+
+static ManifestEntry entry(const std::string& path, uint64_t size, int64_t mtime,
+                           const std::string& hash)
+{
+    ManifestEntry e;
+    e.path = path;
+    e.size = size;
+    e.mtime = mtime;
+    e.hash = hash;
+    return e;
+}
+
+static LocalFile localFile(const std::string& rel, uint64_t size, int64_t mtime)
+{
+    LocalFile f;
+    f.localPath = "/local/" + rel;
+    f.relPath = rel;
+    f.size = size;
+    f.mtime = mtime;
+    return f;
+}
+
+void TestDeployManifest::serializeRoundTrip()
+{
+    DeployManifest m;
+    m.insert(entry("app/bin/a.dll", 1024, 1700000000, "0123456789abcdef0123456789abcdef"));
+    m.insert(entry("app/with space.txt", 7, 1700000001, "fedcba9876543210fedcba9876543210"));
+
+    const DeployManifest back = DeployManifest::parse(m.serialize());
+    QCOMPARE(back.size(), size_t(2));
+    const ManifestEntry* e = back.find("app/with space.txt");
+    QVERIFY(e);
+    QCOMPARE(e->size, uint64_t(7));
+    QCOMPARE(e->mtime, int64_t(1700000001));
+    QCOMPARE(QString::fromStdString(e->hash), QStringLiteral("fedcba9876543210fedcba9876543210"));
+}
+
+void TestDeployManifest::parseRejectsUnknownHeader()
+{
+    QVERIFY(DeployManifest::parse("garbage\nx\t1\t2\tpath\n").empty());
+    QVERIFY(DeployManifest::parse("").empty());
+}
+
+void TestDeployManifest::planClassifiesFiles()
+{
+    DeployManifest remote;
+    remote.insert(entry("same.bin", 10, 100, "h-same"));
+    remote.insert(entry("touched.bin", 10, 100, "h-touched"));
+    remote.insert(entry("edited.bin", 10, 100, "h-old"));
+    remote.insert(entry("resized.bin", 10, 100, "h-resized"));
+    remote.insert(entry("gone.bin", 5, 100, "h-gone"));
+
+    std::vector<LocalFile> local{
+        localFile("same.bin", 10, 100),      // 大小+mtime 一致 → 不算哈希
+        localFile("touched.bin", 10, 200),   // mtime 变、内容未变
+        localFile("edited.bin", 10, 200),    // mtime 变、内容变
+        localFile("resized.bin", 11, 100),   // 大小变
+        localFile("new.bin", 3, 100),        // 新增
+    };
+
+    QStringList hashed;
+    auto hashOf = [&hashed](const LocalFile& f) -> std::string {
+        hashed << QString::fromStdString(f.relPath);
+        if (f.relPath == "touched.bin") return "h-touched";
+        return "h-new-" + f.relPath;
+    };
+
+    const DeployPlan plan = planDelta(local, remote, false, hashOf);
+    QCOMPARE(plan.added, size_t(1));
+    QCOMPARE(plan.changed, size_t(2));
+    QCOMPARE(plan.unchanged, size_t(2));
+    QCOMPARE(plan.toUpload.size(), size_t(3));
+    QCOMPARE(plan.uploadBytes, uint64_t(10 + 11 + 3));
+    QCOMPARE(plan.skippedBytes, uint64_t(20));
+    QVERIFY(plan.toDelete.empty());
+    QVERIFY(!hashed.contains(QStringLiteral("same.bin")));
+
+    // 未删除时设备上多出的文件保留在清单中；mtime 刷新为本地值
+    QVERIFY(plan.result.find("gone.bin"));
+    QCOMPARE(plan.result.find("touched.bin")->mtime, int64_t(200));
+    QCOMPARE(QString::fromStdString(plan.result.find("edited.bin")->hash),
+             QStringLiteral("h-new-edited.bin"));
+}
+
+void TestDeployManifest::planDeleteRemoved()
+{
+    DeployManifest remote;
+    remote.insert(entry("keep.bin", 1, 1, "h"));
+    remote.insert(entry("gone.bin", 1, 1, "h"));
+
+    const DeployPlan plan = planDelta({ localFile("keep.bin", 1, 1) }, remote, true,
+                                      [](const LocalFile&) { return std::string("h"); });
+    QCOMPARE(plan.toDelete.size(), size_t(1));
+    QCOMPARE(QString::fromStdString(plan.toDelete.front()), QStringLiteral("gone.bin"));
+    QVERIFY(!plan.result.find("gone.bin"));
+    QVERIFY(plan.toUpload.empty());
+}
+
+void TestDeployManifest::scanLocalLayout()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    QDir root(tmp.path());
+    QVERIFY(root.mkpath(QStringLiteral("proj/sub")));
+
+    auto write = [](const QString& path, const QByteArray& data) {
+        QFile f(path);
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write(data);
+    };
+    write(root.filePath(QStringLiteral("proj/a.txt")), "abc");
+    write(root.filePath(QStringLiteral("proj/sub/b.txt")), "hello");
+    write(root.filePath(QStringLiteral("single.cfg")), "x");
+
+    const auto files = DeployManifest::scanLocal({
+        root.filePath(QStringLiteral("proj")).toStdString(),
+        root.filePath(QStringLiteral("single.cfg")).toStdString() });
+
+    QStringList rels;
+    for (const auto& f : files) rels << QString::fromStdString(f.relPath);
+    rels.sort();
+    QCOMPARE(rels, QStringList({ QStringLiteral("proj/a.txt"), QStringLiteral("proj/sub/b.txt"),
+                                 QStringLiteral("single.cfg") }));
+
+    // "abc" 的 MD5
+    QCOMPARE(QString::fromStdString(
+                 DeployManifest::hashFile(root.filePath(QStringLiteral("proj/a.txt")).toStdString())),
+             QStringLiteral("900150983cd24fb0d6963f7d28e17f72"));
+}
+
+void TestDeployManifest::scanLocalReportsMissing()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    QDir root(tmp.path());
+    QFile f(root.filePath(QStringLiteral("present.cfg")));
+    QVERIFY(f.open(QIODevice::WriteOnly));
+    f.write("x");
+    f.close();
+
+    const std::string missingFile = root.filePath(QStringLiteral("gone.cfg")).toStdString();
+    const std::string missingDir = root.filePath(QStringLiteral("gone_dir")).toStdString();
+    std::vector<std::string> unreadable;
+    const auto files = DeployManifest::scanLocal({
+        root.filePath(QStringLiteral("present.cfg")).toStdString(), missingFile, missingDir },
+        &unreadable);
+
+    QCOMPARE(files.size(), size_t(1));
+    QCOMPARE(files[0].relPath, std::string("present.cfg"));
+    QCOMPARE(unreadable, std::vector<std::string>({ missingFile, missingDir }));
+}
+
+QTEST_MAIN(TestDeployManifest)
+#include "tst_deploy_manifest.moc"
@@ -0,0 +1,172 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include "tools/FtpDeployTool/DeployVerifier.h"
+
+class TestDeployVerifier : public QObject {
+    Q_OBJECT
+private slots:
+    void sizeAndHashMismatches();
+    void missingRemoteDigestFallsBackToSize();
+    void crc32MatchesXcrc();
+    void cancelStopsEarly();
+    void parseMd5sumOutput();
+    void md5sumCommandQuotes();
+};
+
+static LocalFile writeFile(const QTemporaryDir& dir, const QString& rel, const QByteArray& data)
+{
+    const QString path = dir.filePath(rel);
+    QFile f(path);
+    if (f.open(QIODevice::WriteOnly)) f.write(data);
+
+    LocalFile lf;
+    lf.localPath = path.toStdString();
+    lf.relPath = rel.toStdString();
+    lf.size = static_cast<uint64_t>(data.size());
+    return lf;
+}
+
+static std::string remoteOf(const LocalFile& f)
+{
+    return "/dst/" + f.relPath;
+}
+
+// 模拟设备：远端大小 / 摘要表，记录摘要批次
+struct FakeRemote {
+    std::map<std::string, uint64_t> sizes;
+    std::map<std::string, std::string> digests;
+    std::vector<size_t> batches;
+
+    RemoteProbe probe(const std::string& algorithm)
+    {
+        RemoteProbe p;
+        p.algorithm = algorithm;
+        p.size = [this](const std::string& path, uint64_t& size) {
+            auto it = sizes.find(path);
+            if (it == sizes.end()) return false;
+            size = it->second;
+            return true;
+        };
+        p.hash = [this](const std::vector<std::string>& paths, std::map<std::string, std::string>& out) {
+            batches.push_back(paths.size());
+            for (const auto& path : paths) {
+                auto it = digests.find(path);
+                if (it != digests.end()) out[path] = it->second;
+            }
+        };
+        return p;
+    }
+};
+
+void TestDeployVerifier::sizeAndHashMismatches()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const LocalFile good = writeFile(dir, "good.bin", "hello");
+    const LocalFile corrupt = writeFile(dir, "corrupt.bin", "world");
+    const LocalFile truncated = writeFile(dir, "truncated.bin", "0123456789");
+    const LocalFile missing = writeFile(dir, "missing.bin", "x");
+
+    FakeRemote remote;
+    remote.sizes = { { "/dst/good.bin", 5 }, { "/dst/corrupt.bin", 5 }, { "/dst/truncated.bin", 4 } };
+    remote.digests = { { "/dst/good.bin", DeployManifest::hashFile(good.localPath) },
+                       { "/dst/corrupt.bin", "00000000000000000000000000000000" } };
+
+    DeployVerifier verifier(nullptr);
+    const VerifyReport report = verifier.verify({ good, corrupt, truncated, missing }, remoteOf,
+                                                remote.probe("md5"));
+    QCOMPARE(report.checked, size_t(4));
+    QCOMPARE(report.hashed, size_t(2));     // 大小不一致/缺失的文件不再取摘要
+    QCOMPARE(report.algorithm, std::string("md5"));
+    QCOMPARE(report.mismatches.size(), size_t(3));
+    QCOMPARE(report.mismatches[0].file.relPath, std::string("truncated.bin"));
+    QCOMPARE(report.mismatches[1].file.relPath, std::string("missing.bin"));
+    QCOMPARE(report.mismatches[2].file.relPath, std::string("corrupt.bin"));
+    QCOMPARE(report.mismatches[2].remotePath, std::string("/dst/corrupt.bin"));
+    QCOMPARE(remote.batches, std::vector<size_t>{ 2 });
+}
+
+void TestDeployVerifier::missingRemoteDigestFallsBackToSize()
+{
+    QTemporaryDir dir;
+    const LocalFile f = writeFile(dir, "a.txt", "abc");
+
+    FakeRemote remote;
+    remote.sizes = { { "/dst/a.txt", 3 } };
+    DeployVerifier verifier([](const LocalFile&) { return std::string("ABC"); });
+    const VerifyReport report = verifier.verify({ f }, remoteOf, remote.probe("md5"));
+    QVERIFY(report.ok());
+    QCOMPARE(report.hashed, size_t(0));
+
+    // 大小写不敏感
+    remote.digests = { { "/dst/a.txt", "abc" } };
+    QVERIFY(verifier.verify({ f }, remoteOf, remote.probe("md5")).ok());
+}
+
+void TestDeployVerifier::crc32MatchesXcrc()
+{
+    QTemporaryDir dir;
+    const LocalFile f = writeFile(dir, "check.txt", "123456789");
+    QCOMPARE(DeployVerifier::fileCrc32(f.localPath), std::string("cbf43926"));
+
+    FakeRemote remote;
+    remote.sizes = { { "/dst/check.txt", 9 } };
+    remote.digests = { { "/dst/check.txt", "CBF43926" } };
+    DeployVerifier verifier(nullptr);
+    const VerifyReport report = verifier.verify({ f }, remoteOf, remote.probe("crc32"));
+    QVERIFY(report.ok());
+    QCOMPARE(report.hashed, size_t(1));
+
+    // 前导零缺省
+    const LocalFile z = writeFile(dir, "z.bin", QByteArray());
+    QCOMPARE(DeployVerifier::fileCrc32(z.localPath), std::string("00000000"));
+    remote.sizes["/dst/z.bin"] = 0;
+    remote.digests["/dst/z.bin"] = "0";
+    QVERIFY(verifier.verify({ z }, remoteOf, remote.probe("crc32")).ok());
+}
+
+void TestDeployVerifier::cancelStopsEarly()
+{
+    QTemporaryDir dir;
+    std::vector<LocalFile> files;
+    for (int i = 0; i < 10; ++i) files.push_back(writeFile(dir, QString("f%1").arg(i), "x"));
+
+    std::atomic<bool> cancelled{false};
+    RemoteProbe probe;
+    int calls = 0;
+    probe.size = [&](const std::string&, uint64_t& size) {
+        if (++calls == 3) cancelled = true;
+        size = 1;
+        return true;
+    };
+    DeployVerifier verifier(nullptr);
+    const VerifyReport report = verifier.verify(files, remoteOf, probe, &cancelled);
+    QCOMPARE(report.checked, size_t(3));
+    QVERIFY(report.ok());
+}
+
+void TestDeployVerifier::parseMd5sumOutput()
+{
+    const auto sums = DeployVerifier::parseMd5sum(
+        "root@dev:~# md5sum -- '/d/a b.txt' 2>/dev/null\r\n"
+        "D41D8CD98F00B204E9800998ECF8427E  /d/a b.txt\r\n"
+        "0123456789abcdef0123456789abcdef */d/bin\n"
+        "\\0123456789abcdef0123456789abcdef  /d/x\\\\y\\nz\n"
+        "root@dev:~# ");
+    QCOMPARE(sums.size(), size_t(3));
+    QCOMPARE(sums.at("/d/a b.txt"), std::string("d41d8cd98f00b204e9800998ecf8427e"));
+    QCOMPARE(sums.at("/d/bin"), std::string("0123456789abcdef0123456789abcdef"));
+    QVERIFY(sums.count("/d/x\\y\nz"));
+}
+
+void TestDeployVerifier::md5sumCommandQuotes()
+{
+    QCOMPARE(DeployVerifier::md5sumCommand({ "/d/a b", "/d/it's" }),
+             std::string("md5sum -- '/d/a b' '/d/it'\\''s' 2>/dev/null"));
+    QCOMPARE(DeployVerifier::shellQuote("/d/x;rm -rf /"), std::string("'/d/x;rm -rf /'"));
+    QCOMPARE(DeployVerifier::shellQuote(""), std::string("''"));
+}
+
+QTEST_MAIN(TestDeployVerifier)
+#include "tst_deploy_verifier.moc"
@@ -0,0 +1,199 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <chrono>
+#include <thread>
+#include "tools/FtpDeployTool/FileChunkCache.h"
+
+class TestFileChunkCache : public QObject {
+    Q_OBJECT
+private slots:
+    void sharedReadersReadDiskOnce();
+    void seekForResume();
+    void missingFileFails();
+    void evictsBeyondCapacity();
+    void lateReaderReusesChunk();
+    void releaseAfterEvictIgnored();
+    void readPendsUntilLoaded();
+};
+
+static QByteArray pattern(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i) data[i] = static_cast<char>(i * 31 + 7);
+    return data;
+}
+
+static QString writeFile(const QTemporaryDir& dir, const QByteArray& data)
+{
+    const QString path = dir.filePath(QStringLiteral("payload.bin"));
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) return QString();
+    f.write(data);
+    return path;
+}
+
+static QByteArray drain(ChunkStream& stream, size_t bufSize = 16384)
+{
+    QByteArray out;
+    std::vector<char> buf(bufSize);
+    for (;;) {
+        const size_t n = stream.read(buf.data(), buf.size());
+        if (n == ChunkStream::kPending) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        if (n == 0 || n == ChunkStream::kFailed) break;
+        out.append(buf.data(), static_cast<qsizetype>(n));
+    }
+    return out;
+}
+
+void TestFileChunkCache::sharedReadersReadDiskOnce()
+{
+    QTemporaryDir dir;
+    const QByteArray data = pattern(3 * 1024 * 1024 + 123);
+    const std::string path = writeFile(dir, data).toStdString();
+
+    const int readers = 4;
+    auto cache = std::make_shared<FileChunkCache>(readers);
+    std::vector<QByteArray> results(readers);
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            ChunkStream stream(cache, path, static_cast<uint64_t>(data.size()));
+            results[r] = drain(stream);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    for (const auto& r : results) QCOMPARE(r, data);
+    const auto st = cache->stats();
+    QCOMPARE(st.diskBytes, uint64_t(data.size()));
+    QCOMPARE(st.servedBytes, uint64_t(data.size()) * readers);
+    QCOMPARE(st.residentBytes, uint64_t(0));
+}
+
+void TestFileChunkCache::seekForResume()
+{
+    QTemporaryDir dir;
+    const QByteArray data = pattern(2 * 1024 * 1024 + 5);
+    const std::string path = writeFile(dir, data).toStdString();
+
+    auto cache = std::make_shared<FileChunkCache>(1);
+    ChunkStream stream(cache, path, static_cast<uint64_t>(data.size()));
+    QVERIFY(stream.seek(1024 * 1024 + 17));
+    QCOMPARE(drain(stream), data.mid(1024 * 1024 + 17));
+    QVERIFY(!stream.seek(static_cast<uint64_t>(data.size()) + 1));
+}
+
+void TestFileChunkCache::missingFileFails()
+{
+    auto cache = std::make_shared<FileChunkCache>(2);
+    ChunkStream stream(cache, "/nonexistent/payload.bin", 10);
+    char buf[4];
+    size_t n = ChunkStream::kPending;
+    for (int i = 0; i < 5000 && n == ChunkStream::kPending; ++i) {
+        n = stream.read(buf, sizeof(buf));
+        if (n == ChunkStream::kPending) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    QCOMPARE(n, ChunkStream::kFailed);
+    QVERIFY(stream.ready());
+}
+
+void TestFileChunkCache::evictsBeyondCapacity()
+{
+    QTemporaryDir dir;
+    const QByteArray data = pattern(64 * 1024);
+    const std::string path = writeFile(dir, data).toStdString();
+
+    // 两个读者只来了一个：未释放的块受容量上限约束
+    auto cache = std::make_shared<FileChunkCache>(2, 1024, 4096);
+    ChunkStream stream(cache, path, static_cast<uint64_t>(data.size()));
+    QCOMPARE(drain(stream, 8192), data);
+    QVERIFY(cache->stats().residentBytes <= 4096 + 1024);
+}
+
+void TestFileChunkCache::lateReaderReusesChunk()
+{
+    QTemporaryDir dir;
+    const QByteArray data = pattern(2 * 1024 * 1024 + 9);
+    const std::string path = writeFile(dir, data).toStdString();
+
+    // 预期三个读者、先只来两个（工作线程少于设备数）：块不回收，第三个读者不再读盘
+    auto cache = std::make_shared<FileChunkCache>(3);
+    for (int r = 0; r < 2; ++r) {
+        ChunkStream stream(cache, path, static_cast<uint64_t>(data.size()));
+        QCOMPARE(drain(stream), data);
+    }
+    QCOMPARE(cache->stats().residentBytes, uint64_t(data.size()));
+
+    ChunkStream last(cache, path, static_cast<uint64_t>(data.size()));
+    QCOMPARE(drain(last), data);
+    const auto st = cache->stats();
+    QCOMPARE(st.diskBytes, uint64_t(data.size()));
+    QCOMPARE(st.residentBytes, uint64_t(0));
+}
+
+void TestFileChunkCache::releaseAfterEvictIgnored()
+{
+    QTemporaryDir dir;
+    const QByteArray data = pattern(4096);
+    const std::string path = writeFile(dir, data).toStdString();
+
+    // 容量只容一个块：a 持有的块 0 被淘汰后重读，a 的 release 不得扣减新副本的引用
+    FileChunkCache cache(2, 1024, 1024);
+    const auto a = cache.acquire(path, 0);
+    const auto b = cache.acquire(path, 1);     // 淘汰块 0
+    const auto c = cache.acquire(path, 0);     // 重读块 0，淘汰块 1
+    QVERIFY(a && b && c && a != c);
+    QCOMPARE(cache.stats().diskBytes, uint64_t(3 * 1024));
+
+    cache.release(path, 0, a);
+    cache.release(path, 1, b);
+    const auto d = cache.acquire(path, 0);     // 命中重读的副本
+    QCOMPARE(d, c);
+    QCOMPARE(cache.stats().diskBytes, uint64_t(3 * 1024));
+
+    cache.release(path, 0, c);
+    QCOMPARE(cache.stats().residentBytes, uint64_t(1024));
+    cache.release(path, 0, d);
+    QCOMPARE(cache.stats().residentBytes, uint64_t(0));
+}
+
+void TestFileChunkCache::readPendsUntilLoaded()
+{
+    QTemporaryDir dir;
+    const QByteArray data = pattern(3 * 1024);
+    const std::string path = writeFile(dir, data).toStdString();
+
+    // 读取方不读盘：首次读取只排队加载并返回 kPending
+    auto cache = std::make_shared<FileChunkCache>(1, 1024);
+    ChunkStream stream(cache, path, static_cast<uint64_t>(data.size()));
+    char buf[1024];
+    QCOMPARE(stream.read(buf, sizeof(buf)), ChunkStream::kPending);
+
+    bool ready = false;
+    for (int i = 0; i < 5000 && !ready; ++i) {
+        ready = stream.ready();
+        if (!ready) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    QVERIFY(ready);
+    QCOMPARE(stream.read(buf, sizeof(buf)), sizeof(buf));
+    QCOMPARE(QByteArray(buf, sizeof(buf)), data.left(1024));
+
+    // 取得块 0 时已预取块 1
+    for (int i = 0; i < 5000 && cache->stats().diskBytes < 2048; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    QCOMPARE(cache->stats().diskBytes, uint64_t(2048));
+    QVERIFY(stream.ready());
+    QCOMPARE(stream.read(buf, sizeof(buf)), sizeof(buf));
+    QCOMPARE(QByteArray(buf, sizeof(buf)), data.mid(1024, 1024));
+
+    QCOMPARE(drain(stream), data.mid(2048));
+    QCOMPARE(cache->stats().diskBytes, uint64_t(data.size()));
+}
+
+QTEST_MAIN(TestFileChunkCache)
+#include "tst_file_chunk_cache.moc"
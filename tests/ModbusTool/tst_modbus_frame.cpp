@@ -0,0 +1,186 @@
+#include <QtTest>
+#include <cstring>
+#include "tools/ModbusTool/ModbusFrame.h"
+
+class TestModbusFrame : public QObject {
+    Q_OBJECT
+private slots:
+    void readRequestFrame();
+    void writeCoilEncoding();
+    void frameLengthStreaming();
+    void decodeRegisters();
+    void decodeBits();
+    void decodeException();
+    void decodeLengthMismatch();
+    void writeEcho();
+    void rtuCrc();
+    void rtuFrameRoundTrip();
+    void rtuResponseLength();
+    void rtuTiming();
+};
+
+void TestModbusFrame::readRequestFrame()
+{
+    uint8_t pdu[ModbusFrame::kRequestPduSize];
+    QCOMPARE(ModbusFrame::encodeReadPdu(pdu, ModbusTable::HoldingRegisters, 0x006B, 3), ModbusFrame::kRequestPduSize);
+
+    uint8_t frame[ModbusFrame::kMaxTcpFrameSize];
+    const size_t n = ModbusFrame::encodeTcpFrame(frame, 0x1234, 0x11, pdu, sizeof(pdu));
+    const uint8_t expected[] = {0x12, 0x34, 0x00, 0x00, 0x00, 0x06, 0x11, 0x03, 0x00, 0x6B, 0x00, 0x03};
+    QCOMPARE(n, sizeof(expected));
+    QVERIFY(std::memcmp(frame, expected, n) == 0);
+    QCOMPARE(ModbusFrame::tcpTransactionId(frame), uint16_t(0x1234));
+    QCOMPARE(ModbusFrame::tcpUnitId(frame), uint8_t(0x11));
+
+    ModbusFrame::encodeReadPdu(pdu, ModbusTable::Coils, 0, 1);
+    QCOMPARE(pdu[0], uint8_t(0x01));
+    ModbusFrame::encodeReadPdu(pdu, ModbusTable::DiscreteInputs, 0, 1);
+    QCOMPARE(pdu[0], uint8_t(0x02));
+    ModbusFrame::encodeReadPdu(pdu, ModbusTable::InputRegisters, 0, 1);
+    QCOMPARE(pdu[0], uint8_t(0x04));
+}
+
+void TestModbusFrame::writeCoilEncoding()
+{
+    uint8_t pdu[ModbusFrame::kRequestPduSize];
+    ModbusFrame::encodeWritePdu(pdu, ModbusTable::Coils, 0x00AC, 1);
+    const uint8_t on[] = {0x05, 0x00, 0xAC, 0xFF, 0x00};
+    QVERIFY(std::memcmp(pdu, on, sizeof(on)) == 0);
+
+    ModbusFrame::encodeWritePdu(pdu, ModbusTable::HoldingRegisters, 0x0001, 0x0003);
+    const uint8_t reg[] = {0x06, 0x00, 0x01, 0x00, 0x03};
+    QVERIFY(std::memcmp(pdu, reg, sizeof(reg)) == 0);
+
+    QCOMPARE(ModbusFrame::writeFunction(ModbusTable::InputRegisters), uint8_t(0));
+}
+
+void TestModbusFrame::frameLengthStreaming()
+{
+    const uint8_t frame[] = {0x00, 0x01, 0x00, 0x00, 0x00, 0x05, 0x01, 0x03, 0x02, 0x00, 0x2A};
+    QCOMPARE(ModbusFrame::tcpFrameLength(frame, 3), 0);
+    QCOMPARE(ModbusFrame::tcpFrameLength(frame, 7), 11);
+    QCOMPARE(ModbusFrame::tcpFrameLength(frame, sizeof(frame)), 11);
+
+    const uint8_t badProtocol[] = {0x00, 0x01, 0x00, 0x01, 0x00, 0x05, 0x01};
+    QCOMPARE(ModbusFrame::tcpFrameLength(badProtocol, sizeof(badProtocol)), -1);
+    const uint8_t badLength[] = {0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01};
+    QCOMPARE(ModbusFrame::tcpFrameLength(badLength, sizeof(badLength)), -1);
+}
+
+void TestModbusFrame::decodeRegisters()
+{
+    const uint8_t pdu[] = {0x03, 0x06, 0x02, 0x2B, 0x00, 0x00, 0x00, 0x64};
+    uint16_t values[3] = {};
+    std::string error;
+    QVERIFY(ModbusFrame::decodeReadResponse(pdu, sizeof(pdu), ModbusTable::HoldingRegisters, 3, values, error));
+    QCOMPARE(values[0], uint16_t(0x022B));
+    QCOMPARE(values[1], uint16_t(0));
+    QCOMPARE(values[2], uint16_t(0x64));
+}
+
+void TestModbusFrame::decodeBits()
+{
+    // 19 个线圈，低位在前：CD 6B 05
+    const uint8_t pdu[] = {0x01, 0x03, 0xCD, 0x6B, 0x05};
+    uint16_t values[19] = {};
+    std::string error;
+    QVERIFY(ModbusFrame::decodeReadResponse(pdu, sizeof(pdu), ModbusTable::Coils, 19, values, error));
+    const uint16_t expected[19] = {1,0,1,1,0,0,1,1, 1,1,0,1,0,1,1,0, 1,0,1};
+    for (int i = 0; i < 19; ++i) QCOMPARE(values[i], expected[i]);
+}
+
+void TestModbusFrame::decodeException()
+{
+    const uint8_t pdu[] = {0x83, 0x02};
+    uint16_t values[1] = {};
+    std::string error;
+    QVERIFY(!ModbusFrame::decodeReadResponse(pdu, sizeof(pdu), ModbusTable::HoldingRegisters, 1, values, error));
+    QCOMPARE(error, ModbusFrame::exceptionText(0x02));
+}
+
+void TestModbusFrame::decodeLengthMismatch()
+{
+    const uint8_t pdu[] = {0x04, 0x02, 0x00, 0x01};
+    uint16_t values[2] = {};
+    std::string error;
+    QVERIFY(!ModbusFrame::decodeReadResponse(pdu, sizeof(pdu), ModbusTable::InputRegisters, 2, values, error));
+    QVERIFY(!error.empty());
+
+    const uint8_t wrongFc[] = {0x03, 0x02, 0x00, 0x01};
+    QVERIFY(!ModbusFrame::decodeReadResponse(wrongFc, sizeof(wrongFc), ModbusTable::InputRegisters, 1, values, error));
+}
+
+void TestModbusFrame::writeEcho()
+{
+    uint8_t req[ModbusFrame::kRequestPduSize];
+    ModbusFrame::encodeWritePdu(req, ModbusTable::HoldingRegisters, 10, 77);
+    std::string error;
+    QVERIFY(ModbusFrame::decodeWriteResponse(req, sizeof(req), req, error));
+
+    uint8_t other[ModbusFrame::kRequestPduSize];
+    ModbusFrame::encodeWritePdu(other, ModbusTable::HoldingRegisters, 10, 78);
+    QVERIFY(!ModbusFrame::decodeWriteResponse(other, sizeof(other), req, error));
+
+    const uint8_t exc[] = {0x86, 0x04};
+    QVERIFY(!ModbusFrame::decodeWriteResponse(exc, sizeof(exc), req, error));
+    QCOMPARE(error, ModbusFrame::exceptionText(0x04));
+}
+
+void TestModbusFrame::rtuCrc()
+{
+    const uint8_t read[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0A};
+    QCOMPARE(ModbusFrame::crc16(read, sizeof(read)), uint16_t(0xCDC5));
+    const uint8_t spec[] = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03};
+    QCOMPARE(ModbusFrame::crc16(spec, sizeof(spec)), uint16_t(0x8776));
+    const char* check = "123456789";
+    QCOMPARE(ModbusFrame::crc16(reinterpret_cast<const uint8_t*>(check), 9), uint16_t(0x4B37));
+}
+
+void TestModbusFrame::rtuFrameRoundTrip()
+{
+    uint8_t pdu[ModbusFrame::kRequestPduSize];
+    ModbusFrame::encodeReadPdu(pdu, ModbusTable::HoldingRegisters, 0x006B, 3);
+    uint8_t frame[ModbusFrame::kMaxRtuFrameSize];
+    const size_t n = ModbusFrame::encodeRtuFrame(frame, 0x11, pdu, sizeof(pdu));
+    QCOMPARE(n, size_t(8));
+    const uint8_t expected[] = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+    QVERIFY(std::memcmp(frame, expected, sizeof(expected)) == 0);
+    QVERIFY(ModbusFrame::checkRtuCrc(frame, n));
+
+    frame[3] ^= 0x01;
+    QVERIFY(!ModbusFrame::checkRtuCrc(frame, n));
+    QVERIFY(!ModbusFrame::checkRtuCrc(frame, 3));
+}
+
+void TestModbusFrame::rtuResponseLength()
+{
+    const uint8_t read[] = {0x11, 0x03, 0x06};
+    QCOMPARE(ModbusFrame::rtuResponseLength(read, 1, 0x03), 0);
+    QCOMPARE(ModbusFrame::rtuResponseLength(read, 2, 0x03), 0);
+    QCOMPARE(ModbusFrame::rtuResponseLength(read, 3, 0x03), 11);
+
+    const uint8_t exc[] = {0x11, 0x83};
+    QCOMPARE(ModbusFrame::rtuResponseLength(exc, sizeof(exc), 0x03), 5);
+
+    const uint8_t write[] = {0x11, 0x06};
+    QCOMPARE(ModbusFrame::rtuResponseLength(write, sizeof(write), 0x06), 8);
+    QCOMPARE(ModbusFrame::rtuResponseLength(write, sizeof(write), 0x03), -1);
+}
+
+void TestModbusFrame::rtuTiming()
+{
+    const ModbusRtuTiming slow = ModbusFrame::rtuTiming(9600);
+    QCOMPARE(slow.charNs, int64_t(1145833));
+    QCOMPARE(slow.t15Ns, int64_t(1718750));
+    QCOMPARE(slow.t35Ns, int64_t(4010416));
+
+    const ModbusRtuTiming fast = ModbusFrame::rtuTiming(38400);
+    QCOMPARE(fast.t15Ns, ModbusFrame::kRtuFixedT15Ns);
+    QCOMPARE(fast.t35Ns, ModbusFrame::kRtuFixedT35Ns);
+    QCOMPARE(fast.charNs, int64_t(286458));
+
+    QCOMPARE(ModbusFrame::rtuTiming(0).t35Ns, int64_t(0));
+}
+
+QTEST_MAIN(TestModbusFrame)
+#include "tst_modbus_frame.moc"
@@ -0,0 +1,180 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include "tools/ModbusTool/ModbusReadPlanner.h"
+
+class TestModbusReadPlanner : public QObject {
+    Q_OBJECT
+private slots:
+    void splitsOversizedRange();
+    void mergesSmallGaps();
+    void keepsLargeGapsApart();
+    void gapZeroMergesOnlyTouching();
+    void separatesUnitsAndTables();
+    void bitTableLimit();
+    void clipsAddressSpace();
+    void scatterRandomized();
+};
+
+namespace {
+
+ModbusTag tag(uint16_t address, uint32_t count, ModbusTable table = ModbusTable::HoldingRegisters, uint8_t unit = 1)
+{
+    ModbusTag t;
+    t.unitId = unit;
+    t.table = table;
+    t.address = address;
+    t.count = count;
+    return t;
+}
+
+// 模拟从站：每个点的值 = 地址低 16 位
+std::vector<uint16_t> readAll(const ModbusReadPlan& plan)
+{
+    std::vector<uint16_t> out(plan.totalPoints(), 0xFFFF);
+    const auto offsets = plan.tagOffsets();
+    for (size_t b = 0; b < plan.blocks.size(); ++b) {
+        std::vector<uint16_t> values(plan.blocks[b].count);
+        for (size_t i = 0; i < values.size(); ++i) values[i] = static_cast<uint16_t>(plan.blocks[b].address + i);
+        plan.scatter(b, values.data(), out.data(), offsets);
+    }
+    return out;
+}
+
+} // namespace
+
+void TestModbusReadPlanner::splitsOversizedRange()
+{
+    const auto plan = ModbusReadPlanner::plan({tag(100, 300)});
+    QCOMPARE(plan.blocks.size(), size_t(3));
+    QCOMPARE(plan.blocks[0].address, uint16_t(100));
+    QCOMPARE(plan.blocks[0].count, uint16_t(125));
+    QCOMPARE(plan.blocks[1].address, uint16_t(225));
+    QCOMPARE(plan.blocks[2].count, uint16_t(50));
+    QCOMPARE(plan.stats.naiveRequests, 3u);
+    QCOMPARE(plan.stats.saved(), 0u);
+
+    const auto values = readAll(plan);
+    for (size_t i = 0; i < values.size(); ++i) QCOMPARE(values[i], uint16_t(100 + i));
+}
+
+void TestModbusReadPlanner::mergesSmallGaps()
+{
+    const auto plan = ModbusReadPlanner::plan({tag(0, 10), tag(20, 5), tag(40, 10)});
+    QCOMPARE(plan.blocks.size(), size_t(1));
+    QCOMPARE(plan.blocks[0].address, uint16_t(0));
+    QCOMPARE(plan.blocks[0].count, uint16_t(50));
+    QCOMPARE(plan.stats.requests, 1u);
+    QCOMPARE(plan.stats.saved(), 2u);
+    QCOMPARE(plan.stats.gapPoints, 25u);
+
+    const auto values = readAll(plan);
+    QCOMPARE(values[0], uint16_t(0));
+    QCOMPARE(values[10], uint16_t(20));
+    QCOMPARE(values[15], uint16_t(40));
+    QCOMPARE(values[24], uint16_t(49));
+}
+
+void TestModbusReadPlanner::keepsLargeGapsApart()
+{
+    ModbusReadPlanner::Options opt;
+    opt.maxGapRegisters = 8;
+    const auto plan = ModbusReadPlanner::plan({tag(0, 10), tag(18, 2), tag(100, 1)}, opt);
+    QCOMPARE(plan.blocks.size(), size_t(2));
+    QCOMPARE(plan.blocks[0].count, uint16_t(20));
+    QCOMPARE(plan.blocks[1].address, uint16_t(100));
+
+    // 合并后超过 125 的不合并
+    const auto full = ModbusReadPlanner::plan({tag(0, 120), tag(130, 10)});
+    QCOMPARE(full.blocks.size(), size_t(2));
+    QCOMPARE(full.stats.gapPoints, 0u);
+}
+
+void TestModbusReadPlanner::gapZeroMergesOnlyTouching()
+{
+    ModbusReadPlanner::Options opt;
+    opt.maxGapRegisters = 0;
+    const auto plan = ModbusReadPlanner::plan({tag(0, 10), tag(10, 10), tag(5, 3), tag(21, 1)}, opt);
+    QCOMPARE(plan.blocks.size(), size_t(2));
+    QCOMPARE(plan.blocks[0].count, uint16_t(20));
+    QCOMPARE(plan.stats.gapPoints, 0u);
+
+    const auto values = readAll(plan);
+    const auto offsets = plan.tagOffsets();
+    QCOMPARE(values[offsets[2]], uint16_t(5));
+    QCOMPARE(values[offsets[3]], uint16_t(21));
+}
+
+void TestModbusReadPlanner::separatesUnitsAndTables()
+{
+    const auto plan = ModbusReadPlanner::plan({
+        tag(0, 10, ModbusTable::HoldingRegisters, 1),
+        tag(0, 10, ModbusTable::InputRegisters, 1),
+        tag(10, 10, ModbusTable::HoldingRegisters, 2),
+        tag(10, 10, ModbusTable::HoldingRegisters, 1),
+    });
+    QCOMPARE(plan.blocks.size(), size_t(3));
+    for (const auto& b : plan.blocks) {
+        for (uint32_t i = 0; i < b.sliceCount; ++i) {
+            const ModbusTag& t = plan.tags[plan.slices[b.firstSlice + i].tag];
+            QCOMPARE(t.unitId, b.unitId);
+            QVERIFY(t.table == b.table);
+        }
+    }
+}
+
+void TestModbusReadPlanner::bitTableLimit()
+{
+    const auto plan = ModbusReadPlanner::plan({tag(0, 4500, ModbusTable::Coils)});
+    QCOMPARE(plan.blocks.size(), size_t(3));
+    QCOMPARE(plan.blocks[0].count, uint16_t(2000));
+    QCOMPARE(plan.blocks[2].count, uint16_t(500));
+
+    // 位表的合并阈值独立于寄存器
+    const auto merged = ModbusReadPlanner::plan({tag(0, 8, ModbusTable::DiscreteInputs), tag(200, 8, ModbusTable::DiscreteInputs)});
+    QCOMPARE(merged.blocks.size(), size_t(1));
+}
+
+void TestModbusReadPlanner::clipsAddressSpace()
+{
+    const auto plan = ModbusReadPlanner::plan({tag(65530, 100)});
+    QCOMPARE(plan.tags[0].count, 6u);
+    QCOMPARE(plan.stats.clippedTags, 1u);
+    QCOMPARE(plan.blocks.size(), size_t(1));
+    QCOMPARE(plan.blocks[0].count, uint16_t(6));
+    const auto values = readAll(plan);
+    QCOMPARE(values.back(), uint16_t(65535));
+}
+
+void TestModbusReadPlanner::scatterRandomized()
+{
+    QRandomGenerator rng(20261017);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<ModbusTag> tags;
+        const int n = 1 + static_cast<int>(rng.bounded(40));
+        for (int i = 0; i < n; ++i) {
+            const auto table = static_cast<ModbusTable>(rng.bounded(4));
+            tags.push_back(tag(static_cast<uint16_t>(rng.bounded(3000)), 1 + rng.bounded(300), table,
+                               static_cast<uint8_t>(1 + rng.bounded(2))));
+        }
+        ModbusReadPlanner::Options opt;
+        opt.maxGapRegisters = rng.bounded(64);
+        opt.maxGapBits = rng.bounded(512);
+        const auto plan = ModbusReadPlanner::plan(tags, opt);
+
+        QVERIFY(plan.stats.requests <= plan.stats.naiveRequests);
+        for (const auto& b : plan.blocks) {
+            QVERIFY(b.count > 0);
+            QVERIFY(b.count <= ModbusFrame::maxReadCount(b.table));
+        }
+        const auto values = readAll(plan);
+        const auto offsets = plan.tagOffsets();
+        for (size_t t = 0; t < tags.size(); ++t) {
+            for (uint32_t k = 0; k < tags[t].count; ++k) {
+                QCOMPARE(values[offsets[t] + k], uint16_t(tags[t].address + k));
+            }
+        }
+    }
+}
+
+QTEST_MAIN(TestModbusReadPlanner)
+#include "tst_modbus_read_planner.moc"
@@ -0,0 +1,490 @@
+#include <QtTest>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lwconn_base.h"
+#include "tools/ModbusTool/ModbusRtuBus.h"
+
+using namespace std::chrono_literals;
+
+class TestModbusRtuBus : public QObject {
+    Q_OBJECT
+private slots:
+    void t35Spacing();
+    void splitFrameReassembled();
+    void framingErrors();
+    void broadcastTurnaround();
+    void discardOnError();
+    void silentSlaveTimesOut();
+    void periodicTasks();
+    void removePurgesQueuedRequests();
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Bytes = std::vector<uint8_t>;
+
+// 应答的一段：send 返回后 after 时刻到达。9600 波特率下 8 字节请求帧本身约需 8.3ms，
+// 应答延迟都取在其后
+struct Chunk {
+    std::chrono::microseconds after;
+    Bytes bytes;
+};
+
+// 模拟串口线路。从站由 responder 按请求帧生成应答分段；测试线程在总线析构后仍可读取记录
+struct Line {
+    using Responder = std::function<std::vector<Chunk>(const Bytes& request)>;
+
+    struct Sent {
+        Clock::time_point at;
+        Bytes frame;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    Responder responder;
+    std::vector<Sent> sent;
+    std::vector<std::pair<Clock::time_point, Bytes>> arriving;   // 按到达时刻排序
+
+    std::vector<Sent> sentFrames() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sent;
+    }
+};
+
+class FakeSerial : public LWConnBase {
+public:
+    explicit FakeSerial(std::shared_ptr<Line> line)
+        : LWConnBase(LWConnType::SERIAL, "fake-serial"), m_line(std::move(line)) {}
+
+    LWConnError start() override { m_open = true; return LWConnError::SUCCESS; }
+    void stop() override { m_open = false; }
+    LWConnError disconnect() override { m_open = false; return LWConnError::SUCCESS; }
+    bool isConnected() const override { return m_open; }
+    int nativeHandle() const override { return -1; }
+
+    LWConnError send(const char* data, size_t length, int) override {
+        Bytes frame(data, data + length);
+        std::lock_guard<std::mutex> lock(m_line->mutex);
+        const auto now = Clock::now();
+        m_line->sent.push_back({ now, frame });
+        if (m_line->responder) {
+            for (Chunk& c : m_line->responder(frame)) m_line->arriving.emplace_back(now + c.after, std::move(c.bytes));
+            std::stable_sort(m_line->arriving.begin(), m_line->arriving.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
+        }
+        m_line->cv.notify_all();
+        return LWConnError::SUCCESS;
+    }
+
+    // 交出已到达的字节；没有时等到下一段到达或超时
+    LWConnError receive(char* buffer, size_t size, size_t& received, int timeoutMs) override {
+        received = 0;
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        std::unique_lock<std::mutex> lock(m_line->mutex);
+        for (;;) {
+            const auto now = Clock::now();
+            auto& q = m_line->arriving;
+            while (!q.empty() && q.front().first <= now && received < size) {
+                Bytes& bytes = q.front().second;
+                const size_t n = std::min(size - received, bytes.size());
+                std::copy_n(bytes.begin(), n, buffer + received);
+                received += n;
+                bytes.erase(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(n));
+                if (bytes.empty()) q.erase(q.begin());
+            }
+            if (received > 0) return LWConnError::SUCCESS;
+            if (now >= deadline) return LWConnError::TIMEOUT;
+            const auto wakeAt = q.empty() ? deadline : std::min(deadline, q.front().first);
+            m_line->cv.wait_until(lock, wakeAt);
+        }
+    }
+
+    void clearReceiveBuffer() override {
+        std::lock_guard<std::mutex> lock(m_line->mutex);
+        const auto now = Clock::now();
+        auto& q = m_line->arriving;
+        q.erase(q.begin(), std::find_if(q.begin(), q.end(), [now](const auto& c) { return c.first > now; }));
+    }
+
+private:
+    std::shared_ptr<Line> m_line;
+    std::atomic<bool> m_open{false};
+};
+
+Bytes rtuFrame(uint8_t unitId, const Bytes& pdu)
+{
+    Bytes frame(pdu.size() + ModbusFrame::kRtuOverhead);
+    ModbusFrame::encodeRtuFrame(frame.data(), unitId, pdu.data(), pdu.size());
+    return frame;
+}
+
+// 保持寄存器读请求的正确应答：寄存器 addr 的值为 addr 本身
+Bytes holdingReply(const Bytes& request)
+{
+    const uint16_t address = static_cast<uint16_t>(request[2] << 8 | request[3]);
+    const uint16_t count = static_cast<uint16_t>(request[4] << 8 | request[5]);
+    Bytes pdu{ request[1], static_cast<uint8_t>(count * 2) };
+    for (uint16_t i = 0; i < count; ++i) {
+        const uint16_t v = static_cast<uint16_t>(address + i);
+        pdu.push_back(static_cast<uint8_t>(v >> 8));
+        pdu.push_back(static_cast<uint8_t>(v & 0xFF));
+    }
+    return rtuFrame(request[0], pdu);
+}
+
+// 请求发完后 delay 整帧到达
+Line::Responder answerAfter(std::chrono::microseconds delay)
+{
+    return [delay](const Bytes& request) -> std::vector<Chunk> {
+        return { { delay, holdingReply(request) } };
+    };
+}
+
+struct Outcome {
+    bool ok = false;
+    std::string error;
+    std::vector<uint16_t> values;
+    int64_t latencyUs = 0;
+};
+
+// 收集完成回调的结果（回调在总线线程执行）
+class Collector {
+public:
+    ModbusRtuBus::Completion slot(size_t index) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_results.size() <= index) m_results.resize(index + 1);
+        }
+        return [this, index](const ModbusResult& r) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Outcome& o = m_results[index];
+            o.ok = r.ok;
+            o.error = r.error;
+            o.latencyUs = r.latencyUs;
+            if (r.ok) o.values.assign(r.values, r.values + r.count);
+            ++m_done;
+        };
+    }
+
+    bool waitFor(size_t count, std::chrono::milliseconds timeout = 5000ms) const {
+        const auto until = Clock::now() + timeout;
+        while (m_done < count) {
+            if (Clock::now() >= until) return false;
+            std::this_thread::sleep_for(2ms);
+        }
+        return true;
+    }
+
+    Outcome result(size_t index) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_results[index];
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Outcome> m_results;
+    std::atomic<size_t> m_done{0};
+};
+
+ModbusRequest readHolding(uint16_t address, uint16_t count, uint8_t unitId = 1)
+{
+    ModbusRequest r;
+    r.unitId = unitId;
+    r.table = ModbusTable::HoldingRegisters;
+    r.address = address;
+    r.count = count;
+    return r;
+}
+
+ModbusRtuBus::SerialConfig config9600()
+{
+    ModbusRtuBus::SerialConfig config;
+    config.port = "fake";
+    config.baudRate = 9600;
+    return config;
+}
+
+std::unique_ptr<ModbusRtuBus> makeBus(const std::shared_ptr<Line>& line)
+{
+    return std::make_unique<ModbusRtuBus>(config9600(), std::make_unique<FakeSerial>(line));
+}
+
+} // namespace
+
+void TestModbusRtuBus::t35Spacing()
+{
+    auto line = std::make_shared<Line>();
+    line->responder = answerAfter(12ms);
+    auto bus = makeBus(line);
+    const ModbusRtuTiming timing = bus->timing();
+    QVERIFY(timing.t35Ns > 3000000);   // 9600 8N1：3.5 个字符约 3.6ms
+
+    const size_t total = 4;
+    Collector c;
+    for (size_t i = 0; i < total; ++i) bus->submit(readHolding(static_cast<uint16_t>(i * 10), 3), c.slot(i));
+    QVERIFY(c.waitFor(total));
+
+    for (size_t i = 0; i < total; ++i) {
+        const Outcome o = c.result(i);
+        QVERIFY(o.ok);
+        const uint16_t a = static_cast<uint16_t>(i * 10);
+        QCOMPARE(o.values, (std::vector<uint16_t>{ a, static_cast<uint16_t>(a + 1), static_cast<uint16_t>(a + 2) }));
+    }
+    // 每个请求帧：8 字节、CRC 正确；上一个应答到达后至少静默 t3.5 才发下一帧
+    const auto sent = line->sentFrames();
+    QCOMPARE(sent.size(), total);
+    for (size_t i = 0; i < total; ++i) {
+        QCOMPARE(sent[i].frame.size(), size_t(8));
+        QVERIFY(ModbusFrame::checkRtuCrc(sent[i].frame.data(), sent[i].frame.size()));
+        if (i == 0) continue;
+        const auto replyAt = sent[i - 1].at + 12ms;
+        QVERIFY(sent[i].at - replyAt >= std::chrono::nanoseconds(timing.t35Ns));
+    }
+}
+
+void TestModbusRtuBus::splitFrameReassembled()
+{
+    // 应答分三段到达，段间隔小于字符间隔判定值：按功能码与字节数拼出整帧
+    auto line = std::make_shared<Line>();
+    line->responder = [](const Bytes& request) -> std::vector<Chunk> {
+        const Bytes frame = holdingReply(request);
+        return { { 10ms, Bytes(frame.begin(), frame.begin() + 2) },
+                 { 15ms, Bytes(frame.begin() + 2, frame.begin() + 6) },
+                 { 20ms, Bytes(frame.begin() + 6, frame.end()) } };
+    };
+    auto bus = makeBus(line);
+
+    Collector c;
+    bus->submit(readHolding(100, 4), c.slot(0));
+    QVERIFY(c.waitFor(1));
+    const Outcome o = c.result(0);
+    QVERIFY(o.ok);
+    QCOMPARE(o.values, (std::vector<uint16_t>{ 100, 101, 102, 103 }));
+    QVERIFY(o.latencyUs >= 10000);
+}
+
+void TestModbusRtuBus::framingErrors()
+{
+    enum class Fault { BadCrc, Truncated, WrongLength, WrongFunction, WrongUnit, Exception };
+    const std::vector<std::pair<Fault, std::string>> cases = {
+        { Fault::BadCrc, "RTU 应答 CRC 校验失败" },
+        { Fault::Truncated, "RTU 应答不完整（字符间隔超时）" },
+        { Fault::WrongLength, "响应长度不符 (4 字节，应为 2)" },
+        { Fault::WrongFunction, "RTU 应答与请求不匹配" },
+        { Fault::WrongUnit, "RTU 应答从站地址不符" },
+        { Fault::Exception, ModbusFrame::exceptionText(0x02) },
+    };
+    for (const auto& [fault, expected] : cases) {
+        auto line = std::make_shared<Line>();
+        line->responder = [fault = fault](const Bytes& request) -> std::vector<Chunk> {
+            Bytes frame = holdingReply(request);
+            switch (fault) {
+            case Fault::BadCrc: frame.back() ^= 0xFF; break;
+            case Fault::Truncated: frame.resize(frame.size() - 2); break;
+            case Fault::WrongLength: frame = rtuFrame(request[0], { 0x03, 0x04, 0x00, 0x05, 0x00, 0x06 }); break;
+            case Fault::WrongFunction: frame = rtuFrame(request[0], { 0x04, 0x02, 0x00, 0x01 }); break;
+            case Fault::WrongUnit: frame = rtuFrame(static_cast<uint8_t>(request[0] + 1), { 0x03, 0x02, 0x00, 0x01 }); break;
+            case Fault::Exception: frame = rtuFrame(request[0], { 0x83, 0x02 }); break;
+            }
+            return { { 10ms, frame } };
+        };
+        auto bus = makeBus(line);
+        Collector c;
+        bus->submit(readHolding(5, 1), c.slot(0));
+        QVERIFY(c.waitFor(1));
+        const Outcome o = c.result(0);
+        QVERIFY(!o.ok);
+        QCOMPARE(o.error, expected);
+        QCOMPARE(bus->stats().failed, uint64_t(1));
+    }
+}
+
+void TestModbusRtuBus::broadcastTurnaround()
+{
+    auto line = std::make_shared<Line>();
+    line->responder = [](const Bytes& request) -> std::vector<Chunk> {
+        if (request[0] == 0) return {};   // 广播不应答
+        return { { 10ms, holdingReply(request) } };
+    };
+    auto bus = makeBus(line);
+    bus->setTurnaroundMs(40);
+
+    ModbusRequest broadcastWrite;
+    broadcastWrite.unitId = 0;
+    broadcastWrite.write = true;
+    broadcastWrite.address = 7;
+    broadcastWrite.value = 0x1234;
+
+    Collector c;
+    bus->submit(readHolding(1, 1, 0), c.slot(0));   // 广播读：不发出即失败
+    bus->submit(broadcastWrite, c.slot(1));
+    bus->submit(readHolding(1, 1), c.slot(2));
+    QVERIFY(c.waitFor(3));
+
+    QVERIFY(!c.result(0).ok);
+    QCOMPARE(c.result(0).error, std::string("广播地址只能写入"));
+    const Outcome write = c.result(1);
+    QVERIFY(write.ok);
+    QVERIFY(write.latencyUs >= 40000);
+    QVERIFY(c.result(2).ok);
+
+    // 广播帧发完后等满 turnaround 才发下一帧
+    const auto sent = line->sentFrames();
+    QCOMPARE(sent.size(), size_t(2));
+    QCOMPARE(sent[0].frame[0], uint8_t(0));
+    const auto frameTime = std::chrono::nanoseconds(bus->timing().charNs * static_cast<int64_t>(sent[0].frame.size()));
+    QVERIFY(sent[1].at - sent[0].at >= frameTime + 40ms);
+}
+
+void TestModbusRtuBus::discardOnError()
+{
+    // 第一个应答 CRC 错误，其后从站还在陆续吐出残余字节；总线须等线路安静后再发下一帧，
+    // 且残余字节不能被当作下一个应答
+    auto line = std::make_shared<Line>();
+    std::atomic<int> requests{0};
+    line->responder = [&requests](const Bytes& request) -> std::vector<Chunk> {
+        if (requests++ > 0) return { { 10ms, holdingReply(request) } };
+        Bytes bad = holdingReply(request);
+        bad.back() ^= 0xFF;
+        return { { 10ms, bad },
+                 { 20ms, holdingReply(request) },
+                 { 32ms, Bytes{ 0x55, 0xAA, 0x55 } } };
+    };
+    auto bus = makeBus(line);
+
+    Collector c;
+    bus->submit(readHolding(40, 2), c.slot(0));
+    bus->submit(readHolding(50, 2), c.slot(1));
+    QVERIFY(c.waitFor(2));
+
+    QVERIFY(!c.result(0).ok);
+    QCOMPARE(c.result(0).error, std::string("RTU 应答 CRC 校验失败"));
+    const Outcome second = c.result(1);
+    QVERIFY(second.ok);
+    QCOMPARE(second.values, (std::vector<uint16_t>{ 50, 51 }));
+
+    const auto sent = line->sentFrames();
+    QCOMPARE(sent.size(), size_t(2));
+    const auto lastGarbage = sent[0].at + 32ms;
+    QVERIFY(sent[1].at - lastGarbage >= std::chrono::nanoseconds(bus->timing().t35Ns));
+}
+
+void TestModbusRtuBus::silentSlaveTimesOut()
+{
+    // 超时之后才到的应答不能被当作下一个请求的应答
+    auto line = std::make_shared<Line>();
+    std::atomic<int> requests{0};
+    line->responder = [&requests](const Bytes& request) -> std::vector<Chunk> {
+        if (requests++ == 0) return { { 90ms, holdingReply(request) } };
+        return { { 10ms, holdingReply(request) } };
+    };
+    auto bus = makeBus(line);
+    bus->setTimeoutMs(60);
+
+    Collector c;
+    bus->submit(readHolding(3, 1), c.slot(0));
+    QVERIFY(c.waitFor(1));
+    QVERIFY(!c.result(0).ok);
+    QCOMPARE(c.result(0).error, std::string("应答超时"));
+
+    std::this_thread::sleep_for(40ms);
+    bus->submit(readHolding(9, 1), c.slot(1));
+    QVERIFY(c.waitFor(2));
+    QVERIFY(c.result(1).ok);
+    QCOMPARE(c.result(1).values, std::vector<uint16_t>{ 9 });
+
+    const ModbusPollerStats stats = bus->stats();
+    QCOMPARE(stats.sent, uint64_t(2));
+    QCOMPARE(stats.timeouts, uint64_t(1));
+    QCOMPARE(stats.succeeded, uint64_t(1));
+    QCOMPARE(stats.failed, uint64_t(1));
+    bus->resetStats();
+    QCOMPARE(bus->stats().sent, uint64_t(0));
+}
+
+void TestModbusRtuBus::periodicTasks()
+{
+    auto line = std::make_shared<Line>();
+    line->responder = answerAfter(10ms);
+    auto bus = makeBus(line);
+
+    QCOMPARE(bus->addPeriodic(readHolding(0, 0), 0, nullptr), -1);
+
+    const int cls = bus->addScanClass(30ms);
+    QVERIFY(cls >= 0);
+    std::atomic<int> calls{0};
+    std::atomic<bool> allOk{true};
+    const int task = bus->addPeriodic(readHolding(20, 1), cls, [&](const ModbusResult& r) {
+        if (!r.ok || r.values[0] != 20) allOk = false;
+        ++calls;
+    });
+    QVERIFY(task >= 0);
+
+    const auto until = Clock::now() + 3s;
+    while (calls < 3 && Clock::now() < until) std::this_thread::sleep_for(5ms);
+    QVERIFY(calls >= 3);
+    QVERIFY(allOk);
+
+    // 移除后不再回调；回调对象释放后 ID 被下一个周期任务复用
+    bus->removePeriodic(task);
+    const int after = calls;
+    std::this_thread::sleep_for(100ms);
+    QCOMPARE(calls.load(), after);
+    QCOMPARE(bus->addPeriodic(readHolding(21, 1), cls, nullptr), task);
+
+    bus->clearPeriodic();
+    QVERIFY(bus->scanClassStats().empty());
+    QVERIFY(bus->stats().succeeded >= 3);
+}
+
+void TestModbusRtuBus::removePurgesQueuedRequests()
+{
+    // 总线被慢请求占住期间两个周期任务同时到期、一起排队；第一个在途时移除（或清空）
+    // 第二个，排队中的请求不得再发出
+    for (const bool clearAll : { false, true }) {
+        auto line = std::make_shared<Line>();
+        line->responder = [](const Bytes& request) -> std::vector<Chunk> {
+            const uint16_t address = static_cast<uint16_t>(request[2] << 8 | request[3]);
+            return { { address == 30 ? 100ms : (address == 99 ? 80ms : 10ms), holdingReply(request) } };
+        };
+        auto bus = makeBus(line);
+        auto sentTo = [&line](uint16_t address) {
+            const auto sent = line->sentFrames();
+            return std::any_of(sent.begin(), sent.end(), [address](const Line::Sent& s) {
+                return static_cast<uint16_t>(s.frame[2] << 8 | s.frame[3]) == address;
+            });
+        };
+
+        Collector c;
+        bus->submit(readHolding(99, 1), c.slot(0));
+        std::this_thread::sleep_for(20ms);
+        // 首轮在加入后一个周期（约 70ms）到期，此时慢请求（约 88ms 完成）仍占着总线
+        const int first = bus->addPeriodic(readHolding(30, 1), bus->addScanClass(50ms), nullptr);
+        const int second = bus->addPeriodic(readHolding(31, 1), bus->addScanClass(50ms), nullptr);
+        QVERIFY(first >= 0 && second >= 0);
+
+        const auto until = Clock::now() + 3s;
+        while (!sentTo(30) && Clock::now() < until) std::this_thread::sleep_for(2ms);
+        QVERIFY(sentTo(30));
+        if (clearAll) {
+            bus->clearPeriodic();
+        } else {
+            bus->removePeriodic(second);
+        }
+        std::this_thread::sleep_for(250ms);
+        QVERIFY(!sentTo(31));
+        QVERIFY(c.result(0).ok);
+    }
+}
+
+QTEST_MAIN(TestModbusRtuBus)
+#include "tst_modbus_rtu_bus.moc"
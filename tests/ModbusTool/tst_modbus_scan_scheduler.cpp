@@ -0,0 +1,221 @@
+#include <QtTest>
+#include "tools/ModbusTool/ModbusScanScheduler.h"
+
+using Clock = ModbusScanScheduler::Clock;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+class TestModbusScanScheduler : public QObject {
+    Q_OBJECT
+private slots:
+    void spreadsPhasesEvenly();
+    void busyItemCountsOverrun();
+    void lateSchedulingSkipsMissedRounds();
+    void removeRebalances();
+    void classesRunIndependently();
+    void clearResetsOverruns();
+    void churnDoesNotDuplicate();
+    void bulkAddSpreadsEvenly();
+    void rebalanceKeepsRecentlyFiredDue();
+};
+
+namespace {
+
+const Clock::time_point t0 = Clock::time_point() + std::chrono::hours(1);
+
+// 依次推进时间，记录每个条目的触发时刻（触发后立即完成）
+std::vector<std::vector<int64_t>> simulate(ModbusScanScheduler& s, int items, int64_t untilUs, int64_t stepUs)
+{
+    std::vector<std::vector<int64_t>> fired(static_cast<size_t>(items));
+    std::vector<ModbusScanScheduler::Fire> out;
+    for (int64_t t = 0; t <= untilUs; t += stepUs) {
+        s.collectDue(t0 + microseconds(t), out);
+        for (const auto& f : out) {
+            fired[static_cast<size_t>(f.item)].push_back(t);
+            s.complete(f.item);
+        }
+    }
+    return fired;
+}
+
+} // namespace
+
+void TestModbusScanScheduler::spreadsPhasesEvenly()
+{
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(100), t0);
+    for (int i = 0; i < 4; ++i) s.add(i, 0, t0);
+    QCOMPARE(s.nextDeadline(), t0);
+
+    const auto fired = simulate(s, 4, 299000, 1000);
+    for (int i = 0; i < 4; ++i) {
+        QCOMPARE(fired[static_cast<size_t>(i)].size(), size_t(3));
+        QCOMPARE(fired[static_cast<size_t>(i)][0], int64_t(i) * 25000);
+        QCOMPARE(fired[static_cast<size_t>(i)][1], int64_t(i) * 25000 + 100000);
+    }
+    const auto stats = s.stats();
+    QCOMPARE(stats[0].fired, uint64_t(12));
+    QCOMPARE(stats[0].overruns, uint64_t(0));
+    QCOMPARE(stats[0].maxLateUs, int64_t(0));
+}
+
+void TestModbusScanScheduler::busyItemCountsOverrun()
+{
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(10), t0);
+    s.add(0, 0, t0);
+    std::vector<ModbusScanScheduler::Fire> out;
+
+    QCOMPARE(s.collectDue(t0, out), size_t(1));
+    // 未 complete：下一轮到期时跳过并计超限
+    QCOMPARE(s.collectDue(t0 + milliseconds(10), out), size_t(0));
+    QCOMPARE(s.stats()[0].overruns, uint64_t(1));
+    QCOMPARE(s.totalOverruns(), uint64_t(1));
+
+    s.complete(0);
+    QCOMPARE(s.collectDue(t0 + milliseconds(15), out), size_t(0));
+    QCOMPARE(s.collectDue(t0 + milliseconds(20), out), size_t(1));
+    QCOMPARE(out[0].lateUs, int64_t(0));
+}
+
+void TestModbusScanScheduler::lateSchedulingSkipsMissedRounds()
+{
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(10), t0);
+    s.add(0, 0, t0);
+    std::vector<ModbusScanScheduler::Fire> out;
+    QCOMPARE(s.collectDue(t0, out), size_t(1));
+    s.complete(0);
+
+    // 55ms 才得到调度：10ms 那轮晚 45ms 触发一次，20..50 四轮错过
+    QCOMPARE(s.collectDue(t0 + milliseconds(55), out), size_t(1));
+    QCOMPARE(out[0].lateUs, int64_t(45000));
+    const auto st = s.stats()[0];
+    QCOMPARE(st.missed, uint64_t(4));
+    QCOMPARE(st.maxLateUs, int64_t(45000));
+    // 下一轮仍对齐到绝对时间
+    QCOMPARE(s.nextDeadline(), t0 + milliseconds(60));
+}
+
+void TestModbusScanScheduler::removeRebalances()
+{
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(90), t0);
+    for (int i = 0; i < 3; ++i) s.add(i, 0, t0);
+    s.remove(1, t0);
+    QCOMPARE(s.stats()[0].items, 2u);
+
+    const auto fired = simulate(s, 3, 179000, 1000);
+    QVERIFY(fired[1].empty());
+    QCOMPARE(fired[0].front(), int64_t(0));
+    QCOMPARE(fired[2].front(), int64_t(45000));
+}
+
+void TestModbusScanScheduler::classesRunIndependently()
+{
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(50), t0);
+    s.addClass(1, milliseconds(500), t0);
+    s.add(0, 0, t0);
+    s.add(1, 0, t0);
+    s.add(2, 1, t0);
+
+    const auto fired = simulate(s, 3, 999000, 1000);
+    QCOMPARE(fired[0].size(), size_t(20));
+    QCOMPARE(fired[1].size(), size_t(20));
+    QCOMPARE(fired[2].size(), size_t(2));
+    QCOMPARE(fired[1].front(), int64_t(25000));
+
+    s.clear();
+    QVERIFY(s.empty());
+}
+
+void TestModbusScanScheduler::clearResetsOverruns()
+{
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(10), t0);
+    s.add(0, 0, t0);
+    std::vector<ModbusScanScheduler::Fire> out;
+    s.collectDue(t0, out);
+    s.collectDue(t0 + milliseconds(10), out);
+    QCOMPARE(s.totalOverruns(), uint64_t(1));
+
+    // 调用方在 clear 后把已读取的累计值归零，这里必须同步归零，否则下次差值重复计入
+    s.clear();
+    QCOMPARE(s.totalOverruns(), uint64_t(0));
+    QVERIFY(s.empty());
+}
+
+void TestModbusScanScheduler::churnDoesNotDuplicate()
+{
+    // 反复移除 / 重新加入：堆中残留的旧截止时间不得造成重复触发
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(100), t0);
+    s.add(0, 0, t0);
+    s.add(1, 0, t0);
+    for (int i = 0; i < 1000; ++i) {
+        s.remove(1, t0);
+        s.add(1, 0, t0);
+    }
+    QCOMPARE(s.nextDeadline(), t0);
+
+    const auto fired = simulate(s, 2, 299000, 1000);
+    QCOMPARE(fired[0], (std::vector<int64_t>{ 0, 100000, 200000 }));
+    QCOMPARE(fired[1], (std::vector<int64_t>{ 50000, 150000, 250000 }));
+}
+
+void TestModbusScanScheduler::bulkAddSpreadsEvenly()
+{
+    const int n = 2000;
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(2000), t0);
+    for (int i = 0; i < n; ++i) s.add(i, 0, t0);
+    QCOMPARE(s.stats()[0].items, uint32_t(n));
+
+    const auto fired = simulate(s, n, 1999000, 1000);
+    for (int i = 0; i < n; ++i) {
+        QCOMPARE(fired[static_cast<size_t>(i)].size(), size_t(1));
+        QCOMPARE(fired[static_cast<size_t>(i)][0], int64_t(i) * 1000);
+    }
+}
+
+void TestModbusScanScheduler::rebalanceKeepsRecentlyFiredDue()
+{
+    ModbusScanScheduler s;
+    s.addClass(0, milliseconds(100), t0);
+    s.add(0, 0, t0);
+    s.add(1, 0, t0);
+
+    // 条目 0 于 0ms、条目 1 于 50ms 触发；条目 1 仍在执行
+    std::vector<ModbusScanScheduler::Fire> out;
+    std::vector<std::vector<int64_t>> fired(3);
+    for (int64_t t = 0; t <= 60000; t += 1000) {
+        s.collectDue(t0 + microseconds(t), out);
+        for (const auto& f : out) {
+            fired[static_cast<size_t>(f.item)].push_back(t);
+            if (f.item == 0) s.complete(f.item);
+        }
+    }
+    QCOMPARE(fired[1], (std::vector<int64_t>{ 50000 }));
+
+    // 60ms 加入条目 2：相位重排为 0 / 33.3 / 66.7ms，条目 1 的新位置（133.3ms）
+    // 早于上次触发后一个周期（150ms），保留原截止时间
+    s.add(2, 0, t0 + milliseconds(60));
+    s.complete(1);
+    for (int64_t t = 61000; t <= 260000; t += 1000) {
+        s.collectDue(t0 + microseconds(t), out);
+        for (const auto& f : out) {
+            fired[static_cast<size_t>(f.item)].push_back(t);
+            s.complete(f.item);
+        }
+    }
+    QCOMPARE(fired[0], (std::vector<int64_t>{ 0, 100000, 200000 }));
+    QCOMPARE(fired[1], (std::vector<int64_t>{ 50000, 150000, 250000 }));
+    QCOMPARE(fired[2], (std::vector<int64_t>{ 67000, 167000 }));
+    for (const auto& times : fired) {
+        for (size_t i = 1; i < times.size(); ++i) QVERIFY(times[i] - times[i - 1] >= 100000);
+    }
+}
+
+QTEST_MAIN(TestModbusScanScheduler)
+#include "tst_modbus_scan_scheduler.moc"
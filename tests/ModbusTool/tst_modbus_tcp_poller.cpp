@@ -0,0 +1,348 @@
+#include <QtTest>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tools/ModbusTool/ModbusTcpPoller.h"
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using NativeSocket = SOCKET;
+static const NativeSocket kInvalidSocket = INVALID_SOCKET;
+static void closeSocket(NativeSocket s) { ::closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using NativeSocket = int;
+static const NativeSocket kInvalidSocket = -1;
+static void closeSocket(NativeSocket s) { ::close(s); }
+#endif
+
+using namespace std::chrono_literals;
+
+class TestModbusTcpPoller : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void rejectsInvalidRequests();
+    void pipelinedTransactionIds();
+    void timeoutReconnects();
+    void taskIdsReused();
+};
+
+namespace {
+
+// 回环上的最小 Modbus TCP 从站：保持寄存器 addr 的值为 addr 本身
+class FakeSlave {
+public:
+    enum class Mode {
+        ReverseBatch,            // 收齐 batch 个请求后按相反顺序应答
+        SilentFirstConnection    // 第一条连接只收不答，之后的连接立即应答
+    };
+
+    FakeSlave(Mode mode, size_t batch = 1) : m_mode(mode), m_batch(batch) {
+        m_listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (m_listener == kInvalidSocket
+            || ::bind(m_listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::listen(m_listener, 4) != 0
+            || ::getsockname(m_listener, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            return;
+        }
+        m_port = ntohs(addr.sin_port);
+        m_thread = std::thread([this] { run(); });
+    }
+
+    ~FakeSlave() {
+        m_stop = true;
+        if (m_thread.joinable()) m_thread.join();
+        if (m_listener != kInvalidSocket) closeSocket(m_listener);
+    }
+
+    int port() const { return m_port; }
+    int connections() const { return m_connections; }
+    size_t maxOutstanding() const { return m_maxOutstanding; }
+
+private:
+    // 等待 s 可读，最多 20ms
+    static bool readable(NativeSocket s) {
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(s, &set);
+        timeval tv{ 0, 20000 };
+        return ::select(static_cast<int>(s) + 1, &set, nullptr, nullptr, &tv) > 0;
+    }
+
+    void run() {
+        while (!m_stop) {
+            if (!readable(m_listener)) continue;
+            const NativeSocket client = ::accept(m_listener, nullptr, nullptr);
+            if (client == kInvalidSocket) continue;
+            const int index = m_connections++;
+            serve(client, index);
+            closeSocket(client);
+        }
+    }
+
+    void serve(NativeSocket s, int index) {
+        const bool silent = m_mode == Mode::SilentFirstConnection && index == 0;
+        std::vector<uint8_t> rx;
+        std::vector<std::vector<uint8_t>> requests;
+        while (!m_stop) {
+            if (!readable(s)) continue;
+            uint8_t buf[512];
+            const auto n = ::recv(s, reinterpret_cast<char*>(buf), sizeof(buf), 0);
+            if (n <= 0) return;   // 对端关闭（轮询引擎重建连接）
+            if (silent) continue;
+            rx.insert(rx.end(), buf, buf + n);
+
+            for (;;) {
+                const int len = ModbusFrame::tcpFrameLength(rx.data(), rx.size());
+                if (len <= 0 || rx.size() < static_cast<size_t>(len)) break;
+                requests.emplace_back(rx.begin(), rx.begin() + len);
+                rx.erase(rx.begin(), rx.begin() + len);
+            }
+            m_maxOutstanding = std::max(m_maxOutstanding.load(), requests.size());
+            const size_t batch = m_mode == Mode::ReverseBatch ? m_batch : 1;
+            if (requests.size() < batch) continue;
+
+            std::reverse(requests.begin(), requests.end());
+            for (const auto& req : requests) reply(s, req);
+            requests.clear();
+        }
+    }
+
+    // 读保持寄存器应答：值等于寄存器地址
+    static void reply(NativeSocket s, const std::vector<uint8_t>& req) {
+        const uint8_t* pdu = req.data() + ModbusFrame::kMbapHeaderSize;
+        const uint16_t address = static_cast<uint16_t>(pdu[1] << 8 | pdu[2]);
+        const uint16_t count = static_cast<uint16_t>(pdu[3] << 8 | pdu[4]);
+        std::vector<uint8_t> resp{ pdu[0], static_cast<uint8_t>(count * 2) };
+        for (uint16_t i = 0; i < count; ++i) {
+            const uint16_t v = static_cast<uint16_t>(address + i);
+            resp.push_back(static_cast<uint8_t>(v >> 8));
+            resp.push_back(static_cast<uint8_t>(v & 0xFF));
+        }
+        uint8_t frame[ModbusFrame::kMaxTcpFrameSize];
+        const size_t size = ModbusFrame::encodeTcpFrame(frame, ModbusFrame::tcpTransactionId(req.data()),
+                                                        ModbusFrame::tcpUnitId(req.data()),
+                                                        resp.data(), resp.size());
+        ::send(s, reinterpret_cast<const char*>(frame), static_cast<int>(size), 0);
+    }
+
+    Mode m_mode;
+    size_t m_batch;
+    NativeSocket m_listener = kInvalidSocket;
+    int m_port = 0;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+    std::atomic<int> m_connections{0};
+    std::atomic<size_t> m_maxOutstanding{0};
+};
+
+struct Outcome {
+    bool ok = false;
+    std::string error;
+    std::vector<uint16_t> values;
+};
+
+// 收集完成回调的结果（回调在引擎线程执行）
+class Collector {
+public:
+    ModbusTcpPoller::Completion slot(size_t index) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_results.size() <= index) m_results.resize(index + 1);
+        }
+        return [this, index](const ModbusResult& r) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Outcome& o = m_results[index];
+            o.ok = r.ok;
+            o.error = r.error;
+            if (r.ok) o.values.assign(r.values, r.values + r.count);
+            ++m_done;
+        };
+    }
+
+    bool waitFor(size_t count, std::chrono::milliseconds timeout = 5000ms) const {
+        const auto until = std::chrono::steady_clock::now() + timeout;
+        while (m_done < count) {
+            if (std::chrono::steady_clock::now() >= until) return false;
+            std::this_thread::sleep_for(5ms);
+        }
+        return true;
+    }
+
+    Outcome result(size_t index) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_results[index];
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Outcome> m_results;
+    std::atomic<size_t> m_done{0};
+};
+
+ModbusRequest readHolding(uint16_t address, uint16_t count)
+{
+    ModbusRequest r;
+    r.table = ModbusTable::HoldingRegisters;
+    r.address = address;
+    r.count = count;
+    return r;
+}
+
+} // namespace
+
+void TestModbusTcpPoller::initTestCase()
+{
+#if defined(_WIN32)
+    WSADATA wsa;
+    QCOMPARE(WSAStartup(MAKEWORD(2, 2), &wsa), 0);
+#endif
+}
+
+void TestModbusTcpPoller::cleanupTestCase()
+{
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+void TestModbusTcpPoller::rejectsInvalidRequests()
+{
+    ModbusTcpPoller poller;
+    const int conn = poller.connection("127.0.0.1", 1);
+    QVERIFY(conn >= 0);
+
+    QVERIFY(!readHolding(0, 0).valid());
+    QVERIFY(!readHolding(0, ModbusFrame::kMaxReadRegisters + 1).valid());
+    QVERIFY(readHolding(0, ModbusFrame::kMaxReadRegisters).valid());
+    ModbusRequest coils;
+    coils.table = ModbusTable::Coils;
+    coils.count = ModbusFrame::kMaxReadBits;
+    QVERIFY(coils.valid());
+    ModbusRequest writeInput;
+    writeInput.table = ModbusTable::InputRegisters;
+    writeInput.write = true;
+    QVERIFY(!writeInput.valid());
+
+    Collector c;
+    poller.submit(conn, readHolding(0, 0), c.slot(0));
+    poller.submit(conn, readHolding(0, 200), c.slot(1));
+    poller.submit(conn, writeInput, c.slot(2));
+    QVERIFY(c.waitFor(3));
+    for (size_t i = 0; i < 3; ++i) {
+        QVERIFY(!c.result(i).ok);
+        QVERIFY(!c.result(i).error.empty());
+    }
+
+    const int cls = poller.addScanClass(std::chrono::milliseconds(100));
+    QCOMPARE(poller.addPeriodic(conn, readHolding(0, 0), cls, nullptr), -1);
+    QCOMPARE(poller.addPeriodic(conn, readHolding(0, 126), cls, nullptr), -1);
+    QCOMPARE(poller.stats().sent, uint64_t(0));
+}
+
+void TestModbusTcpPoller::pipelinedTransactionIds()
+{
+    const size_t depth = 4;
+    FakeSlave slave(FakeSlave::Mode::ReverseBatch, depth);
+    QVERIFY(slave.port() > 0);
+
+    ModbusTcpPoller poller;
+    poller.setPipelineDepth(static_cast<int>(depth));
+    const int conn = poller.connection("127.0.0.1", slave.port());
+    QVERIFY(conn >= 0);
+
+    // 从站攒满一批才应答且顺序颠倒：只有按事务 ID 匹配才能把值交给正确的请求
+    const size_t total = depth * 3;
+    Collector c;
+    for (size_t i = 0; i < total; ++i) {
+        poller.submit(conn, readHolding(static_cast<uint16_t>(i * 10), 2), c.slot(i));
+    }
+    QVERIFY(c.waitFor(total));
+
+    for (size_t i = 0; i < total; ++i) {
+        const Outcome o = c.result(i);
+        QVERIFY(o.ok);
+        QCOMPARE(o.values, (std::vector<uint16_t>{ static_cast<uint16_t>(i * 10),
+                                                   static_cast<uint16_t>(i * 10 + 1) }));
+    }
+    QCOMPARE(slave.maxOutstanding(), depth);
+    QCOMPARE(slave.connections(), 1);
+    const ModbusPollerStats stats = poller.stats();
+    QCOMPARE(stats.sent, uint64_t(total));
+    QCOMPARE(stats.succeeded, uint64_t(total));
+    QCOMPARE(stats.timeouts, uint64_t(0));
+}
+
+void TestModbusTcpPoller::timeoutReconnects()
+{
+    FakeSlave slave(FakeSlave::Mode::SilentFirstConnection);
+    QVERIFY(slave.port() > 0);
+
+    ModbusTcpPoller poller;
+    poller.setPipelineDepth(1);
+    poller.setTimeoutMs(100);
+    const int conn = poller.connection("127.0.0.1", slave.port());
+
+    // 连续 kMaxConsecutiveTimeouts 次超时后引擎关闭连接
+    const size_t timeouts = ModbusTcpPoller::kMaxConsecutiveTimeouts;
+    Collector c;
+    for (size_t i = 0; i < timeouts; ++i) poller.submit(conn, readHolding(1, 1), c.slot(i));
+    QVERIFY(c.waitFor(timeouts));
+    for (size_t i = 0; i < timeouts; ++i) {
+        QVERIFY(!c.result(i).ok);
+        QCOMPARE(c.result(i).error, std::string("应答超时"));
+    }
+    QCOMPARE(poller.stats().timeouts, uint64_t(timeouts));
+
+    // 重连等待期内的请求立即失败；等待期过后重建连接，新连接上的请求成功
+    const auto until = std::chrono::steady_clock::now()
+                     + std::chrono::milliseconds(ModbusTcpPoller::kReconnectDelayMs + 3000);
+    bool succeeded = false;
+    for (size_t i = timeouts; !succeeded && std::chrono::steady_clock::now() < until; ++i) {
+        poller.submit(conn, readHolding(7, 1), c.slot(i));
+        QVERIFY(c.waitFor(i + 1));
+        const Outcome o = c.result(i);
+        succeeded = o.ok;
+        if (succeeded) QCOMPARE(o.values, std::vector<uint16_t>{ 7 });
+        else std::this_thread::sleep_for(50ms);
+    }
+    QVERIFY(succeeded);
+    QCOMPARE(slave.connections(), 2);
+}
+
+void TestModbusTcpPoller::taskIdsReused()
+{
+    ModbusTcpPoller poller;
+    const int conn = poller.connection("127.0.0.1", 1);
+    int cls = poller.addScanClass(std::chrono::seconds(10));
+
+    // 反复启停扫描：移除的任务 ID 在回调对象释放后复用，任务表不随启停次数增长
+    for (int round = 0; round < 5; ++round) {
+        std::vector<int> ids;
+        for (int i = 0; i < 3; ++i) ids.push_back(poller.addPeriodic(conn, readHolding(0, 1), cls, nullptr));
+        std::sort(ids.begin(), ids.end());
+        QCOMPARE(ids, (std::vector<int>{ 0, 1, 2 }));
+
+        poller.clearPeriodic();
+        poller.scanClassStats();   // 等引擎线程跑完一轮，已移除任务的 ID 回到空闲表
+        cls = poller.addScanClass(std::chrono::seconds(10));
+    }
+}
+
+QTEST_MAIN(TestModbusTcpPoller)
+#include "tst_modbus_tcp_poller.moc"
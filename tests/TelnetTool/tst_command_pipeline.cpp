@@ -0,0 +1,108 @@
+#include <QtTest>
+#include "tools/TelnetTool/CommandPipeline.h"
+
+class TestCommandPipeline : public QObject {
+    Q_OBJECT
+private slots:
+    void buildScript();
+    void splitTelnetEcho();
+    void splitSshOutput();
+    void missingMarkerStopsSplit();
+    void lastCommandNeedsMarker();
+    void markerPrefixNotConfused();
+    void uniqueTags();
+};
+
+void TestCommandPipeline::buildScript()
+{
+    const PipelineScript s = CommandPipeline::build({ "uname -a", "ls", "pwd" }, "__T", "\r\n");
+    QCOMPARE(s.markers, (std::vector<std::string>{ "__T_1__", "__T_2__", "__T_3__" }));
+    QCOMPARE(s.text, std::string("uname -a\r\necho __T_1__\r\nls\r\necho __T_2__\r\npwd\r\necho __T_3__"));
+
+    const PipelineScript one = CommandPipeline::build({ "ls" }, "__T", "\n");
+    QCOMPARE(one.markers, (std::vector<std::string>{ "__T_1__" }));
+    QCOMPARE(one.text, std::string("ls\necho __T_1__"));
+}
+
+void TestCommandPipeline::splitTelnetEcho()
+{
+    // 终端回显命令与 "echo 标记"，标记输出单独成行
+    const PipelineScript s = CommandPipeline::build({ "a", "b", "c" }, "__T", "\r\n");
+    const std::string out =
+        "a\r\nout-a\r\n-> echo __T_1__\r\n__T_1__\r\n"
+        "-> b\r\nout-b1\r\nout-b2\r\n-> echo __T_2__\r\n__T_2__\r\n"
+        "-> c\r\nout-c\r\n-> echo __T_3__\r\n__T_3__\r\n";
+
+    const auto parts = CommandPipeline::split(out, s, 3);
+    QCOMPARE(parts.size(), size_t(3));
+    QCOMPARE(parts[0].output, std::string("a\r\nout-a\r\n"));
+    QVERIFY(parts[0].completed);
+    QCOMPARE(parts[1].output, std::string("-> b\r\nout-b1\r\nout-b2\r\n"));
+    QVERIFY(parts[1].completed);
+    QCOMPARE(parts[2].output, std::string("-> c\r\nout-c\r\n"));
+    QVERIFY(parts[2].completed);
+}
+
+void TestCommandPipeline::splitSshOutput()
+{
+    const PipelineScript s = CommandPipeline::build({ "a", "b" }, "__S", "\n");
+    const auto parts = CommandPipeline::split("x\ny\n__S_1__\nz\n__S_2__\n", s, 2);
+    QCOMPARE(parts[0].output, std::string("x\ny\n"));
+    QCOMPARE(parts[1].output, std::string("z\n"));
+    QVERIFY(parts[1].completed);
+
+    // 命令无输出
+    const auto empty = CommandPipeline::split("__S_1__\n__S_2__\n", s, 2);
+    QCOMPARE(empty[0].output, std::string());
+    QVERIFY(empty[0].completed);
+    QCOMPARE(empty[1].output, std::string());
+    QVERIFY(empty[1].completed);
+}
+
+void TestCommandPipeline::missingMarkerStopsSplit()
+{
+    const PipelineScript s = CommandPipeline::build({ "a", "b", "c" }, "__T", "\n");
+    const auto parts = CommandPipeline::split("out-a\n__T_1__\nout-b partial", s, 3);
+    QVERIFY(parts[0].completed);
+    QCOMPARE(parts[1].output, std::string("out-b partial"));
+    QVERIFY(!parts[1].completed);
+    QCOMPARE(parts[2].output, std::string());
+    QVERIFY(!parts[2].completed);
+}
+
+void TestCommandPipeline::lastCommandNeedsMarker()
+{
+    // 适配器超时 / 通道提前关闭：最后一条有输出但未见结束标记，不算完成
+    const PipelineScript s = CommandPipeline::build({ "a", "b" }, "__T", "\n");
+    const auto parts = CommandPipeline::split("out-a\n__T_1__\nout-b still running\n", s, 2);
+    QVERIFY(parts[0].completed);
+    QCOMPARE(parts[1].output, std::string("out-b still running\n"));
+    QVERIFY(!parts[1].completed);
+}
+
+void TestCommandPipeline::markerPrefixNotConfused()
+{
+    std::vector<std::string> cmds(11, "x");
+    const PipelineScript s = CommandPipeline::build(cmds, "__T", "\n");
+    std::string out;
+    for (size_t i = 0; i < s.markers.size(); ++i) {
+        out += "o" + std::to_string(i + 1) + "\n" + s.markers[i] + "\n";
+    }
+
+    const auto parts = CommandPipeline::split(out, s, cmds.size());
+    for (size_t i = 0; i < parts.size(); ++i) {
+        QCOMPARE(parts[i].output, "o" + std::to_string(i + 1) + "\n");
+        QVERIFY(parts[i].completed);
+    }
+    // 输出行内出现标记（非单独成行）不算命令结束
+    const auto inline_ = CommandPipeline::split("say __T_1__ here\n__T_1__\n", s, cmds.size());
+    QCOMPARE(inline_[0].output, std::string("say __T_1__ here\n"));
+}
+
+void TestCommandPipeline::uniqueTags()
+{
+    QVERIFY(CommandPipeline::nextTag() != CommandPipeline::nextTag());
+}
+
+QTEST_MAIN(TestCommandPipeline)
+#include "tst_command_pipeline.moc"
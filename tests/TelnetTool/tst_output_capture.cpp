@@ -0,0 +1,97 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "tools/TelnetTool/OutputCapture.h"
+
+class TestOutputCapture : public QObject {
+    Q_OBJECT
+private slots:
+    void underCapKeepsAll();
+    void ringKeepsTail();
+    void oversizedAppend();
+    void unlimited();
+    void truncationNotice();
+    void spillWritesFullOutput();
+};
+
+void TestOutputCapture::underCapKeepsAll()
+{
+    OutputCapture c(16);
+    c.append("abc");
+    c.append(std::string("def"));
+    QCOMPARE(c.tail(), std::string("abcdef"));
+    QCOMPARE(c.text(), std::string("abcdef"));
+    QCOMPARE(c.totalBytes(), quint64(6));
+    QVERIFY(!c.truncated());
+}
+
+void TestOutputCapture::ringKeepsTail()
+{
+    // 多次小块写入，绕过环形缓冲末尾若干圈
+    OutputCapture c(7);
+    std::string all;
+    for (int i = 0; i < 40; ++i) {
+        const std::string chunk(static_cast<size_t>(i % 5 + 1), static_cast<char>('a' + i % 26));
+        c.append(chunk);
+        all += chunk;
+        const std::string expected = all.size() > 7 ? all.substr(all.size() - 7) : all;
+        QCOMPARE(c.tail(), expected);
+    }
+    QCOMPARE(c.totalBytes(), quint64(all.size()));
+    QVERIFY(c.truncated());
+}
+
+void TestOutputCapture::oversizedAppend()
+{
+    OutputCapture c(4);
+    c.append("xy");
+    c.append("0123456789");
+    QCOMPARE(c.tail(), std::string("6789"));
+    c.append("ab");
+    QCOMPARE(c.tail(), std::string("89ab"));
+}
+
+void TestOutputCapture::unlimited()
+{
+    OutputCapture c(0);
+    c.append(std::string(100000, 'x'));
+    QCOMPARE(c.tail().size(), size_t(100000));
+    QVERIFY(!c.truncated());
+}
+
+void TestOutputCapture::truncationNotice()
+{
+    OutputCapture c(4);
+    c.append("hello world");
+    const std::string text = c.text();
+    QVERIFY(text.find("11") != std::string::npos);
+    QVERIFY(text.size() > 4);
+    QCOMPARE(text.substr(text.size() - 5), std::string("\norld"));
+    QVERIFY(c.spillPath().isEmpty());
+}
+
+void TestOutputCapture::spillWritesFullOutput()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("10.0.0.1.log");
+    {
+        OutputCapture c(4, path);
+        QCOMPARE(c.spillPath(), path);
+        c.append("hello ");
+        c.append("world");
+        QCOMPARE(c.tail(), std::string("orld"));
+        QVERIFY(c.text().find(path.toStdString()) != std::string::npos);
+    }
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    QCOMPARE(f.readAll(), QByteArray("hello world"));
+
+    // 目录不存在：不落盘，内存捕获照常
+    OutputCapture bad(4, dir.filePath("missing/x.log"));
+    QVERIFY(bad.spillPath().isEmpty());
+    bad.append("abcdef");
+    QCOMPARE(bad.tail(), std::string("cdef"));
+}
+
+QTEST_MAIN(TestOutputCapture)
+#include "tst_output_capture.moc"
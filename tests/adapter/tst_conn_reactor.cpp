@@ -0,0 +1,261 @@
+#include <QtTest>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "adapter/ConnReactor.h"
+#include "lwconn_base.h"
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using NativeSocket = SOCKET;
+static const NativeSocket kInvalidSocket = INVALID_SOCKET;
+static void closeSocket(NativeSocket s) { ::closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using NativeSocket = int;
+static const NativeSocket kInvalidSocket = -1;
+static void closeSocket(NativeSocket s) { ::close(s); }
+#endif
+
+using namespace std::chrono_literals;
+
+class TestConnReactor : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void deliversData();
+    void noCallbackAfterUnwatch();
+    void unwatchInsideCallback();
+    void closedOnPeerShutdown();
+};
+
+namespace {
+
+// 回环 TCP 连接对：first 交给反应器，second 作为对端写入
+bool loopbackPair(NativeSocket& a, NativeSocket& b)
+{
+    a = b = kInvalidSocket;
+    NativeSocket listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == kInvalidSocket) return false;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    bool ok = ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0
+           && ::listen(listener, 1) == 0
+           && ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) == 0;
+    if (ok) {
+        b = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        ok = b != kInvalidSocket
+          && ::connect(b, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    if (ok) {
+        a = ::accept(listener, nullptr, nullptr);
+        ok = a != kInvalidSocket;
+    }
+    closeSocket(listener);
+    return ok;
+}
+
+// 以原生套接字实现的最小连接，只提供反应器用到的 receive / isConnected / nativeHandle
+class SocketConn : public LWConnBase {
+public:
+    explicit SocketConn(NativeSocket s) : LWConnBase(LWConnType::TCP_CLIENT, "test"), m_socket(s) {}
+    ~SocketConn() override { closeSocket(m_socket); }
+
+    LWConnError start() override { return LWConnError::SUCCESS; }
+    void stop() override {}
+    LWConnError send(const char* data, size_t length, int) override {
+        return ::send(m_socket, data, static_cast<int>(length), 0) == static_cast<int>(length)
+            ? LWConnError::SUCCESS : LWConnError::SEND_FAILED;
+    }
+    LWConnError receive(char* buffer, size_t size, size_t& received, int) override {
+        received = 0;
+        const auto n = ::recv(m_socket, buffer, static_cast<int>(size), 0);
+        if (n == 0) {
+            m_connected = false;
+            return LWConnError::NOT_CONNECTED;
+        }
+        if (n < 0) return LWConnError::RECEIVE_FAILED;
+        received = static_cast<size_t>(n);
+        return LWConnError::SUCCESS;
+    }
+    LWConnError disconnect() override { return LWConnError::SUCCESS; }
+    bool isConnected() const override { return m_connected; }
+    void clearReceiveBuffer() override {}
+    int nativeHandle() const override { return static_cast<int>(m_socket); }
+
+private:
+    NativeSocket m_socket;
+    std::atomic<bool> m_connected{true};
+};
+
+struct Pair {
+    std::shared_ptr<SocketConn> conn;
+    NativeSocket peer = kInvalidSocket;
+
+    ~Pair() { if (peer != kInvalidSocket) closeSocket(peer); }
+    bool write(const char* text) const {
+        const int n = static_cast<int>(strlen(text));
+        return ::send(peer, text, n, 0) == n;
+    }
+};
+
+bool makePair(Pair& p)
+{
+    NativeSocket a, b;
+    if (!loopbackPair(a, b)) return false;
+    p.conn = std::make_shared<SocketConn>(a);
+    p.peer = b;
+    return true;
+}
+
+template <typename Pred>
+bool waitUntil(Pred pred, std::chrono::milliseconds timeout = 2000ms)
+{
+    const auto until = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= until) return false;
+        std::this_thread::sleep_for(5ms);
+    }
+    return true;
+}
+
+} // namespace
+
+void TestConnReactor::initTestCase()
+{
+#if defined(_WIN32)
+    WSADATA wsa;
+    QCOMPARE(WSAStartup(MAKEWORD(2, 2), &wsa), 0);
+#endif
+}
+
+void TestConnReactor::cleanupTestCase()
+{
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+void TestConnReactor::deliversData()
+{
+    Pair p;
+    QVERIFY(makePair(p));
+
+    std::mutex mutex;
+    std::string received;
+    const uint64_t token = ConnReactor::instance().watch(p.conn,
+        [&](const char* data, size_t length) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.append(data, length);
+        });
+    QVERIFY(token != 0);
+
+    QVERIFY(p.write("hello "));
+    QVERIFY(p.write("reactor"));
+    QVERIFY(waitUntil([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return received == "hello reactor";
+    }));
+    ConnReactor::instance().unwatch(token);
+}
+
+void TestConnReactor::noCallbackAfterUnwatch()
+{
+    Pair p;
+    QVERIFY(makePair(p));
+
+    // 回调故意较慢，使 unwatch 大概率发生在回调执行期间
+    std::atomic<int> calls{0};
+    std::atomic<bool> inside{false};
+    const uint64_t token = ConnReactor::instance().watch(p.conn,
+        [&](const char*, size_t) {
+            inside = true;
+            ++calls;
+            std::this_thread::sleep_for(20ms);
+            inside = false;
+        });
+    QVERIFY(token != 0);
+
+    std::atomic<bool> writing{true};
+    std::thread writer([&] {
+        while (writing) {
+            p.write("x");
+            std::this_thread::sleep_for(2ms);
+        }
+    });
+    QVERIFY(waitUntil([&] { return calls > 0; }));
+
+    ConnReactor::instance().unwatch(token);
+    QVERIFY(!inside);
+    const int afterUnwatch = calls;
+
+    std::this_thread::sleep_for(150ms);
+    writing = false;
+    writer.join();
+    QCOMPARE(calls.load(), afterUnwatch);
+}
+
+void TestConnReactor::unwatchInsideCallback()
+{
+    Pair p;
+    QVERIFY(makePair(p));
+
+    const size_t before = ConnReactor::instance().watchedCount();
+    std::atomic<uint64_t> token{0};
+    std::atomic<int> calls{0};
+    std::atomic<bool> returned{false};
+    token = ConnReactor::instance().watch(p.conn,
+        [&](const char*, size_t) {
+            ++calls;
+            ConnReactor::instance().unwatch(token);   // 不得自锁
+            returned = true;
+        });
+    QVERIFY(token != 0);
+
+    QVERIFY(p.write("first"));
+    QVERIFY(waitUntil([&] { return returned.load(); }));
+
+    QVERIFY(p.write("second"));
+    QVERIFY(p.write("third"));
+    std::this_thread::sleep_for(150ms);
+    QCOMPARE(calls.load(), 1);
+    QVERIFY(waitUntil([&] { return ConnReactor::instance().watchedCount() == before; }));
+}
+
+void TestConnReactor::closedOnPeerShutdown()
+{
+    Pair p;
+    QVERIFY(makePair(p));
+
+    std::atomic<int> closed{0};
+    std::atomic<int> dataAfterClose{0};
+    const uint64_t token = ConnReactor::instance().watch(p.conn,
+        [&](const char*, size_t) { if (closed) ++dataAfterClose; },
+        [&] { ++closed; });
+    QVERIFY(token != 0);
+
+    closeSocket(p.peer);
+    p.peer = kInvalidSocket;
+    QVERIFY(waitUntil([&] { return closed.load() == 1; }));
+
+    // 断开后已自动注销：再次 unwatch 无副作用，也不再回调
+    ConnReactor::instance().unwatch(token);
+    std::this_thread::sleep_for(50ms);
+    QCOMPARE(closed.load(), 1);
+    QCOMPARE(dataAfterClose.load(), 0);
+}
+
+QTEST_MAIN(TestConnReactor)
+#include "tst_conn_reactor.moc"
@@ -0,0 +1,177 @@
+#include <QtTest>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "adapter/SftpPipeline.h"
+
+class TestSftpPipeline : public QObject {
+    Q_OBJECT
+private slots:
+    void writeAllAcked();
+    void partialAckKeepsUnackedFront();
+    void refillsFreedSpace();
+    void readFailure();
+    void writeFailure();
+    void emptySource();
+    void jsonEscaping();
+    void jsonArray();
+};
+
+namespace {
+
+// 按给定块大小依次交出 source 的本地读取
+struct Source {
+    std::string data;
+    size_t pos = 0;
+    size_t chunk = SIZE_MAX;
+
+    size_t operator()(char* buf, size_t size) {
+        const size_t n = std::min({ size, chunk, data.size() - pos });
+        std::copy_n(data.data() + pos, n, buf);
+        pos += n;
+        return n;
+    }
+};
+
+// 模拟 libssh2_sftp_write：每次按 acks 中的顺序确认字节，记录每次交入的数据
+struct Sink {
+    std::vector<int64_t> acks;
+    size_t next = 0;
+    std::vector<std::string> offered;
+    std::string committed;
+
+    int64_t operator()(const char* data, size_t length) {
+        offered.emplace_back(data, length);
+        int64_t ack = next < acks.size() ? acks[next++] : static_cast<int64_t>(length);
+        if (ack > 0) {
+            ack = std::min<int64_t>(ack, static_cast<int64_t>(length));
+            committed.append(data, static_cast<size_t>(ack));
+        }
+        return ack;
+    }
+};
+
+std::string pattern(size_t n)
+{
+    std::string s(n, '\0');
+    for (size_t i = 0; i < n; ++i) s[i] = static_cast<char>('a' + i % 26);
+    return s;
+}
+
+} // namespace
+
+void TestSftpPipeline::writeAllAcked()
+{
+    Source src{ pattern(100) };
+    Sink sink;
+    std::vector<char> buf(32);
+    std::vector<uint64_t> progress;
+    int64_t err = 0;
+
+    const auto r = SftpPipeline::writeStream(buf, std::ref(src), std::ref(sink),
+                                             [&](uint64_t acked) { progress.push_back(acked); }, err);
+    QCOMPARE(r, SftpPipeline::WriteResult::Done);
+    QCOMPARE(sink.committed, src.data);
+    QCOMPARE(progress, (std::vector<uint64_t>{ 32, 64, 96, 100 }));
+}
+
+void TestSftpPipeline::partialAckKeepsUnackedFront()
+{
+    // 第一次只确认 10 字节、第二次 0 字节：未确认部分必须原样位于下一次交出数据的前端
+    Source src{ pattern(40) };
+    Sink sink;
+    sink.acks = { 10, 0 };
+    std::vector<char> buf(16);
+    int64_t err = 0;
+
+    const auto r = SftpPipeline::writeStream(buf, std::ref(src), std::ref(sink), nullptr, err);
+    QCOMPARE(r, SftpPipeline::WriteResult::Done);
+    QCOMPARE(sink.committed, src.data);
+
+    QVERIFY(sink.offered.size() >= 3);
+    QCOMPARE(sink.offered[0], src.data.substr(0, 16));
+    QCOMPARE(sink.offered[1], src.data.substr(10, 16));      // 剩余 6 字节 + 补满的 10 字节
+    QCOMPARE(sink.offered[2], sink.offered[1]);              // 未确认时原样重交
+}
+
+void TestSftpPipeline::refillsFreedSpace()
+{
+    // 本地读取每次只给 5 字节：每次写入前都先补满缓冲的空位
+    Source src{ pattern(30) };
+    src.chunk = 5;
+    Sink sink;
+    sink.acks = { 3, 3, 3 };
+    std::vector<char> buf(8);
+    int64_t err = 0;
+
+    const auto r = SftpPipeline::writeStream(buf, std::ref(src), std::ref(sink), nullptr, err);
+    QCOMPARE(r, SftpPipeline::WriteResult::Done);
+    QCOMPARE(sink.committed, src.data);
+    QCOMPARE(sink.offered[0], src.data.substr(0, 5));
+    QCOMPARE(sink.offered[1], src.data.substr(3, 7));        // 剩 2 字节 + 新读 5 字节
+    QCOMPARE(sink.offered[2], src.data.substr(6, 8));        // 剩 4 字节 + 补满 4 字节
+    for (const std::string& chunk : sink.offered) QVERIFY(chunk.size() <= buf.size());
+}
+
+void TestSftpPipeline::readFailure()
+{
+    int calls = 0;
+    auto read = [&](char*, size_t) -> size_t { return ++calls == 1 ? 4 : SIZE_MAX; };
+    Sink sink;
+    sink.acks = { 2 };
+    std::vector<char> buf(8);
+    int64_t err = 0;
+
+    const auto r = SftpPipeline::writeStream(buf, read, std::ref(sink), nullptr, err);
+    QCOMPARE(r, SftpPipeline::WriteResult::ReadFailed);
+    QCOMPARE(sink.committed.size(), size_t(2));
+}
+
+void TestSftpPipeline::writeFailure()
+{
+    Source src{ pattern(20) };
+    Sink sink;
+    sink.acks = { 8, -31 };
+    std::vector<char> buf(8);
+    std::vector<uint64_t> progress;
+    int64_t err = 0;
+
+    const auto r = SftpPipeline::writeStream(buf, std::ref(src), std::ref(sink),
+                                             [&](uint64_t acked) { progress.push_back(acked); }, err);
+    QCOMPARE(r, SftpPipeline::WriteResult::WriteFailed);
+    QCOMPARE(err, int64_t(-31));
+    QCOMPARE(progress, (std::vector<uint64_t>{ 8 }));
+}
+
+void TestSftpPipeline::emptySource()
+{
+    Source src;
+    Sink sink;
+    std::vector<char> buf(8);
+    int64_t err = 0;
+
+    QCOMPARE(SftpPipeline::writeStream(buf, std::ref(src), std::ref(sink), nullptr, err),
+             SftpPipeline::WriteResult::Done);
+    QVERIFY(sink.offered.empty());
+}
+
+void TestSftpPipeline::jsonEscaping()
+{
+    QCOMPARE(SftpPipeline::jsonEscape("plain.txt"), std::string("plain.txt"));
+    QCOMPARE(SftpPipeline::jsonEscape("a\"b\\c"), std::string("a\\\"b\\\\c"));
+    QCOMPARE(SftpPipeline::jsonEscape("line\nbreak\ttab\r"), std::string("line\\nbreak\\ttab\\r"));
+    QCOMPARE(SftpPipeline::jsonEscape(std::string("x\x01y\x1f", 4)), std::string("x\\u0001y\\u001f"));
+    // UTF-8 文件名原样保留
+    QCOMPARE(SftpPipeline::jsonEscape("\xe6\x97\xa5\xe5\xbf\x97.log"), std::string("\xe6\x97\xa5\xe5\xbf\x97.log"));
+}
+
+void TestSftpPipeline::jsonArray()
+{
+    QCOMPARE(SftpPipeline::jsonStringArray({}), std::string("[]"));
+    QCOMPARE(SftpPipeline::jsonStringArray({ "a" }), std::string("[\"a\"]"));
+    QCOMPARE(SftpPipeline::jsonStringArray({ "a b", "q\"uote", "back\\slash" }),
+             std::string("[\"a b\",\"q\\\"uote\",\"back\\\\slash\"]"));
+}
+
+QTEST_MAIN(TestSftpPipeline)
+#include "tst_sftp_pipeline.moc"
@@ -0,0 +1,72 @@
+#include <QtTest>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "adapter/SshHostKeyStore.h"
+
+class TestSshHostKeyStore : public QObject {
+    Q_OBJECT
+private slots:
+    void firstKeyPerHostAccepted();
+    void mismatchOnlyForSameHost();
+    void portIsPartOfHost();
+    void concurrentFirstConnects();
+};
+
+using Result = SshHostKeyStore::Result;
+
+void TestSshHostKeyStore::firstKeyPerHostAccepted()
+{
+    // 两台设备各有自己的密钥：第二台不得因与第一台不同而被拒绝
+    SshHostKeyStore store;
+    QCOMPARE(store.verify("192.168.1.10", 22, "aa"), Result::Accepted);
+    QCOMPARE(store.verify("192.168.1.11", 22, "bb"), Result::Accepted);
+    QCOMPARE(store.verify("192.168.1.10", 22, "aa"), Result::Known);
+    QCOMPARE(store.verify("192.168.1.11", 22, "bb"), Result::Known);
+}
+
+void TestSshHostKeyStore::mismatchOnlyForSameHost()
+{
+    SshHostKeyStore store;
+    QCOMPARE(store.verify("192.168.1.10", 22, "aa"), Result::Accepted);
+    QCOMPARE(store.verify("192.168.1.11", 22, "bb"), Result::Accepted);
+
+    QCOMPARE(store.verify("192.168.1.10", 22, "bb"), Result::Mismatch);
+    // 被拒绝的指纹不覆盖记录
+    QCOMPARE(store.verify("192.168.1.10", 22, "aa"), Result::Known);
+    QCOMPARE(store.verify("192.168.1.11", 22, "bb"), Result::Known);
+}
+
+void TestSshHostKeyStore::portIsPartOfHost()
+{
+    // 同一地址不同端口（如端口转发到不同设备）分别记录
+    SshHostKeyStore store;
+    QCOMPARE(store.verify("10.0.0.1", 22, "aa"), Result::Accepted);
+    QCOMPARE(store.verify("10.0.0.1", 2222, "bb"), Result::Accepted);
+    QCOMPARE(store.verify("10.0.0.1", 2222, "aa"), Result::Mismatch);
+}
+
+void TestSshHostKeyStore::concurrentFirstConnects()
+{
+    // 同一主机并发首次连接、各自看到不同密钥：只有一个被接受，其余全部拒绝
+    SshHostKeyStore store;
+    const int threads = 8;
+    std::atomic<int> accepted{0}, known{0}, mismatched{0};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            switch (store.verify("10.0.0.5", 22, "key" + std::to_string(t))) {
+            case Result::Accepted: ++accepted; break;
+            case Result::Known: ++known; break;
+            case Result::Mismatch: ++mismatched; break;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    QCOMPARE(accepted.load(), 1);
+    QCOMPARE(known.load(), 0);
+    QCOMPARE(mismatched.load(), threads - 1);
+}
+
+QTEST_MAIN(TestSshHostKeyStore)
+#include "tst_ssh_host_key_store.moc"
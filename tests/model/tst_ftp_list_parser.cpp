@@ -0,0 +1,124 @@
+#include <QtTest>
+#include "model/FtpListParser.h"
+
+class TestFtpListParser : public QObject {
+    Q_OBJECT
+private slots:
+    void unixListing();
+    void unixYearInference();
+    void symlinkAndMissingGroup();
+    void dosListing();
+    void mlsdListing();
+    void skipsNoise();
+    void largeListing();
+};
+
+void TestFtpListParser::unixListing()
+{
+    FtpListParser parser(FtpListParser::Format::List, QDate(2026, 10, 17));
+    const QList<FtpFileInfo> list = parser.parse(
+        "total 8\r\n"
+        "drwxr-xr-x    2 user     group        4096 Jan 01 12:00 my  dir\r\n"
+        "-rw-r--r--    1 user     group          34 Dec 25  2024 f.txt\r\n",
+        QStringLiteral("/data"));
+
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list[0].name, QStringLiteral("my  dir"));
+    QVERIFY(list[0].isDirectory);
+    QCOMPARE(list[0].size, qint64(4096));
+    QCOMPARE(list[0].permissions, QStringLiteral("drwxr-xr-x"));
+    QCOMPARE(list[0].remotePath, QStringLiteral("/data"));
+    QCOMPARE(list[0].lastModified, QDateTime(QDate(2026, 1, 1), QTime(12, 0)));
+
+    QCOMPARE(list[1].name, QStringLiteral("f.txt"));
+    QVERIFY(!list[1].isDirectory);
+    QCOMPARE(list[1].size, qint64(34));
+    QCOMPARE(list[1].lastModified, QDateTime(QDate(2024, 12, 25), QTime(0, 0)));
+}
+
+void TestFtpListParser::unixYearInference()
+{
+    // 不带年份且晚于今天的日期属于去年
+    FtpListParser parser(FtpListParser::Format::List, QDate(2026, 10, 17));
+    const QList<FtpFileInfo> list = parser.parse(
+        "-rw-r--r-- 1 u g 1 Nov 30 09:15 a\n", QStringLiteral("/"));
+    QCOMPARE(list.size(), 1);
+    QCOMPARE(list[0].lastModified, QDateTime(QDate(2025, 11, 30), QTime(9, 15)));
+}
+
+void TestFtpListParser::symlinkAndMissingGroup()
+{
+    FtpListParser parser(FtpListParser::Format::List, QDate(2026, 10, 17));
+    const QList<FtpFileInfo> list = parser.parse(
+        "lrwxrwxrwx 1 u g 3 Jan 02 10:00 current -> release-1\n"
+        "-rw-r--r-- 1 owner 77 Jan 03 08:00 nogroup.log\n",
+        QStringLiteral("/"));
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list[0].name, QStringLiteral("current"));
+    QVERIFY(!list[0].isDirectory);
+    QCOMPARE(list[1].name, QStringLiteral("nogroup.log"));
+    QCOMPARE(list[1].size, qint64(77));
+}
+
+void TestFtpListParser::dosListing()
+{
+    FtpListParser parser(FtpListParser::Format::List);
+    const QList<FtpFileInfo> list = parser.parse(
+        "01-01-24  12:00PM       <DIR>          Dir X\r\n"
+        "2024-03-05  01:07AM                 99 y z.bin\r\n",
+        QStringLiteral("/"));
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list[0].name, QStringLiteral("Dir X"));
+    QVERIFY(list[0].isDirectory);
+    QCOMPARE(list[0].lastModified, QDateTime(QDate(2024, 1, 1), QTime(12, 0)));
+    QCOMPARE(list[1].name, QStringLiteral("y z.bin"));
+    QCOMPARE(list[1].size, qint64(99));
+    QCOMPARE(list[1].lastModified, QDateTime(QDate(2024, 3, 5), QTime(1, 7)));
+}
+
+void TestFtpListParser::mlsdListing()
+{
+    FtpListParser parser(FtpListParser::Format::Mlsd);
+    const QList<FtpFileInfo> list = parser.parse(
+        "type=cdir;modify=20240101000000; .\r\n"
+        "type=dir;modify=20240102030405;UNIX.mode=0755; sub dir\r\n"
+        "Type=file;Size=12;Modify=20240101120000.123; a b.txt\r\n",
+        QStringLiteral("/"));
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list[0].name, QStringLiteral("sub dir"));
+    QVERIFY(list[0].isDirectory);
+    QCOMPARE(list[0].permissions, QStringLiteral("drwxr-xr-x"));
+    QCOMPARE(list[0].lastModified,
+             QDateTime(QDate(2024, 1, 2), QTime(3, 4, 5), QTimeZone::utc()));
+    QCOMPARE(list[1].name, QStringLiteral("a b.txt"));
+    QCOMPARE(list[1].size, qint64(12));
+}
+
+void TestFtpListParser::skipsNoise()
+{
+    FtpListParser parser(FtpListParser::Format::List);
+    const QList<FtpFileInfo> list = parser.parse(
+        "total 0\n\n   \ngarbage line\n"
+        "drwxr-xr-x 2 u g 4096 Jan 01 12:00 .\n"
+        "drwxr-xr-x 2 u g 4096 Jan 01 12:00 ..\n",
+        QStringLiteral("/"));
+    QVERIFY(list.isEmpty());
+}
+
+void TestFtpListParser::largeListing()
+{
+    QByteArray data;
+    for (int i = 0; i < 20000; ++i) {
+        data += "-rw-r--r--    1 user     group       12345 Jan 01 12:00 log_"
+              + QByteArray::number(i) + ".txt\r\n";
+    }
+    FtpListParser parser(FtpListParser::Format::List);
+    const QList<FtpFileInfo> list = parser.parse(data, QStringLiteral("/logs"));
+    QCOMPARE(list.size(), 20000);
+    QCOMPARE(list.last().name, QStringLiteral("log_19999.txt"));
+    // 权限串在条目间共享同一份数据
+    QVERIFY(list.first().permissions.isSharedWith(list.last().permissions));
+}
+
+QTEST_MAIN(TestFtpListParser)
+#include "tst_ftp_list_parser.moc"
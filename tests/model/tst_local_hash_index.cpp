@@ -0,0 +1,96 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDateTime>
+#include "model/LocalHashIndex.h"
+
+class TestLocalHashIndex : public QObject {
+    Q_OBJECT
+private:
+    QTemporaryDir m_dir;
+    QString writeFile(const QString& name, const QByteArray& data);
+private slots:
+    void knownDigest();
+    void cacheHitUntilModified();
+    void persistAcrossInstances();
+    void parallelMatchesSerial();
+    void largeFileMapped();
+};
+
+QString TestLocalHashIndex::writeFile(const QString& name, const QByteArray& data)
+{
+    const QString path = m_dir.filePath(name);
+    QFile f(path);
+    if (f.open(QIODevice::WriteOnly | QIODevice::Truncate)) f.write(data);
+    return path;
+}
+
+void TestLocalHashIndex::knownDigest()
+{
+    LocalHashIndex index{QString()};
+    const QString path = writeFile(QStringLiteral("abc.txt"), "abc");
+    QCOMPARE(index.hashOf(path), QStringLiteral("900150983cd24fb0d6963f7d28e17f72"));
+    QVERIFY(index.hashOf(m_dir.filePath(QStringLiteral("missing"))).isEmpty());
+}
+
+void TestLocalHashIndex::cacheHitUntilModified()
+{
+    LocalHashIndex index{QString()};
+    const QString path = writeFile(QStringLiteral("a.bin"), "first");
+    const QString h1 = index.hashOf(path);
+    QCOMPARE(index.stats().misses, qint64(1));
+
+    QCOMPARE(index.hashOf(path), h1);
+    QCOMPARE(index.stats().hits, qint64(1));
+
+    // 内容与大小都变化 → 重新计算
+    writeFile(QStringLiteral("a.bin"), "second!");
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadWrite));
+    QVERIFY(f.setFileTime(QDateTime::currentDateTime().addSecs(5), QFileDevice::FileModificationTime));
+    f.close();
+    QVERIFY(index.hashOf(path) != h1);
+    QCOMPARE(index.stats().misses, qint64(2));
+}
+
+void TestLocalHashIndex::persistAcrossInstances()
+{
+    const QString indexPath = m_dir.filePath(QStringLiteral("index.bin"));
+    const QString path = writeFile(QStringLiteral("p.txt"), "persist");
+    QString h;
+    {
+        LocalHashIndex index(indexPath);
+        h = index.hashOf(path);
+        QVERIFY(index.save());
+    }
+    LocalHashIndex reloaded(indexPath);
+    QCOMPARE(reloaded.size(), 1);
+    QCOMPARE(reloaded.hashOf(path), h);
+    QCOMPARE(reloaded.stats().hits, qint64(1));
+    QCOMPARE(reloaded.stats().misses, qint64(0));
+}
+
+void TestLocalHashIndex::parallelMatchesSerial()
+{
+    QStringList paths;
+    for (int i = 0; i < 64; ++i) {
+        paths << writeFile(QStringLiteral("f%1.dat").arg(i), QByteArray(1000 + i, char('a' + i % 26)));
+    }
+    LocalHashIndex parallel{QString()};
+    const QHash<QString, QString> all = parallel.hashAll(paths);
+    QCOMPARE(all.size(), paths.size());
+    for (const QString& p : paths) {
+        QCOMPARE(all.value(p), LocalHashIndex::computeHash(p));
+    }
+}
+
+void TestLocalHashIndex::largeFileMapped()
+{
+    QByteArray data(int(LocalHashIndex::kMapThreshold) * 3 + 17, 'x');
+    const QString path = writeFile(QStringLiteral("large.bin"), data);
+    QCOMPARE(LocalHashIndex::computeHash(path),
+             QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex()));
+}
+
+QTEST_MAIN(TestLocalHashIndex)
+#include "tst_local_hash_index.moc"
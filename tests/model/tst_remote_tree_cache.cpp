@@ -0,0 +1,170 @@
+#include <QtTest>
+#include <QHash>
+#include "model/RemoteTreeCache.h"
+
+// 模拟服务器：目录 → 列表，记录每个目录被列出的次数
+class FakeServer {
+public:
+    QHash<QString, QList<FtpFileInfo>> dirs;
+    QHash<QString, int> calls;
+
+    RemoteTreeCache::Lister lister()
+    {
+        return [this](const QString& dir) {
+            calls[dir]++;
+            return dirs.value(dir);
+        };
+    }
+
+    static FtpFileInfo entry(const QString& name, bool isDir, const QDateTime& mtime, qint64 size = 0)
+    {
+        FtpFileInfo info;
+        info.name = name;
+        info.isDirectory = isDir;
+        info.lastModified = mtime;
+        info.size = size;
+        return info;
+    }
+};
+
+class TestRemoteTreeCache : public QObject {
+    Q_OBJECT
+private:
+    const QDateTime t1 = QDateTime(QDate(2026, 1, 1), QTime(10, 0));
+    const QDateTime t2 = QDateTime(QDate(2026, 1, 2), QTime(10, 0));
+private slots:
+    void hitWithinTtl();
+    void expiresAfterTtl();
+    void incrementalRefresh();
+    void invalidateRecursive();
+    void listerErrorKeepsCache();
+    void mlsdSupportPerServer();
+};
+
+void TestRemoteTreeCache::hitWithinTtl()
+{
+    FakeServer server;
+    server.dirs["a"] = { FakeServer::entry("f.txt", false, t1, 3) };
+    RemoteTreeCache cache(60000);
+
+    RemoteTreeCache::Delta delta;
+    QCOMPARE(cache.list("dev", "/a/", server.lister(), false, &delta).size(), 1);
+    QVERIFY(!delta.fromCache);
+    QCOMPARE(delta.added, 1);
+
+    QCOMPARE(cache.list("dev", "a", server.lister(), false, &delta).size(), 1);
+    QVERIFY(delta.fromCache);
+    QCOMPARE(server.calls["a"], 1);
+
+    // 设备之间互不共享
+    cache.list("other", "a", server.lister());
+    QCOMPARE(server.calls["a"], 2);
+}
+
+void TestRemoteTreeCache::expiresAfterTtl()
+{
+    FakeServer server;
+    server.dirs["a"] = {};
+    RemoteTreeCache cache(20);
+
+    cache.list("dev", "a", server.lister());
+    QThread::msleep(40);
+    cache.list("dev", "a", server.lister());
+    QCOMPARE(server.calls["a"], 2);
+
+    cache.list("dev", "a", server.lister(), true);
+    QCOMPARE(server.calls["a"], 3);
+}
+
+void TestRemoteTreeCache::incrementalRefresh()
+{
+    FakeServer server;
+    server.dirs[""] = { FakeServer::entry("same", true, t1), FakeServer::entry("touched", true, t1),
+                        FakeServer::entry("gone", true, t1), FakeServer::entry("f", false, t1, 1) };
+    server.dirs["same"] = { FakeServer::entry("x", false, t1) };
+    server.dirs["touched"] = { FakeServer::entry("y", false, t1) };
+    server.dirs["gone"] = { FakeServer::entry("z", false, t1) };
+    server.dirs["gone/deep"] = {};
+    RemoteTreeCache cache(60000);
+
+    for (const QString& dir : { "", "same", "touched", "gone", "gone/deep" }) {
+        cache.list("dev", dir, server.lister());
+    }
+
+    // 服务器侧：touched 修改时间变化、gone 被删除、f 变大、new 新增
+    server.dirs[""] = { FakeServer::entry("same", true, t1), FakeServer::entry("touched", true, t2),
+                        FakeServer::entry("f", false, t1, 2), FakeServer::entry("new", false, t2) };
+    RemoteTreeCache::Delta delta;
+    cache.list("dev", "", server.lister(), true, &delta);
+    QCOMPARE(delta.added, 1);
+    QCOMPARE(delta.removed, 1);
+    QCOMPARE(delta.changed, 2);
+
+    QList<FtpFileInfo> out;
+    QVERIFY(!cache.peek("dev", "gone", out));
+    QVERIFY(!cache.peek("dev", "gone/deep", out));
+
+    cache.list("dev", "same", server.lister());
+    cache.list("dev", "touched", server.lister());
+    QCOMPARE(server.calls["same"], 1);      // 未变化的子目录仍命中缓存
+    QCOMPARE(server.calls["touched"], 2);   // 变化的子目录重新列出
+}
+
+void TestRemoteTreeCache::invalidateRecursive()
+{
+    FakeServer server;
+    RemoteTreeCache cache(60000);
+    for (const QString& dir : { "a", "a/b", "ab" }) cache.list("dev", dir, server.lister());
+
+    cache.invalidate("dev", "/a", true);
+    QList<FtpFileInfo> out;
+    QVERIFY(!cache.peek("dev", "a", out));
+    QVERIFY(!cache.peek("dev", "a/b", out));
+    QVERIFY(cache.peek("dev", "ab", out));
+
+    cache.invalidate("dev", "ab");
+    QVERIFY(cache.peek("dev", "ab", out));  // 非递归：保留内容，仅标记过期
+    cache.list("dev", "ab", server.lister());
+    QCOMPARE(server.calls["ab"], 2);
+}
+
+void TestRemoteTreeCache::listerErrorKeepsCache()
+{
+    FakeServer server;
+    server.dirs["a"] = { FakeServer::entry("f", false, t1) };
+    RemoteTreeCache cache(60000);
+    cache.list("dev", "a", server.lister());
+
+    bool thrown = false;
+    try {
+        cache.list("dev", "a", [](const QString&) -> QList<FtpFileInfo> {
+            throw std::runtime_error("offline");
+        }, true);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+    QList<FtpFileInfo> out;
+    QVERIFY(cache.peek("dev", "a", out));
+    QCOMPARE(out.size(), 1);
+}
+
+void TestRemoteTreeCache::mlsdSupportPerServer()
+{
+    RemoteTreeCache cache(60000);
+    QCOMPARE(cache.mlsdSupport("10.0.0.1:21"), -1);
+    cache.setMlsdSupport("10.0.0.1:21", false);
+    cache.setMlsdSupport("10.0.0.2:21", true);
+    QCOMPARE(cache.mlsdSupport("10.0.0.1:21"), 0);
+    QCOMPARE(cache.mlsdSupport("10.0.0.2:21"), 1);
+    QCOMPARE(cache.mlsdSupport("10.0.0.1:2121"), -1);
+
+    // 目录缓存失效不影响服务器能力记录
+    cache.invalidateDevice("10.0.0.1:21");
+    QCOMPARE(cache.mlsdSupport("10.0.0.1:21"), 0);
+    cache.clear();
+    QCOMPARE(cache.mlsdSupport("10.0.0.1:21"), -1);
+}
+
+QTEST_MAIN(TestRemoteTreeCache)
+#include "tst_remote_tree_cache.moc"
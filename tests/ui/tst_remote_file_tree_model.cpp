@@ -0,0 +1,167 @@
+#include <QtTest>
+#include <QAbstractItemModelTester>
+#include <QSemaphore>
+#include "ui/RemoteFileTreeModel.h"
+
+namespace {
+
+FtpFileInfo entry(const QString& name, bool isDir, qint64 size = 0)
+{
+    FtpFileInfo info;
+    info.name = name;
+    info.isDirectory = isDir;
+    info.size = size;
+    return info;
+}
+
+QList<FtpFileInfo> files(int count, const QString& prefix = QStringLiteral("f"))
+{
+    QList<FtpFileInfo> out;
+    for (int i = 0; i < count; ++i) out.append(entry(prefix + QString::number(i), false, i));
+    return out;
+}
+
+} // namespace
+
+class TestRemoteFileTreeModel : public QObject {
+    Q_OBJECT
+private slots:
+    void rootPaging();
+    void roles();
+    void lazyFetch();
+    void fetchFailureRetries();
+    void resetDiscardsInflight();
+    void sortDirsFirst();
+};
+
+void TestRemoteFileTreeModel::rootPaging()
+{
+    RemoteFileTreeModel model;
+    QAbstractItemModelTester tester(&model);
+    model.setBatchSize(500);
+    model.setRoot("dev (/r/)", "/r/", files(1200), true);
+
+    const QModelIndex root = model.index(0, 0);
+    QCOMPARE(model.rowCount(root), 1 + 500);   // "返回上一级" + 第一批
+    QVERIFY(model.canFetchMore(root));
+    model.fetchMore(root);
+    QCOMPARE(model.rowCount(root), 1 + 1000);
+    model.fetchMore(root);
+    QCOMPARE(model.rowCount(root), 1 + 1200);
+    QVERIFY(!model.canFetchMore(root));
+}
+
+void TestRemoteFileTreeModel::roles()
+{
+    RemoteFileTreeModel model;
+    model.setRoot("dev (/r/)", "/r/", { entry("sub", true), entry("a.txt", false, 2048) }, true);
+
+    const QModelIndex root = model.index(0, 0);
+    QVERIFY(root.data(RemoteFileTreeModel::IsRootRole).toBool());
+    QCOMPARE(root.data(Qt::DisplayRole).toString(), QStringLiteral("dev (/r/)"));
+
+    const QModelIndex up = model.index(0, 0, root);
+    QCOMPARE(up.data(RemoteFileTreeModel::PathRole).toString(), QStringLiteral("/"));
+    QVERIFY(up.data(RemoteFileTreeModel::IsDirRole).toBool());
+    QVERIFY(!model.hasChildren(up));
+
+    const QModelIndex sub = model.index(1, 0, root);
+    QCOMPARE(sub.data(RemoteFileTreeModel::PathRole).toString(), QStringLiteral("/r/sub/"));
+    QCOMPARE(sub.data(RemoteFileTreeModel::NameRole).toString(), QStringLiteral("sub"));
+    QVERIFY(model.hasChildren(sub));
+
+    const QModelIndex file = model.index(2, 0, root);
+    QCOMPARE(file.data(RemoteFileTreeModel::PathRole).toString(), QStringLiteral("/r/a.txt"));
+    QCOMPARE(file.data(Qt::DisplayRole).toString(), QStringLiteral("a.txt (2.0 KB)"));
+    QVERIFY(!model.hasChildren(file));
+}
+
+void TestRemoteFileTreeModel::lazyFetch()
+{
+    RemoteFileTreeModel model;
+    QAbstractItemModelTester tester(&model);
+    QStringList listed;
+    model.setLister([&listed](const QString& dir) {
+        listed << dir;
+        return files(30, QStringLiteral("x"));
+    });
+    model.setBatchSize(20);
+    model.setRoot("dev (/)", "/", { entry("sub", true) }, false);
+
+    QSignalSpy loaded(&model, &RemoteFileTreeModel::directoryLoaded);
+    const QModelIndex sub = model.index(0, 0, model.index(0, 0));
+    QCOMPARE(model.rowCount(sub), 0);
+    QVERIFY(model.canFetchMore(sub));
+    model.fetchMore(sub);
+    QVERIFY(!model.canFetchMore(sub));   // 列出中不重复请求
+
+    QTRY_COMPARE(model.rowCount(sub), 20);
+    QCOMPARE(loaded.count(), 1);
+    QCOMPARE(loaded.at(0).at(0).toString(), QStringLiteral("/sub/"));
+    QCOMPARE(listed, QStringList{ QStringLiteral("/sub/") });
+    QCOMPARE(model.index(0, 0, sub).data(RemoteFileTreeModel::PathRole).toString(),
+             QStringLiteral("/sub/x0"));
+
+    QVERIFY(model.canFetchMore(sub));
+    model.fetchMore(sub);
+    QCOMPARE(model.rowCount(sub), 30);
+    QVERIFY(!model.canFetchMore(sub));
+}
+
+void TestRemoteFileTreeModel::fetchFailureRetries()
+{
+    RemoteFileTreeModel model;
+    int calls = 0;
+    model.setLister([&calls](const QString&) -> QList<FtpFileInfo> {
+        if (++calls == 1) throw std::runtime_error("offline");
+        return files(3);
+    });
+    model.setRoot("dev (/)", "/", { entry("sub", true) }, false);
+
+    QSignalSpy failed(&model, &RemoteFileTreeModel::directoryFailed);
+    const QModelIndex sub = model.index(0, 0, model.index(0, 0));
+    model.fetchMore(sub);
+    QTRY_COMPARE(failed.count(), 1);
+    QCOMPARE(failed.at(0).at(1).toString(), QStringLiteral("offline"));
+
+    QVERIFY(model.canFetchMore(sub));
+    model.fetchMore(sub);
+    QTRY_COMPARE(model.rowCount(sub), 3);
+}
+
+void TestRemoteFileTreeModel::resetDiscardsInflight()
+{
+    RemoteFileTreeModel model;
+    QAbstractItemModelTester tester(&model);
+    QSemaphore gate;
+    model.setLister([&gate](const QString&) {
+        gate.acquire();
+        return files(5);
+    });
+    model.setRoot("dev (/)", "/", { entry("sub", true) }, false);
+
+    QSignalSpy loaded(&model, &RemoteFileTreeModel::directoryLoaded);
+    model.fetchMore(model.index(0, 0, model.index(0, 0)));
+
+    // 列出期间切换目录：旧结果到达后必须丢弃
+    model.setRoot("dev (/other/)", "/other/", { entry("b", false) }, true);
+    gate.release();
+    QTest::qWait(200);
+
+    QCOMPARE(loaded.count(), 0);
+    QCOMPARE(model.rowCount(model.index(0, 0)), 2);
+}
+
+void TestRemoteFileTreeModel::sortDirsFirst()
+{
+    QList<FtpFileInfo> list = { entry("b.txt", false), entry("Zdir", true), entry("A.txt", false),
+                                entry("adir", true) };
+    RemoteFileTreeModel::sortEntries(list);
+    QCOMPARE(list[0].name, QStringLiteral("adir"));
+    QCOMPARE(list[1].name, QStringLiteral("Zdir"));
+    QCOMPARE(list[2].name, QStringLiteral("A.txt"));
+    QCOMPARE(list[3].name, QStringLiteral("b.txt"));
+}
+
+QTEST_GUILESS_MAIN(TestRemoteFileTreeModel)
+#include "tst_remote_file_tree_model.moc"